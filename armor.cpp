@@ -1,6 +1,6 @@
 #include "armor.h"
-#include <Windows.h>
-#include <gl/GL.h>
+#include "platform.h"
+#include "gl_stats.h"
 #include "utils.h"
 
 extern float* segCos;
@@ -23,6 +23,7 @@ void setArmorMaterial() {
 }
 
 void drawHelmet() {
+    GL_STATS_SCOPE(SUB_ARMOR);
     setArmorMaterial();
     const int segments = 32;
     const float helmetRadius = HEAD_RADIUS * 1.75f;
@@ -270,6 +271,7 @@ void drawHelmet() {
 }
 
 void drawArmor() {
+    GL_STATS_SCOPE(SUB_ARMOR);
     setArmorMaterial();
     glPushMatrix();
     // Increased scale to make armor significantly bigger than torso
@@ -300,6 +302,7 @@ void drawShoulderArmor() {
 }
 
 void drawUpperLegArmor() { // Draws Thigh Guard
+    GL_STATS_SCOPE(SUB_ARMOR);
     setArmorMaterial();
     const int legSegments = 40;
     const float legScale = 0.7f * 1.15f;
@@ -334,6 +337,7 @@ void drawUpperLegArmor() { // Draws Thigh Guard
 }
 
 void drawLowerLegArmor() { // Draws Shin Guard
+    GL_STATS_SCOPE(SUB_ARMOR);
     setArmorMaterial();
     const int legSegments = 40;
     const float legScale = 0.8f * 1.10f;
@@ -354,6 +358,7 @@ void drawLowerLegArmor() { // Draws Shin Guard
 }
 
 void drawSabatons() {
+    GL_STATS_SCOPE(SUB_ARMOR);
     setArmorMaterial();
     const int segments = 40;
     const float scale = 1.1f;
@@ -465,6 +470,7 @@ void drawSabatons() {
 // ===================================================================
 
 void drawUpperArmArmor() {
+    GL_STATS_SCOPE(SUB_ARMOR);
     setArmorMaterial();
     const float armScale = 0.14f; // Same as ARM_SCALE
     const float armorRadius = (0.8f) * armScale; // Base arm radius + armor thickness
@@ -2,29 +2,90 @@
 #include <vector>
 #include <algorithm>
 #include <ctime>
+#include <cfloat>
 #include <cmath>
 #include <cstring>
+#include <cstdio>
+#include <chrono>
+#include "command_list.h"
+#include "gl_stats.h"
+#include "jobs.h"
+#include "log.h"
+#include "rng.h"
+#include "terrain.h"
+#include "texture_manager.h"
+#include "texture_atlas.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// Force ANSI version for this specific function call
-#undef LoadImage
-#define LoadImage LoadImageA
-
 // Initialize static variables
 GLUquadric* BackgroundRenderer::quadric = nullptr;
-float BackgroundRenderer::windTime = 0.0f;
-float BackgroundRenderer::cloudTime = 0.0f;
-int BackgroundRenderer::currentWeather = WEATHER_CLEAR;
 float BackgroundRenderer::lightningTimer = 0.0f;
-float BackgroundRenderer::lightningBrightness = 0.0f;
-float BackgroundRenderer::siegeTime = 0.0f;
-float BackgroundRenderer::dayNightTime = 0.0f;
-std::vector<Spark> BackgroundRenderer::sparks;
-std::vector<Arrow> BackgroundRenderer::arrows;
-std::vector<Ember> BackgroundRenderer::embers;
+// Siege particles; capacities are the on-screen caps of each effect. The
+// drawn copy takes them from the first frame applied.
+static BackgroundRenderer::Snapshot firstStep() {
+    BackgroundRenderer::Snapshot state;
+    state.weather = WEATHER_CLEAR;
+    state.sparks = ParticlePool(1024);
+    state.arrows = ParticlePool(4096);
+    state.embers = ParticlePool(30);
+    return state;
+}
+BackgroundRenderer::Snapshot BackgroundRenderer::simulated = firstStep();
+BackgroundRenderer::Snapshot BackgroundRenderer::drawn;
+size_t BackgroundRenderer::nextStuckArrow = 0;
+std::vector<float> BackgroundRenderer::arrowStepX;
+std::vector<float> BackgroundRenderer::arrowStepY;
+std::vector<float> BackgroundRenderer::arrowStepZ;
+std::vector<SegmentHit> BackgroundRenderer::arrowHits;
+BackgroundRenderer::Capsule BackgroundRenderer::characterCapsule = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+unsigned BackgroundRenderer::arrowHitsOnCharacter = 0;
+const size_t kMaxStuckArrows = 512;
+const int kArrowsPerVolley = 40;
+// Billboard batches, refilled by their passes; the shapes are the quads each
+// pass used to draw one at a time
+BillboardBatch BackgroundRenderer::armyBillboards(1.0f, 2.0f, 1.0f);
+BillboardBatch BackgroundRenderer::archerBillboards(1.0f, 1.5f, 1.0f);
+BillboardBatch BackgroundRenderer::cavalryBillboards(1.0f, 2.0f, 1.0f);
+BillboardBatch BackgroundRenderer::starBillboards(0.5f, 1.0f, 0.5f);
+BillboardBatch BackgroundRenderer::forestBillboards(1.0f, 2.0f, 1.0f);
+RenderQueue BackgroundRenderer::warSceneQueue;
+
+// Many passes used to inherit their colour and normal (both matter under
+// lighting) from whatever was drawn before them. The render queue reorders
+// the war scene and culling skips passes out of view, so they set the values
+// they always had.
+static const float kSiegeTint[3] = { 0.25f, 0.25f, 0.3f };
+static const float kSiegeNormal[3] = { 0.0f, 0.3826835f, -0.9238795f };
+static const float kCampTint[3] = { 0.15f, 0.1f, 0.08f };
+static const float kCampNormal[3] = { 0.0f, 0.5f, -0.8660254f };
+static const float kCampfireNormal[3] = { 0.0f, 0.50000006f, -0.8660254f };   // Left by the cooking pot's sphere
+static const float kArmyTint[3] = { 0.7f, 0.35f, 0.18f };
+static const float kFacingNormal[3] = { 0.0f, 0.0f, 1.0f };
+static const float kUpNormal[3] = { 0.0f, 1.0f, 0.0f };
+static const float kFortressNormal[3] = { 0.0f, 0.8479983f, 0.52999896f };
+static const float kCastleNormal[3] = { 0.0f, 0.8637789f, 0.503871f };
+static const float kSlopeNormal[3] = { 0.0f, 0.7071068f, -0.7071068f };
+static const float kArmNormal[3] = { 0.0f, 0.70710683f, -0.70710683f };
+static const float kRackNormal[3] = { 0.0f, 0.76822126f, -0.6401844f };
+static const float kBannerNormal[3] = { 0.0f, 0.8660254f, -0.50000006f };
+
+// Procedural scatter, generated once by buildScatter() from fixed seeds
+std::vector<BackgroundRenderer::GrassBlade> BackgroundRenderer::grassBlades;
+std::vector<BackgroundRenderer::ScatterPoint> BackgroundRenderer::herbs;
+std::vector<BackgroundRenderer::RainDrop> BackgroundRenderer::rainDrops;
+std::vector<BackgroundRenderer::Rubble> BackgroundRenderer::rubble;
+std::vector<BackgroundRenderer::Rubble> BackgroundRenderer::woodDebris;
+std::vector<BackgroundRenderer::ScatterPoint> BackgroundRenderer::volleyJitter;
+
+// Per-system generators for the effects that stay random frame to frame,
+// seeded so a run replays exactly. The bolts' own generator is drawn from by
+// render() on the render thread, the others by update() on the simulation's.
+static Rng siegeRandom(0x5EE9u);
+static Rng lightningRandom(0x11647u);
+static Rng boltRandom(0xB0175u);
 
 // Audio system variables
 bool BackgroundRenderer::warSoundPlaying = false;
@@ -32,16 +93,79 @@ bool BackgroundRenderer::warSoundInitialized = false;
 float BackgroundRenderer::warSoundVolume = 0.7f;
 
 // Collision detection variables
-std::vector<BackgroundRenderer::CollisionBox> BackgroundRenderer::collisionBoxes;
+std::vector<CollisionBox> BackgroundRenderer::collisionBoxes;
+CollisionGrid BackgroundRenderer::collisionGrid;
 bool BackgroundRenderer::collisionDebugMode = false;
 
 // Texture system variables
 GLuint BackgroundRenderer::textures[50];
+GLuint BackgroundRenderer::boundTexture = 0;
 bool BackgroundRenderer::texturesLoaded = false;
 
+// Static scene cache variables
+std::vector<BackgroundRenderer::StaticBatch> BackgroundRenderer::staticBatches;
+bool BackgroundRenderer::staticCacheEnabled = true;
+BackgroundRenderer::FrameStats BackgroundRenderer::frameStats = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0, 0.0 };
+
+// Frustum culling variables
+Frustum BackgroundRenderer::viewFrustum;
+bool BackgroundRenderer::cullingEnabled = true;
+bool BackgroundRenderer::cullingActive = false;
+
+// Every pass that draws the same thing each frame, grouped by layer and then
+// by primary texture, each compiled into its own display list
+const BackgroundRenderer::StaticPass BackgroundRenderer::staticPasses[] = {
+    { drawSkyDome,                 TEX_SKY,               LAYER_SKY,   true },
+    { drawMountains,               TEX_MOUNTAIN,          LAYER_FAR,   false },
+    { drawWesternCastle,           -1,                    LAYER_WORLD, false },
+    { drawBatteringRams,           -1,                    LAYER_WORLD, false },
+    { drawTrebuchetFrames,         -1,                    LAYER_WORLD, false },
+    { drawWesternKnightFormations, -1,                    LAYER_WORLD, false },
+    { drawWesternWarHorns,         -1,                    LAYER_WORLD, false },
+    { drawWeaponRacks,             -1,                    LAYER_WORLD, false },
+    { drawChineseFortress,         TEX_CASTLE,            LAYER_WORLD, false },
+    { drawSiegeLadders,            TEX_CASTLE,            LAYER_WORLD, false },
+    { drawSiegeTowers,             TEX_CASTLE,            LAYER_WORLD, false },
+    { drawBattlefield,             TEX_BATTLEFIELD,       LAYER_WORLD, false },
+    { drawChineseWarDrums,         TEX_WOOD,              LAYER_WORLD, false },
+    { drawMassiveArmy,             TEX_BILLBOARD_ATLAS,   LAYER_WORLD, false },
+    { drawArcherFormations,        TEX_BILLBOARD_ATLAS,   LAYER_WORLD, false },
+    { drawFallenWarriors,          TEX_FALLEN_WARRIOR,    LAYER_WORLD, false },
+    { drawWarHorses,               TEX_HORSES,            LAYER_WORLD, false },
+};
+
+// The passes drawn every frame, in the order render() draws them
+const BackgroundRenderer::AnimatedPassInfo BackgroundRenderer::animatedPasses[ANIMATED_PASS_COUNT] = {
+    { "stars",                 drawStars },
+    { "clouds",                drawClouds },
+    { "birds",                 drawBirds },
+    { "trebuchet arms",        drawTrebuchets },
+    { "catapult stones",       drawCatapultStones },
+    { "arrow volleys",         drawArrowVolleys },
+    { "trebuchet battery",     drawTrebuchetBattery },
+    { "battering ram assault", drawBatteringRamAssault },
+    { "arrow volley",          drawArrowVolley },
+    { "campfires",             drawCampfireFlames },
+    { "war drums",             drawWarDrums },
+    { "trees",                 drawTrees },
+    { "dragon banners",        drawChineseDragonBanners },
+    { "fire lances",           drawChineseFireLances },
+    { "crossbow squads",       drawWesternCrossbowSquads },
+    { "grass",                 drawGrass },
+    { "weapons and debris",    drawWeaponsAndDebris },
+    { "banners",               drawBanners },
+    { "fires",                 drawFires },
+};
+
+// Pass boxes, filled in by measurePassBounds()
+PassBounds BackgroundRenderer::animatedBounds[ANIMATED_PASS_COUNT];
+std::vector<PassBounds> BackgroundRenderer::staticBounds;
+
+const int BackgroundRenderer::staticPassCount = sizeof(staticPasses) / sizeof(staticPasses[0]);
+
 
 void BackgroundRenderer::init() {
-    printf("Initializing BackgroundRenderer...\n");
+    LOG_INFO("Initializing BackgroundRenderer...");
     
     quadric = gluNewQuadric();
     gluQuadricNormals(quadric, GLU_SMOOTH);
@@ -61,23 +185,34 @@ void BackgroundRenderer::init() {
     glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
     glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
 
-    // Seed random generator for effects like fire and grass
-    srand(time(NULL));
+    // Scatter grass, rain, trees and debris once, from fixed seeds
+    buildScatter();
     
     // Load all textures
-    printf("Loading all textures...\n");
+    LOG_INFO("Loading all textures...");
     loadAllTextures();
     
     // Initialize audio system
-    printf("Initializing audio system...\n");
+    LOG_INFO("Initializing audio system...");
     warSoundInitialized = true;
     warSoundPlaying = false;
     
     // Initialize collision detection system
-    printf("Initializing collision detection...\n");
+    LOG_INFO("Initializing collision detection...");
     initializeCollisionBoxes();
     
-    printf("BackgroundRenderer initialization complete.\n");
+    // Ground heightfield: one display list per chunk and level of detail
+    Terrain::upload();
+    
+    // Compile the time-invariant scene once
+    LOG_INFO("Building static scene cache...");
+    buildStaticCache();
+    
+    // Boxes around what each pass draws, for the frustum test
+    LOG_INFO("Measuring pass bounds...");
+    measurePassBounds();
+    
+    LOG_INFO("BackgroundRenderer initialization complete.");
 }
 
 void BackgroundRenderer::cleanup() {
@@ -86,9 +221,12 @@ void BackgroundRenderer::cleanup() {
         quadric = nullptr;
     }
     
-    // Clean up textures
+    releaseStaticCache();
+    Terrain::release();
+    
+    // Clean up textures (the names belong to the texture manager)
     if (texturesLoaded) {
-        glDeleteTextures(50, textures);
+        memset(textures, 0, sizeof(textures));
         texturesLoaded = false;
     }
     
@@ -100,186 +238,225 @@ void BackgroundRenderer::cleanup() {
     warSoundInitialized = false;
 }
 
+void BackgroundRenderer::advanceClocks(Snapshot& state, float deltaTime) {
+    state.windTime += deltaTime * 0.8f;
+    state.cloudTime += deltaTime * 0.15f;
+    state.siegeTime += deltaTime;
+    state.dayNightTime += deltaTime; // Update day/night cycle
+}
+
 void BackgroundRenderer::update(float deltaTime) {
-    windTime += deltaTime * 0.8f;
-    cloudTime += deltaTime * 0.15f;
-    siegeTime += deltaTime;
-    dayNightTime += deltaTime; // Update day/night cycle
+    advanceClocks(simulated, deltaTime);
 
     // Update lightning for storms
-    if (currentWeather == WEATHER_STORM) {
+    if (simulated.weather == WEATHER_STORM) {
         lightningTimer -= deltaTime;
         if (lightningTimer <= 0.0f) {
             // More intense and varied lightning strikes
-            lightningBrightness = 0.7f + (rand() % 30) / 100.0f; // Random brightness 0.7-1.0
-            lightningTimer = 1.0f + (rand() % 40) / 10.0f;       // Next strike in 1-5 seconds (more frequent)
+            simulated.lightningBrightness = 0.7f + lightningRandom.below(30) / 100.0f; // Random brightness 0.7-1.0
+            lightningTimer = 1.0f + lightningRandom.below(40) / 10.0f;       // Next strike in 1-5 seconds (more frequent)
         }
         // Faster fade out for more dramatic flicker
-        lightningBrightness -= deltaTime * 6.0f;
-        if (lightningBrightness < 0.0f) lightningBrightness = 0.0f;
+        simulated.lightningBrightness -= deltaTime * 6.0f;
+        if (simulated.lightningBrightness < 0.0f) simulated.lightningBrightness = 0.0f;
     } else {
-        lightningBrightness = 0.0f;
+        simulated.lightningBrightness = 0.0f;
     }
 
     // Update siege effects
     updateSiegeEffects(deltaTime);
 }
 
+void BackgroundRenderer::capture(Snapshot& out) {
+    out.windTime = simulated.windTime;
+    out.cloudTime = simulated.cloudTime;
+    out.siegeTime = simulated.siegeTime;
+    out.dayNightTime = simulated.dayNightTime;
+    out.weather = simulated.weather;
+    out.lightningBrightness = simulated.lightningBrightness;
+    out.arrows.assign(simulated.arrows);
+    out.sparks.assign(simulated.sparks);
+    out.embers.assign(simulated.embers);
+    out.stuckArrows = simulated.stuckArrows;
+}
+
+void BackgroundRenderer::apply(const Snapshot& in, float behind) {
+    drawn.windTime = in.windTime;
+    drawn.cloudTime = in.cloudTime;
+    drawn.siegeTime = in.siegeTime;
+    drawn.dayNightTime = in.dayNightTime;
+    drawn.weather = in.weather;
+    drawn.lightningBrightness = in.lightningBrightness;
+    drawn.arrows.assign(in.arrows);
+    drawn.sparks.assign(in.sparks);
+    drawn.embers.assign(in.embers);
+    drawn.stuckArrows = in.stuckArrows;
+    behind = std::min(behind, drawn.siegeTime);  // Not back past the first step
+    if (behind > 0.0f) {
+        advanceClocks(drawn, -behind);
+        drawn.arrows.drift(-behind);
+        drawn.sparks.drift(-behind);
+        drawn.embers.drift(-behind);
+    }
+}
+
 // ===== SIEGE EFFECTS UPDATE =====
 void BackgroundRenderer::updateSiegeEffects(float deltaTime) {
-    // Update flying arrows
-    for (auto it = arrows.begin(); it != arrows.end();) {
-        it->position.x += it->velocity.x * deltaTime;
-        it->position.y += it->velocity.y * deltaTime;
-        it->position.z += it->velocity.z * deltaTime;
-        it->velocity.y -= 9.8f * deltaTime; // Gravity
-        it->lifetime -= deltaTime;
-        
-        if (it->lifetime <= 0.0f || it->position.y < 0.0f) {
-            it = arrows.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    collideArrows(deltaTime);              // Before the step it tests
+
+    // The pools step independently, one job each
+    ParticlePool* const pools[3] = { &simulated.arrows, &simulated.sparks, &simulated.embers };
+    static const float acceleration[3] = {
+        -9.8f,                             // Gravity
+        -5.0f,                             // Light gravity
+        2.0f,                              // Rising with heat
+    };
+    Jobs::parallelFor(3, 1, [&pools, deltaTime](size_t begin, size_t end) {
+        for (size_t pool = begin; pool < end; ++pool) pools[pool]->update(deltaTime, acceleration[pool]);
+    });
     
-    // Update sparks from metalwork
-    for (auto it = sparks.begin(); it != sparks.end();) {
-        it->position.x += it->velocity.x * deltaTime;
-        it->position.y += it->velocity.y * deltaTime;
-        it->position.z += it->velocity.z * deltaTime;
-        it->velocity.y -= 5.0f * deltaTime; // Light gravity
-        it->lifetime -= deltaTime;
-        
-        if (it->lifetime <= 0.0f) {
-            it = sparks.erase(it);
-        } else {
-            ++it;
+    // Spawn new effects periodically
+    if (fmod(simulated.siegeTime, 0.5f) < deltaTime) {
+        spawnSiegeEffects();
+    }
+}
+
+// Tests each arrow's coming step (the segment update() will move it along)
+// against the collision grid in one batch, then the character and the
+// ground. Struck arrows are expired before the step is taken.
+void BackgroundRenderer::collideArrows(float deltaTime) {
+    const size_t count = simulated.arrows.size();
+    if (count == 0) return;
+    if (arrowHits.size() < simulated.arrows.capacity()) {
+        arrowStepX.resize(simulated.arrows.capacity());
+        arrowStepY.resize(simulated.arrows.capacity());
+        arrowStepZ.resize(simulated.arrows.capacity());
+        arrowHits.resize(simulated.arrows.capacity());
+    }
+    const float* x = simulated.arrows.x(), * y = simulated.arrows.y(), * z = simulated.arrows.z();
+    const float* vx = simulated.arrows.velocityX(), * vy = simulated.arrows.velocityY(), * vz = simulated.arrows.velocityZ();
+    for (size_t i = 0; i < count; ++i) {
+        arrowStepX[i] = vx[i] * deltaTime;
+        arrowStepY[i] = vy[i] * deltaTime;
+        arrowStepZ[i] = vz[i] * deltaTime;
+    }
+    collisionGrid.segmentHits(x, y, z, arrowStepX.data(), arrowStepY.data(), arrowStepZ.data(), count, arrowHits.data());
+
+    const Capsule& body = characterCapsule;
+    for (size_t i = 0; i < count; ++i) {
+        SegmentHit& hit = arrowHits[i];
+        const float step[3] = { arrowStepX[i], arrowStepY[i], arrowStepZ[i] };
+        bool struck = hit.box >= 0;
+        bool stick = struck && collisionBoxes[hit.box].category != COLLIDE_FORTIFICATION; // Stone walls deflect
+
+        float time;
+        if (body.radius > 0.0f && segmentHitsCapsule(x[i], y[i], z[i], step[0], step[1], step[2],
+                                                     body.x, body.z, body.bottomY, body.topY, body.radius, time) &&
+            (!struck || time < hit.time)) {
+            // Glances off the armour
+            const float hx = x[i] + step[0] * time - body.x, hz = z[i] + step[2] * time - body.z;
+            const float length = sqrtf(hx * hx + hz * hz);
+            hit.time = time;
+            hit.normal[0] = length > 1e-6f ? hx / length : 0.0f;
+            hit.normal[1] = length > 1e-6f ? 0.0f : 1.0f;
+            hit.normal[2] = length > 1e-6f ? hz / length : 0.0f;
+            struck = true;
+            stick = false;
+            ++arrowHitsOnCharacter;
         }
+
+        if (!struck) {
+            // Ground: where the height above the terrain changes sign
+            const float above0 = y[i] - Terrain::heightAt(x[i], z[i]);
+            const float above1 = y[i] + step[1] - Terrain::heightAt(x[i] + step[0], z[i] + step[2]);
+            if (above1 >= 0.0f) continue;
+            hit.time = above0 > 0.0f ? above0 / (above0 - above1) : 0.0f;
+            hit.normal[0] = 0.0f; hit.normal[1] = 1.0f; hit.normal[2] = 0.0f;
+            stick = true;
+        }
+
+        spawnArrowImpact(x[i] + step[0] * hit.time, y[i] + step[1] * hit.time, z[i] + step[2] * hit.time,
+                         step, hit.normal, stick);
+        simulated.arrows.expire(i);
     }
-    
-    // Update fire embers
-    for (auto it = embers.begin(); it != embers.end();) {
-        it->position.x += it->velocity.x * deltaTime;
-        it->position.y += it->velocity.y * deltaTime;
-        it->position.z += it->velocity.z * deltaTime;
-        it->velocity.y += 2.0f * deltaTime; // Rising with heat
-        it->lifetime -= deltaTime;
-        
-        if (it->lifetime <= 0.0f) {
-            it = embers.erase(it);
+}
+
+void BackgroundRenderer::spawnArrowImpact(float x, float y, float z, const float direction[3], const float normal[3], bool stick) {
+    if (stick) {
+        const float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+        const float inverse = length > 1e-6f ? 1.0f / length : 0.0f;
+        const StuckArrow arrow = { x, y, z, direction[0] * inverse, direction[1] * inverse, direction[2] * inverse };
+        if (simulated.stuckArrows.size() < kMaxStuckArrows) {
+            simulated.stuckArrows.push_back(arrow);
         } else {
-            ++it;
+            simulated.stuckArrows[nextStuckArrow] = arrow;
+            nextStuckArrow = (nextStuckArrow + 1) % kMaxStuckArrows;
         }
+        return;
     }
-    
-    // Spawn new effects periodically
-    if (fmod(siegeTime, 0.5f) < deltaTime) {
-        spawnSiegeEffects();
+
+    // Sparks thrown back off the surface
+    for (int i = 0; i < 4 && !simulated.sparks.full(); i++) {
+        float vx = normal[0] * 3.0f + (siegeRandom.below(10) - 5) * 0.4f;
+        float vy = normal[1] * 3.0f + siegeRandom.below(8) * 0.5f;
+        float vz = normal[2] * 3.0f + (siegeRandom.below(10) - 5) * 0.4f;
+        simulated.sparks.spawn(x, y, z, vx, vy, vz, 0.3f + siegeRandom.below(100) / 300.0f);
     }
 }
 
+void BackgroundRenderer::setCharacterCapsule(float x, float z, float bottomY, float topY, float radius) {
+    characterCapsule = { x, z, bottomY, topY, radius };
+}
+
 void BackgroundRenderer::spawnSiegeEffects() {
-    // Spawn arrows during siege
-    if (arrows.size() < 20) {
-        Arrow arrow;
-        arrow.position = {-80.0f + (rand() % 160), 25.0f + (rand() % 15), -60.0f + (rand() % 20)};
-        arrow.velocity = {15.0f + (rand() % 10), -5.0f + (rand() % 5), 10.0f + (rand() % 5)};
-        arrow.lifetime = 3.0f + (rand() % 200) / 100.0f;
-        arrows.push_back(arrow);
+    // Spawn an arrow volley during siege: a loose block of archers loosing together
+    float volleyX = -80.0f + siegeRandom.below(160), volleyZ = -60.0f + siegeRandom.below(20);
+    for (int i = 0; i < kArrowsPerVolley && !simulated.arrows.full(); i++) {
+        float x = volleyX + siegeRandom.below(100) / 10.0f, y = 25.0f + siegeRandom.below(15), z = volleyZ + siegeRandom.below(60) / 10.0f;
+        float vx = 15.0f + siegeRandom.below(10), vy = -5.0f + siegeRandom.below(5), vz = 10.0f + siegeRandom.below(5);
+        simulated.arrows.spawn(x, y, z, vx, vy, vz, 3.0f + siegeRandom.below(200) / 100.0f);
     }
     
     // Spawn sparks from metalwork
-    if (sparks.size() < 50) {
+    if (!simulated.sparks.full()) {
         for (int i = 0; i < 5; i++) {
-            Spark spark;
-            spark.position = {-40.0f + (rand() % 80), 8.0f + (rand() % 5), -35.0f + (rand() % 10)};
-            spark.velocity = {(rand() % 10 - 5) * 0.5f, (float)(rand() % 8), (rand() % 10 - 5) * 0.5f};
-            spark.lifetime = 0.5f + (rand() % 100) / 200.0f;
-            sparks.push_back(spark);
+            float x = -40.0f + siegeRandom.below(80), y = 8.0f + siegeRandom.below(5), z = -35.0f + siegeRandom.below(10);
+            float vx = (siegeRandom.below(10) - 5) * 0.5f, vy = (float)siegeRandom.below(8), vz = (siegeRandom.below(10) - 5) * 0.5f;
+            simulated.sparks.spawn(x, y, z, vx, vy, vz, 0.5f + siegeRandom.below(100) / 200.0f);
         }
     }
     
     // Spawn fire embers
-    if (embers.size() < 30) {
+    if (!simulated.embers.full()) {
         for (int i = 0; i < 3; i++) {
-            Ember ember;
-            ember.position = {15.0f + (rand() % 10), 2.0f, -8.0f + (rand() % 4)};
-            ember.velocity = {(rand() % 6 - 3) * 0.3f, 2.0f + (rand() % 3), (rand() % 6 - 3) * 0.3f};
-            ember.lifetime = 2.0f + (rand() % 150) / 100.0f;
-            embers.push_back(ember);
+            float x = 15.0f + siegeRandom.below(10), z = -8.0f + siegeRandom.below(4);
+            float vx = (siegeRandom.below(6) - 3) * 0.3f, vy = 2.0f + siegeRandom.below(3), vz = (siegeRandom.below(6) - 3) * 0.3f;
+            simulated.embers.spawn(x, 2.0f, z, vx, vy, vz, 2.0f + siegeRandom.below(150) / 100.0f);
         }
     }
 }
 
 // ===== TEXTURE SYSTEM =====
-GLuint BackgroundRenderer::loadBMPTexture(const char* filename) {
-    printf("Loading texture: %s\n", filename);
-    
-    GLuint textureID = 0;
-    HBITMAP hBMP = NULL;
-    BITMAP BMP;
-
-    // Load bitmap using the same method as the working example
-    hBMP = (HBITMAP)LoadImage(GetModuleHandle(NULL), filename, IMAGE_BITMAP, 0, 0, 
-                              LR_CREATEDIBSECTION | LR_LOADFROMFILE);
-
-    // If loading failed, show detailed error information
-    if (!hBMP) {
-        DWORD error = GetLastError();
-        printf("ERROR: Could not load texture file '%s'. Error code: %lu\n", filename, error);
-        
-        // Create a simple colored texture as fallback instead of returning 0
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        
-        // Create a 2x2 white texture as fallback
-        unsigned char whitePixels[12] = {255,255,255, 255,255,255, 255,255,255, 255,255,255};
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2, 2, 0, GL_RGB, GL_UNSIGNED_BYTE, whitePixels);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        return textureID;
-    }
-
-    printf("Successfully loaded texture: %s\n", filename);
-
-    // Get bitmap information
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-    GetObject(hBMP, sizeof(BMP), &BMP);
-
-    // Generate and bind texture
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    
-    // Set texture parameters for better performance
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    
-    // Load texture data directly from bitmap bits (more efficient)
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, BMP.bmWidth, BMP.bmHeight, 0, 
-                 GL_BGR_EXT, GL_UNSIGNED_BYTE, BMP.bmBits);
-
-    // Clean up GDI object immediately to reduce memory usage
-    DeleteObject(hBMP);
-    
-    return textureID;
+// Files are decoded on the texture manager's worker thread and uploaded a few
+// per frame; the GL name returned here is bindable at once and shows a
+// placeholder until then (a missing file ends up plain white)
+GLuint BackgroundRenderer::requestTexture(const char* filename) {
+    return TextureManager::name(TextureManager::request(filename));
 }
 
 void BackgroundRenderer::loadAllTextures() {
     if (texturesLoaded) return;
     
-    printf("Loading essential textures...\n");
+    LOG_INFO("Requesting essential textures...");
     
-    // Only load the most essential textures at startup to reduce memory usage
-    // Other textures will be loaded on-demand when needed
-    textures[TEX_BATTLEFIELD] = loadBMPTexture("texturess/Battlefield Terrain.bmp");
-    textures[TEX_SKY] = loadBMPTexture("texturess/sky.bmp");
-    textures[TEX_SUN] = loadBMPTexture("texturess/sun.bmp");
-    textures[TEX_MOON] = loadBMPTexture("texturess/moon.bmp");
-    textures[TEX_MOUNTAIN] = loadBMPTexture("texturess/mountain.bmp");
-    textures[TEX_CASTLE] = loadBMPTexture("texturess/castle.bmp");
+    // Only queue the most essential textures at startup to reduce memory usage
+    // Other textures will be requested on first use
+    textures[TEX_BATTLEFIELD] = requestTexture("texturess/Battlefield Terrain.bmp");
+    textures[TEX_SKY] = requestTexture("texturess/sky.bmp");
+    textures[TEX_SUN] = requestTexture("texturess/sun.bmp");
+    textures[TEX_MOON] = requestTexture("texturess/moon.bmp");
+    textures[TEX_MOUNTAIN] = requestTexture("texturess/mountain.bmp");
+    textures[TEX_CASTLE] = requestTexture("texturess/castle.bmp");
     
     // Initialize other texture slots to 0 (will be loaded on-demand)
     textures[TEX_CLOUDS] = 0;
@@ -316,57 +493,99 @@ void BackgroundRenderer::loadAllTextures() {
     textures[TEX_SABATONS] = 0;
     
     texturesLoaded = true;
-    printf("Essential textures loaded successfully.\n");
+    LOG_INFO("Essential textures queued.");
 }
 
-// Load texture on-demand to reduce memory usage
+// Files behind the texture slots, indexed by TextureIndex
+static const char* const textureFiles[] = {
+    "texturess/Battlefield Terrain.bmp",  // TEX_BATTLEFIELD (0)
+    "texturess/sky.bmp",                  // TEX_SKY (1)
+    "texturess/sun.bmp",                  // TEX_SUN (2)
+    "texturess/moon.bmp",                 // TEX_MOON (3)
+    "texturess/clouds.bmp",               // TEX_CLOUDS (4)
+    "texturess/mountain.bmp",             // TEX_MOUNTAIN (5)
+    "texturess/forest.bmp",               // TEX_FOREST (6)
+    "texturess/grass.bmp",                // TEX_GRASS (7)
+    "texturess/castle.bmp",               // TEX_CASTLE (8)
+    "texturess/rain.bmp",                 // TEX_RAIN (9)
+    "texturess/storm.bmp",                // TEX_STORM (10)
+    "texturess/lightning.bmp",            // TEX_LIGHTNING (11)
+    "texturess/fire.bmp",                 // TEX_FIRE (12)
+    "texturess/smoke.bmp",                // TEX_SMOKE (13)
+    "texturess/debris.bmp",               // TEX_DEBRIS (14)
+    "texturess/bird.bmp",                 // TEX_BIRD (15)
+    "texturess/horses.bmp",               // TEX_HORSES (16)
+    "texturess/Scorch Marks.bmp",         // TEX_SCORCH (17)
+    "texturess/tattered banner.bmp",      // TEX_BANNER (18)
+    "texturess/mixed forest.bmp",         // TEX_MIXED_FOREST (19)
+    "texturess/arrow.bmp",                // TEX_ARROWS (20)
+    "texturess/battering rams.bmp",       // TEX_BATTERING_RAMS (21)
+    "texturess/catapult stones.bmp",      // TEX_CATAPULT_STONES (22)
+    "texturess/fallen warrior.bmp",       // TEX_FALLEN_WARRIOR (23)
+    "texturess/knight formations.bmp",    // TEX_KNIGHT_FORMATIONS (24)
+    "texturess/drums.bmp",                // TEX_DRUMS (25)
+    "texturess/camp fire.bmp",            // TEX_CAMPFIRE (26)
+    "texturess/trebuchets.bmp",           // TEX_TREBUCHET (27)
+    "texturess/star.bmp",                 // TEX_STARS (28)
+    "texturess/trees.bmp",                // TEX_TREES (29)
+    "texturess/horses.bmp",               // TEX_HORSE_CAVALRY (30)
+    "texturess/knight formations.bmp",    // TEX_ARCHER_FORMATIONS (31)
+    "texturess/wood.bmp",                 // TEX_WOOD (32)
+    "texturess/blood stains.bmp",         // TEX_BLOOD_STAINS (33)
+    "texturess/armor.bmp",                // TEX_ARMOR (34)
+    "texturess/skin.bmp",                 // TEX_SKIN (35)
+    "texturess/helmet.bmp",               // TEX_HELMET (36)
+    "texturess/sabatons.bmp"              // TEX_SABATONS (37)
+};
+
+// Cells are 256 texels, more than any billboard covers on screen; the eight
+// files fill a 768x768 atlas with a cell to spare. Slots naming the same file
+// (the formations, the horses) share a cell.
+const BackgroundRenderer::BillboardAtlas& BackgroundRenderer::billboardAtlas() {
+    static BillboardAtlas atlas;
+    if (!atlas.paths.empty()) return atlas;
+
+    const int members[] = {
+        TEX_KNIGHT_FORMATIONS, TEX_ARCHER_FORMATIONS, TEX_HORSE_CAVALRY, TEX_TREBUCHET,
+        TEX_DRUMS, TEX_BATTERING_RAMS, TEX_ARROWS, TEX_STARS, TEX_TREES
+    };
+    for (int& cell : atlas.cell) cell = -1;
+    for (int member : members) {
+        const std::string path = textureFiles[member];
+        const auto found = std::find(atlas.paths.begin(), atlas.paths.end(), path);
+        atlas.cell[member] = (int)(found - atlas.paths.begin());
+        if (found == atlas.paths.end()) atlas.paths.push_back(path);
+    }
+    atlas.layout = TextureAtlas::layoutFor((int)atlas.paths.size(), 256);
+    for (int slot = 0; slot < 50; slot++) {
+        if (atlas.cell[slot] >= 0) atlas.rects[slot] = atlas.layout.rect(atlas.cell[slot]);
+    }
+    return atlas;
+}
+
+const TextureAtlas::Rect* BackgroundRenderer::atlasRegion(int textureIndex) {
+    const BillboardAtlas& atlas = billboardAtlas();
+    return textureIndex >= 0 && textureIndex < 50 && atlas.cell[textureIndex] >= 0 ? &atlas.rects[textureIndex] : nullptr;
+}
+
+RenderQueue::State BackgroundRenderer::atlasState(int textureIndex) {
+    loadTextureOnDemand(TEX_BILLBOARD_ATLAS);
+    RenderQueue::State state = { textures[TEX_BILLBOARD_ATLAS], atlasRegion(textureIndex), true, false };
+    return state;
+}
+
+// Request a texture on first use; it streams in over the next frames
 void BackgroundRenderer::loadTextureOnDemand(int textureIndex) {
     if (textureIndex < 0 || textureIndex >= 50 || textures[textureIndex] != 0) {
         return; // Already loaded or invalid index
     }
     
-    const char* filenames[] = {
-        "texturess/Battlefield Terrain.bmp",  // TEX_BATTLEFIELD (0)
-        "texturess/sky.bmp",                  // TEX_SKY (1)
-        "texturess/sun.bmp",                  // TEX_SUN (2)
-        "texturess/moon.bmp",                 // TEX_MOON (3)
-        "texturess/clouds.bmp",               // TEX_CLOUDS (4)
-        "texturess/mountain.bmp",             // TEX_MOUNTAIN (5)
-        "texturess/forest.bmp",               // TEX_FOREST (6)
-        "texturess/grass.bmp",                // TEX_GRASS (7)
-        "texturess/castle.bmp",               // TEX_CASTLE (8)
-        "texturess/rain.bmp",                 // TEX_RAIN (9)
-        "texturess/storm.bmp",                // TEX_STORM (10)
-        "texturess/lightning.bmp",            // TEX_LIGHTNING (11)
-        "texturess/fire.bmp",                 // TEX_FIRE (12)
-        "texturess/smoke.bmp",                // TEX_SMOKE (13)
-        "texturess/debris.bmp",               // TEX_DEBRIS (14)
-        "texturess/bird.bmp",                 // TEX_BIRD (15)
-        "texturess/horses.bmp",               // TEX_HORSES (16)
-        "texturess/Scorch Marks.bmp",         // TEX_SCORCH (17)
-        "texturess/tattered banner.bmp",      // TEX_BANNER (18)
-        "texturess/mixed forest.bmp",         // TEX_MIXED_FOREST (19)
-        "texturess/arrow.bmp",                // TEX_ARROWS (20)
-        "texturess/battering rams.bmp",       // TEX_BATTERING_RAMS (21)
-        "texturess/catapult stones.bmp",      // TEX_CATAPULT_STONES (22)
-        "texturess/fallen warrior.bmp",       // TEX_FALLEN_WARRIOR (23)
-        "texturess/knight formations.bmp",    // TEX_KNIGHT_FORMATIONS (24)
-        "texturess/drums.bmp",                // TEX_DRUMS (25)
-        "texturess/camp fire.bmp",            // TEX_CAMPFIRE (26)
-        "texturess/trebuchets.bmp",           // TEX_TREBUCHET (27)
-        "texturess/star.bmp",                 // TEX_STARS (28)
-        "texturess/trees.bmp",                // TEX_TREES (29)
-        "texturess/horses.bmp",               // TEX_HORSE_CAVALRY (30)
-        "texturess/knight formations.bmp",    // TEX_ARCHER_FORMATIONS (31)
-        "texturess/wood.bmp",                 // TEX_WOOD (32)
-        "texturess/blood stains.bmp",         // TEX_BLOOD_STAINS (33)
-        "texturess/armor.bmp",                // TEX_ARMOR (34)
-        "texturess/skin.bmp",                 // TEX_SKIN (35)
-        "texturess/helmet.bmp",               // TEX_HELMET (36)
-        "texturess/sabatons.bmp"              // TEX_SABATONS (37)
-    };
-    
-    textures[textureIndex] = loadBMPTexture(filenames[textureIndex]);
+    if (textureIndex == TEX_BILLBOARD_ATLAS) {
+        textures[textureIndex] = TextureManager::name(TextureManager::requestAtlas(billboardAtlas().paths, billboardAtlas().layout));
+        return;
+    }
+    if (textureIndex >= (int)(sizeof(textureFiles) / sizeof(textureFiles[0]))) return;
+    textures[textureIndex] = requestTexture(textureFiles[textureIndex]);
 }
 
 void BackgroundRenderer::bindTexture(int textureIndex) {
@@ -378,25 +597,349 @@ void BackgroundRenderer::bindTexture(int textureIndex) {
         
         if (textures[textureIndex] != 0) {
             glEnable(GL_TEXTURE_2D);
-            glBindTexture(GL_TEXTURE_2D, textures[textureIndex]);
-            printf("Bound texture %d successfully\n", textureIndex);
+            if (textures[textureIndex] != boundTexture) {
+                glBindTexture(GL_TEXTURE_2D, textures[textureIndex]);
+                boundTexture = textures[textureIndex];
+                frameStats.textureBinds++;
+            }
+            LOG_TRACE("Bound texture %d", textureIndex);
         } else {
-            printf("Warning: Failed to bind texture %d\n", textureIndex);
+            LOG_WARN_EVERY(5.0, "Failed to bind texture %d", textureIndex);
             glDisable(GL_TEXTURE_2D);
         }
     } else {
-        printf("Warning: Invalid texture index %d or textures not loaded\n", textureIndex);
+        LOG_WARN_EVERY(5.0, "Invalid texture index %d or textures not loaded", textureIndex);
         glDisable(GL_TEXTURE_2D);
     }
 }
 
+// ===== STATIC SCENE CACHE =====
+void BackgroundRenderer::buildStaticCache() {
+    releaseStaticCache();
+    if (!texturesLoaded) return;
+
+    // Textures must exist before compiling - glTexImage2D inside glNewList
+    // would be recorded into the list instead of creating the texture
+    const int staticTextures[] = {
+        TEX_SKY, TEX_MOUNTAIN, TEX_CASTLE, TEX_BATTLEFIELD, TEX_BLOOD_STAINS, TEX_SCORCH,
+        TEX_WOOD, TEX_BILLBOARD_ATLAS, TEX_FALLEN_WARRIOR,
+        TEX_SKIN, TEX_ARMOR, TEX_SABATONS, TEX_HELMET, TEX_HORSES
+    };
+    for (int tex : staticTextures) {
+        loadTextureOnDemand(tex);
+    }
+
+    for (int pass = 0; pass < staticPassCount; pass++) {
+        GLuint list = glGenLists(1);
+        if (list == 0) {
+            LOG_WARN("Could not allocate display list, static cache disabled");
+            releaseStaticCache();
+            return;
+        }
+
+        glNewList(list, GL_COMPILE);
+        boundTexture = 0;                                  // Each list binds for itself
+        if (staticPasses[pass].texture < 0) glDisable(GL_TEXTURE_2D);
+        staticPasses[pass].draw();
+        glEndList();
+        boundTexture = 0;                                  // Compiling bound nothing
+
+        staticBatches.push_back({ list, pass });
+    }
+
+    LOG_INFO("Static scene cache: %d passes compiled into display lists", staticPassCount);
+}
+
+void BackgroundRenderer::releaseStaticCache() {
+    for (const auto& batch : staticBatches) {
+        glDeleteLists(batch.list, 1);
+    }
+    staticBatches.clear();
+}
+
+void BackgroundRenderer::setStaticCacheEnabled(bool enabled) {
+    staticCacheEnabled = enabled;
+    if (enabled && staticBatches.empty()) {
+        buildStaticCache();
+    }
+    LOG_INFO("Static scene cache %s", enabled ? "enabled" : "disabled");
+}
+
+void BackgroundRenderer::drawStaticLayer(int layer) {
+    if (staticCacheEnabled && !staticBatches.empty()) {
+        for (const auto& batch : staticBatches) {
+            const StaticPass& pass = staticPasses[batch.pass];
+            if (pass.layer != layer || !inView(staticBounds[batch.pass])) continue;
+            glCallList(batch.list);
+            frameStats.staticBatches++;
+        }
+        boundTexture = 0;
+        return;
+    }
+
+    // Immediate-mode reference path, same order and state as the compiled lists
+    for (int i = 0; i < staticPassCount; i++) {
+        if (staticPasses[i].layer != layer || !inView(staticBounds[i])) continue;
+        boundTexture = 0;
+        if (staticPasses[i].texture < 0) glDisable(GL_TEXTURE_2D);
+        staticPasses[i].draw();
+    }
+}
+
+// ===== FRUSTUM CULLING =====
+void BackgroundRenderer::setCullingEnabled(bool enabled) {
+    cullingEnabled = enabled;
+    LOG_INFO("Background frustum culling %s", enabled ? "enabled" : "disabled");
+}
+
+bool BackgroundRenderer::inView(const PassBounds& bounds) {
+    bool visible = bounds.min[0] <= bounds.max[0] &&
+                   (!cullingActive || viewFrustum.boxVisible(bounds.min, bounds.max));
+    if (visible && cullingActive && bounds.ring > 0.0f) {
+        // Nearest point of the wall, for an eye inside it
+        const float eyeDistance = sqrtf(viewFrustum.eye[0] * viewFrustum.eye[0] + viewFrustum.eye[2] * viewFrustum.eye[2]);
+        visible = bounds.ring - eyeDistance <= viewFrustum.reach;
+    }
+    if (visible) frameStats.passesDrawn++;
+    else frameStats.passesCulled++;
+    return visible;
+}
+
+bool BackgroundRenderer::batchInView(const BillboardBatch& batch) {
+    const bool visible = batch.preparedCount() > 0;
+    if (visible) frameStats.passesDrawn++;
+    else frameStats.passesCulled++;
+    return visible;
+}
+
+// The animated passes are measured at this many points of the clocks as
+// update() runs them, this far apart: 118 s, past the 111 s the clouds take
+// to wrap, in an odd step so the shorter cycles come round at new phases
+// each time. Every box is then padded by the margin, for poses in between.
+static const int kBoundsSweepSamples = 320;
+static const float kBoundsSweepStep = 0.37f;
+static const float kBoundsMargin = 1.0f;
+
+static PassBounds emptyBounds() {
+    return { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX }, 0.0f };
+}
+
+static void pad(PassBounds& bounds, float margin) {
+    for (int k = 0; k < 3; ++k) {
+        bounds.min[k] -= margin;
+        bounds.max[k] += margin;
+    }
+}
+
+// Nearest a segment comes to the y axis
+static float axisDistance(const float* a, const float* b) {
+    const float dx = b[0] - a[0], dz = b[2] - a[2];
+    const float lengthSquared = dx * dx + dz * dz;
+    float t = lengthSquared > 0.0f ? -(a[0] * dx + a[2] * dz) / lengthSquared : 0.0f;
+    t = std::max(0.0f, std::min(1.0f, t));
+    const float x = a[0] + dx * t, z = a[2] + dz * t;
+    return sqrtf(x * x + z * z);
+}
+
+void BackgroundRenderer::growToGeometry(const MeasuredPass* passes, size_t count) {
+    // Background space straight through to window coordinates: a cube this
+    // big holds every pass, so anything it clips lands on its faces
+    const float kReach = 512.0f;
+    glPushAttrib(GL_ALL_ATTRIB_BITS);
+    glPushClientAttrib(GL_CLIENT_ALL_ATTRIB_BITS);
+    glDisable(GL_CULL_FACE);
+    GLint viewport[4];
+    GLfloat depthRange[2];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetFloatv(GL_DEPTH_RANGE, depthRange);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(-kReach, kReach, -kReach, kReach, -kReach, kReach);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    static std::vector<GLfloat> feedback(1 << 20);
+    for (size_t pass = 0; pass < count; ++pass) {
+        GLint size;
+        for (;;) {
+            glFeedbackBuffer((GLsizei)feedback.size(), GL_3D, feedback.data());
+            glRenderMode(GL_FEEDBACK);
+            passes[pass].draw();
+            size = glRenderMode(GL_RENDER);
+            if (size >= 0) break;
+            feedback.resize(feedback.size() * 2);  // Overflowed; again with room
+        }
+
+        PassBounds& bounds = *passes[pass].bounds;
+        const int kMaxCorners = 64;                // Past these, a polygon's ring is measured at its corners
+        float corners[kMaxCorners][3];
+        for (GLint i = 0; i < size;) {
+            const GLenum token = (GLenum)feedback[i++];
+            int vertices = 0;
+            if (token == GL_POLYGON_TOKEN) vertices = (int)feedback[i++];
+            else if (token == GL_LINE_TOKEN || token == GL_LINE_RESET_TOKEN) vertices = 2;
+            else if (token == GL_POINT_TOKEN || token == GL_BITMAP_TOKEN ||
+                     token == GL_DRAW_PIXEL_TOKEN || token == GL_COPY_PIXEL_TOKEN) vertices = 1;
+            else if (token == GL_PASS_THROUGH_TOKEN) { ++i; continue; }
+            for (int v = 0; v < vertices; ++v, i += 3) {
+                const GLfloat* w = &feedback[i];
+                float p[3] = {
+                    ((w[0] - viewport[0]) / viewport[2] * 2.0f - 1.0f) * kReach,
+                    ((w[1] - viewport[1]) / viewport[3] * 2.0f - 1.0f) * kReach,
+                    // glOrtho's z runs the other way: near (eye z = +kReach) is depth 0
+                    (1.0f - (w[2] - depthRange[0]) / (depthRange[1] - depthRange[0]) * 2.0f) * kReach,
+                };
+                for (int k = 0; k < 3; ++k) {
+                    bounds.min[k] = std::min(bounds.min[k], p[k]);
+                    bounds.max[k] = std::max(bounds.max[k], p[k]);
+                }
+                if (v < kMaxCorners) memcpy(corners[v], p, sizeof(p));
+                if (bounds.ring > 0.0f) bounds.ring = std::min(bounds.ring, axisDistance(p, p));
+            }
+            // A wall is nearest the axis along its edges, not at its corners
+            const int edges = std::min(vertices, kMaxCorners);
+            if (bounds.ring > 0.0f && edges > 1) {
+                for (int v = 0; v < edges; ++v) {
+                    bounds.ring = std::min(bounds.ring, axisDistance(corners[v], corners[(v + 1) % edges]));
+                }
+            }
+        }
+    }
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopClientAttrib();
+    glPopAttrib();
+    boundTexture = 0;
+}
+
+void BackgroundRenderer::measurePassBounds() {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<MeasuredPass> passes;
+    staticBounds.assign(staticPassCount, emptyBounds());
+    for (int i = 0; i < staticPassCount; ++i) {
+        if (staticPasses[i].wall) staticBounds[i].ring = FLT_MAX;
+        passes.push_back({ staticPasses[i].draw, &staticBounds[i] });
+    }
+    growToGeometry(passes.data(), passes.size());
+
+    // The animated passes in the poses the clocks give them, from a scratch
+    // run of the clocks over the drawn copy's, the weather taking each of
+    // its values in turn
+    const Snapshot saved = drawn;
+    passes.clear();
+    for (int i = 0; i < ANIMATED_PASS_COUNT; ++i) {
+        animatedBounds[i] = emptyBounds();
+        passes.push_back({ animatedPasses[i].draw, &animatedBounds[i] });
+    }
+    drawn.windTime = drawn.cloudTime = drawn.siegeTime = drawn.dayNightTime = 0.0f;
+    for (int sample = 0; sample < kBoundsSweepSamples; ++sample) {
+        drawn.weather = WEATHER_CLEAR + sample % (WEATHER_STORM + 1);
+        growToGeometry(passes.data(), passes.size());
+        advanceClocks(drawn, kBoundsSweepStep);
+    }
+    drawn = saved;
+
+    for (PassBounds& bounds : staticBounds) pad(bounds, kBoundsMargin);
+    for (PassBounds& bounds : animatedBounds) pad(bounds, kBoundsMargin);
+    LOG_INFO("Pass bounds: %d static and %d animated passes measured in %.0f ms", staticPassCount, (int)ANIMATED_PASS_COUNT,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+// Around the vertices drawSiegeEffects() emits
+PassBounds BackgroundRenderer::siegeEffectsBounds() {
+    PassBounds bounds = emptyBounds();
+    auto grow = [&bounds](float x, float y, float z) {
+        bounds.min[0] = std::min(bounds.min[0], x); bounds.max[0] = std::max(bounds.max[0], x);
+        bounds.min[1] = std::min(bounds.min[1], y); bounds.max[1] = std::max(bounds.max[1], y);
+        bounds.min[2] = std::min(bounds.min[2], z); bounds.max[2] = std::max(bounds.max[2], z);
+    };
+    const float* ax = drawn.arrows.x(), * ay = drawn.arrows.y(), * az = drawn.arrows.z();
+    const float* avx = drawn.arrows.velocityX(), * avy = drawn.arrows.velocityY(), * avz = drawn.arrows.velocityZ();
+    for (size_t i = 0; i < drawn.arrows.size(); ++i) {
+        grow(ax[i], ay[i], az[i]);
+        grow(ax[i] - avx[i] * 0.1f, ay[i] - avy[i] * 0.1f, az[i] - avz[i] * 0.1f);    // Tail
+        grow(ax[i] - 0.3f, ay[i] - 0.1f, az[i]);                                        // Head
+        grow(ax[i] - 0.3f, ay[i] + 0.1f, az[i]);
+    }
+    for (const StuckArrow& arrow : drawn.stuckArrows) {
+        grow(arrow.x + arrow.dirX * 0.3f, arrow.y + arrow.dirY * 0.3f, arrow.z + arrow.dirZ * 0.3f);
+        grow(arrow.x - arrow.dirX * 2.2f, arrow.y - arrow.dirY * 2.2f, arrow.z - arrow.dirZ * 2.2f);
+    }
+    for (const ParticlePool* pool : { &drawn.sparks, &drawn.embers }) {
+        for (size_t i = 0; i < pool->size(); ++i) grow(pool->x()[i], pool->y()[i], pool->z()[i]);
+    }
+    return bounds;
+}
+
+std::vector<BackgroundRenderer::BoundsViolation> BackgroundRenderer::checkPassBounds() {
+    struct CheckedPass { std::string name; void (*draw)(); PassBounds bounds; };
+    std::vector<CheckedPass> passes;
+    for (int i = 0; i < ANIMATED_PASS_COUNT; ++i) {
+        passes.push_back({ animatedPasses[i].name, animatedPasses[i].draw, animatedBounds[i] });
+    }
+    passes.push_back({ "siege effects", drawSiegeEffects, siegeEffectsBounds() });
+    for (int i = 0; i < staticPassCount; ++i) {
+        passes.push_back({ "static pass " + std::to_string(i), staticPasses[i].draw, staticBounds[i] });
+    }
+
+    std::vector<PassBounds> measured(passes.size(), emptyBounds());
+    std::vector<MeasuredPass> measuring;
+    for (size_t i = 0; i < passes.size(); ++i) measuring.push_back({ passes[i].draw, &measured[i] });
+    growToGeometry(measuring.data(), measuring.size());
+
+    std::vector<BoundsViolation> violations;
+    for (size_t i = 0; i < passes.size(); ++i) {
+        float outside = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            if (measured[i].min[k] > measured[i].max[k]) break;     // Drew nothing
+            outside = std::max(outside, std::max(passes[i].bounds.min[k] - measured[i].min[k],
+                                                 measured[i].max[k] - passes[i].bounds.max[k]));
+        }
+        if (outside > 0.01f) violations.push_back({ passes[i].name, outside });
+    }
+    return violations;
+}
+
+// The animated batches are placed and expanded as jobs, together, before
+// render() submits anything; their passes then only draw. The batches cull
+// themselves a slice at a time from where the instances are this frame, so
+// a pass with nothing in view prepares nothing. The jobs get the drawn
+// clocks as arguments.
+void BackgroundRenderer::prepareBillboards() {
+    auto start = std::chrono::steady_clock::now();
+    const Frustum* frustum = cullingActive ? &viewFrustum : nullptr;
+    const float siege = drawn.siegeTime, wind = drawn.windTime;
+
+    Jobs::Counter prepared;
+    Jobs::run(prepared, [siege, frustum] { placeCavalryCharges(siege); cavalryBillboards.prepare(frustum); });
+    if (drawn.dayNightTime > 0.7f) {
+        Jobs::run(prepared, [siege, frustum] { placeStarField(siege); starBillboards.prepare(frustum); });
+    }
+    Jobs::run(prepared, [wind, frustum] { swayForestTrees(wind); forestBillboards.prepare(frustum); });
+    Jobs::wait(prepared);
+    frameStats.prepareMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Draws a batch prepareBillboards() left ready
+void BackgroundRenderer::drawBillboards(BillboardBatch& batch) {
+    const size_t drawn = batch.submit();
+    frameStats.instancesDrawn += (unsigned)drawn;
+    frameStats.instancesCulled += (unsigned)(batch.size() - drawn);
+}
+
 // ===== SKY & ATMOSPHERE =====
 void BackgroundRenderer::drawSkyDome() {
     glPushMatrix();
     glDisable(GL_LIGHTING);
     glDepthMask(GL_FALSE);
     
-    printf("Drawing sky dome with texture...\n");
+    LOG_TRACE("Drawing sky dome with texture...");
     
     // Apply sky texture
     bindTexture(TEX_SKY);
@@ -441,7 +984,7 @@ void BackgroundRenderer::drawSkyDome() {
     glEnable(GL_LIGHTING);
     glPopMatrix();
     
-    printf("Sky dome rendering complete\n");
+    LOG_TRACE("Sky dome rendering complete");
 }
 
 void BackgroundRenderer::drawSunOrMoon() {
@@ -451,7 +994,7 @@ void BackgroundRenderer::drawSunOrMoon() {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
     // If stormy, no sun/moon visible
-    if (currentWeather == WEATHER_STORM || currentWeather == WEATHER_RAIN) {
+    if (drawn.weather == WEATHER_STORM || drawn.weather == WEATHER_RAIN) {
         glDisable(GL_BLEND);
         glEnable(GL_LIGHTING);
         glPopMatrix();
@@ -459,7 +1002,7 @@ void BackgroundRenderer::drawSunOrMoon() {
     }
 
     // 20-second cycle: first 10 seconds = day (sun), next 10 seconds = night (moon)
-    float cycleTime = fmod(dayNightTime, 20.0f);
+    float cycleTime = fmod(drawn.dayNightTime, 20.0f);
     bool isDay = (cycleTime < 10.0f);
     
     // Position sun/moon high in the sky - make sure it's visible
@@ -476,7 +1019,7 @@ void BackgroundRenderer::drawSunOrMoon() {
         gluSphere(quadric, 8.0f, 18, 14);
         
         // Main sun disc with texture - use a textured quad facing the camera
-        printf("Drawing sun with texture...\n");
+        LOG_TRACE("Drawing sun with texture...");
         bindTexture(TEX_SUN);
         glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
         glBegin(GL_QUADS);
@@ -486,7 +1029,7 @@ void BackgroundRenderer::drawSunOrMoon() {
         glTexCoord2f(0.0f, 1.0f); glVertex3f(-8.0f, 8.0f, 0.0f);
         glEnd();
         glDisable(GL_TEXTURE_2D);
-        printf("Sun texture applied\n");
+        LOG_TRACE("Sun texture applied");
         
         // Inner bright core for additional glow effect
         glColor4f(1.0f, 1.0f, 0.9f, 0.4f);
@@ -502,7 +1045,7 @@ void BackgroundRenderer::drawSunOrMoon() {
         gluSphere(quadric, 6.0f, 18, 14);
         
         // Main moon disc with texture - use a textured quad facing the camera
-        printf("Drawing moon with texture...\n");
+        LOG_TRACE("Drawing moon with texture...");
         bindTexture(TEX_MOON);
         glColor4f(1.0f, 1.0f, 1.0f, 0.9f);
         glBegin(GL_QUADS);
@@ -512,7 +1055,7 @@ void BackgroundRenderer::drawSunOrMoon() {
         glTexCoord2f(0.0f, 1.0f); glVertex3f(-6.0f, 6.0f, 0.0f);
         glEnd();
         glDisable(GL_TEXTURE_2D);
-        printf("Moon texture applied\n");
+        LOG_TRACE("Moon texture applied");
     }
 
     glDisable(GL_BLEND);
@@ -522,10 +1065,10 @@ void BackgroundRenderer::drawSunOrMoon() {
 
 void BackgroundRenderer::drawStars() {
     // Only draw stars during night time
-    float cycleTime = fmod(dayNightTime, 20.0f);
+    float cycleTime = fmod(drawn.dayNightTime, 20.0f);
     bool isNight = (cycleTime >= 10.0f);
     
-    if (!isNight || currentWeather == WEATHER_STORM || currentWeather == WEATHER_RAIN) {
+    if (!isNight || drawn.weather == WEATHER_STORM || drawn.weather == WEATHER_RAIN) {
         return;
     }
     
@@ -548,7 +1091,7 @@ void BackgroundRenderer::drawStars() {
         float z = -120.0f + 50.0f * cos(i * 2.11f);
         
         // Add subtle twinkling effect
-        float twinkle = 0.8f + 0.2f * sin(windTime * 3.0f + i * 0.7f);
+        float twinkle = 0.8f + 0.2f * sin(drawn.windTime * 3.0f + i * 0.7f);
         glColor4f(twinkle, twinkle, 1.0f, 0.7f);
         
         glVertex3f(x, y, z);
@@ -562,7 +1105,7 @@ void BackgroundRenderer::drawStars() {
         float z = -130.0f + 40.0f * cos(i * 3.33f);
         
         // Brighter twinkling
-        float twinkle = 0.9f + 0.1f * sin(windTime * 2.0f + i * 0.5f);
+        float twinkle = 0.9f + 0.1f * sin(drawn.windTime * 2.0f + i * 0.5f);
         glColor4f(twinkle, twinkle, 1.0f, 0.9f);
         
         glVertex3f(x, y, z);
@@ -591,12 +1134,12 @@ void BackgroundRenderer::drawClouds() {
     glColor4f(1.0f, 1.0f, 1.0f, 0.4f); // Use white to show texture properly
     for (int high = 0; high < 6; high++) {
         glPushMatrix();
-        float x = -120.0f + high * 40.0f + sin(cloudTime * 0.3f + high) * 20.0f;
-        float z = cos(cloudTime * 0.2f + high) * 25.0f;
+        float x = -120.0f + high * 40.0f + sin(drawn.cloudTime * 0.3f + high) * 20.0f;
+        float z = cos(drawn.cloudTime * 0.2f + high) * 25.0f;
         glTranslatef(x, 0.0f, z);
         
         // Draw cloud as textured quad
-        float size = 15.0f + sin(cloudTime + high) * 3.0f;
+        float size = 15.0f + sin(drawn.cloudTime + high) * 3.0f;
         glBegin(GL_QUADS);
         glTexCoord2f(0.0f, 0.0f); glVertex3f(-size, -2.0f, -size*0.5f);
         glTexCoord2f(1.0f, 0.0f); glVertex3f(size, -2.0f, -size*0.5f);
@@ -612,11 +1155,11 @@ void BackgroundRenderer::drawClouds() {
     glTranslatef(0.0f, 25.0f, -60.0f);
 
     float r, g, b, alpha;
-    if (currentWeather == WEATHER_RAIN || currentWeather == WEATHER_STORM) {
+    if (drawn.weather == WEATHER_RAIN || drawn.weather == WEATHER_STORM) {
         // Much darker and more dramatic storm clouds
-        r = 0.2f + lightningBrightness * 0.8f; // Flash brighter during lightning
-        g = 0.2f + lightningBrightness * 0.8f; 
-        b = 0.3f + lightningBrightness * 0.7f; // Slight blue tint
+        r = 0.2f + drawn.lightningBrightness * 0.8f; // Flash brighter during lightning
+        g = 0.2f + drawn.lightningBrightness * 0.8f; 
+        b = 0.3f + drawn.lightningBrightness * 0.7f; // Slight blue tint
         alpha = 0.95f; // Very dense storm clouds
     } else {
         r = 1.0f; g = 1.0f; b = 1.0f; alpha = 0.7f; // Bright white clouds
@@ -625,17 +1168,17 @@ void BackgroundRenderer::drawClouds() {
     // Large cumulus clouds with texture
     for (int i = 0; i < 8; i++) {
         glPushMatrix();
-        float x = -100.0f + i * 25.0f + sin(cloudTime * 0.8f + i) * 12.0f;
-        float y = sin(cloudTime * 0.4f + i * 0.9f) * 6.0f;
-        float z = cos(cloudTime * 0.25f + i) * 20.0f;
-        glTranslatef(fmod(x + cloudTime * 15.0f, 250.0f) - 125.0f, y, z);
+        float x = -100.0f + i * 25.0f + sin(drawn.cloudTime * 0.8f + i) * 12.0f;
+        float y = sin(drawn.cloudTime * 0.4f + i * 0.9f) * 6.0f;
+        float z = cos(drawn.cloudTime * 0.25f + i) * 20.0f;
+        glTranslatef(fmod(x + drawn.cloudTime * 15.0f, 250.0f) - 125.0f, y, z);
         
         // Cloud color variation for realism
-        float cloudVariation = sin(cloudTime + i * 1.3f) * 0.1f;
+        float cloudVariation = sin(drawn.cloudTime + i * 1.3f) * 0.1f;
         glColor4f(r + cloudVariation, g + cloudVariation, b + cloudVariation, alpha);
         
         // Main cloud body as textured billboards
-        float size = 8.0f + sin(cloudTime + i) * 2.0f;
+        float size = 8.0f + sin(drawn.cloudTime + i) * 2.0f;
         glBegin(GL_QUADS);
         glTexCoord2f(0.0f, 0.0f); glVertex3f(-size, -size*0.4f, -size*0.6f);
         glTexCoord2f(1.0f, 0.0f); glVertex3f(size, -size*0.4f, -size*0.6f);
@@ -646,7 +1189,7 @@ void BackgroundRenderer::drawClouds() {
         gluSphere(quadric, 5.0f, 10, 6);
         
         // Additional cloud detail for storm clouds
-        if (currentWeather == WEATHER_STORM || currentWeather == WEATHER_RAIN) {
+        if (drawn.weather == WEATHER_STORM || drawn.weather == WEATHER_RAIN) {
             glColor4f(r * 0.7f, g * 0.7f, b * 0.7f, alpha * 1.1f);
             glTranslatef(2.0f, -4.0f, 1.0f);
             gluSphere(quadric, 4.0f, 8, 6);
@@ -658,7 +1201,7 @@ void BackgroundRenderer::drawClouds() {
     }
     
     // Additional storm cloud layer for dramatic effect
-    if (currentWeather == WEATHER_STORM) {
+    if (drawn.weather == WEATHER_STORM) {
         glTranslatef(0.0f, -5.0f, 10.0f);
         
         // Apply storm texture for realistic storm clouds
@@ -667,13 +1210,13 @@ void BackgroundRenderer::drawClouds() {
         
         for (int storm = 0; storm < 12; storm++) {
             glPushMatrix();
-            float x = -150.0f + storm * 25.0f + sin(cloudTime * 1.2f + storm) * 15.0f;
-            float y = sin(cloudTime * 0.6f + storm * 1.1f) * 3.0f;
-            float z = cos(cloudTime * 0.4f + storm) * 12.0f;
+            float x = -150.0f + storm * 25.0f + sin(drawn.cloudTime * 1.2f + storm) * 15.0f;
+            float y = sin(drawn.cloudTime * 0.6f + storm * 1.1f) * 3.0f;
+            float z = cos(drawn.cloudTime * 0.4f + storm) * 12.0f;
             glTranslatef(x, y, z);
             
             // Large, menacing storm clouds with texture
-            float stormSize = 10.0f + sin(cloudTime * 0.8f + storm) * 3.0f;
+            float stormSize = 10.0f + sin(drawn.cloudTime * 0.8f + storm) * 3.0f;
             
             // Draw storm clouds as textured quads
             glBegin(GL_QUADS);
@@ -713,13 +1256,13 @@ void BackgroundRenderer::drawClouds() {
     
     for (int distant = 0; distant < 15; distant++) {
         glPushMatrix();
-        float x = -200.0f + distant * 27.0f + sin(cloudTime * 0.5f + distant) * 25.0f;
-        float y = sin(cloudTime * 0.3f + distant * 0.7f) * 8.0f;
-        float z = cos(cloudTime * 0.2f + distant) * 30.0f;
+        float x = -200.0f + distant * 27.0f + sin(drawn.cloudTime * 0.5f + distant) * 25.0f;
+        float y = sin(drawn.cloudTime * 0.3f + distant * 0.7f) * 8.0f;
+        float z = cos(drawn.cloudTime * 0.2f + distant) * 30.0f;
         glTranslatef(x, y, z);
         
         // Smaller, more scattered distant clouds
-        gluSphere(quadric, 4.0f + sin(cloudTime + distant) * 1.0f, 8, 6);
+        gluSphere(quadric, 4.0f + sin(drawn.cloudTime + distant) * 1.0f, 8, 6);
         glPopMatrix();
     }
     
@@ -731,10 +1274,10 @@ void BackgroundRenderer::drawClouds() {
 }
 
 void BackgroundRenderer::setupFog() {
-    if (currentWeather == WEATHER_FOG || currentWeather == WEATHER_STORM) {
+    if (drawn.weather == WEATHER_FOG || drawn.weather == WEATHER_STORM) {
         glEnable(GL_FOG);
         GLfloat fogColor[4];
-        if (currentWeather == WEATHER_STORM) {
+        if (drawn.weather == WEATHER_STORM) {
             fogColor[0] = 0.1f; fogColor[1] = 0.1f; fogColor[2] = 0.15f; fogColor[3] = 1.0f;
         } else {
             fogColor[0] = 0.5f; fogColor[1] = 0.5f; fogColor[2] = 0.6f; fogColor[3] = 1.0f;
@@ -749,7 +1292,7 @@ void BackgroundRenderer::setupFog() {
 }
 
 void BackgroundRenderer::drawLightning() {
-    if (lightningBrightness <= 0.0f) return;
+    if (drawn.lightningBrightness <= 0.0f) return;
 
     // Apply lightning texture for dramatic effect
     bindTexture(TEX_LIGHTNING);
@@ -769,7 +1312,7 @@ void BackgroundRenderer::drawLightning() {
     glLoadIdentity();
     
     // Draw multiple lightning flashes for more dramatic effect
-    float flashIntensity = lightningBrightness;
+    float flashIntensity = drawn.lightningBrightness;
     
     // Main lightning flash (full screen)
     glColor4f(1.0f, 1.0f, 1.0f, flashIntensity * 0.8f);
@@ -801,7 +1344,7 @@ void BackgroundRenderer::drawLightning() {
     
     for (int i = 0; i < 5; i++) {
         glPushMatrix();
-        float offsetX = (i - 2) * 40.0f + sin(siegeTime * 3.0f + i) * 20.0f;
+        float offsetX = (i - 2) * 40.0f + sin(drawn.siegeTime * 3.0f + i) * 20.0f;
         glTranslatef(offsetX, 0.0f, 0.0f);
         
         // Lightning bolt intensity varies per bolt
@@ -814,9 +1357,9 @@ void BackgroundRenderer::drawLightning() {
         
         float y = 0.0f;
         for (int segment = 0; segment < 12; segment++) {
-            float x = sin(segment * 0.5f + i) * 8.0f + (rand() % 10 - 5);
-            y -= 8.0f + (rand() % 8);
-            float z = (rand() % 20) - 10;
+            float x = sin(segment * 0.5f + i) * 8.0f + (boltRandom.below(10) - 5);
+            y -= 8.0f + boltRandom.below(8);
+            float z = boltRandom.below(20) - 10;
             glVertex3f(x, y, z);
         }
         glEnd();
@@ -926,70 +1469,26 @@ void BackgroundRenderer::drawMountains() {
     glPopMatrix();
 }
 
-void BackgroundRenderer::drawBattlefield() {
-    // Apply battlefield terrain texture
+void BackgroundRenderer::drawTerrain() {
+    boundTexture = 0;                  // May run at a replay, after the recorded binds
     bindTexture(TEX_BATTLEFIELD);
-    
-    // Realistic muddy battlefield terrain with varied elevations
     glColor3f(1.0f, 1.0f, 1.0f); // White to show texture properly
-    for (int j = -50; j < 50; j++) {
-        glBegin(GL_TRIANGLE_STRIP);
-        for (int i = -50; i <= 50; i++) {
-            float x1 = i * 2.0f;
-            float z1 = j * 2.0f;
-            float x2 = i * 2.0f;
-            float z2 = (j + 1) * 2.0f;
-            
-            // More complex height variation for realistic battlefield
-            float baseHeight1 = sin(x1 * 0.05f) * cos(z1 * 0.07f) * 2.0f;
-            float mudVariation1 = sin(x1 * 0.25f + z1 * 0.35f) * 0.8f; // Mud ruts and puddles
-            float battleWear1 = cos(x1 * 0.15f + z1 * 0.1f) * 0.5f; // Battle trampling
-            float y1 = baseHeight1 + mudVariation1 + battleWear1;
-            
-            float baseHeight2 = sin(x2 * 0.05f) * cos(z2 * 0.07f) * 2.0f;
-            float mudVariation2 = sin(x2 * 0.25f + z2 * 0.35f) * 0.8f;
-            float battleWear2 = cos(x2 * 0.15f + z2 * 0.1f) * 0.5f;
-            float y2 = baseHeight2 + mudVariation2 + battleWear2;
-            
-            // Texture coordinates (repeat across terrain)
-            float u1 = (x1 + 100.0f) / 20.0f;
-            float v1 = (z1 + 100.0f) / 20.0f;
-            float u2 = (x2 + 100.0f) / 20.0f;
-            float v2 = (z2 + 100.0f) / 20.0f;
-            
-            // Add subtle color variations to enhance texture
-            float colorVar1 = (y1 + 3.0f) * 0.02f;
-            float bloodStain1 = (sin(x1 * 0.35f) + cos(z1 * 0.3f)) > 1.5f ? -0.1f : 0.0f;
-            float ashStain1 = (sin(x1 * 0.6f) + cos(z1 * 0.45f)) > 1.7f ? -0.05f : 0.0f;
-            
-            float colorVar2 = (y2 + 3.0f) * 0.02f;
-            float bloodStain2 = (sin(x2 * 0.35f) + cos(z2 * 0.3f)) > 1.5f ? -0.1f : 0.0f;
-            float ashStain2 = (sin(x2 * 0.6f) + cos(z2 * 0.45f)) > 1.7f ? -0.05f : 0.0f;
-
-            glNormal3f(0.0f, 1.0f, 0.0f);
-            
-            glColor3f(1.0f - colorVar1 + bloodStain1 + ashStain1, 
-                     1.0f - colorVar1 * 0.5f + bloodStain1 * 0.5f + ashStain1, 
-                     1.0f - colorVar1 * 0.3f + ashStain1);
-            glTexCoord2f(u1, v1);
-            glVertex3f(x1, y1, z1);
-            
-            glColor3f(1.0f - colorVar2 + bloodStain2 + ashStain2, 
-                     1.0f - colorVar2 * 0.5f + bloodStain2 * 0.5f + ashStain2, 
-                     1.0f - colorVar2 * 0.3f + ashStain2);
-            glTexCoord2f(u2, v2);
-            glVertex3f(x2, y2, z2);
-        }
-        glEnd();
-    }
-
-    glDisable(GL_TEXTURE_2D); // Disable texture for other elements
+    Terrain::DrawStats stats;
+    Terrain::draw(&stats);
+    frameStats.terrainChunks = stats.chunksDrawn;
+    frameStats.terrainChunksCulled = stats.chunksCulled;
+    glDisable(GL_TEXTURE_2D);
+}
 
+void BackgroundRenderer::drawBattlefield() {
+    // The ground itself is the chunked heightfield in terrain.cpp (drawTerrain);
+    // this pass adds the time-invariant marks on top of it
     // Add blood stains texture overlays on battlefield terrain
     bindTexture(TEX_BLOOD_STAINS);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glColor4f(0.8f, 0.2f, 0.1f, 0.7f); // Dark red blood color with transparency
+    glNormal3fv(kUpNormal);
     glDisable(GL_LIGHTING);
     
     // Major blood stain areas from fierce battles
@@ -1121,16 +1620,6 @@ void BackgroundRenderer::drawBattlefield() {
     glDisable(GL_TEXTURE_2D);
     glEnable(GL_LIGHTING);
     glDisable(GL_BLEND);
-    
-    // Add Chinese war elements
-    drawChineseWarDrums();
-    drawChineseDragonBanners(); 
-    drawChineseFireLances();
-    
-    // Add Western war elements
-    drawWesternKnightFormations();
-    drawWesternCrossbowSquads();
-    drawWesternWarHorns();
 }
 
 // ===== STRUCTURE RENDERING =====
@@ -1344,24 +1833,36 @@ void BackgroundRenderer::drawWesternCastle() {
 void BackgroundRenderer::drawSiegeEffects() {
     // Draw flying arrows using GL_LINES
     glColor3f(0.4f, 0.3f, 0.2f); // Dark wood shaft
+    glNormal3fv(kCampfireNormal);
     glLineWidth(3.0f);
+    const float* ax = drawn.arrows.x(), * ay = drawn.arrows.y(), * az = drawn.arrows.z();
+    const float* avx = drawn.arrows.velocityX(), * avy = drawn.arrows.velocityY(), * avz = drawn.arrows.velocityZ();
     glBegin(GL_LINES);
-    for (const auto& arrow : arrows) {
-        glVertex3f(arrow.position.x, arrow.position.y, arrow.position.z);
-        glVertex3f(arrow.position.x - arrow.velocity.x * 0.1f, 
-                  arrow.position.y - arrow.velocity.y * 0.1f, 
-                  arrow.position.z - arrow.velocity.z * 0.1f);
+    for (size_t i = 0; i < drawn.arrows.size(); ++i) {
+        glVertex3f(ax[i], ay[i], az[i]);
+        glVertex3f(ax[i] - avx[i] * 0.1f, 
+                  ay[i] - avy[i] * 0.1f, 
+                  az[i] - avz[i] * 0.1f);
+    }
+    glEnd();
+    
+    // Arrows stuck where they struck, heads buried
+    glColor3f(0.4f, 0.3f, 0.2f);
+    glBegin(GL_LINES);
+    for (const StuckArrow& arrow : drawn.stuckArrows) {
+        glVertex3f(arrow.x + arrow.dirX * 0.3f, arrow.y + arrow.dirY * 0.3f, arrow.z + arrow.dirZ * 0.3f);
+        glVertex3f(arrow.x - arrow.dirX * 2.2f, arrow.y - arrow.dirY * 2.2f, arrow.z - arrow.dirZ * 2.2f);
     }
     glEnd();
     
     // Arrow heads using GL_TRIANGLES
     glColor3f(0.3f, 0.3f, 0.3f); // Steel arrowheads
     glBegin(GL_TRIANGLES);
-    for (const auto& arrow : arrows) {
+    for (size_t i = 0; i < drawn.arrows.size(); ++i) {
         float length = 0.3f;
-        glVertex3f(arrow.position.x, arrow.position.y, arrow.position.z);
-        glVertex3f(arrow.position.x - length, arrow.position.y - 0.1f, arrow.position.z);
-        glVertex3f(arrow.position.x - length, arrow.position.y + 0.1f, arrow.position.z);
+        glVertex3f(ax[i], ay[i], az[i]);
+        glVertex3f(ax[i] - length, ay[i] - 0.1f, az[i]);
+        glVertex3f(ax[i] - length, ay[i] + 0.1f, az[i]);
     }
     glEnd();
     
@@ -1369,8 +1870,8 @@ void BackgroundRenderer::drawSiegeEffects() {
     glColor3f(1.0f, 0.8f, 0.2f); // Bright yellow-orange sparks
     glPointSize(3.0f);
     glBegin(GL_POINTS);
-    for (const auto& spark : sparks) {
-        glVertex3f(spark.position.x, spark.position.y, spark.position.z);
+    for (size_t i = 0; i < drawn.sparks.size(); ++i) {
+        glVertex3f(drawn.sparks.x()[i], drawn.sparks.y()[i], drawn.sparks.z()[i]);
     }
     glEnd();
     
@@ -1378,8 +1879,8 @@ void BackgroundRenderer::drawSiegeEffects() {
     glColor3f(1.0f, 0.4f, 0.1f); // Orange-red embers
     glPointSize(5.0f);
     glBegin(GL_POINTS);
-    for (const auto& ember : embers) {
-        glVertex3f(ember.position.x, ember.position.y, ember.position.z);
+    for (size_t i = 0; i < drawn.embers.size(); ++i) {
+        glVertex3f(drawn.embers.x()[i], drawn.embers.y()[i], drawn.embers.z()[i]);
     }
     glEnd();
     
@@ -1395,7 +1896,7 @@ void BackgroundRenderer::drawCatapultStones() {
     // Animate several stones
     for (int i = 0; i < 3; i++) {
         glPushMatrix();
-        float time_offset = siegeTime + i * 2.0f;
+        float time_offset = drawn.siegeTime + i * 2.0f;
         float arc_progress = fmod(time_offset * 0.3f, 1.0f);
         
         float x = -70.0f + arc_progress * 140.0f; // Across the battlefield
@@ -1414,6 +1915,7 @@ void BackgroundRenderer::drawSiegeLadders() {
     // Siege ladders against the walls using textured quads
     bindTexture(TEX_CASTLE); // Use castle texture for wooden appearance
     glColor3f(0.8f, 0.6f, 0.4f); // Warm wood color to blend with texture
+    glNormal3fv(kFortressNormal);
     
     // Ladder against Chinese fortress
     glPushMatrix();
@@ -1453,6 +1955,7 @@ void BackgroundRenderer::drawSiegeTowers() {
     // Massive siege towers approaching the walls with castle texture
     bindTexture(TEX_CASTLE); // Use castle texture for wooden structure
     glColor3f(0.7f, 0.55f, 0.4f); // Weathered wood color to blend with texture
+    glNormal3fv(kFortressNormal);
     
     // Chinese siege tower
     glPushMatrix();
@@ -1560,9 +2063,10 @@ void BackgroundRenderer::drawSiegeTowers() {
     glPopMatrix();
 }
 
-void BackgroundRenderer::drawTrebuchets() {
+void BackgroundRenderer::drawTrebuchetFrames() {
     // Large trebuchets for long-range siege warfare
     glColor3f(0.3f, 0.2f, 0.15f); // Dark siege engine wood
+    glNormal3fv(kSlopeNormal);
     
     // Chinese trebuchet
     glPushMatrix();
@@ -1593,8 +2097,45 @@ void BackgroundRenderer::drawTrebuchets() {
     glVertex3f(-3.0f, 12.0f, 0.0f); glVertex3f(3.0f, 12.0f, 0.0f);
     glEnd();
     
+    glPopMatrix(); // End trebuchet
+    
+    // Western trebuchet - slightly different position and design
+    glPushMatrix();
+    glTranslatef(45.0f, 0.0f, 30.0f);
+    glRotatef(180.0f, 0.0f, 1.0f, 0.0f); // Facing opposite direction
+    
+    // Similar structure but smaller
+    glColor3f(0.28f, 0.2f, 0.14f);
+    glScalef(0.8f, 0.8f, 0.8f);
+    
+    // Base and supports (similar to Chinese but smaller)
+    glBegin(GL_QUADS);
+    glVertex3f(-6.0f, 0.0f, -6.0f); glVertex3f(6.0f, 0.0f, -6.0f);
+    glVertex3f(6.0f, 0.8f, 6.0f); glVertex3f(-6.0f, 0.8f, 6.0f);
+    glEnd();
+    
+    glLineWidth(6.0f);
+    glBegin(GL_LINES);
+    // A-frame supports
+    glVertex3f(-4.0f, 0.8f, -1.5f); glVertex3f(-2.0f, 10.0f, 0.0f);
+    glVertex3f(-4.0f, 0.8f, 1.5f); glVertex3f(-2.0f, 10.0f, 0.0f);
+    glVertex3f(4.0f, 0.8f, -1.5f); glVertex3f(2.0f, 10.0f, 0.0f);
+    glVertex3f(4.0f, 0.8f, 1.5f); glVertex3f(2.0f, 10.0f, 0.0f);
+    glVertex3f(-2.0f, 10.0f, 0.0f); glVertex3f(2.0f, 10.0f, 0.0f);
+    glEnd();
+    
+    glPopMatrix();
+}
+
+void BackgroundRenderer::drawTrebuchets() {
+    // Chinese trebuchet throwing arm - the frames are static and come from the cache
+    glPushMatrix();
+    glTranslatef(-50.0f, 0.0f, 25.0f);
+    glColor3f(0.25f, 0.18f, 0.12f);
+    glNormal3fv(kArmNormal);
+    
     // Throwing arm
-    float armAngle = 45.0f + sin(siegeTime * 0.3f) * 15.0f; // Animated loading/firing
+    float armAngle = 45.0f + sin(drawn.siegeTime * 0.3f) * 15.0f; // Animated loading/firing
     glPushMatrix();
     glTranslatef(0.0f, 12.0f, 0.0f);
     glRotatef(armAngle, 0.0f, 0.0f, 1.0f);
@@ -1623,38 +2164,12 @@ void BackgroundRenderer::drawTrebuchets() {
     
     glPopMatrix(); // End throwing arm
     glPopMatrix(); // End trebuchet
-    
-    // Western trebuchet - slightly different position and design
-    glPushMatrix();
-    glTranslatef(45.0f, 0.0f, 30.0f);
-    glRotatef(180.0f, 0.0f, 1.0f, 0.0f); // Facing opposite direction
-    
-    // Similar structure but smaller
-    glColor3f(0.28f, 0.2f, 0.14f);
-    glScalef(0.8f, 0.8f, 0.8f);
-    
-    // Base and supports (similar to Chinese but smaller)
-    glBegin(GL_QUADS);
-    glVertex3f(-6.0f, 0.0f, -6.0f); glVertex3f(6.0f, 0.0f, -6.0f);
-    glVertex3f(6.0f, 0.8f, 6.0f); glVertex3f(-6.0f, 0.8f, 6.0f);
-    glEnd();
-    
-    glLineWidth(6.0f);
-    glBegin(GL_LINES);
-    // A-frame supports
-    glVertex3f(-4.0f, 0.8f, -1.5f); glVertex3f(-2.0f, 10.0f, 0.0f);
-    glVertex3f(-4.0f, 0.8f, 1.5f); glVertex3f(-2.0f, 10.0f, 0.0f);
-    glVertex3f(4.0f, 0.8f, -1.5f); glVertex3f(2.0f, 10.0f, 0.0f);
-    glVertex3f(4.0f, 0.8f, 1.5f); glVertex3f(2.0f, 10.0f, 0.0f);
-    glVertex3f(-2.0f, 10.0f, 0.0f); glVertex3f(2.0f, 10.0f, 0.0f);
-    glEnd();
-    
-    glPopMatrix();
 }
 
 void BackgroundRenderer::drawBatteringRams() {
     // Massive battering rams for breaching gates
     glColor3f(0.25f, 0.2f, 0.15f); // Heavy siege wood
+    glNormal3fv(kCastleNormal);
     
     // Chinese battering ram
     glPushMatrix();
@@ -1748,12 +2263,13 @@ void BackgroundRenderer::drawBatteringRams() {
 void BackgroundRenderer::drawArrowVolleys() {
     // Massive arrow volleys flying overhead (increased quantities)
     glColor3f(0.3f, 0.2f, 0.1f); // Dark arrow shafts
+    glNormal3fv(kSiegeNormal);
     glLineWidth(2.0f);
     
     glBegin(GL_LINES);
     // Multiple volleys at different stages of flight (increased back to 3 volleys)
     for (int volley = 0; volley < 3; volley++) {
-        float volleyTime = fmod(siegeTime + volley * 2.0f, 8.0f); // 8 second cycle
+        float volleyTime = fmod(drawn.siegeTime + volley * 2.0f, 8.0f); // 8 second cycle
         float volleyX = -60.0f + volleyTime * 15.0f; // Flies across battlefield
         float volleyHeight = 25.0f + sin(volleyTime * M_PI / 4.0f) * 8.0f; // Arc trajectory
         
@@ -1775,7 +2291,7 @@ void BackgroundRenderer::drawArrowVolleys() {
     glPointSize(4.0f);
     glBegin(GL_POINTS);
     for (int volley = 0; volley < 3; volley++) {  // Increased back to 3 volleys
-        float volleyTime = fmod(siegeTime + volley * 2.0f, 8.0f);
+        float volleyTime = fmod(drawn.siegeTime + volley * 2.0f, 8.0f);
         float volleyX = -60.0f + volleyTime * 15.0f;
         float volleyHeight = 25.0f + sin(volleyTime * M_PI / 4.0f) * 8.0f;
         
@@ -1798,6 +2314,7 @@ void BackgroundRenderer::drawTrees() {
     
     // Ink-wash style pine trees using GL_TRIANGLES
     glColor3f(1.0f, 1.0f, 1.0f); // White to show texture clearly
+    glNormal3fv(kCampfireNormal);
     
     // Stylized Chinese pine trees on mountainsides
     for (int i = 0; i < 6; i++) {
@@ -1833,7 +2350,7 @@ void BackgroundRenderer::drawTrees() {
             // Create layered triangular foliage with texture coordinates
             for (int side = 0; side < 6; side++) {
                 float angle = side * M_PI / 3.0f;
-                float wind_sway = sin(windTime + i + layer) * 0.3f;
+                float wind_sway = sin(drawn.windTime + i + layer) * 0.3f;
                 
                 glTexCoord2f(0.5f, 1.0f); glVertex3f(0.0f, y_base + radius, 0.0f);
                 glTexCoord2f(0.0f, 0.0f); glVertex3f(radius * cos(angle) + wind_sway, y_base, radius * sin(angle));
@@ -1875,17 +2392,16 @@ void BackgroundRenderer::drawTrees() {
     glLineWidth(1.0f);
 }
 
-void BackgroundRenderer::drawGrass() {
-    // Apply grass texture for realistic battlefield vegetation
-    bindTexture(TEX_GRASS);
-    
-    // Sparse battlefield grass using textured quads instead of lines
-    glColor3f(1.0f, 1.0f, 1.0f); // White to show texture clearly
-    
-    glBegin(GL_QUADS);
+// Everything that used to be re-rolled with rand() each frame: one seed per
+// system, drawn in the same order as the old loops so the distributions match
+void BackgroundRenderer::buildScatter() {
+    Rng grassRandom(0x6A55u);
+    grassBlades.clear();
     for (int i = 0; i < 300; i++) {
-        float x = -80.0f + (rand() % 16000) / 100.0f;
-        float z = -50.0f + (rand() % 10000) / 100.0f;
+        float x = -80.0f + grassRandom.below(16000) / 100.0f;
+        float z = -50.0f + grassRandom.below(10000) / 100.0f;
+        float height = 0.3f + grassRandom.below(100) / 300.0f;
+        float width = 0.05f + grassRandom.below(50) / 1000.0f;
         
         // Avoid grass in fortress and battle areas
         if ((x > -50 && x < -30 && z > -40 && z < -25) || // Chinese fortress
@@ -1893,34 +2409,98 @@ void BackgroundRenderer::drawGrass() {
             (x > 15 && x < 25 && z > -15 && z < -5)) {    // Fire area
             continue;
         }
-        
-        float height = 0.3f + (rand() % 100) / 300.0f;
-        float sway = sin(windTime * 1.5f + x * 0.1f) * 0.2f;
-        float width = 0.05f + (rand() % 50) / 1000.0f;
-        
-        // Draw grass as small textured quads
-        glTexCoord2f(0.0f, 0.0f); glVertex3f(x - width, 0.0f, z);
-        glTexCoord2f(1.0f, 0.0f); glVertex3f(x + width, 0.0f, z);
-        glTexCoord2f(1.0f, 1.0f); glVertex3f(x + width + sway, height, z);
-        glTexCoord2f(0.0f, 1.0f); glVertex3f(x - width + sway, height, z);
+        grassBlades.push_back({ x, Terrain::heightAt(x, z), z, height, width });
     }
-    glEnd();
-    
-    // Battlefield herbs and small bushes using GL_TRIANGLE_FAN
-    glColor3f(0.15f, 0.25f, 0.1f);
+    herbs.clear();
     for (int i = 0; i < 15; i++) {
-        glPushMatrix();
-        float x = -60.0f + (rand() % 12000) / 100.0f;
-        float z = -40.0f + (rand() % 8000) / 100.0f;
+        float x = -60.0f + grassRandom.below(12000) / 100.0f;
+        float z = -40.0f + grassRandom.below(8000) / 100.0f;
         
         // Skip if in structure areas
         if ((x > -50 && x < -30 && z > -40 && z < -25) ||
             (x > 40 && x < 60 && z > -50 && z < -35)) {
-            glPopMatrix();
             continue;
         }
+        herbs.push_back({ x, Terrain::heightAt(x, z), z });
+    }
+    
+    Rng rainRandom(0x7A19u);
+    rainDrops.resize(250);
+    for (RainDrop& drop : rainDrops) {
+        drop.x = -60.0f + rainRandom.below(12000) / 100.0f;
+        drop.z = -60.0f + rainRandom.below(12000) / 100.0f;
+        drop.phase = (float)rainRandom.below(30);
+    }
+    
+    // Forest: 40 columns x 10 rows each side; only the sway changes per frame
+    Rng forestRandom(0xF0E57u);
+    forestBillboards.clear();
+    for (int tree = 0; tree < 800; tree++) {
+        bool left = tree < 400;
+        float x = (left ? -180.0f : 140.0f) + (tree % 40) * 4.0f;
+        float z = (left ? -100.0f : -40.0f) + (tree % 400 / 40) * 4.0f;
+        float height = 15.0f + forestRandom.below(10);
+        forestBillboards.add(x, -15.0f + height * 0.3f, z, 6.0f, height, 6.0f);
+    }
+    
+    Rng debrisRandom(0xDEB815u);
+    rubble.resize(25);
+    for (Rubble& r : rubble) {
+        r.x = 35.0f + debrisRandom.below(200) / 10.0f - 10.0f;
+        r.z = -50.0f + debrisRandom.below(200) / 10.0f;
+        r.y = Terrain::heightAt(r.x, r.z);
+        r.angle = (float)debrisRandom.below(360);
+        r.scaleX = 0.4f + debrisRandom.below(100) / 200.0f;
+        r.scaleY = 0.2f + debrisRandom.below(100) / 300.0f;
+        r.scaleZ = 0.5f + debrisRandom.below(100) / 150.0f;
+    }
+    woodDebris.resize(20);
+    for (Rubble& w : woodDebris) {
+        w.x = -50.0f + debrisRandom.below(1000) / 10.0f;
+        w.z = -40.0f + debrisRandom.below(800) / 10.0f;
+        w.y = Terrain::heightAt(w.x, w.z) + 0.05f;
+        w.angle = (float)debrisRandom.below(180);
+        w.scaleX = 2.0f + debrisRandom.below(100) / 50.0f;
+        w.scaleY = 0.3f;
+        w.scaleZ = 0.5f;
+    }
+    
+    Rng volleyRandom(0xA770u);
+    volleyJitter.resize(150);
+    for (ScatterPoint& p : volleyJitter) {
+        p.x = (float)(volleyRandom.below(10) - 5);
+        p.y = 0.0f;
+        p.z = (float)(volleyRandom.below(8) - 4);
+    }
+}
+
+void BackgroundRenderer::drawGrass() {
+    // Apply grass texture for realistic battlefield vegetation
+    bindTexture(TEX_GRASS);
+    
+    // Sparse battlefield grass using textured quads instead of lines
+    glColor3f(1.0f, 1.0f, 1.0f); // White to show texture clearly
+    glNormal3fv(kUpNormal);
+    
+    glBegin(GL_QUADS);
+    for (const GrassBlade& blade : grassBlades) {
+        float x = blade.x, y = blade.y, z = blade.z;
+        float height = blade.height, width = blade.width;
+        float sway = sin(drawn.windTime * 1.5f + x * 0.1f) * 0.2f;
         
-        glTranslatef(x, 0.0f, z);
+        // Draw grass as small textured quads
+        glTexCoord2f(0.0f, 0.0f); glVertex3f(x - width, y, z);
+        glTexCoord2f(1.0f, 0.0f); glVertex3f(x + width, y, z);
+        glTexCoord2f(1.0f, 1.0f); glVertex3f(x + width + sway, y + height, z);
+        glTexCoord2f(0.0f, 1.0f); glVertex3f(x - width + sway, y + height, z);
+    }
+    glEnd();
+    
+    // Battlefield herbs and small bushes using GL_TRIANGLE_FAN
+    glColor3f(0.15f, 0.25f, 0.1f);
+    for (const ScatterPoint& herb : herbs) {
+        glPushMatrix();
+        glTranslatef(herb.x, herb.y, herb.z);
         
         glBegin(GL_TRIANGLE_FAN);
         glVertex3f(0.0f, 0.5f, 0.0f); // Center
@@ -1939,6 +2519,7 @@ void BackgroundRenderer::drawWeaponsAndDebris() {
     // Apply debris texture for realistic battlefield remnants
     bindTexture(TEX_DEBRIS);
     glColor3f(1.0f, 1.0f, 1.0f); // White to show texture clearly
+    glNormal3fv(kUpNormal);
     
     // Chinese jian swords scattered across battlefield - as textured quads
     glBegin(GL_QUADS);
@@ -2036,29 +2617,22 @@ void BackgroundRenderer::drawWeaponsAndDebris() {
     
     // Extensive rubble and debris near damaged structures
     glColor3f(0.28f, 0.28f, 0.32f); // Stone rubble
-    for(int i = 0; i < 25; i++) {
+    for (const Rubble& r : rubble) {
         glPushMatrix();
-        float rubbleX = 35.0f + (rand() % 200) / 10.0f - 10.0f;
-        float rubbleZ = -50.0f + (rand() % 200) / 10.0f;
-        float rubbleY = 0.0f;
-        glTranslatef(rubbleX, rubbleY, rubbleZ);
-        glRotatef(rand() % 360, 1.0f, 0.5f, 0.8f);
-        glScalef(0.4f + (rand() % 100) / 200.0f, 
-                0.2f + (rand() % 100) / 300.0f, 
-                0.5f + (rand() % 100) / 150.0f);
+        glTranslatef(r.x, r.y, r.z);
+        glRotatef(r.angle, 1.0f, 0.5f, 0.8f);
+        glScalef(r.scaleX, r.scaleY, r.scaleZ);
         gluSphere(quadric, 1.2f, 6, 4);
         glPopMatrix();
     }
     
     // Wooden debris from siege engines and structures
     glColor3f(0.3f, 0.2f, 0.12f); // Splintered wood
-    for(int wood = 0; wood < 20; wood++) {
+    for (const Rubble& w : woodDebris) {
         glPushMatrix();
-        float wx = -50.0f + (rand() % 1000) / 10.0f;
-        float wz = -40.0f + (rand() % 800) / 10.0f;
-        glTranslatef(wx, 0.05f, wz);
-        glRotatef(rand() % 180, 0.0f, 1.0f, 0.0f);
-        glScalef(2.0f + (rand() % 100) / 50.0f, 0.3f, 0.5f);
+        glTranslatef(w.x, w.y, w.z);
+        glRotatef(w.angle, 0.0f, 1.0f, 0.0f);
+        glScalef(w.scaleX, w.scaleY, w.scaleZ);
         gluSphere(quadric, 0.8f, 4, 3); // Low-poly for performance
         glPopMatrix();
     }
@@ -2092,8 +2666,8 @@ void BackgroundRenderer::drawTatteredBanner(float x, float y, float z, float hei
     
     glBegin(GL_QUADS);
     // Main banner quad with texture coordinates
-    float windOffset1 = sin(windTime * 2.5f) * 0.5f;
-    float windOffset2 = sin(windTime * 2.5f + 1.0f) * 0.3f;
+    float windOffset1 = sin(drawn.windTime * 2.5f) * 0.5f;
+    float windOffset2 = sin(drawn.windTime * 2.5f + 1.0f) * 0.3f;
     
     glTexCoord2f(0.0f, 0.0f); glVertex3f(x, height, z);
     glTexCoord2f(1.0f, 0.0f); glVertex3f(x + width + windOffset1, height, z);
@@ -2103,7 +2677,7 @@ void BackgroundRenderer::drawTatteredBanner(float x, float y, float z, float hei
     // Add tattered edge effect with additional small quads
     for (int i = 0; i < 3; i++) {
         float segmentHeight = height - 3.0f - i * 1.0f;
-        float jaggedOffset = sin(i * 2.0f + windTime) * 0.3f;
+        float jaggedOffset = sin(i * 2.0f + drawn.windTime) * 0.3f;
         
         glTexCoord2f(0.0f, (float)i / 3.0f); 
         glVertex3f(x + i * 0.2f, segmentHeight, z);
@@ -2119,6 +2693,7 @@ void BackgroundRenderer::drawTatteredBanner(float x, float y, float z, float hei
 
 void BackgroundRenderer::drawBanners() {
     // Multiple Chinese banners and standards
+    glNormal3fv(kBannerNormal);
     drawTatteredBanner(-25.0f, 0.0f, -20.0f, 12.0f, 4.0f, 0.7f, 0.1f, 0.1f); // Main Chinese banner
     drawTatteredBanner(-45.0f, 0.0f, -15.0f, 10.0f, 3.0f, 0.6f, 0.4f, 0.0f); // Orange Chinese banner
     drawTatteredBanner(-15.0f, 0.0f, -30.0f, 8.0f, 2.5f, 0.8f, 0.2f, 0.1f); // Yellow Chinese standard
@@ -2295,24 +2870,26 @@ void BackgroundRenderer::drawBanners() {
     
     // Campfires and cooking areas
     drawCampfires();
-    
-    // Weapon racks and equipment stores
-    drawWeaponRacks();
 }
 
 void BackgroundRenderer::drawCampfires() {
     glDisable(GL_LIGHTING);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    drawCampfireFlames();
+    glDisable(GL_BLEND);
+    glEnable(GL_LIGHTING);
+}
 
+void BackgroundRenderer::drawCampfireFlames() {
     // Chinese camp cooking fire
     glPushMatrix();
     glTranslatef(-55.0f, 0.1f, 30.0f);
     for (int i = 0; i < 20; i++) {
-        float flicker = sin(windTime * 12.0f + i * 0.8f) * 0.25f;
-        float height = 1.0f + sin(windTime * 8.0f + i) * 0.4f;
+        float flicker = sin(drawn.windTime * 12.0f + i * 0.8f) * 0.25f;
+        float height = 1.0f + sin(drawn.windTime * 8.0f + i) * 0.4f;
         float width = 0.3f + flicker;
-        float angle = (i * 18.0f + windTime * 35.0f);
+        float angle = (i * 18.0f + drawn.windTime * 35.0f);
         
         glPushMatrix();
         glRotatef(angle, 0, 1, 0);
@@ -2359,10 +2936,10 @@ void BackgroundRenderer::drawCampfires() {
     glPushMatrix();
     glTranslatef(50.0f, 0.1f, 32.0f);
     for (int i = 0; i < 18; i++) {
-        float flicker = sin(windTime * 10.0f + i * 0.9f) * 0.2f;
-        float height = 0.9f + sin(windTime * 7.0f + i) * 0.35f;
+        float flicker = sin(drawn.windTime * 10.0f + i * 0.9f) * 0.2f;
+        float height = 0.9f + sin(drawn.windTime * 7.0f + i) * 0.35f;
         float width = 0.28f + flicker;
-        float angle = (i * 20.0f + windTime * 32.0f);
+        float angle = (i * 20.0f + drawn.windTime * 32.0f);
         
         glPushMatrix();
         glRotatef(angle, 0, 1, 0);
@@ -2384,14 +2961,12 @@ void BackgroundRenderer::drawCampfires() {
     glPopMatrix();
     
     glPopMatrix();
-    
-    glDisable(GL_BLEND);
-    glEnable(GL_LIGHTING);
 }
 
 void BackgroundRenderer::drawWeaponRacks() {
     // Chinese weapon rack
     glColor3f(0.3f, 0.25f, 0.2f); // Dark wood
+    glNormal3fv(kRackNormal);
     glPushMatrix();
     glTranslatef(-50.0f, 0.0f, 25.0f);
     
@@ -2662,7 +3237,7 @@ void BackgroundRenderer::drawChineseDragonBanners() {
         glBegin(GL_LINES);
         for (int strand = 0; strand < 3; strand++) {
             float sx = strand * 0.2f - 0.2f;
-            float sway = sin(windTime * 2.0f + tassel + strand) * 0.3f;
+            float sway = sin(drawn.windTime * 2.0f + tassel + strand) * 0.3f;
             glVertex3f(sx, 0.0f, 0.0f);
             glVertex3f(sx + sway, -2.0f, 0.0f);
         }
@@ -2724,7 +3299,7 @@ void BackgroundRenderer::drawChineseFireLances() {
         gluCylinder(quadric, 0.05f, 0.02f, 0.8f, 6, 1);
         
         // Fire effects (during battle)
-        if (fmod(siegeTime + lance * 0.3f, 4.0f) < 0.5f) {
+        if (fmod(drawn.siegeTime + lance * 0.3f, 4.0f) < 0.5f) {
             glColor4f(1.0f, 0.6f, 0.1f, 0.7f);
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE);
@@ -2785,10 +3360,10 @@ void BackgroundRenderer::drawFires() {
     glPushMatrix();
     glTranslatef(20.0f, 0.1f, -8.0f);
     for (int i = 0; i < 25; i++) {
-        float flicker = sin(windTime * 10.0f + i * 0.5f) * 0.3f;
-        float height = 2.0f + sin(windTime * 6.0f + i) * 0.8f;
+        float flicker = sin(drawn.windTime * 10.0f + i * 0.5f) * 0.3f;
+        float height = 2.0f + sin(drawn.windTime * 6.0f + i) * 0.8f;
         float width = 0.6f + flicker;
-        float angle = (i * 15.0f + windTime * 30.0f);
+        float angle = (i * 15.0f + drawn.windTime * 30.0f);
         
         glPushMatrix();
         glRotatef(angle, 0, 1, 0);
@@ -2817,10 +3392,10 @@ void BackgroundRenderer::drawFires() {
         glTranslatef(fx, 0.05f, fz);
         
         for (int flame = 0; flame < 15; flame++) {
-            float flicker = sin(windTime * 12.0f + flame + fireSpot * 3.0f) * 0.25f;
-            float height = 1.2f + sin(windTime * 8.0f + flame) * 0.5f;
+            float flicker = sin(drawn.windTime * 12.0f + flame + fireSpot * 3.0f) * 0.25f;
+            float height = 1.2f + sin(drawn.windTime * 8.0f + flame) * 0.5f;
             float width = 0.4f + flicker;
-            float angle = flame * 24.0f + windTime * 40.0f + fireSpot * 60.0f;
+            float angle = flame * 24.0f + drawn.windTime * 40.0f + fireSpot * 60.0f;
             
             glPushMatrix();
             glRotatef(angle, 0, 1, 0);
@@ -2840,12 +3415,12 @@ void BackgroundRenderer::drawFires() {
     glPushMatrix();
     glTranslatef(-35.0f, 0.2f, -25.0f); // Chinese fortress fire
     for (int i = 0; i < 18; i++) {
-        float flicker = sin(windTime * 9.0f + i * 0.7f) * 0.4f;
-        float height = 2.5f + sin(windTime * 5.0f + i) * 1.0f;
+        float flicker = sin(drawn.windTime * 9.0f + i * 0.7f) * 0.4f;
+        float height = 2.5f + sin(drawn.windTime * 5.0f + i) * 1.0f;
         float width = 0.8f + flicker;
         
         glPushMatrix();
-        glRotatef(i * 20.0f + windTime * 25.0f, 0, 1, 0);
+        glRotatef(i * 20.0f + drawn.windTime * 25.0f, 0, 1, 0);
         glBegin(GL_TRIANGLES);
         glColor4f(1.0f, 0.8f, 0.1f, 0.4f);
         glVertex3f(0.0f, height * 1.4f, 0.0f);
@@ -2861,12 +3436,12 @@ void BackgroundRenderer::drawFires() {
     glPushMatrix();
     glTranslatef(45.0f, 0.3f, -40.0f);
     for (int i = 0; i < 20; i++) {
-        float flicker = sin(windTime * 11.0f + i * 0.4f) * 0.3f;
-        float height = 3.0f + sin(windTime * 7.0f + i) * 1.2f;
+        float flicker = sin(drawn.windTime * 11.0f + i * 0.4f) * 0.3f;
+        float height = 3.0f + sin(drawn.windTime * 7.0f + i) * 1.2f;
         float width = 0.7f + flicker;
         
         glPushMatrix();
-        glRotatef(i * 18.0f + windTime * 35.0f, 0, 1, 0);
+        glRotatef(i * 18.0f + drawn.windTime * 35.0f, 0, 1, 0);
         glBegin(GL_TRIANGLES);
         glColor4f(1.0f, 0.9f, 0.4f, 0.3f);
         glVertex3f(0.0f, height * 1.5f, 0.0f);
@@ -3021,6 +3596,7 @@ void BackgroundRenderer::drawWarHorses() {
     // Apply horses texture for realistic war steeds
     bindTexture(TEX_HORSES);
     glColor3f(1.0f, 1.0f, 1.0f); // White to show texture clearly
+    glNormal3fv(kSlopeNormal);
     
     for (int horse = 0; horse < 6; horse++) {
         glPushMatrix();
@@ -3099,7 +3675,7 @@ void BackgroundRenderer::drawSmokePlumes() {
     glColor4f(1.0f, 1.0f, 1.0f, 0.7f); // Semi-transparent white to show texture
     for (int i = 0; i < 8; i++) {
         glPushMatrix();
-        float timeOffset = windTime + i * 1.2f;
+        float timeOffset = drawn.windTime + i * 1.2f;
         float rise = fmod(timeOffset * 2.5f, 35.0f);
         float sway = sin(timeOffset * 0.6f) * 5.0f + cos(timeOffset * 0.3f) * 2.0f;
         glTranslatef(20.0f + sway, rise + 2.0f, -8.0f);
@@ -3120,7 +3696,7 @@ void BackgroundRenderer::drawSmokePlumes() {
         
         for (int i = 0; i < 6; i++) {
             glPushMatrix();
-            float timeOffset = windTime + i * 1.3f + column * 2.0f;
+            float timeOffset = drawn.windTime + i * 1.3f + column * 2.0f;
             float rise = fmod(timeOffset * 1.8f, 42.0f);
             float sway = sin(timeOffset * 0.35f + column) * 4.0f;
             glTranslatef(baseX + sway, 6.0f + rise, baseZ);
@@ -3135,7 +3711,7 @@ void BackgroundRenderer::drawSmokePlumes() {
     glColor4f(0.4f, 0.35f, 0.28f, 0.3f); // Dusty brown
     for (int dust = 0; dust < 10; dust++) {
         glPushMatrix();
-        float timeOffset = windTime + dust * 0.8f;
+        float timeOffset = drawn.windTime + dust * 0.8f;
         float drift = fmod(timeOffset * 1.2f, 60.0f) - 30.0f; // Horizontal drift
         float rise = sin(timeOffset * 0.5f) * 2.0f + 1.0f;
         float dustX = -40.0f + dust * 8.0f + drift;
@@ -3153,7 +3729,7 @@ void BackgroundRenderer::drawSmokePlumes() {
 }
 
 void BackgroundRenderer::drawRain() {
-    if (currentWeather != WEATHER_RAIN && currentWeather != WEATHER_STORM) return;
+    if (drawn.weather != WEATHER_RAIN && drawn.weather != WEATHER_STORM) return;
     
     // Apply rain texture for realistic rain effects
     bindTexture(TEX_RAIN);
@@ -3162,13 +3738,14 @@ void BackgroundRenderer::drawRain() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glColor4f(1.0f, 1.0f, 1.0f, 0.6f); // Semi-transparent white to show texture
-    float windSlant = 0.5f + sin(windTime) * 0.2f;
+    float windSlant = 0.5f + sin(drawn.windTime) * 0.2f;
 
     glBegin(GL_QUADS);
-    for (int i = 0; i < 250; i++) {
-        float x = -60.0f + (rand() % 12000) / 100.0f;
-        float z = -60.0f + (rand() % 12000) / 100.0f;
-        float y_base = fmod(30.0f - (windTime * 20.0f) + (float)(rand() % 30), 30.0f);
+    for (const RainDrop& drop : rainDrops) {
+        float x = drop.x, z = drop.z;
+        // Falls 20 units per unit of wind time, wrapping from the ground back to 30
+        float y_base = fmod(drop.phase - drawn.windTime * 20.0f, 30.0f);
+        if (y_base < 0.0f) y_base += 30.0f;
         float width = 0.02f;
         
         // Draw rain drops as textured quads
@@ -3183,21 +3760,21 @@ void BackgroundRenderer::drawRain() {
 
 void BackgroundRenderer::drawBirds() {
     // Birds don't fly in bad weather
-    if (currentWeather != WEATHER_CLEAR) return;
+    if (drawn.weather != WEATHER_CLEAR) return;
     
     // Apply bird texture for realistic flying birds
     bindTexture(TEX_BIRD);
     glColor3f(1.0f, 1.0f, 1.0f); // White to show texture clearly
     
     for (int flock = 0; flock < 2; flock++) {
-        float baseX = -40.0f + flock * 50.0f + sin(cloudTime + flock) * 15.0f;
-        float baseY = 30.0f + cos(cloudTime * 0.7f + flock) * 5.0f;
+        float baseX = -40.0f + flock * 50.0f + sin(drawn.cloudTime + flock) * 15.0f;
+        float baseY = 30.0f + cos(drawn.cloudTime * 0.7f + flock) * 5.0f;
         float baseZ = -70.0f + flock * 10.0f;
         
         for (int bird = 0; bird < 6; bird++) {
             float x = baseX + (bird - 3) * 2.5f;
             float y = baseY - abs(bird - 3) * 0.8f;
-            float wingFlap = sin(windTime * 5.0f + bird) * 0.4f;
+            float wingFlap = sin(drawn.windTime * 5.0f + bird) * 0.4f;
             
             glPushMatrix();
             glTranslatef(x, y, baseZ);
@@ -3222,6 +3799,20 @@ void BackgroundRenderer::drawBirds() {
 // ===== MAIN RENDER FUNCTION =====
 void BackgroundRenderer::render() {
     // War sound no longer auto-starts - user controls via T key
+    GL_STATS_SCOPE(SUB_BACKGROUND);
+    auto frameStart = std::chrono::steady_clock::now();
+    unsigned drawCallsAtStart = GLStats::totalDrawCalls();
+    frameStats.staticBatches = 0;
+    frameStats.textureBinds = 0;
+    frameStats.passesDrawn = frameStats.passesCulled = 0;
+    frameStats.instancesDrawn = frameStats.instancesCulled = 0;
+    boundTexture = 0;                  // The character binds between frames
+
+    // Passes wholly outside the view are skipped; a frame recorded for
+    // several views draws everything
+    cullingActive = cullingEnabled && !CommandList::recording();
+    if (cullingActive) viewFrustum = Frustum::fromCurrentMatrices();
+    prepareBillboards();
     
     glPushMatrix();
     glEnable(GL_DEPTH_TEST);
@@ -3230,17 +3821,17 @@ void BackgroundRenderer::render() {
     GLfloat light_ambient[] = { 0.2f, 0.2f, 0.25f, 1.0f }; // Darker base for dramatic effect
     
     // Lightning flash lighting
-    light_ambient[0] += lightningBrightness * 0.8f;
-    light_ambient[1] += lightningBrightness * 0.8f;
-    light_ambient[2] += lightningBrightness;
+    light_ambient[0] += drawn.lightningBrightness * 0.8f;
+    light_ambient[1] += drawn.lightningBrightness * 0.8f;
+    light_ambient[2] += drawn.lightningBrightness;
     
     // Fire glow lighting from battlefield
-    float fireGlow = sin(siegeTime * 4.0f) * 0.1f + 0.15f;
+    float fireGlow = sin(drawn.siegeTime * 4.0f) * 0.1f + 0.15f;
     light_ambient[0] += fireGlow;
     light_ambient[1] += fireGlow * 0.6f; // Orange-red fire glow
     
     // Day/night cycle lighting
-    float dayIntensity = 0.5f + cos(dayNightTime * 3.14159f) * 0.3f;
+    float dayIntensity = 0.5f + cos(drawn.dayNightTime * 3.14159f) * 0.3f;
     light_ambient[0] *= dayIntensity;
     light_ambient[1] *= dayIntensity;
     light_ambient[2] *= dayIntensity;
@@ -3263,12 +3854,12 @@ void BackgroundRenderer::render() {
     glLightfv(GL_LIGHT1, GL_SPECULAR, light1_specular);
     
     // Storm lighting - blue-tinted directional light during storms
-    if (currentWeather == WEATHER_STORM) {
+    if (drawn.weather == WEATHER_STORM) {
         GLfloat storm_light_pos[] = { -100.0f, 80.0f, -50.0f, 0.0f }; // Directional
         GLfloat storm_light_diffuse[] = { 
-            0.4f + lightningBrightness, 
-            0.5f + lightningBrightness, 
-            0.8f + lightningBrightness * 0.5f, 
+            0.4f + drawn.lightningBrightness, 
+            0.5f + drawn.lightningBrightness, 
+            0.8f + drawn.lightningBrightness * 0.5f, 
             1.0f 
         }; // Blue storm light
         
@@ -3283,54 +3874,48 @@ void BackgroundRenderer::render() {
     setupFog();
     
     // 1. Atmospheric elements (farthest)
-    drawSkyDome();
-    drawSunOrMoon();
-    drawStars(); // Draw stars during night time
+    drawStaticLayer(LAYER_SKY); // Sky dome
+    drawSunOrMoon();            // Not culled: the mountains and clouds are lit and textured as it leaves them
+    if (inView(animatedBounds[PASS_STARS])) drawStars(); // Draw stars during night time
     
     // 2. Distant mountain ranges (ink-wash style)
-    drawMountains();
-    drawClouds();
-    drawBirds();
-    
-    // 3. Mid-ground fortifications and structures
-    drawChineseFortress();
-    drawWesternCastle();
-    
-    // 4. Siege equipment and effects
-    drawSiegeLadders();
-    drawSiegeTowers(); // Massive siege towers
-    drawTrebuchets(); // Long-range siege engines
-    drawBatteringRams(); // Gate-breaking weapons
-    drawCatapultStones();
-    drawArrowVolleys(); // Massive arrow formations
-    
-    // 5. Expanded War Scene - Massive Battle Elements
-    drawMassiveArmy(); // Multiple army battalions
-    drawArcherFormations(); // Archer positions on hills
-    drawCavalryCharges(); // Massive cavalry charges from flanks
-    drawTrebuchetBattery(); // Battery of trebuchets
-    drawBatteringRamAssault(); // Battering ram assault on gates
-    drawArrowVolley(); // Dense arrow volleys filling the sky
-    drawCampfires(); // Military campfires throughout battlefield
-    drawWarDrums(); // War drums for battle rhythm
-    drawStarField(); // Enhanced star field for night battles
-    drawForestTrees(); // Massive forest with individual trees
-    
-    // 6. Natural elements
-    drawTrees();
-    drawBattlefield();
-    drawGrass();
+    drawStaticLayer(LAYER_FAR); // Mountains
+    if (inView(animatedBounds[PASS_CLOUDS])) drawClouds();
+    if (inView(animatedBounds[PASS_BIRDS])) drawBirds();
+    
+    // 3. Ground chunks in view, then everything time-invariant: fortifications, siege
+    //    engine frames, army formations, battlefield marks, fallen warriors and horses
+    //    (display lists sorted by texture)
+    CommandList::perView(drawTerrain);    // Culled and levelled per camera when recorded
+    boundTexture = 0;
+    drawStaticLayer(LAYER_WORLD);
+    
+    // 4. Siege equipment and effects (animated parts only)
+    if (inView(animatedBounds[PASS_TREBUCHET_ARMS])) drawTrebuchets(); // Throwing arms of the long-range siege engines
+    if (inView(animatedBounds[PASS_CATAPULT_STONES])) drawCatapultStones();
+    if (inView(animatedBounds[PASS_ARROW_VOLLEYS])) drawArrowVolleys(); // Massive arrow formations
+    
+    // 5. Expanded War Scene - Massive Battle Elements, sorted by state
+    submitWarScene();
+    warSceneQueue.flush();
+    boundTexture = 0;
+    
+    // 6. Natural elements and animated war elements on the battlefield
+    if (inView(animatedBounds[PASS_TREES])) drawTrees();
+    if (inView(animatedBounds[PASS_DRAGON_BANNERS])) drawChineseDragonBanners();
+    if (inView(animatedBounds[PASS_FIRE_LANCES])) drawChineseFireLances();
+    if (inView(animatedBounds[PASS_CROSSBOW_SQUADS])) drawWesternCrossbowSquads();
+    if (inView(animatedBounds[PASS_GRASS])) drawGrass();
     
     // 7. Battle aftermath and active siege effects
-    drawWeaponsAndDebris();
-    drawFallenWarriors(); // Fallen soldiers across battlefield
-    drawWarHorses(); // Fallen war horses
-    drawBanners();
-    drawFires();
-    drawSiegeEffects(); // Active battle effects
+    if (inView(animatedBounds[PASS_WEAPONS_AND_DEBRIS])) drawWeaponsAndDebris();
+    if (inView(animatedBounds[PASS_BANNERS])) drawBanners();
+    if (inView(animatedBounds[PASS_FIRES])) drawFires();
+    if (inView(siegeEffectsBounds())) drawSiegeEffects(); // Active battle effects
     drawSmokePlumes(); // Smoke should be drawn over most elements
 
-    // 7. Weather overlays (drawn last)
+    // 7. Weather overlays (drawn last). Like the smoke, never culled: the
+    // character is drawn with what they leave behind
     drawRain();
     drawLightning(); // 2D effect, drawn over everything
     
@@ -3338,6 +3923,27 @@ void BackgroundRenderer::render() {
     drawCollisionBoxes(); // Show collision boundaries if debug mode enabled
 
     glPopMatrix();
+
+    frameStats.textureBinds += warSceneQueue.lastFlush().textureBinds;
+    frameStats.queueStateChanges = warSceneQueue.lastFlush().stateChanges;
+    frameStats.drawCalls = GLStats::totalDrawCalls() - drawCallsAtStart;
+    frameStats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+}
+
+// The billboards share the atlas and come out in one run; the campfires are
+// blended, so they follow
+void BackgroundRenderer::submitWarScene() {
+    const RenderQueue::State campfire = { 0, nullptr, false, true };
+    if (batchInView(cavalryBillboards)) warSceneQueue.submit(atlasState(TEX_HORSE_CAVALRY), drawCavalryCharges); // Massive cavalry charges from flanks
+    if (inView(animatedBounds[PASS_TREBUCHET_BATTERY])) warSceneQueue.submit(atlasState(TEX_TREBUCHET), drawTrebuchetBattery); // Battery of trebuchets
+    if (inView(animatedBounds[PASS_BATTERING_RAM_ASSAULT])) warSceneQueue.submit(atlasState(TEX_BATTERING_RAMS), drawBatteringRamAssault); // Battering ram assault on gates
+    if (inView(animatedBounds[PASS_ARROW_VOLLEY])) warSceneQueue.submit(atlasState(TEX_ARROWS), drawArrowVolley); // Dense arrow volleys filling the sky
+    if (inView(animatedBounds[PASS_CAMPFIRES])) warSceneQueue.submit(campfire, drawCampfireFlames); // Military campfires throughout battlefield
+    if (inView(animatedBounds[PASS_WAR_DRUMS])) warSceneQueue.submit(atlasState(TEX_DRUMS), drawWarDrums); // War drums for battle rhythm
+    if (drawn.dayNightTime > 0.7f && batchInView(starBillboards)) {
+        warSceneQueue.submit(atlasState(TEX_STARS), drawStarField); // Enhanced star field for night battles
+    }
+    if (batchInView(forestBillboards)) warSceneQueue.submit(atlasState(TEX_TREES), drawForestTrees); // Massive forest with individual trees
 }
 
 void BackgroundRenderer::drawWesternKnightFormations() {
@@ -3437,6 +4043,7 @@ void BackgroundRenderer::drawWesternKnightFormations() {
 void BackgroundRenderer::drawWesternCrossbowSquads() {
     // Western crossbow battalions in defensive positions
     glColor3f(0.3f, 0.25f, 0.2f); // Wood and steel
+    glNormal3fv(kUpNormal);
     
     // Main crossbow squadron
     glPushMatrix();
@@ -3493,7 +4100,7 @@ void BackgroundRenderer::drawWesternCrossbowSquads() {
         glEnd();
         
         // Bolt (if loaded)
-        if ((xbow + (int)siegeTime) % 3 == 0) {
+        if ((xbow + (int)drawn.siegeTime) % 3 == 0) {
             glColor3f(0.4f, 0.3f, 0.1f);
             glLineWidth(2.0f);
             glBegin(GL_LINES);
@@ -3562,138 +4169,97 @@ void BackgroundRenderer::drawWesternWarHorns() {
         
         glPopMatrix();
     }
-    glPopMatrix();
     
     glLineWidth(1.0f);
 }
 
 void BackgroundRenderer::setWeather(int weather) {
     if (weather >= 0 && weather <= WEATHER_STORM) {
-        currentWeather = weather;
+        simulated.weather = weather;
         if (weather != WEATHER_STORM) {
-            lightningBrightness = 0.0f;
+            simulated.lightningBrightness = 0.0f;
             lightningTimer = 5.0f; // Reset timer
         }
     }
 }
 
-// Draw massive army formations spanning the entire battlefield (reduced quantities, raised position)
+// Draw massive army formations spanning the entire battlefield (raised position)
 void BackgroundRenderer::drawMassiveArmy() {
-    bindTexture(TEX_KNIGHT_FORMATIONS);
-    glEnable(GL_TEXTURE_2D);
-    
-    // Draw multiple army battalions across the battlefield (reduced to minimal 2x3)
-    for (int battalion = 0; battalion < 2; battalion++) {      // Reduced from 4 to 2 battalions
-        for (int formation = 0; formation < 3; formation++) {  // Reduced from 6 to 3 formations
-            glPushMatrix();
-            
-            float x = -60.0f + battalion * 120.0f;             // Wider spacing for better visibility
-            float z = -60.0f + formation * 60.0f;              // Wider spacing
-            
-            glTranslatef(x, -2.0f, z);  // Raised Y position from -15.0f to -2.0f
-            glScalef(8.0f, 5.0f, 8.0f);
-            
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f); glVertex3f(-1.0f, 0.0f, -1.0f);
-            glTexCoord2f(1.0f, 0.0f); glVertex3f(1.0f, 0.0f, -1.0f);
-            glTexCoord2f(1.0f, 1.0f); glVertex3f(1.0f, 2.0f, 1.0f);
-            glTexCoord2f(0.0f, 1.0f); glVertex3f(-1.0f, 2.0f, 1.0f);
-            glEnd();
-            
-            glPopMatrix();
+    bindTexture(TEX_BILLBOARD_ATLAS);
+    TextureAtlas::loadTextureMatrix(*atlasRegion(TEX_KNIGHT_FORMATIONS));
+    glColor3fv(kArmyTint);
+    glNormal3fv(kFacingNormal);
+    
+    // 6 battalions of 10 formations (was 2x3 before the billboards were batched)
+    armyBillboards.clear();
+    for (int battalion = 0; battalion < 6; battalion++) {
+        for (int formation = 0; formation < 10; formation++) {
+            float x = -75.0f + battalion * 30.0f;
+            float z = -67.5f + formation * 15.0f;
+            armyBillboards.add(x, -2.0f, z, 8.0f, 5.0f, 8.0f);
         }
     }
+    armyBillboards.draw();
     
+    TextureAtlas::resetTextureMatrix();
     glDisable(GL_TEXTURE_2D);
 }
 
-// Draw archer formations on elevated positions (increased quantities)
+// Draw archer formations on elevated positions
 void BackgroundRenderer::drawArcherFormations() {
-    bindTexture(TEX_ARCHER_FORMATIONS);
-    glEnable(GL_TEXTURE_2D);
+    bindTexture(TEX_BILLBOARD_ATLAS);
+    TextureAtlas::loadTextureMatrix(*atlasRegion(TEX_ARCHER_FORMATIONS));
+    glColor3fv(kArmyTint);
+    glNormal3fv(kFacingNormal);
     
-    // Archer positions on hills and battlements (reduced to 4 positions, raised above ground)
+    // Archer positions on hills and battlements, raised above ground
     float positions[][3] = {
         {-80.0f, 3.0f, -40.0f}, {80.0f, 6.0f, -52.0f},
         {-90.0f, 8.0f, 20.0f}, {90.0f, 7.0f, 25.0f}
     };
     
-    for (int i = 0; i < 4; i++) {  // Reduced from 8 to 4
-        glPushMatrix();
-        glTranslatef(positions[i][0], positions[i][1], positions[i][2]);
-        glScalef(6.0f, 4.0f, 6.0f);
-        
-        glBegin(GL_QUADS);
-        glTexCoord2f(0.0f, 0.0f); glVertex3f(-1.0f, 0.0f, -1.0f);
-        glTexCoord2f(1.0f, 0.0f); glVertex3f(1.0f, 0.0f, -1.0f);
-        glTexCoord2f(1.0f, 1.0f); glVertex3f(1.0f, 1.5f, 1.0f);
-        glTexCoord2f(0.0f, 1.0f); glVertex3f(-1.0f, 1.5f, 1.0f);
-        glEnd();
-        
-        glPopMatrix();
+    // A company of 2 ranks x 5 files on each position (was a single quad)
+    archerBillboards.clear();
+    for (int i = 0; i < 4; i++) {
+        for (int archer = 0; archer < 10; archer++) {
+            float dx = (archer % 5 - 2) * 7.0f;
+            float dz = (archer / 5) * 8.0f - 4.0f;
+            archerBillboards.add(positions[i][0] + dx, positions[i][1], positions[i][2] + dz, 6.0f, 4.0f, 6.0f);
+        }
     }
+    archerBillboards.draw();
     
+    TextureAtlas::resetTextureMatrix();
     glDisable(GL_TEXTURE_2D);
 }
 
 // Draw massive cavalry charges from both flanks
 void BackgroundRenderer::drawCavalryCharges() {
-    bindTexture(TEX_HORSE_CAVALRY);
-    glEnable(GL_TEXTURE_2D);
-    
-    // Left flank cavalry charge
-    for (int wave = 0; wave < 5; wave++) {
-        for (int rider = 0; rider < 15; rider++) {
-            glPushMatrix();
-            
-            float x = -150.0f + wave * 8.0f;
-            float z = -60.0f + rider * 8.0f;
-            float charge_offset = sin(siegeTime * 2.0f + wave * 0.5f) * 5.0f;
-            
-            glTranslatef(x + charge_offset, -12.0f, z);
-            glScalef(4.0f, 3.0f, 6.0f);
-            
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f); glVertex3f(-1.0f, 0.0f, -1.0f);
-            glTexCoord2f(1.0f, 0.0f); glVertex3f(1.0f, 0.0f, -1.0f);
-            glTexCoord2f(1.0f, 1.0f); glVertex3f(1.0f, 2.0f, 1.0f);
-            glTexCoord2f(0.0f, 1.0f); glVertex3f(-1.0f, 2.0f, 1.0f);
-            glEnd();
-            
-            glPopMatrix();
-        }
-    }
-    
-    // Right flank cavalry charge
-    for (int wave = 0; wave < 5; wave++) {
-        for (int rider = 0; rider < 15; rider++) {
-            glPushMatrix();
-            
-            float x = 150.0f - wave * 8.0f;
-            float z = -60.0f + rider * 8.0f;
-            float charge_offset = sin(siegeTime * 2.0f + wave * 0.5f + 3.14f) * 5.0f;
-            
-            glTranslatef(x + charge_offset, -12.0f, z);
-            glScalef(4.0f, 3.0f, 6.0f);
-            
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f); glVertex3f(-1.0f, 0.0f, -1.0f);
-            glTexCoord2f(1.0f, 0.0f); glVertex3f(1.0f, 0.0f, -1.0f);
-            glTexCoord2f(1.0f, 1.0f); glVertex3f(1.0f, 2.0f, 1.0f);
-            glTexCoord2f(0.0f, 1.0f); glVertex3f(-1.0f, 2.0f, 1.0f);
-            glEnd();
-            
-            glPopMatrix();
+    glColor3fv(kSiegeTint);
+    glNormal3fv(kSiegeNormal);
+    drawBillboards(cavalryBillboards);
+}
+
+// Places the riders for siege time time (prepareBillboards)
+void BackgroundRenderer::placeCavalryCharges(float time) {
+    // Each flank charges in 10 waves of 75 riders (was 5 x 15)
+    cavalryBillboards.clear();
+    for (int flank = 0; flank < 2; flank++) {
+        for (int wave = 0; wave < 10; wave++) {
+            float charge_offset = sin(time * 2.0f + wave * 0.25f + flank * 3.14f) * 5.0f;
+            float x = flank == 0 ? -150.0f + wave * 4.0f : 150.0f - wave * 4.0f;
+            for (int rider = 0; rider < 75; rider++) {
+                float z = -60.0f + rider * 1.6f;
+                cavalryBillboards.add(x + charge_offset, -12.0f, z, 4.0f, 3.0f, 6.0f);
+            }
         }
     }
-    
-    glDisable(GL_TEXTURE_2D);
 }
 
 // Draw battery of trebuchets for massive siege warfare
 void BackgroundRenderer::drawTrebuchetBattery() {
-    bindTexture(TEX_TREBUCHET);
-    glEnable(GL_TEXTURE_2D);
+    glColor3fv(kSiegeTint);
+    glNormal3fv(kSiegeNormal);
     
     // Multiple trebuchet positions
     float trebuchet_positions[][3] = {
@@ -3707,7 +4273,7 @@ void BackgroundRenderer::drawTrebuchetBattery() {
         glTranslatef(trebuchet_positions[i][0], trebuchet_positions[i][1], trebuchet_positions[i][2]);
         
         // Animate trebuchet arm
-        float arm_angle = sin(siegeTime * 1.5f + i * 0.8f) * 30.0f - 45.0f;
+        float arm_angle = sin(drawn.siegeTime * 1.5f + i * 0.8f) * 30.0f - 45.0f;
         glRotatef(arm_angle, 1.0f, 0.0f, 0.0f);
         glScalef(8.0f, 12.0f, 8.0f);
         
@@ -3720,15 +4286,13 @@ void BackgroundRenderer::drawTrebuchetBattery() {
         
         glPopMatrix();
     }
-    
-    glDisable(GL_TEXTURE_2D);
 }
 
 // Draw military campfires throughout the battlefield
 // Draw war drums for battle rhythm
 void BackgroundRenderer::drawWarDrums() {
-    bindTexture(TEX_DRUMS);
-    glEnable(GL_TEXTURE_2D);
+    glColor3fv(kCampTint);
+    glNormal3fv(kCampNormal);
     
     // Drum positions around army formations
     float drum_positions[][3] = {
@@ -3742,7 +4306,7 @@ void BackgroundRenderer::drawWarDrums() {
         glTranslatef(drum_positions[i][0], drum_positions[i][1], drum_positions[i][2]);
         
         // Animate drumbeat
-        float beat = abs(sin(siegeTime * 4.0f + i * 1.2f));
+        float beat = abs(sin(drawn.siegeTime * 4.0f + i * 1.2f));
         glScalef(3.0f, 2.0f + beat * 0.5f, 3.0f);
         
         glBegin(GL_QUADS);
@@ -3754,15 +4318,13 @@ void BackgroundRenderer::drawWarDrums() {
         
         glPopMatrix();
     }
-    
-    glDisable(GL_TEXTURE_2D);
 }
 
 // Draw fallen warriors across the battlefield
 // Draw battering ram assault on castle gates
 void BackgroundRenderer::drawBatteringRamAssault() {
-    bindTexture(TEX_BATTERING_RAMS);
-    glEnable(GL_TEXTURE_2D);
+    glColor3fv(kSiegeTint);
+    glNormal3fv(kSiegeNormal);
     
     // Multiple battering rams approaching castle
     float ram_positions[][3] = {
@@ -3773,7 +4335,7 @@ void BackgroundRenderer::drawBatteringRamAssault() {
     for (int i = 0; i < 5; i++) {
         glPushMatrix();
         
-        float assault_motion = sin(siegeTime * 3.0f + i * 1.5f) * 2.0f;
+        float assault_motion = sin(drawn.siegeTime * 3.0f + i * 1.5f) * 2.0f;
         glTranslatef(ram_positions[i][0], ram_positions[i][1], ram_positions[i][2] + assault_motion);
         glScalef(8.0f, 4.0f, 12.0f);
         
@@ -3786,25 +4348,23 @@ void BackgroundRenderer::drawBatteringRamAssault() {
         
         glPopMatrix();
     }
-    
-    glDisable(GL_TEXTURE_2D);
 }
 
 // Draw massive arrow volleys filling the sky
 void BackgroundRenderer::drawArrowVolley() {
-    bindTexture(TEX_ARROWS);
-    glEnable(GL_TEXTURE_2D);
+    glColor3fv(kSiegeTint);
+    glNormal3fv(kSiegeNormal);
     
     // Dense arrow volleys across the battlefield
     for (int volley = 0; volley < 150; volley++) {
         glPushMatrix();
         
-        float x = -160.0f + (volley % 20) * 16.0f + (rand() % 10) - 5.0f;
-        float y = 10.0f + (volley / 20) * 8.0f + sin(siegeTime * 2.0f + volley * 0.3f) * 5.0f;
-        float z = -70.0f + (volley / 40) * 25.0f + (rand() % 8) - 4.0f;
+        float x = -160.0f + (volley % 20) * 16.0f + volleyJitter[volley].x;
+        float y = 10.0f + (volley / 20) * 8.0f + sin(drawn.siegeTime * 2.0f + volley * 0.3f) * 5.0f;
+        float z = -70.0f + (volley / 40) * 25.0f + volleyJitter[volley].z;
         
         glTranslatef(x, y, z);
-        glRotatef(sin(siegeTime + volley * 0.2f) * 15.0f, 1.0f, 0.0f, 0.0f);
+        glRotatef(sin(drawn.siegeTime + volley * 0.2f) * 15.0f, 1.0f, 0.0f, 0.0f);
         glScalef(0.3f, 4.0f, 0.3f);
         
         glBegin(GL_QUADS);
@@ -3816,8 +4376,6 @@ void BackgroundRenderer::drawArrowVolley() {
         
         glPopMatrix();
     }
-    
-    glDisable(GL_TEXTURE_2D);
 }
 
 // ===== COLLISION DETECTION SYSTEM =====
@@ -3826,98 +4384,113 @@ void BackgroundRenderer::initializeCollisionBoxes() {
     
     // Chinese Fortress collision (at -45, 0, -35 with scale 1.5)
     // Original fortress size: -15 to +15 (X), -8 to +8 (Z), scaled by 1.5
-    collisionBoxes.push_back({-67.5f, -22.5f, -47.0f, -23.0f, 18.0f, "Chinese Fortress"});
+    collisionBoxes.push_back({-67.5f, -22.5f, -47.0f, -23.0f, 18.0f, "Chinese Fortress", COLLIDE_FORTIFICATION});
     
     // Western Castle collision (at 50, 0, -45)
     // Castle size: -8 to +8 (X), -8 to +8 (Z) plus cylindrical keep
-    collisionBoxes.push_back({42.0f, 58.0f, -53.0f, -37.0f, 20.0f, "Western Castle"});
+    collisionBoxes.push_back({42.0f, 58.0f, -53.0f, -37.0f, 20.0f, "Western Castle", COLLIDE_FORTIFICATION});
     
     // Major siege equipment collision boxes (moved away from center)
     // Chinese siege tower (at -25, 0, -15)
-    collisionBoxes.push_back({-31.0f, -19.0f, -21.0f, -9.0f, 24.0f, "Chinese Siege Tower"});
+    collisionBoxes.push_back({-31.0f, -19.0f, -21.0f, -9.0f, 24.0f, "Chinese Siege Tower", COLLIDE_SIEGE_ENGINE});
     
     // Western siege tower (at 35, 0, -20)
-    collisionBoxes.push_back({31.0f, 39.0f, -24.0f, -16.0f, 18.0f, "Western Siege Tower"});
+    collisionBoxes.push_back({31.0f, 39.0f, -24.0f, -16.0f, 18.0f, "Western Siege Tower", COLLIDE_SIEGE_ENGINE});
     
     // Trebuchets (far from center)
-    collisionBoxes.push_back({-56.0f, -44.0f, 19.0f, 31.0f, 15.0f, "Chinese Trebuchet"});
-    collisionBoxes.push_back({44.0f, 56.0f, 19.0f, 31.0f, 15.0f, "Western Trebuchet"});
+    collisionBoxes.push_back({-56.0f, -44.0f, 19.0f, 31.0f, 15.0f, "Chinese Trebuchet", COLLIDE_SIEGE_ENGINE});
+    collisionBoxes.push_back({44.0f, 56.0f, 19.0f, 31.0f, 15.0f, "Western Trebuchet", COLLIDE_SIEGE_ENGINE});
     
     // Battering rams (near gates, away from center)
-    collisionBoxes.push_back({-50.0f, -40.0f, -32.0f, -28.0f, 3.0f, "Chinese Gate Ram"});
-    collisionBoxes.push_back({45.0f, 55.0f, -48.0f, -42.0f, 3.0f, "Western Gate Ram"});
+    collisionBoxes.push_back({-50.0f, -40.0f, -32.0f, -28.0f, 3.0f, "Chinese Gate Ram", COLLIDE_SIEGE_ENGINE});
+    collisionBoxes.push_back({45.0f, 55.0f, -48.0f, -42.0f, 3.0f, "Western Gate Ram", COLLIDE_SIEGE_ENGINE});
     
     // Large campfires and weapon racks (moved away from center)
-    collisionBoxes.push_back({17.0f, 23.0f, -12.0f, -2.0f, 2.5f, "Major Campfire"});
-    collisionBoxes.push_back({-53.0f, -47.0f, 23.0f, 27.0f, 3.0f, "Chinese Weapon Rack"});
-    collisionBoxes.push_back({47.0f, 53.0f, 23.0f, 27.0f, 3.0f, "Western Weapon Rack"});
+    collisionBoxes.push_back({17.0f, 23.0f, -12.0f, -2.0f, 2.5f, "Major Campfire", COLLIDE_CAMP});
+    collisionBoxes.push_back({-53.0f, -47.0f, 23.0f, 27.0f, 3.0f, "Chinese Weapon Rack", COLLIDE_CAMP});
+    collisionBoxes.push_back({47.0f, 53.0f, 23.0f, 27.0f, 3.0f, "Western Weapon Rack", COLLIDE_CAMP});
     
     // Battlefield debris and obstacles (moved away from starting area)
-    collisionBoxes.push_back({-35.0f, -25.0f, 8.0f, 18.0f, 2.0f, "Battlefield Debris 1"});
-    collisionBoxes.push_back({25.0f, 35.0f, -25.0f, -15.0f, 2.0f, "Battlefield Debris 2"});
-    collisionBoxes.push_back({-45.0f, -35.0f, 5.0f, 12.0f, 1.8f, "Supply Wagon"});
-    collisionBoxes.push_back({30.0f, 37.0f, 8.0f, 15.0f, 2.2f, "Overturned Cart"});
-    collisionBoxes.push_back({-18.0f, -12.0f, -8.0f, -2.0f, 1.0f, "Boulder"});
-    collisionBoxes.push_back({40.0f, 47.0f, -10.0f, -3.0f, 1.5f, "Broken Catapult"});
-    collisionBoxes.push_back({-25.0f, -18.0f, 25.0f, 32.0f, 2.0f, "Abandoned Tent"});
-    
-    printf("Initialized %zu collision boxes\n", collisionBoxes.size());
-    printf("Center area (±15, ±15) kept clear for character movement\n");
+    collisionBoxes.push_back({-35.0f, -25.0f, 8.0f, 18.0f, 2.0f, "Battlefield Debris 1", COLLIDE_DEBRIS});
+    collisionBoxes.push_back({25.0f, 35.0f, -25.0f, -15.0f, 2.0f, "Battlefield Debris 2", COLLIDE_DEBRIS});
+    collisionBoxes.push_back({-45.0f, -35.0f, 5.0f, 12.0f, 1.8f, "Supply Wagon", COLLIDE_DEBRIS});
+    collisionBoxes.push_back({30.0f, 37.0f, 8.0f, 15.0f, 2.2f, "Overturned Cart", COLLIDE_DEBRIS});
+    collisionBoxes.push_back({-18.0f, -12.0f, -8.0f, -2.0f, 1.0f, "Boulder", COLLIDE_DEBRIS});
+    collisionBoxes.push_back({40.0f, 47.0f, -10.0f, -3.0f, 1.5f, "Broken Catapult", COLLIDE_DEBRIS});
+    collisionBoxes.push_back({-25.0f, -18.0f, 25.0f, 32.0f, 2.0f, "Abandoned Tent", COLLIDE_CAMP});
+    
+    // Index over the walkable area (checkCollision blocks everything outside it)
+    collisionGrid.build(collisionBoxes, -90.0f, 90.0f, -80.0f, 60.0f, 10.0f);
+    
+    LOG_INFO("Initialized %zu collision boxes", collisionBoxes.size());
+    LOG_INFO("Center area (±15, ±15) kept clear for character movement");
+}
+
+bool BackgroundRenderer::outsideBattlefield(float x, float z) {
+    // Battlefield extends roughly from -90 to +90 (prevents falling off the edge)
+    const float battlefieldSize = 90.0f;
+    return x < -battlefieldSize || x > battlefieldSize || z < -80.0f || z > 60.0f;
 }
 
 bool BackgroundRenderer::checkCollision(float x, float z, float radius) {
-    // First check battlefield boundaries (prevent falling off the edge)
-    const float battlefieldSize = 90.0f; // Battlefield extends roughly from -90 to +90
-    if (x < -battlefieldSize || x > battlefieldSize || z < -80.0f || z > 60.0f) {
+    if (outsideBattlefield(x, z)) {
         return true; // Blocked at battlefield edge
     }
-    
-    // Check collision with all objects
-    return checkCollisionWithCastles(x, z, radius) || checkCollisionWithObjects(x, z, radius);
+    return collisionGrid.overlapCircle(x, z, radius) >= 0;
 }
 
 bool BackgroundRenderer::checkCollisionWithCastles(float x, float z, float radius) {
-    // Check major fortifications
-    for (const auto& box : collisionBoxes) {
-        if (strstr(box.name, "Fortress") || strstr(box.name, "Castle")) {
-            if (circleBoxCollision(x, z, radius, box)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    // Major fortifications only
+    return collisionGrid.overlapCircle(x, z, radius, COLLIDE_FORTIFICATION) >= 0;
 }
 
 bool BackgroundRenderer::checkCollisionWithObjects(float x, float z, float radius) {
-    // Check all other objects (siege equipment, debris, etc.)
-    for (const auto& box : collisionBoxes) {
-        if (!strstr(box.name, "Fortress") && !strstr(box.name, "Castle")) {
-            if (circleBoxCollision(x, z, radius, box)) {
-                return true;
-            }
+    // All other objects (siege equipment, debris, etc.)
+    return collisionGrid.overlapCircle(x, z, radius, COLLIDE_ALL & ~COLLIDE_FORTIFICATION) >= 0;
+}
+
+void BackgroundRenderer::checkCollisions(const float* x, const float* z, const float* radius, size_t count,
+                                         bool* blocked, unsigned categories) {
+    for (size_t i = 0; i < count; ++i) {
+        blocked[i] = outsideBattlefield(x[i], z[i]) || collisionGrid.overlapCircle(x[i], z[i], radius[i], categories) >= 0;
+    }
+}
+
+bool BackgroundRenderer::sweepCollision(float x, float z, float dx, float dz, float radius, SweepHit& hit,
+                                        unsigned categories) {
+    collisionGrid.sweepCircle(x, z, dx, dz, radius, hit, categories);
+
+    // The edge stops the centre, as in outsideBattlefield()
+    const float edgeMin[2] = { -90.0f, -80.0f }, edgeMax[2] = { 90.0f, 60.0f };
+    const float origin[2] = { x, z }, delta[2] = { dx, dz };
+    bool edge = false;
+    for (int axis = 0; axis < 2; ++axis) {
+        float t, normal;
+        if (delta[axis] > 0.0f && origin[axis] + delta[axis] > edgeMax[axis]) {
+            t = (edgeMax[axis] - origin[axis]) / delta[axis];
+            normal = -1.0f;
+        } else if (delta[axis] < 0.0f && origin[axis] + delta[axis] < edgeMin[axis]) {
+            t = (edgeMin[axis] - origin[axis]) / delta[axis];
+            normal = 1.0f;
+        } else {
+            continue;
+        }
+        t = t < 0.0f ? 0.0f : t;
+        if ((hit.box < 0 && !edge) || t < hit.time) {
+            hit.time = t;
+            hit.normalX = axis == 0 ? normal : 0.0f;
+            hit.normalZ = axis == 1 ? normal : 0.0f;
+            hit.box = -1;
+            edge = true;
         }
     }
-    return false;
+    return edge || hit.box >= 0;
 }
 
 bool BackgroundRenderer::pointInBox(float x, float z, const CollisionBox& box) {
     return (x >= box.minX && x <= box.maxX && z >= box.minZ && z <= box.maxZ);
 }
 
-bool BackgroundRenderer::circleBoxCollision(float cx, float cz, float radius, const CollisionBox& box) {
-    // Find the closest point on the box to the circle center
-    float closestX = (box.minX > cx) ? box.minX : ((cx > box.maxX) ? box.maxX : cx);
-    float closestZ = (box.minZ > cz) ? box.minZ : ((cz > box.maxZ) ? box.maxZ : cz);
-    
-    // Calculate distance from circle center to closest point
-    float distanceX = cx - closestX;
-    float distanceZ = cz - closestZ;
-    float distanceSquared = distanceX * distanceX + distanceZ * distanceZ;
-    
-    // Collision occurs if distance is less than radius
-    return distanceSquared < (radius * radius);
-}
-
 void BackgroundRenderer::drawCollisionBoxes() {
     if (!collisionDebugMode) return;
     
@@ -3965,7 +4538,7 @@ void BackgroundRenderer::drawCollisionBoxes() {
 // ===== AUDIO SYSTEM =====
 void BackgroundRenderer::playWarSound() {
     if (!warSoundInitialized) {
-        printf("Warning: Audio system not initialized\n");
+        LOG_WARN("Audio system not initialized");
         return;
     }
     
@@ -3973,33 +4546,13 @@ void BackgroundRenderer::playWarSound() {
         return; // Already playing
     }
     
-    // Use MCI to play MP3 file
-    char command[512];
-    sprintf_s(command, sizeof(command), "open \"texturess/war sound.mp3\" type mpegvideo alias warsound");
-    MCIERROR mciError = mciSendStringA(command, NULL, 0, NULL);
-    
-    if (mciError != 0) {
-        printf("Error opening war sound: %lu\n", mciError);
-        return;
-    }
-    
-    // Set volume (0 to 1000, where 1000 is maximum)
-    int volume = (int)(warSoundVolume * 1000.0f);
-    sprintf_s(command, sizeof(command), "setaudio warsound volume to %d", volume);
-    mciSendStringA(command, NULL, 0, NULL);
-    
-    // Play the sound in a loop
-    sprintf_s(command, sizeof(command), "play warsound repeat");
-    mciError = mciSendStringA(command, NULL, 0, NULL);
-    
-    if (mciError != 0) {
-        printf("Error playing war sound: %lu\n", mciError);
-        mciSendStringA("close warsound", NULL, 0, NULL);
+    // Streamed and looped by the platform audio backend
+    if (!Platform::playLooping("warsound", "texturess/war sound.mp3", warSoundVolume)) {
         return;
     }
     
     warSoundPlaying = true;
-    printf("War sound started playing\n");
+    LOG_INFO("War sound started playing");
 }
 
 void BackgroundRenderer::stopWarSound() {
@@ -4008,11 +4561,10 @@ void BackgroundRenderer::stopWarSound() {
     }
     
     // Stop and close the sound
-    mciSendStringA("stop warsound", NULL, 0, NULL);
-    mciSendStringA("close warsound", NULL, 0, NULL);
+    Platform::stopSound("warsound");
     
     warSoundPlaying = false;
-    printf("War sound stopped\n");
+    LOG_INFO("War sound stopped");
 }
 
 void BackgroundRenderer::setWarSoundVolume(float volume) {
@@ -4024,77 +4576,44 @@ void BackgroundRenderer::setWarSoundVolume(float volume) {
     
     // If currently playing, update the volume
     if (warSoundPlaying) {
-        char command[256];
-        int mciVolume = (int)(volume * 1000.0f);
-        sprintf_s(command, sizeof(command), "setaudio warsound volume to %d", mciVolume);
-        mciSendStringA(command, NULL, 0, NULL);
+        Platform::setVolume("warsound", volume);
     }
     
-    printf("War sound volume set to %.1f%%\n", volume * 100.0f);
+    LOG_INFO("War sound volume set to %.1f%%", volume * 100.0f);
 }
 
-// Draw enhanced star field for night battles
+// Draw enhanced star field for night battles (submitted only at night)
 void BackgroundRenderer::drawStarField() {
-    if (dayNightTime > 0.7f) {  // Only at night
-        bindTexture(TEX_STARS);
-        glEnable(GL_TEXTURE_2D);
-        
-        // Dense star field
-        for (int star = 0; star < 200; star++) {
-            glPushMatrix();
-            
-            float x = -200.0f + (star % 25) * 16.0f;
-            float y = 50.0f + (star / 25) * 15.0f + sin(siegeTime * 0.5f + star * 0.1f) * 2.0f;
-            float z = -150.0f + (star / 50) * 30.0f;
-            
-            glTranslatef(x, y, z);
-            
-            float twinkle = 0.5f + abs(sin(siegeTime * 3.0f + star * 0.8f)) * 0.5f;
-            glScalef(twinkle, twinkle, twinkle);
-            
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f); glVertex3f(-0.5f, 0.0f, -0.5f);
-            glTexCoord2f(1.0f, 0.0f); glVertex3f(0.5f, 0.0f, -0.5f);
-            glTexCoord2f(1.0f, 1.0f); glVertex3f(0.5f, 1.0f, 0.5f);
-            glTexCoord2f(0.0f, 1.0f); glVertex3f(-0.5f, 1.0f, 0.5f);
-            glEnd();
-            
-            glPopMatrix();
-        }
-        
-        glDisable(GL_TEXTURE_2D);
+    glColor3fv(kCampTint);
+    glNormal3fv(kCampNormal);
+    drawBillboards(starBillboards);
+}
+
+// Places and twinkles the stars for siege time time (prepareBillboards)
+void BackgroundRenderer::placeStarField(float time) {
+    // Dense star field: 50 columns x 40 rows in 4 depth layers (was 200 stars)
+    starBillboards.clear();
+    for (int star = 0; star < 2000; star++) {
+        float x = -200.0f + (star % 50) * 8.0f;
+        float y = 50.0f + (star / 50) * 3.0f + sin(time * 0.5f + star * 0.1f) * 2.0f;
+        float z = -150.0f + (star / 500) * 30.0f;
+        
+        float twinkle = 0.5f + abs(sin(time * 3.0f + star * 0.8f)) * 0.5f;
+        starBillboards.add(x, y, z, twinkle, twinkle, twinkle);
     }
 }
 
 // Draw massive forest with individual trees
 void BackgroundRenderer::drawForestTrees() {
-    bindTexture(TEX_TREES);
-    glEnable(GL_TEXTURE_2D);
-    
-    // Dense forest on both sides of battlefield
-    for (int tree = 0; tree < 80; tree++) {
-        glPushMatrix();
-        
-        float x = (tree < 40) ? -180.0f + (tree % 20) * 8.0f : 140.0f + (tree % 20) * 8.0f;
-        float z = -100.0f + (tree / 20) * 30.0f;
-        float height = 15.0f + (rand() % 10);
-        
-        glTranslatef(x, -15.0f + height * 0.3f, z);
-        
-        // Slight wind sway
-        float sway = sin(windTime + tree * 0.5f) * 2.0f;
-        glRotatef(sway, 0.0f, 0.0f, 1.0f);
-        glScalef(6.0f, height, 6.0f);
-        
-        glBegin(GL_QUADS);
-        glTexCoord2f(0.0f, 0.0f); glVertex3f(-1.0f, 0.0f, -1.0f);
-        glTexCoord2f(1.0f, 0.0f); glVertex3f(1.0f, 0.0f, -1.0f);
-        glTexCoord2f(1.0f, 1.0f); glVertex3f(1.0f, 2.0f, 1.0f);
-        glTexCoord2f(0.0f, 1.0f); glVertex3f(-1.0f, 2.0f, 1.0f);
-        glEnd();
-        
-        glPopMatrix();
+    glColor3fv(kCampTint);
+    glNormal3fv(kCampNormal);
+    drawBillboards(forestBillboards);
+}
+
+// Dense forest on both sides of battlefield (placed by buildScatter); only
+// the wind sway changes per frame (prepareBillboards)
+void BackgroundRenderer::swayForestTrees(float time) {
+    for (size_t tree = 0; tree < forestBillboards.size(); tree++) {
+        forestBillboards.setSway(tree, sin(time + tree * 0.5f) * 2.0f);
     }
-    
-    glDisable(GL_TEXTURE_2D);
 }
\ No newline at end of file
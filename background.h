@@ -1,12 +1,15 @@
 #pragma once
 
-#include <Windows.h>
-#include <gl/GL.h>
-#include <gl/GLU.h>
-#pragma comment(lib, "winmm.lib")
-#include <mmsystem.h>
+#include "platform.h"
+#include "particles.h"
+#include "billboards.h"
+#include "collision.h"
+#include "frustum.h"
+#include "render_queue.h"
+#include "texture_atlas.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <string>
 #include <vector>
 
 #ifndef M_PI
@@ -21,27 +24,17 @@ enum WeatherType {
     WEATHER_STORM = 3
 };
 
-// Siege effect structures
 struct Vec3 {
     float x, y, z;
 };
 
-struct Arrow {
-    Vec3 position;
-    Vec3 velocity;
-    float lifetime;
-};
-
-struct Spark {
-    Vec3 position;
-    Vec3 velocity;
-    float lifetime;
-};
-
-struct Ember {
-    Vec3 position;
-    Vec3 velocity;
-    float lifetime;
+// World-space box around one background pass (background space), for the
+// frustum test in BackgroundRenderer::render(). A box with min > max holds
+// nothing and is never in view.
+struct PassBounds {
+    float min[3], max[3];
+    float ring;     // > 0: the pass is a wall this far around the y axis (the sky),
+                    // hidden when all of it is beyond the frustum's reach
 };
 
 class BackgroundRenderer {
@@ -53,12 +46,31 @@ public:
     // Update animations
     static void update(float deltaTime);
 
+    // What update() advances and render() draws, as one frame's copy. The
+    // simulation keeps its own (update() on whichever thread runs it) and
+    // captures it after each step; the render thread applies the newest over
+    // the one render() draws. setWeather() and setCharacterCapsule() act on
+    // the simulation's, so they are called where update() runs.
+    struct StuckArrow { float x, y, z, dirX, dirY, dirZ; };
+    struct Snapshot {
+        float windTime = 0.0f, cloudTime = 0.0f, siegeTime = 0.0f, dayNightTime = 0.0f;
+        int weather = 0;
+        float lightningBrightness = 0.0f;
+        ParticlePool arrows{ 0 }, sparks{ 0 }, embers{ 0 };
+        std::vector<StuckArrow> stuckArrows;
+    };
+    static void capture(Snapshot& out);
+    // behind > 0 draws in as it stood that many seconds before it was taken:
+    // the clocks run back and the particles in flight drift back along their
+    // velocity. A frame that falls between two steps draws between them.
+    static void apply(const Snapshot& in, float behind = 0.0f);
+
     // Main rendering function
     static void render();
 
     // Weather control
     static void setWeather(int weather);
-    static int getWeather() { return currentWeather; }
+    static int getWeather() { return simulated.weather; }
 
     // Audio control
     static void playWarSound();
@@ -72,50 +84,205 @@ public:
     // Collision debug access
     static bool collisionDebugMode;
     
-    // Collision detection system
+    // Collision detection system (uniform grid over the battlefield, see collision.h)
     static bool checkCollision(float x, float z, float radius = 1.0f);
     static bool checkCollisionWithCastles(float x, float z, float radius);
     static bool checkCollisionWithObjects(float x, float z, float radius);
+    // Batched: blocked[i] = checkCollision(x[i], z[i], radius[i]) limited to categories
+    static void checkCollisions(const float* x, const float* z, const float* radius, size_t count,
+                                bool* blocked, unsigned categories = COLLIDE_ALL);
+    // First contact of a circle moving by (dx, dz), including the battlefield
+    // edge (hit.box -1); false if the whole move is clear. See collision.h.
+    static bool sweepCollision(float x, float z, float dx, float dz, float radius, SweepHit& hit,
+                               unsigned categories = COLLIDE_ALL);
+    static const CollisionGrid& getCollisionGrid() { return collisionGrid; }
+    // The character as a vertical capsule in background space (radius 0 =
+    // none), for the siege arrows to hit; set every frame by the game
+    static void setCharacterCapsule(float x, float z, float bottomY, float topY, float radius);
+    static unsigned getArrowHitsOnCharacter() { return arrowHitsOnCharacter; }
     static void drawCollisionBoxes(); // Debug visualization
 
+    // Retained static scene cache (display lists built once in init())
+    static void setStaticCacheEnabled(bool enabled);
+    static bool isStaticCacheEnabled() { return staticCacheEnabled; }
+
+    // View-frustum culling of whole passes and of per-frame billboards
+    static void setCullingEnabled(bool enabled);
+    static bool isCullingEnabled() { return cullingEnabled; }
+
+    // Checks the measured pass boxes (measurePassBounds()): every culled pass
+    // is drawn in feedback mode as the scene stands now, and those with a
+    // vertex outside their box are returned with the farthest distance
+    // outside, so a pose the sweep at init() missed shows up. Leaves the GL
+    // state as it found it; call between frames.
+    struct BoundsViolation { std::string pass; float outside; };
+    static std::vector<BoundsViolation> checkPassBounds();
+
+    // Statistics for the last render() call
+    struct FrameStats {
+        unsigned drawCalls;     // glBegin/glCallList/GLU batches submitted
+        unsigned staticBatches; // Display lists replayed from the static cache
+        unsigned terrainChunks; // Ground chunks drawn, and culled by the frustum
+        unsigned terrainChunksCulled;
+        unsigned textureBinds;  // Outside the static cache: bindTexture() and the war-scene queue
+        unsigned queueStateChanges; // Enables, disables and atlas rectangles set by that queue
+        unsigned passesDrawn;   // Passes in view, and skipped by the frustum test
+        unsigned passesCulled;
+        unsigned instancesDrawn; // Billboards of the per-frame batches, likewise
+        unsigned instancesCulled;
+        double cpuMs;           // CPU time spent inside render()
+        double prepareMs;       // Of that, preparing the billboard batches on the job threads
+    };
+    static const FrameStats& getFrameStats() { return frameStats; }
+
 private:
     // Static variables for state
     static GLUquadric* quadric;
-    static float windTime;
-    static float cloudTime;
-    static int currentWeather;
+
+    // The two copies of the Snapshot state. simulated belongs to update()
+    // and its helpers, and is touched by one thread at a time (SimThread's,
+    // or the render thread's while there is none); drawn belongs to render()
+    // and the passes, on the render thread. Nothing reads one for the other.
+    static Snapshot simulated;
+    static Snapshot drawn;
     
     // Storm-related variables
-    static float lightningTimer;
-    static float lightningBrightness;
+    static float lightningTimer;    // update()'s alone, so not in the snapshot
     
     // Audio-related variables
     static bool warSoundInitialized;
     
     // Collision detection data
-    struct CollisionBox {
-        float minX, maxX, minZ, maxZ;
-        float height;
-        const char* name; // For debugging
-    };
     static std::vector<CollisionBox> collisionBoxes;
+    static CollisionGrid collisionGrid;
     
     // Siege effect variables
-    static float siegeTime;
-    static float dayNightTime; // Time for day/night cycle
-    static std::vector<Arrow> arrows;
-    static std::vector<Spark> sparks;
-    static std::vector<Ember> embers;
+    // Arrows that struck wood or the ground stay in Snapshot::stuckArrows; a
+    // fixed ring, the oldest replaced first
+    static size_t nextStuckArrow;
+    // Scratch for the batched arrow tests, sized to the arrow pool once
+    static std::vector<float> arrowStepX, arrowStepY, arrowStepZ;
+    static std::vector<SegmentHit> arrowHits;
+    struct Capsule { float x, z, bottomY, topY, radius; };
+    static Capsule characterCapsule;
+    static unsigned arrowHitsOnCharacter;
+    
+    // Batched billboard passes (one draw per texture)
+    static BillboardBatch armyBillboards;
+    static BillboardBatch archerBillboards;
+    static BillboardBatch cavalryBillboards;
+    static BillboardBatch starBillboards;
+    static BillboardBatch forestBillboards;
     
+    // Procedural scatter: placed once from fixed seeds, so frames don't
+    // flicker and a given frame renders the same on every run
+    struct ScatterPoint { float x, y, z; };
+    struct GrassBlade { float x, y, z, height, width; };
+    struct RainDrop { float x, z, phase; };
+    struct Rubble { float x, y, z, angle, scaleX, scaleY, scaleZ; };
+    static std::vector<GrassBlade> grassBlades;
+    static std::vector<ScatterPoint> herbs;
+    static std::vector<RainDrop> rainDrops;
+    static std::vector<Rubble> rubble;
+    static std::vector<Rubble> woodDebris;
+    static std::vector<ScatterPoint> volleyJitter; // Per-volley x/z offset
+    static void buildScatter();
+    
+    // Static scene cache - time-invariant passes compiled into display lists,
+    // one per pass so render() can cull each on its own
+    enum StaticLayer {
+        LAYER_SKY = 0,   // Sky dome, drawn first with depth writes off
+        LAYER_FAR = 1,   // Distant mountains, drawn before the blended clouds
+        LAYER_WORLD = 2, // Fortifications, siege engines, formations, ground, aftermath
+        LAYER_COUNT
+    };
+    struct StaticPass {
+        void (*draw)();
+        int texture; // Primary texture, -1 for untextured passes
+        int layer;
+        bool wall;   // Culled as a wall around the y axis too (PassBounds::ring)
+    };
+    struct StaticBatch {
+        GLuint list;
+        int pass;    // Index into staticPasses
+    };
+    static const StaticPass staticPasses[];
+    static const int staticPassCount;
+    static std::vector<StaticBatch> staticBatches;
+    static bool staticCacheEnabled;
+    static FrameStats frameStats;
+    static void buildStaticCache();
+    static void releaseStaticCache();
+    static void drawStaticLayer(int layer);
+
+    // Frustum culling: the view in background space, taken at the start of
+    // render(). Off while a frame is recorded for several views (command_list.h).
+    static Frustum viewFrustum;
+    static bool cullingEnabled;
+    static bool cullingActive;
+    static bool inView(const PassBounds& bounds);    // Counts the pass as drawn or culled
+    
+    // Pass boxes, measured from the geometry each pass emits. The static
+    // passes are measured once; the animated ones over a sweep of the clocks
+    // in every weather (measurePassBounds(), from init()). The siege effects
+    // are only where their particles are, so theirs comes from the pools
+    // each frame (siegeEffectsBounds()).
+    enum AnimatedPass {
+        PASS_STARS, PASS_CLOUDS, PASS_BIRDS,
+        PASS_TREBUCHET_ARMS, PASS_CATAPULT_STONES, PASS_ARROW_VOLLEYS,
+        PASS_TREBUCHET_BATTERY, PASS_BATTERING_RAM_ASSAULT, PASS_ARROW_VOLLEY, PASS_CAMPFIRES, PASS_WAR_DRUMS,
+        PASS_TREES, PASS_DRAGON_BANNERS, PASS_FIRE_LANCES, PASS_CROSSBOW_SQUADS, PASS_GRASS,
+        PASS_WEAPONS_AND_DEBRIS, PASS_BANNERS, PASS_FIRES,
+        ANIMATED_PASS_COUNT
+    };
+    struct AnimatedPassInfo {
+        const char* name;
+        void (*draw)();
+    };
+    static const AnimatedPassInfo animatedPasses[ANIMATED_PASS_COUNT];
+    static PassBounds animatedBounds[ANIMATED_PASS_COUNT];
+    static std::vector<PassBounds> staticBounds;    // One per staticPasses entry
+    static void measurePassBounds();
+    static PassBounds siegeEffectsBounds();
+    // Draws each pass in feedback mode and grows its box (and ring, for a
+    // box with one) to hold every vertex it emits
+    struct MeasuredPass {
+        void (*draw)();
+        PassBounds* bounds;
+    };
+    static void growToGeometry(const MeasuredPass* passes, size_t count);
+    static bool batchInView(const BillboardBatch& batch); // Likewise, for a batch prepareBillboards() culled
+    static void prepareBillboards();
+    static void drawBillboards(BillboardBatch& batch); // Leaves out instances outside the view
+
     // Texture system
     static GLuint textures[50]; // Array to hold texture IDs
+    static GLuint boundTexture; // Last bound by bindTexture(); 0 once anything else may have bound
     static bool texturesLoaded;
     
     // Texture loading and management
-    static GLuint loadBMPTexture(const char* filename);
+    static GLuint requestTexture(const char* filename);
     static void loadAllTextures();
     static void loadTextureOnDemand(int textureIndex);
     static void bindTexture(int textureIndex);
+
+    // Small billboard textures packed into TEX_BILLBOARD_ATLAS, so the war
+    // scene and the formations share one bind
+    struct BillboardAtlas {
+        TextureAtlas::Layout layout;
+        std::vector<std::string> paths;     // One per cell
+        int cell[50];                       // Per texture slot, -1 when not packed
+        TextureAtlas::Rect rects[50];
+    };
+    static const BillboardAtlas& billboardAtlas();
+    // Where a slot's image sits in the atlas, or null for a slot not packed
+    static const TextureAtlas::Rect* atlasRegion(int textureIndex);
+    // Queue state drawing a packed slot, lit and opaque
+    static RenderQueue::State atlasState(int textureIndex);
+    
+    // The expanded war scene, submitted by state and drawn sorted
+    static RenderQueue warSceneQueue;
+    static void submitWarScene();
     
     // Texture indices for easy access
     enum TextureIndex {
@@ -156,12 +323,16 @@ private:
         TEX_ARMOR = 34,
         TEX_SKIN = 35,
         TEX_HELMET = 36,
-        TEX_SABATONS = 37
+        TEX_SABATONS = 37,
+        TEX_BILLBOARD_ATLAS = 38
     };
 
     // Siege effects update and spawn
+    static void advanceClocks(Snapshot& state, float deltaTime);
     static void updateSiegeEffects(float deltaTime);
     static void spawnSiegeEffects();
+    static void collideArrows(float deltaTime);
+    static void spawnArrowImpact(float x, float y, float z, const float direction[3], const float normal[3], bool stick);
 
     // Helper to draw a single tattered banner
     static void drawTatteredBanner(float x, float y, float z, float height, float width, float r, float g, float b);
@@ -169,7 +340,7 @@ private:
     // Collision detection helpers
     static void initializeCollisionBoxes();
     static bool pointInBox(float x, float z, const CollisionBox& box);
-    static bool circleBoxCollision(float cx, float cz, float radius, const CollisionBox& box);
+    static bool outsideBattlefield(float x, float z);
 
     // --- Drawing Sub-routines ---
 
@@ -183,7 +354,8 @@ private:
 
     // Terrain
     static void drawMountains();
-    static void drawBattlefield();
+    static void drawTerrain();     // Heightfield ground (terrain.h), culled and LOD'd per frame
+    static void drawBattlefield(); // Static marks on the ground: stains, craters, trenches
 
     // Structures
     static void drawChineseFortress();
@@ -206,10 +378,12 @@ private:
     static void drawCatapultStones();
     static void drawSiegeLadders();
     static void drawSiegeTowers();
-    static void drawTrebuchets();
+    static void drawTrebuchets();       // Animated throwing arms only
+    static void drawTrebuchetFrames();  // Static bases and A-frames
     static void drawBatteringRams();
     static void drawArrowVolleys();
     static void drawCampfires();
+    static void drawCampfireFlames(); // drawCampfires() without its blend and lighting
     static void drawWeaponRacks();
     
     // Chinese War Elements
@@ -238,4 +412,7 @@ private:
     static void drawArrowVolley();
     static void drawStarField();
     static void drawForestTrees();
+    static void placeCavalryCharges(float time);
+    static void placeStarField(float time);
+    static void swayForestTrees(float time);
 };
\ No newline at end of file
@@ -0,0 +1,262 @@
+// BMP decode microbenchmark.
+//
+// For every .bmp in a directory (texturess/ by default), plus a few large
+// synthetic files covering 24/32-bit, row padding and top-down storage, times
+// Bmp::open (map the file and read its pages in, which is what the texture
+// manager's worker does) against the loader it replaced: read the whole file
+// into a buffer, then copy the rows into a bottom-up image. Both run on a warm
+// file cache, so this is the cost of the copies and the system calls, not of
+// the disk.
+//
+// With a headless GL context it also times glTexImage2D from the mapping and
+// from the copy, and reads both textures back to check they match.
+//
+// Build (Windows, console):
+//   cl /O2 /EHsc bench_bmp.cpp bmp.cpp platform_win32.cpp /link /SUBSYSTEM:CONSOLE user32.lib gdi32.lib
+//
+// Build (Linux):
+//   g++ -O2 bench_bmp.cpp bmp.cpp platform_linux.cpp -lGL -lGLU -lX11 -lEGL -o bench_bmp
+//
+// Usage:
+//   bench_bmp [--dir PATH] [--runs N] [--synthetic SIZE] (SIZE 0 skips the synthetic files)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bmp.h"
+#include "platform.h"
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    uint32_t readU32(const unsigned char* p) { return uint32_t(p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24)); }
+
+    void writeU16(FILE* f, unsigned v) { fputc(v & 0xFF, f); fputc((v >> 8) & 0xFF, f); }
+    void writeU32(FILE* f, uint32_t v) { writeU16(f, v & 0xFFFF); writeU16(f, v >> 16); }
+
+    std::vector<std::string> listBitmaps(const std::string& dir) {
+        std::vector<std::string> paths;
+#ifdef _WIN32
+        WIN32_FIND_DATAA found;
+        HANDLE find = FindFirstFileA((dir + "\\*.bmp").c_str(), &found);
+        if (find != INVALID_HANDLE_VALUE) {
+            do paths.push_back(dir + "/" + found.cFileName); while (FindNextFileA(find, &found));
+            FindClose(find);
+        }
+#else
+        if (DIR* d = opendir(dir.c_str())) {
+            while (dirent* entry = readdir(d)) {
+                const size_t n = strlen(entry->d_name);
+                if (n > 4 && !strcmp(entry->d_name + n - 4, ".bmp")) paths.push_back(dir + "/" + entry->d_name);
+            }
+            closedir(d);
+        }
+#endif
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    // Gradient with a per-row twist, so a flipped or sheared upload shows up
+    bool writeSynthetic(const char* path, int width, int height, int bpp, bool topDown) {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        const uint32_t stride = ((uint32_t)width * bpp / 8 + 3) & ~3u;
+        fputc('B', f); fputc('M', f);
+        writeU32(f, 54 + stride * height); writeU32(f, 0); writeU32(f, 54);
+        writeU32(f, 40); writeU32(f, (uint32_t)width); writeU32(f, (uint32_t)(topDown ? -height : height));
+        writeU16(f, 1); writeU16(f, (unsigned)bpp); writeU32(f, 0); writeU32(f, stride * height);
+        writeU32(f, 2835); writeU32(f, 2835); writeU32(f, 0); writeU32(f, 0);
+        std::vector<unsigned char> row(stride, 0);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                unsigned char* p = &row[(size_t)x * bpp / 8];
+                p[0] = (unsigned char)(x + y * 3);
+                p[1] = (unsigned char)(y);
+                p[2] = (unsigned char)(x ^ y);
+                if (bpp == 32) p[3] = 255;
+            }
+            fwrite(row.data(), 1, row.size(), f);
+        }
+        fclose(f);
+        return true;
+    }
+
+    // The replaced loader: the file into a buffer, then the rows into the image
+    bool readAndCopy(const char* path, Platform::Image& out) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        std::vector<unsigned char> file;
+        fseek(f, 0, SEEK_END);
+        const long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        if (size > 0) {
+            file.resize((size_t)size);
+            if (fread(file.data(), 1, file.size(), f) != file.size()) file.clear();
+        }
+        fclose(f);
+        if (file.size() < 54) return false;
+
+        const unsigned char* h = file.data();
+        const int width = (int)readU32(h + 18);
+        int height = (int)readU32(h + 22);
+        const int bpp = h[28];
+        const bool topDown = height < 0;
+        if (topDown) height = -height;
+        if (bpp != 24 && bpp != 32) return false;
+        const size_t stride = ((size_t)width * bpp / 8 + 3) & ~(size_t)3;
+        out.width = width;
+        out.height = height;
+        out.bitsPerPixel = bpp;
+        out.pixels.assign(stride * height, 0);
+        for (int y = 0; y < height; ++y) {
+            memcpy(out.pixels.data() + stride * y, h + readU32(h + 10) + stride * (topDown ? height - 1 - y : y), stride);
+        }
+        return true;
+    }
+
+    void uploadImage(const Platform::Image& image) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, image.bitsPerPixel == 32 ? GL_RGBA : GL_RGB, image.width, image.height, 0,
+                     image.bitsPerPixel == 32 ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE, image.pixels.data());
+    }
+
+    std::vector<unsigned char> readBack(int width, int height) {
+        std::vector<unsigned char> pixels((size_t)width * height * 3);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_BGR, GL_UNSIGNED_BYTE, pixels.data());
+        return pixels;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string dir = "texturess";
+    int runs = 5;
+    int syntheticSize = 1024;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--dir") && i + 1 < argc) dir = argv[++i];
+        else if (!strcmp(argv[i], "--runs") && i + 1 < argc) runs = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--synthetic") && i + 1 < argc) syntheticSize = std::max(0, atoi(argv[++i]));
+        else { fprintf(stderr, "usage: bench_bmp [--dir PATH] [--runs N] [--synthetic SIZE]\n"); return 1; }
+    }
+
+    std::vector<std::string> paths = listBitmaps(dir);
+    std::vector<std::string> synthetic;
+    if (syntheticSize > 0) {
+        struct { const char* name; int widthDelta, bpp; bool topDown; } kinds[] = {
+            { "bench_bmp_24.bmp", 0, 24, false },
+            { "bench_bmp_24_padded_topdown.bmp", 1, 24, true },   // Odd width: padded rows
+            { "bench_bmp_32.bmp", 0, 32, false },
+            { "bench_bmp_32_topdown.bmp", 0, 32, true },
+        };
+        for (const auto& kind : kinds) {
+            if (writeSynthetic(kind.name, syntheticSize + kind.widthDelta, syntheticSize, kind.bpp, kind.topDown)) {
+                synthetic.push_back(kind.name);
+            }
+        }
+        paths.insert(paths.end(), synthetic.begin(), synthetic.end());
+    }
+    if (paths.empty()) {
+        fprintf(stderr, "No .bmp files in '%s'\n", dir.c_str());
+        return 1;
+    }
+
+    const bool gl = Platform::createHeadless(64, 64);
+    GLuint textures[2] = { 0, 0 };
+    if (gl) glGenTextures(2, textures);
+
+    printf("=== BMP decode (%d runs, best) ===\n", runs);
+    printf("%-34s %14s %7s %9s %9s %7s", "file", "size", "MB", "copy ms", "map ms", "speedup");
+    if (gl) printf(" %10s %10s %6s", "up copy", "up map", "match");
+    printf("\n");
+
+    double totalBytes = 0.0, totalCopy = 0.0, totalMap = 0.0, totalUpCopy = 0.0, totalUpMap = 0.0;
+    int mismatches = 0;
+    for (const std::string& path : paths) {
+        Bmp::Bitmap bitmap;
+        if (!Bmp::open(path.c_str(), bitmap)) continue;
+        Bmp::close(bitmap);
+
+        double copyMs = 1e30, mapMs = 1e30, upCopyMs = 1e30, upMapMs = 1e30;
+        Platform::Image image;
+        const bool copyable = readAndCopy(path.c_str(), image);   // 8-bit has no copy-only path
+        for (int run = 0; run < runs; ++run) {
+            if (copyable) {
+                Clock::time_point start = Clock::now();
+                readAndCopy(path.c_str(), image);
+                copyMs = std::min(copyMs, msSince(start));
+            }
+            Clock::time_point start = Clock::now();
+            Bmp::open(path.c_str(), bitmap);
+            mapMs = std::min(mapMs, msSince(start));
+            if (run + 1 < runs) Bmp::close(bitmap);
+        }
+
+        bool match = true;
+        if (gl && copyable) {
+            for (int run = 0; run < runs; ++run) {
+                glBindTexture(GL_TEXTURE_2D, textures[0]);
+                Clock::time_point start = Clock::now();
+                uploadImage(image);
+                glFinish();
+                upCopyMs = std::min(upCopyMs, msSince(start));
+
+                glBindTexture(GL_TEXTURE_2D, textures[1]);
+                start = Clock::now();
+                Bmp::upload(bitmap);
+                glFinish();
+                upMapMs = std::min(upMapMs, msSince(start));
+            }
+            glBindTexture(GL_TEXTURE_2D, textures[0]);
+            const std::vector<unsigned char> fromCopy = readBack(bitmap.width, bitmap.height);
+            glBindTexture(GL_TEXTURE_2D, textures[1]);
+            match = fromCopy == readBack(bitmap.width, bitmap.height);
+            mismatches += match ? 0 : 1;
+        }
+
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%dx%d%s", bitmap.width, bitmap.height, bitmap.bitsPerPixel, bitmap.topDown ? "t" : "");
+        const double mb = bitmap.bytes() / (1024.0 * 1024.0);
+        const char* name = strrchr(path.c_str(), '/') ? strrchr(path.c_str(), '/') + 1 : path.c_str();
+        if (copyable) {
+            printf("%-34s %14s %7.2f %9.3f %9.3f %6.1fx", name, size, mb, copyMs, mapMs, copyMs / mapMs);
+            if (gl) printf(" %10.3f %10.3f %6s", upCopyMs, upMapMs, match ? "yes" : "NO");
+            totalBytes += bitmap.bytes();
+            totalCopy += copyMs;
+            totalMap += mapMs;
+            totalUpCopy += gl ? upCopyMs : 0.0;
+            totalUpMap += gl ? upMapMs : 0.0;
+        } else {
+            printf("%-34s %14s %7.2f %9s %9.3f %7s", name, size, mb, "-", mapMs, "-");
+        }
+        printf("\n");
+        Bmp::close(bitmap);
+    }
+
+    const double totalMB = totalBytes / (1024.0 * 1024.0);
+    printf("decode: copy %.0f MB/s, map %.0f MB/s (%.1fx) over %.1f MB\n",
+           totalMB / (totalCopy / 1000.0), totalMB / (totalMap / 1000.0), totalCopy / totalMap, totalMB);
+    if (gl) {
+        printf("upload: from copy %.0f MB/s, from mapping %.0f MB/s; %d mismatched textures\n",
+               totalMB / (totalUpCopy / 1000.0), totalMB / (totalUpMap / 1000.0), mismatches);
+        glDeleteTextures(2, textures);
+    } else {
+        printf("upload: skipped (no GL context)\n");
+    }
+
+    for (const std::string& path : synthetic) remove(path.c_str());
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+// Headless frame-time benchmark.
+//
+// Creates an offscreen GL context, runs the same initialisation as WinMain and
+// then drives stepSimulation() + display() (and through it renderScene()) for a
+// fixed number of frames at a fixed dt, following a scripted set of phases:
+// idle, walk, run, turn, armour + sword attack, spear + shield, split viewport.
+// Nothing is presented; the numbers are CPU-side submission cost per frame and
+// GL draw calls / vertices per subsystem (see gl_stats.h), so two builds can be
+// compared on the same machine.
+//
+// Build (Windows, console):
+//   cl /O2 /EHsc /DMULAN_NO_ENTRY_POINT bench_headless.cpp main.cpp background.cpp
+//      texture.cpp texture_manager.cpp texture_atlas.cpp render_queue.cpp command_list.cpp bmp.cpp cooked_texture.cpp log.cpp armor.cpp shield.cpp spear.cpp gl_stats.cpp gl_ext.cpp skinning.cpp leg_skinning.cpp leg_skinning_gpu.cpp particles.cpp billboards.cpp frustum.cpp terrain.cpp collision.cpp sim_thread.cpp jobs.cpp platform_win32.cpp
+//      /link /SUBSYSTEM:CONSOLE user32.lib gdi32.lib
+//
+// Build (Linux, e.g. Mesa llvmpipe on a CI host):
+//   g++ -O2 -DMULAN_NO_ENTRY_POINT bench_headless.cpp main.cpp background.cpp texture.cpp texture_manager.cpp texture_atlas.cpp render_queue.cpp command_list.cpp bmp.cpp cooked_texture.cpp log.cpp
+//       armor.cpp shield.cpp spear.cpp gl_stats.cpp gl_ext.cpp skinning.cpp leg_skinning.cpp leg_skinning_gpu.cpp particles.cpp billboards.cpp frustum.cpp terrain.cpp collision.cpp sim_thread.cpp jobs.cpp platform_linux.cpp
+//       -lGL -lGLU -lX11 -lEGL -o bench_headless
+//   EGL_PLATFORM=surfaceless ./bench_headless > /dev/null
+//
+// Usage:
+//   bench_headless [--frames N] [--warmup N] [--dt seconds] [--width W] [--height H]
+//                  [--csv file] [--immediate-legs] [--cpu-skinning] [--split-direct] [--no-culling]
+//                  [--no-sim-thread] [--threads N] [--thread-scaling] [--checksum]
+//                  [--check-bounds]
+//
+// --split-direct renders each half of the split viewport on its own instead
+// of recording the scene once and replaying it (command_list.h).
+//
+// --no-culling draws every background pass and billboard whether or not it is
+// in view.
+//
+// --no-sim-thread runs updateCharacter() before each frame on the render
+// thread instead of on the simulation thread during the frame before. Each
+// frame waits for the step it draws, so threaded runs are as repeatable as
+// inline ones; they draw everything one frame later.
+//
+// --threads N runs the frame's jobs (jobs.h: leg skinning, billboard
+// preparation, the siege particle pools) on N threads, the waiting one
+// included; the default is one per hardware thread, up to 8.
+// --thread-scaling then plays the script again at 1, 2, 4 and 8 threads and
+// tabulates the time the render thread spent in the job stages.
+//
+// --dt is the frame time only: the simulation always steps 1/60 s at a time
+// and each frame draws between the last two steps, so --dt changes how often
+// the simulation is drawn, not how it moves.
+//
+// --checksum reads back every frame after timing it and hashes the pixels
+// (a csv column, plus the last frame in the report). The scene is seeded, so
+// two runs of the same build must print the same hashes.
+//
+// --check-bounds draws every culled background pass again in feedback mode
+// after each frame and lists the passes that reached outside the box the
+// frustum test uses for them (BackgroundRenderer::checkPassBounds()), with
+// the farthest they reached; the run then exits with status 1. It changes
+// nothing that is drawn, but costs time between frames.
+//
+// The report goes to stderr; the renderer's own logging still goes to stdout,
+// so redirect stdout to keep the console quiet.
+
+#include "platform.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gl_stats.h"
+#include "background.h"
+#include "texture_manager.h"
+#include "jobs.h"
+#include "log.h"
+#include "sim_thread.h"
+
+// --- State and entry points owned by main.cpp ---
+extern int gWidth, gHeight;
+extern bool keyUp, keydown, keyLeft, keyRight, keyShift;
+extern bool gSwordVisible, gSpearVisible, gShieldVisible, gArmorVisible;
+extern bool gViewportMode;
+extern bool gLegBuffersEnabled;
+extern bool gLegShaderEnabled;
+extern bool gSplitSceneRecorded;
+extern bool gSimThreadEnabled;
+extern double gSimStepMs;
+extern int gSimSteps;
+extern double gLegSkinMs;
+void initializeCharacterParts();
+void stepSimulation(float dt);
+void stopSimulationThread();
+struct CharacterState;
+void runOnSimulation(void (*command)(CharacterState& character));
+void display();
+void startSwordAttack(CharacterState& character);
+void startSpearAttack(CharacterState& character);
+void startShieldBlock(CharacterState& character);
+
+// ===================================================================
+// Scripted input
+// ===================================================================
+
+static void clearInput() {
+    keyUp = keydown = keyLeft = keyRight = keyShift = false;
+}
+
+static void phaseIdle()   { clearInput(); }
+static void phaseWalk()   { clearInput(); keyUp = true; }
+static void phaseRun()    { clearInput(); keyUp = true; keyShift = true; }
+static void phaseTurn()   { clearInput(); keyUp = true; keyLeft = true; }
+static void phaseSword()  {
+    clearInput();
+    gArmorVisible = true;
+    gSwordVisible = true; gSpearVisible = false; gShieldVisible = false;
+    runOnSimulation(startSwordAttack);
+}
+static void phaseSpearShield() {
+    clearInput();
+    gSwordVisible = false; gSpearVisible = true; gShieldVisible = true;
+    runOnSimulation(startSpearAttack);
+}
+static void phaseSplitView() { clearInput(); keyUp = true; gViewportMode = true; }
+
+struct BenchPhase {
+    const char* name;
+    void (*enter)();
+};
+
+static const BenchPhase kPhases[] = {
+    { "idle",         phaseIdle },
+    { "walk",         phaseWalk },
+    { "run",          phaseRun },
+    { "turn",         phaseTurn },
+    { "sword",        phaseSword },
+    { "spear+shield", phaseSpearShield },
+    { "split view",   phaseSplitView },
+};
+static const int kPhaseCount = sizeof(kPhases) / sizeof(kPhases[0]);
+
+// Restarts the attack for phases that use one so the whole phase is animated
+static void tickPhase(int phase, int frameInPhase) {
+    if (frameInPhase > 0 && frameInPhase % 60 == 0) {
+        if (kPhases[phase].enter == phaseSword) runOnSimulation(startSwordAttack);
+        else if (kPhases[phase].enter == phaseSpearShield) { runOnSimulation(startSpearAttack); runOnSimulation(startShieldBlock); }
+    }
+}
+
+// ===================================================================
+// Report
+// ===================================================================
+
+// FNV-1a over the colour buffer
+static unsigned long long frameChecksum(std::vector<unsigned char>& pixels) {
+    pixels.resize((size_t)gWidth * gHeight * 4);
+    glReadPixels(0, 0, gWidth, gHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    unsigned long long hash = 14695981039346656037ull;
+    for (unsigned char c : pixels) hash = (hash ^ c) * 1099511628211ull;
+    return hash;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static void printTimes(const char* label, std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    double sum = 0.0;
+    for (double v : ms) sum += v;
+    fprintf(stderr, "%-22s mean %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f\n",
+        label, ms.empty() ? 0.0 : sum / ms.size(),
+        percentile(ms, 0.50), percentile(ms, 0.90), percentile(ms, 0.99), ms.empty() ? 0.0 : ms.back());
+}
+
+// ===================================================================
+// Frames
+// ===================================================================
+
+// One pass of the script
+struct Run {
+    std::vector<double> cpuMs, finishMs, simMs, jobMs;
+    long long simSteps = 0;
+    GLStats::Counters totals[GLStats::SUB_COUNT];
+    unsigned long long lastChecksum;
+    Jobs::Stats jobs;
+    std::map<std::string, float> boundsOutside;  // --check-bounds: farthest each pass reached outside
+};
+
+static void runFrames(int frames, float dt, bool checksum, bool checkBounds, FILE* csv, Run& run) {
+    run.cpuMs.reserve(frames); run.finishMs.reserve(frames); run.simMs.reserve(frames); run.jobMs.reserve(frames);
+    for (GLStats::Counters& c : run.totals) c = GLStats::Counters();
+    run.lastChecksum = 0;
+    std::vector<unsigned char> pixels;
+    Jobs::resetStats();
+
+    const int framesPerPhase = frames / kPhaseCount;
+    int phase = -1;
+    for (int f = 0; f < frames; ++f) {
+        SimThread::wait();          // The last step is done before the script touches its state
+        int wanted = std::min(f / framesPerPhase, kPhaseCount - 1);
+        if (wanted != phase) { phase = wanted; kPhases[phase].enter(); }
+        tickPhase(phase, f - phase * framesPerPhase);
+
+        GLStats::reset();
+        gLegSkinMs = 0.0;
+        auto t0 = std::chrono::steady_clock::now();
+        stepSimulation(dt);
+        display();
+        auto t1 = std::chrono::steady_clock::now();
+        glFinish();
+        auto t2 = std::chrono::steady_clock::now();
+
+        double cpu = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        double fin = std::chrono::duration<double, std::milli>(t2 - t0).count();
+        Log::flush();               // Like the viewer, after the frame
+        run.cpuMs.push_back(cpu);
+        run.finishMs.push_back(fin);
+        run.simMs.push_back(gSimStepMs);
+        run.simSteps += gSimSteps;
+        run.jobMs.push_back(BackgroundRenderer::getFrameStats().prepareMs + gLegSkinMs);
+        for (int s = 0; s < GLStats::SUB_COUNT; ++s) {
+            run.totals[s].drawCalls += GLStats::counters[s].drawCalls;
+            run.totals[s].vertices += GLStats::counters[s].vertices;
+        }
+        if (checksum) run.lastChecksum = frameChecksum(pixels);
+        if (checkBounds) {
+            for (const BackgroundRenderer::BoundsViolation& v : BackgroundRenderer::checkPassBounds()) {
+                float& outside = run.boundsOutside[v.pass];
+                outside = std::max(outside, v.outside);
+            }
+        }
+        if (csv) {
+            fprintf(csv, "%d,%s,%.4f,%.4f,%u,%u", f, kPhases[phase].name, cpu, fin,
+                GLStats::totalDrawCalls(), GLStats::totalVertices());
+            if (checksum) fprintf(csv, ",%016llx", run.lastChecksum);
+            fprintf(csv, "\n");
+        }
+    }
+    run.jobs = Jobs::stats();
+}
+
+static double mean(const std::vector<double>& ms) {
+    double sum = 0.0;
+    for (double v : ms) sum += v;
+    return ms.empty() ? 0.0 : sum / ms.size();
+}
+
+int main(int argc, char** argv) {
+    int frames = 700;
+    int warmup = 30;
+    float dt = 1.0f / 60.0f;
+    const char* csvPath = NULL;
+    bool checksum = false;
+    bool checkBounds = false;
+    bool threadScaling = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--frames") && hasValue) frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && hasValue) warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--dt") && hasValue) dt = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--width") && hasValue) gWidth = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--height") && hasValue) gHeight = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv") && hasValue) csvPath = argv[++i];
+        else if (!strcmp(argv[i], "--immediate-legs")) gLegBuffersEnabled = false;
+        else if (!strcmp(argv[i], "--cpu-skinning")) gLegShaderEnabled = false;
+        else if (!strcmp(argv[i], "--split-direct")) gSplitSceneRecorded = false;
+        else if (!strcmp(argv[i], "--no-culling")) BackgroundRenderer::setCullingEnabled(false);
+        else if (!strcmp(argv[i], "--no-sim-thread")) gSimThreadEnabled = false;
+        else if (!strcmp(argv[i], "--threads") && hasValue) Jobs::setThreadCount(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--thread-scaling")) threadScaling = true;
+        else if (!strcmp(argv[i], "--checksum")) checksum = true;
+        else if (!strcmp(argv[i], "--check-bounds")) checkBounds = true;
+        else {
+            fprintf(stderr, "usage: %s [--frames N] [--warmup N] [--dt s] [--width W] [--height H] [--csv file] [--immediate-legs] [--cpu-skinning] [--split-direct] [--no-culling] [--no-sim-thread] [--threads N] [--thread-scaling] [--checksum] [--check-bounds]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames < kPhaseCount) frames = kPhaseCount;
+
+    if (!Platform::createHeadless(gWidth, gHeight)) {
+        fprintf(stderr, "bench_headless: could not create an offscreen GL context\n");
+        return 1;
+    }
+
+    glEnable(GL_DEPTH_TEST); glEnable(GL_NORMALIZE);
+    initializeCharacterParts();
+
+    // Warm-up: first-use texture requests and driver state compilation stay out
+    // of the numbers; then every texture is made resident, so the measured
+    // frames (and their checksums) don't depend on the decode thread's timing
+    for (int i = 0; i < warmup; ++i) { SimThread::wait(); stepSimulation(dt); display(); Log::flush(); }
+    TextureManager::finish();
+    glFinish();
+
+    FILE* csv = csvPath ? fopen(csvPath, "w") : NULL;
+    if (csv) fprintf(csv, "frame,phase,cpu_ms,finish_ms,draw_calls,vertices%s\n", checksum ? ",checksum" : "");
+    Run run;
+    runFrames(frames, dt, checksum, checkBounds, csv, run);
+    if (csv) fclose(csv);
+
+    fprintf(stderr, "\n=== HEADLESS BENCHMARK ===\n");
+    fprintf(stderr, "%d frames (+%d warm-up), dt %.4f s, %dx%d, %d phases of %d frames\n",
+        frames, warmup, dt, gWidth, gHeight, kPhaseCount, frames / kPhaseCount);
+    fprintf(stderr, "GL: %s / %s\n\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+    printTimes("submit (ms)", run.cpuMs);
+    printTimes("submit+glFinish (ms)", run.finishMs);
+    printTimes(gSimThreadEnabled ? "simulation, overlapped" : "simulation, in submit", run.simMs);
+    fprintf(stderr, "simulation steps       %.2f/frame\n", (double)run.simSteps / frames);
+    printTimes("job stages (ms)", run.jobMs);
+    fprintf(stderr, "jobs                   %d threads, %.1f jobs/frame, %.1f stolen/frame\n",
+        Jobs::threadCount(), (double)run.jobs.jobs / frames, (double)run.jobs.steals / frames);
+    if (checksum) fprintf(stderr, "last frame checksum    %016llx\n", run.lastChecksum);
+    if (checkBounds) {
+        fprintf(stderr, "pass bounds            %s\n", run.boundsOutside.empty() ? "every pass inside its box" : "passes outside their box:");
+        for (const auto& pass : run.boundsOutside) fprintf(stderr, "  %-20s %.2f units out\n", pass.first.c_str(), pass.second);
+    }
+
+    fprintf(stderr, "\n%-12s %14s %16s\n", "subsystem", "draws/frame", "vertices/frame");
+    unsigned long long allDraws = 0, allVerts = 0;
+    for (int s = 0; s < GLStats::SUB_COUNT; ++s) {
+        allDraws += run.totals[s].drawCalls;
+        allVerts += run.totals[s].vertices;
+        fprintf(stderr, "%-12s %14.1f %16.1f\n", GLStats::subsystemName(s),
+            (double)run.totals[s].drawCalls / frames, (double)run.totals[s].vertices / frames);
+    }
+    fprintf(stderr, "%-12s %14.1f %16.1f\n", "total", (double)allDraws / frames, (double)allVerts / frames);
+    fprintf(stderr, "\n");
+
+    if (threadScaling) {
+        // The script again at each thread count; later passes start where the
+        // last left the scene, so the frames match in load, not in pixels
+        fprintf(stderr, "%-8s %12s %12s %10s %11s %13s\n", "threads", "submit (ms)", "jobs (ms)", "speed-up", "jobs/frame", "stolen/frame");
+        double oneThread = 0.0;
+        for (int threads = 1; threads <= Jobs::kMaxThreads; threads *= 2) {
+            SimThread::wait();      // No job in flight while the pool changes
+            Jobs::setThreadCount(threads);
+            Run pass;
+            runFrames(frames, dt, false, false, NULL, pass);
+            const double jobMs = mean(pass.jobMs);
+            if (threads == 1) oneThread = jobMs;
+            fprintf(stderr, "%-8d %12.3f %12.3f %9.2fx %11.1f %13.1f\n", threads, mean(pass.cpuMs), jobMs,
+                jobMs > 0.0 ? oneThread / jobMs : 0.0, (double)pass.jobs.jobs / frames, (double)pass.jobs.steals / frames);
+        }
+        fprintf(stderr, "\n");
+    }
+    TextureManager::printReport(stderr);
+    fprintf(stderr, "==========================\n");
+
+    stopSimulationThread();
+    BackgroundRenderer::cleanup();
+    TextureManager::shutdown();
+    Platform::destroyWindow();
+    return run.boundsOutside.empty() ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+// Leg skinning microbenchmark.
+//
+// Builds the leg mesh at 1x, 10x and 100x the shipped ring count and times the
+// scalar reference (animateLegVertices, once per leg) against the skinning
+// engine in skinning.cpp with linear blend and with dual quaternions, then
+// checks that the linear blend agrees with the reference. The 100x mesh is
+// above Skinning::parallelThreshold, so it also covers the job threads.
+// No GL context is needed for that part; main.cpp is only linked for its mesh
+// builders.
+//
+// With --gpu it also opens a headless context and, at the same densities,
+// draws both legs through the CPU path (skin + stream upload) and through the
+// skinning shader, timing the CPU side of each frame and comparing the two
+// framebuffers pixel by pixel, so the shader is checked against the reference.
+//
+// Build (Windows, console):
+//   cl /O2 /EHsc /DMULAN_NO_ENTRY_POINT bench_leg_skinning.cpp main.cpp background.cpp
+//      texture.cpp texture_manager.cpp texture_atlas.cpp render_queue.cpp command_list.cpp bmp.cpp cooked_texture.cpp log.cpp armor.cpp shield.cpp spear.cpp gl_stats.cpp gl_ext.cpp skinning.cpp leg_skinning.cpp leg_skinning_gpu.cpp particles.cpp billboards.cpp frustum.cpp terrain.cpp collision.cpp sim_thread.cpp jobs.cpp platform_win32.cpp
+//      /link /SUBSYSTEM:CONSOLE user32.lib gdi32.lib
+//
+// Build (Linux):
+//   g++ -O2 -DMULAN_NO_ENTRY_POINT bench_leg_skinning.cpp main.cpp background.cpp texture.cpp texture_manager.cpp texture_atlas.cpp render_queue.cpp command_list.cpp bmp.cpp cooked_texture.cpp log.cpp
+//       armor.cpp shield.cpp spear.cpp gl_stats.cpp gl_ext.cpp skinning.cpp leg_skinning.cpp leg_skinning_gpu.cpp particles.cpp billboards.cpp frustum.cpp terrain.cpp collision.cpp sim_thread.cpp jobs.cpp platform_linux.cpp
+//       -lGL -lGLU -lX11 -lEGL -o bench_leg_skinning
+//
+// Usage:
+//   EGL_PLATFORM=surfaceless ./bench_leg_skinning --gpu > /dev/null   (Linux, no display)
+//
+// Usage:
+//   bench_leg_skinning [--iterations N] [--gpu]
+
+#include "platform.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "gl_stats.h"
+#include "utils.h"
+#include "leg_skinning.h"
+
+// --- State and entry points owned by main.cpp ---
+extern std::vector<Vec3f> gAllVertices;
+extern std::vector<Vec3f> gVertexNormals;
+extern std::vector<Vec3f> gAnimatedVertices[2];
+extern std::vector<Vec3f> gAnimatedNormals[2];
+extern LegSkinning::Joints gLegJoints;
+extern LegSkinning::RestPose gLegRestPose;
+extern Skinning::Method gLegSkinningMethod;
+void buildLegMesh(int legSegments);
+void buildTriangles();
+void computeVertexNormals();
+void computeLegFootUVs();
+void partitionLegMesh();
+// GPU comparison
+extern bool gLegShaderEnabled;
+namespace GLExt { void init(); }
+void buildLegBuffers();
+void releaseLegBuffers();
+void animateLegs(float hipAngleL, float kneeAngleL, float hipAngleR, float kneeAngleR);
+void drawLeg(int leg);
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // A walk-like pose sequence, so the trig and caches see changing angles
+    void poseAt(int i, float& hipL, float& kneeL, float& hipR, float& kneeR) {
+        float phase = i * 0.05f;
+        hipL = 30.0f * sinf(phase);  kneeL = 20.0f + 20.0f * sinf(phase + 1.0f);
+        hipR = -hipL;                kneeR = 20.0f - 20.0f * sinf(phase + 1.0f);
+    }
+
+    // Scalar reference for one leg (mirror = right leg), as the viewer skinned
+    // before the skinning engine: the thigh-only and the knee-then-thigh
+    // results blended by the vertex's knee weight, i.e. linear blend skinning
+    // written out longhand.
+    void animateLegVertices(float hipAngle, float kneeAngle, bool mirror,
+                            std::vector<Vec3f>& outVertices, std::vector<Vec3f>& outNormals) {
+        outVertices.resize(gAllVertices.size());
+        outNormals.resize(gAllVertices.size());
+
+        const float degrees = 3.1415926535f / 180.0f;
+        float cosHip = cosf(hipAngle * degrees), sinHip = sinf(hipAngle * degrees);
+        float cosKnee = cosf(kneeAngle * degrees), sinKnee = sinf(kneeAngle * degrees);
+
+        const float kneeY = gLegJoints.kneeY, kneeZ = gLegJoints.kneeZ;
+        const float hipY = gLegJoints.hipY, hipZ = gLegJoints.hipZ;
+        for (size_t i = 0; i < gAllVertices.size(); ++i) {
+            const Vec3f& rest = gAllVertices[i];
+            const Vec3f& restNormal = gVertexNormals[i];
+            const float w = LegSkinning::kneeWeight(rest.y, gLegJoints);
+
+            // 1. Knee bend, blended in by the knee weight
+            float translatedY = rest.y - kneeY;
+            float translatedZ = rest.z - kneeZ;
+            float kneeYPos = translatedY * cosKnee - translatedZ * sinKnee + kneeY;
+            float kneeZPos = translatedY * sinKnee + translatedZ * cosKnee + kneeZ;
+            float kneeNY = restNormal.y * cosKnee - restNormal.z * sinKnee;
+            float kneeNZ = restNormal.y * sinKnee + restNormal.z * cosKnee;
+
+            // 2. Hip bend (affects all vertices), applied to both candidates
+            Vec3f v = rest, n = restNormal;
+            float thighY = rest.y - hipY, thighZ = rest.z - hipZ;
+            float shinY = kneeYPos - hipY, shinZ = kneeZPos - hipZ;
+            v.y = (1.0f - w) * (thighY * cosHip - thighZ * sinHip) + w * (shinY * cosHip - shinZ * sinHip) + hipY;
+            v.z = (1.0f - w) * (thighY * sinHip + thighZ * cosHip) + w * (shinY * sinHip + shinZ * cosHip) + hipZ;
+            n.y = (1.0f - w) * (restNormal.y * cosHip - restNormal.z * sinHip) + w * (kneeNY * cosHip - kneeNZ * sinHip);
+            n.z = (1.0f - w) * (restNormal.y * sinHip + restNormal.z * cosHip) + w * (kneeNY * sinHip + kneeNZ * cosHip);
+
+            // 3. Mirror if necessary
+            if (mirror) {
+                v.x *= -1.0f;
+                n.x *= -1.0f;
+            }
+
+            outVertices[i] = v;
+            outNormals[i] = n;
+        }
+    }
+
+    const int kViewSize = 256;
+
+    void buildMesh(int legSegments) {
+        buildLegMesh(legSegments);
+        buildTriangles();
+        computeVertexNormals();
+        computeLegFootUVs();
+        partitionLegMesh();
+    }
+
+    // Both legs side by side under the renderer's light; returns the CPU time
+    // of the frame (skinning, uploads and submission, not the GPU work)
+    double drawFrame(int frame) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+        gluLookAt(0.0, 5.0, 28.0, 0.0, 5.0, 0.0, 0.0, 1.0, 0.0);
+        const float lightPos[] = { 20.f,20.f,30.f,1.f };
+        glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+
+        float hipL, kneeL, hipR, kneeR;
+        poseAt(frame, hipL, kneeL, hipR, kneeR);
+        Clock::time_point start = Clock::now();
+        animateLegs(hipL, kneeL, hipR, kneeR);
+        glPushMatrix(); glTranslatef(-2.0f, 0.0f, 0.0f); drawLeg(0); glPopMatrix();
+        glPushMatrix(); glTranslatef(2.0f, 0.0f, 0.0f); drawLeg(1); glPopMatrix();
+        double seconds = secondsSince(start);
+        glFinish();
+        return seconds;
+    }
+
+    void readFrame(std::vector<unsigned char>& pixels) {
+        pixels.resize(kViewSize * kViewSize * 4);
+        glReadPixels(0, 0, kViewSize, kViewSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    }
+
+    int runGpuComparison(int iterations, int baseSegments) {
+        if (!Platform::createHeadless(kViewSize, kViewSize)) {
+            fprintf(stderr, "FAIL: could not create an offscreen GL context\n");
+            return 1;
+        }
+        GLExt::init();
+        glViewport(0, 0, kViewSize, kViewSize);
+        glMatrixMode(GL_PROJECTION);
+        gluPerspective(45.0, 1.0, 1.0, 100.0);
+        glEnable(GL_DEPTH_TEST); glEnable(GL_NORMALIZE);
+        glEnable(GL_LIGHTING); glEnable(GL_LIGHT0); glEnable(GL_COLOR_MATERIAL);
+        const float ambientLight[] = { 0.4f,0.4f,0.4f,1.f }, diffuseLight[] = { 0.7f,0.7f,0.7f,1.f };
+        glLightfv(GL_LIGHT0, GL_AMBIENT, ambientLight);
+        glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuseLight);
+
+        fprintf(stderr, "\nGL: %s / %s\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+        fprintf(stderr, "%6s %9s %14s %14s %10s %12s %10s\n", "scale", "vertices", "cpu path ms", "shader ms", "leg px", "pixels off", "max diff");
+        int result = 0;
+        for (int scale = 1; scale <= 100; scale *= 10) {
+            buildMesh(baseSegments * scale);
+            buildLegBuffers();
+            const int frames = std::max(10, iterations / (10 * scale));
+
+            double modeSeconds[2] = { 0.0, 0.0 };
+            std::vector<unsigned char> image[2];
+            gLegSkinningMethod = Skinning::LINEAR_BLEND; // What the shader implements
+        for (int mode = 0; mode < 2; ++mode) { // 0: CPU reference, 1: shader
+                gLegShaderEnabled = mode == 1;
+                for (int f = 0; f < frames; ++f) modeSeconds[mode] += drawFrame(f);
+                readFrame(image[mode]);
+            }
+
+            // Rounding differs between the two pipelines, so count only
+            // pixels off by more than a couple of levels
+            int covered = 0, off = 0, maxDiff = 0;
+            for (size_t i = 0; i < image[0].size(); i += 4) {
+                if (image[0][i] | image[0][i + 1] | image[0][i + 2]) ++covered;
+                int d = 0;
+                for (int c = 0; c < 3; ++c) d = std::max(d, abs((int)image[0][i + c] - (int)image[1][i + c]));
+                maxDiff = std::max(maxDiff, d);
+                if (d > 2) ++off;
+            }
+            fprintf(stderr, "%5dx %9zu %14.3f %14.3f %10d %12d %10d\n", scale, gAllVertices.size(),
+                modeSeconds[0] * 1e3 / frames, modeSeconds[1] * 1e3 / frames, covered, off, maxDiff);
+            if (covered == 0 || off > covered / 100) {
+                fprintf(stderr, "FAIL: shader skinning disagrees with the CPU path\n");
+                result = 1;
+            }
+            releaseLegBuffers();
+        }
+        Platform::destroyWindow();
+        return result;
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = 2000;
+    bool gpu = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc) iterations = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--gpu")) gpu = true;
+        else { fprintf(stderr, "usage: bench_leg_skinning [--iterations N] [--gpu]\n"); return 1; }
+    }
+
+    fprintf(stderr, "kernel: %s; %d workers above %zu vertices\n",
+        Skinning::kernelName(), Skinning::workerCount(), Skinning::parallelThreshold);
+    fprintf(stderr, "%6s %9s %12s %12s %12s %8s %10s %10s\n", "scale", "vertices", "scalar ns/v", "linear ns/v",
+        "dual q ns/v", "speedup", "max diff", "dq vs lin");
+
+    const int baseSegments = 40;
+    for (int scale = 1; scale <= 100; scale *= 10) {
+        buildMesh(baseSegments * scale);
+        const size_t n = gAllVertices.size();
+        const int runs = std::max(1, iterations / scale);
+
+        // Scalar reference, one leg per call
+        std::vector<Vec3f> reference[2], referenceNormals[2];
+        float hipL, kneeL, hipR, kneeR;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < runs; ++i) {
+            poseAt(i, hipL, kneeL, hipR, kneeR);
+            animateLegVertices(hipL, kneeL, false, reference[0], referenceNormals[0]);
+            animateLegVertices(hipR, kneeR, true, reference[1], referenceNormals[1]);
+        }
+        double scalarSeconds = secondsSince(start);
+
+        // Engine, both legs per call, once per method
+        for (int leg = 0; leg < 2; ++leg) {
+            gAnimatedVertices[leg].resize(n);
+            gAnimatedNormals[leg].resize(n);
+        }
+        Vec3f* const positions[2] = { gAnimatedVertices[0].data(), gAnimatedVertices[1].data() };
+        Vec3f* const normals[2] = { gAnimatedNormals[0].data(), gAnimatedNormals[1].data() };
+        const Skinning::Method methods[2] = { Skinning::LINEAR_BLEND, Skinning::DUAL_QUATERNION };
+        double methodSeconds[2];
+        float maxDiff[2] = { 0.0f, 0.0f };
+        for (int method = 0; method < 2; ++method) {
+            start = Clock::now();
+            for (int i = 0; i < runs; ++i) {
+                poseAt(i, hipL, kneeL, hipR, kneeR);
+                const LegSkinning::Pose poses[2] = { { hipL, kneeL, false }, { hipR, kneeR, true } };
+                LegSkinning::skin(gLegRestPose, poses, methods[method], positions, normals);
+            }
+            methodSeconds[method] = secondsSince(start);
+
+            // Both methods end on the same pose as the reference
+            for (int leg = 0; leg < 2; ++leg) {
+                for (size_t v = 0; v < n; ++v) {
+                    const Vec3f& a = reference[leg][v]; const Vec3f& b = gAnimatedVertices[leg][v];
+                    const Vec3f& na = referenceNormals[leg][v]; const Vec3f& nb = gAnimatedNormals[leg][v];
+                    float d = std::max(fabsf(a.x - b.x), std::max(fabsf(a.y - b.y), fabsf(a.z - b.z)));
+                    d = std::max(d, std::max(fabsf(na.x - nb.x), std::max(fabsf(na.y - nb.y), fabsf(na.z - nb.z))));
+                    maxDiff[method] = std::max(maxDiff[method], d);
+                }
+            }
+        }
+
+        const double skinned = double(runs) * 2.0 * double(n); // vertices per leg x 2 legs
+        fprintf(stderr, "%5dx %9zu %12.3f %12.3f %12.3f %7.2fx %10.2e %10.2e\n", scale, n,
+                scalarSeconds * 1e9 / skinned, methodSeconds[0] * 1e9 / skinned, methodSeconds[1] * 1e9 / skinned,
+                scalarSeconds / methodSeconds[0], maxDiff[0], maxDiff[1]);
+        if (maxDiff[0] > 1e-4f) {
+            fprintf(stderr, "FAIL: linear blend disagrees with the scalar reference\n");
+            return 1;
+        }
+    }
+    return gpu ? runGpuComparison(iterations, baseSegments) : 0;
+}
@@ -0,0 +1,121 @@
+// Particle stress benchmark.
+//
+// Keeps a steady population of particles alive (spawning to replace the ones
+// that expire) and times the per-frame update + spawn cost of the old scheme,
+// a std::vector of structs with erase() on death and push_back() on spawn, against
+// ParticlePool (particles.h). Both run the same deterministic spawn stream, so
+// the final live counts must agree.
+//
+// Build (Windows, console):
+//   cl /O2 /EHsc bench_particles.cpp particles.cpp
+//
+// Build (Linux):
+//   g++ -O2 bench_particles.cpp particles.cpp -o bench_particles
+//
+// Usage:
+//   bench_particles [--frames N] [--dt seconds]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "particles.h"
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    // Small LCG so both runs see the same particles on every platform
+    struct Random {
+        unsigned state;
+        explicit Random(unsigned seed) : state(seed) {}
+        float next(float lo, float hi) {
+            state = state * 1664525u + 1013904223u;
+            return lo + (hi - lo) * ((state >> 8) * (1.0f / 16777216.0f));
+        }
+    };
+
+    // The layout and loop background.cpp used before the pool
+    struct LegacyParticle {
+        struct { float x, y, z; } position, velocity;
+        float lifetime;
+    };
+
+    struct LegacyEffect {
+        std::vector<LegacyParticle> particles;
+        size_t size() const { return particles.size(); }
+        void spawn(float x, float y, float z, float vx, float vy, float vz, float lifetime) {
+            particles.push_back({ { x, y, z }, { vx, vy, vz }, lifetime });
+        }
+        void update(float dt, float accelY, float floorY) {
+            for (auto it = particles.begin(); it != particles.end();) {
+                it->position.x += it->velocity.x * dt;
+                it->position.y += it->velocity.y * dt;
+                it->position.z += it->velocity.z * dt;
+                it->velocity.y += accelY * dt;
+                it->lifetime -= dt;
+                if (it->lifetime <= 0.0f || it->position.y < floorY) it = particles.erase(it);
+                else ++it;
+            }
+        }
+    };
+
+    struct Stats { double mean, p99, max; size_t finalCount; };
+
+    // Lifetimes average 1.5 s, so spawning population * dt / 1.5 per frame
+    // holds the population roughly steady; arrows also die at the ground.
+    template <class Effect>
+    Stats run(Effect& effect, size_t population, int frames, float dt) {
+        Random random(1234u);
+        std::vector<double> ms;
+        ms.reserve(frames);
+        double carry = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            Clock::time_point start = Clock::now();
+            effect.update(dt, -9.8f, 0.0f);
+            carry += population * dt / 1.5;
+            for (; carry >= 1.0; carry -= 1.0) {
+                effect.spawn(random.next(-80.0f, 80.0f), random.next(25.0f, 40.0f), random.next(-60.0f, -40.0f),
+                    random.next(15.0f, 25.0f), random.next(-5.0f, 0.0f), random.next(10.0f, 15.0f),
+                    random.next(0.5f, 2.5f));
+            }
+            ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        // First second is the ramp-up
+        std::vector<double> steady(ms.begin() + std::min<size_t>(ms.size() / 2, (size_t)(1.0f / dt)), ms.end());
+        std::sort(steady.begin(), steady.end());
+        double sum = 0.0;
+        for (double v : steady) sum += v;
+        return { sum / steady.size(), steady[(size_t)(0.99 * (steady.size() - 1))], steady.back(), effect.size() };
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = 600;
+    float dt = 1.0f / 60.0f;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = std::max(120, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--dt") && i + 1 < argc) dt = (float)atof(argv[++i]);
+        else { fprintf(stderr, "usage: bench_particles [--frames N] [--dt seconds]\n"); return 1; }
+    }
+
+    printf("%d frames at dt %.4f s; update + spawn per frame, steady state\n\n", frames, dt);
+    printf("%10s %8s | %26s | %26s | %7s\n", "population", "live", "vector + erase (ms)", "ParticlePool (ms)", "speedup");
+    printf("%10s %8s | %8s %8s %8s | %8s %8s %8s |\n", "", "", "mean", "p99", "max", "mean", "p99", "max");
+    const size_t populations[] = { 100, 1000, 10000, 50000 };
+    for (size_t population : populations) {
+        LegacyEffect legacy;
+        Stats a = run(legacy, population, frames, dt);
+        ParticlePool pool(population * 2); // Headroom so spawns never fail
+        Stats b = run(pool, population, frames, dt);
+        printf("%10zu %8zu | %8.3f %8.3f %8.3f | %8.3f %8.3f %8.3f | %6.1fx\n", population, b.finalCount,
+            a.mean, a.p99, a.max, b.mean, b.p99, b.max, a.mean / b.mean);
+        if (a.finalCount != b.finalCount) {
+            printf("FAIL: live counts differ (%zu vs %zu)\n", a.finalCount, b.finalCount);
+            return 1;
+        }
+    }
+    return 0;
+}
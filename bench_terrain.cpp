@@ -0,0 +1,97 @@
+// Terrain query microbenchmark.
+//
+// Times Terrain::heightAt / normalAt (one lookup in the cached grid) against
+// evaluating the analytic battlefield formula, and its finite-difference
+// normal, at the same random points, and reports how far the grid is from
+// the formula. No GL context is needed; the GL libraries are only linked
+// because terrain.cpp also holds the chunk drawing.
+//
+// Build (Windows, console):
+//   cl /O2 /EHsc bench_terrain.cpp terrain.cpp frustum.cpp gl_stats.cpp opengl32.lib glu32.lib
+//
+// Build (Linux):
+//   g++ -O2 bench_terrain.cpp terrain.cpp frustum.cpp gl_stats.cpp -lGL -lGLU -o bench_terrain
+//
+// Usage:
+//   bench_terrain [--queries N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "terrain.h"
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    void analyticNormal(float x, float z, float n[3]) {
+        const float e = 0.01f;
+        const float dx = (Terrain::analyticHeight(x + e, z) - Terrain::analyticHeight(x - e, z)) / (2.0f * e);
+        const float dz = (Terrain::analyticHeight(x, z + e) - Terrain::analyticHeight(x, z - e)) / (2.0f * e);
+        const float len = sqrtf(dx * dx + 1.0f + dz * dz);
+        n[0] = -dx / len; n[1] = 1.0f / len; n[2] = -dz / len;
+    }
+
+    // Best of a few runs, in ns per query; sink keeps the work alive
+    template <class Fn>
+    double time(const std::vector<float>& xs, const std::vector<float>& zs, Fn fn, float& sink) {
+        double best = 1e30;
+        for (int run = 0; run < 5; ++run) {
+            Clock::time_point start = Clock::now();
+            float sum = 0.0f;
+            for (size_t i = 0; i < xs.size(); ++i) sum += fn(xs[i], zs[i]);
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            best = std::min(best, ns / xs.size());
+            sink += sum;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t queries = 1000000;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--queries") && i + 1 < argc) queries = std::max(1000, atoi(argv[++i]));
+        else { fprintf(stderr, "usage: bench_terrain [--queries N]\n"); return 1; }
+    }
+
+    // Points the character can actually reach, in a fixed order
+    std::vector<float> xs(queries), zs(queries);
+    unsigned state = 1234u;
+    for (size_t i = 0; i < queries; ++i) {
+        state = state * 1664525u + 1013904223u; xs[i] = -Terrain::kExtent + (state >> 8) * (2.0f * Terrain::kExtent / 16777216.0f);
+        state = state * 1664525u + 1013904223u; zs[i] = -Terrain::kExtent + (state >> 8) * (2.0f * Terrain::kExtent / 16777216.0f);
+    }
+    Terrain::generate();
+
+    float sink = 0.0f;
+    const double analyticH = time(xs, zs, [](float x, float z) { return Terrain::analyticHeight(x, z); }, sink);
+    const double gridH = time(xs, zs, [](float x, float z) { return Terrain::heightAt(x, z); }, sink);
+    const double analyticN = time(xs, zs, [](float x, float z) { float n[3]; analyticNormal(x, z, n); return n[1]; }, sink);
+    const double gridN = time(xs, zs, [](float x, float z) { float n[3]; Terrain::normalAt(x, z, n); return n[1]; }, sink);
+
+    double maxHeightError = 0.0, meanHeightError = 0.0, maxAngle = 0.0;
+    for (size_t i = 0; i < queries; ++i) {
+        const double e = fabs(Terrain::heightAt(xs[i], zs[i]) - Terrain::analyticHeight(xs[i], zs[i]));
+        maxHeightError = std::max(maxHeightError, e);
+        meanHeightError += e;
+        float a[3], b[3];
+        analyticNormal(xs[i], zs[i], a);
+        Terrain::normalAt(xs[i], zs[i], b);
+        const double dot = std::min(1.0f, a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+        maxAngle = std::max(maxAngle, acos(dot) * 180.0 / 3.14159265358979);
+    }
+    meanHeightError /= queries;
+
+    printf("%zu queries over [-%.0f, %.0f]^2 (checksum %.1f)\n\n", queries, Terrain::kExtent, Terrain::kExtent, sink);
+    printf("%-8s %14s %14s %8s\n", "query", "formula ns", "grid ns", "speedup");
+    printf("%-8s %14.2f %14.2f %7.1fx\n", "height", analyticH, gridH, analyticH / gridH);
+    printf("%-8s %14.2f %14.2f %7.1fx\n", "normal", analyticN, gridN, analyticN / gridN);
+    printf("\ngrid vs formula: height error max %.3f mean %.3f, normal error max %.1f deg\n",
+        maxHeightError, meanHeightError, maxAngle);
+    return 0;
+}
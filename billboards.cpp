@@ -0,0 +1,111 @@
+#include "billboards.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "gl_stats.h"
+#include "jobs.h"
+
+BillboardBatch::BillboardBatch(float halfWidth, float height, float halfDepth)
+    : halfWidth(halfWidth), height(height), halfDepth(halfDepth) {}
+
+void BillboardBatch::add(float x, float y, float z, float scaleX, float scaleY, float scaleZ, float swayDegrees) {
+    instances.push_back({ x, y, z, scaleX, scaleY, scaleZ, swayDegrees });
+}
+
+void BillboardBatch::prepare(const Frustum* frustum) {
+    vertices.resize(instances.size() * 20);
+    sliceKept.resize((instances.size() + kSlice - 1) / kSlice);
+    Jobs::parallelFor(instances.size(), kSlice, [this, frustum](size_t begin, size_t end) {
+        sliceKept[begin / kSlice] = expand(begin, end, frustum);
+    });
+
+    // Close the gaps the culled instances left, slice by slice
+    prepared = 0;
+    for (size_t slice = 0; slice < sliceKept.size(); ++slice) {
+        const size_t from = slice * kSlice;
+        if (prepared != from) {
+            std::memmove(&vertices[prepared * 20], &vertices[from * 20], sliceKept[slice] * 20 * sizeof(float));
+        }
+        prepared += sliceKept[slice];
+    }
+}
+
+size_t BillboardBatch::expand(size_t begin, size_t end, const Frustum* frustum) {
+    // Corner order and texture coordinates of the old glBegin(GL_QUADS) blocks
+    static const float corner[4][4] = {
+        // s     t     x      y
+        { 0.0f, 0.0f, -1.0f, 0.0f },
+        { 1.0f, 0.0f,  1.0f, 0.0f },
+        { 1.0f, 1.0f,  1.0f, 1.0f },
+        { 0.0f, 1.0f, -1.0f, 1.0f },
+    };
+
+    if (frustum) {
+        // Box around the slice at the instances' own scale and sway: a slice
+        // wholly out of view (a flank, a forest) is dropped before any trig
+        float min[3] = { 1e30f, 1e30f, 1e30f }, max[3] = { -1e30f, -1e30f, -1e30f };
+        for (size_t i = begin; i < end; ++i) {
+            const Instance& b = instances[i];
+            const float w = halfWidth * fabsf(b.scaleX), d = halfDepth * fabsf(b.scaleZ);
+            const float up = std::max(0.0f, height * b.scaleY), down = std::min(0.0f, height * b.scaleY);
+            const float lean = std::min(1.0f, fabsf(b.sway) * 3.14159265f / 180.0f);  // >= |sin(sway)|
+            const float reach = w + std::max(up, -down) * lean;
+            min[0] = std::min(min[0], b.x - reach);
+            max[0] = std::max(max[0], b.x + reach);
+            min[1] = std::min(min[1], b.y + down - w * lean);
+            max[1] = std::max(max[1], b.y + up + w * lean);
+            min[2] = std::min(min[2], b.z - d);
+            max[2] = std::max(max[2], b.z + d);
+        }
+        if (!frustum->boxVisible(min, max)) return 0;
+    }
+
+    float* const first = vertices.data() + begin * 20;
+    float* out = first;
+    for (size_t i = begin; i < end; ++i) {
+        const Instance& b = instances[i];
+        float c = 1.0f, s = 0.0f;
+        if (b.sway != 0.0f) {
+            const float radians = b.sway * 3.14159265f / 180.0f;
+            c = cosf(radians);
+            s = sinf(radians);
+        }
+        for (int k = 0; k < 4; ++k) {
+            const float lx = corner[k][2] * halfWidth * b.scaleX;
+            const float ly = corner[k][3] * height * b.scaleY;
+            const float lz = (corner[k][3] * 2.0f - 1.0f) * halfDepth * b.scaleZ;
+            out[0] = corner[k][0];
+            out[1] = corner[k][1];
+            out[2] = b.x + lx * c - ly * s;
+            out[3] = b.y + lx * s + ly * c;
+            out[4] = b.z + lz;
+            out += 5;
+        }
+        if (frustum) {
+            // Box around the four corners just written; dropped by rewinding
+            float min[3], max[3];
+            for (int k = 0; k < 3; ++k) {
+                min[k] = max[k] = out[k - 18];
+                for (int v = 1; v < 4; ++v) {
+                    min[k] = std::min(min[k], out[k - 18 + v * 5]);
+                    max[k] = std::max(max[k], out[k - 18 + v * 5]);
+                }
+            }
+            if (!frustum->boxVisible(min, max)) out -= 20;
+        }
+    }
+    return (size_t)(out - first) / 20;
+}
+
+size_t BillboardBatch::submit() {
+    if (prepared == 0) return 0;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, 5 * sizeof(float), vertices.data());
+    glVertexPointer(3, GL_FLOAT, 5 * sizeof(float), vertices.data() + 2);
+    glDrawArrays(GL_QUADS, 0, (GLsizei)(prepared * 4));
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    return prepared;
+}
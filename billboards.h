@@ -0,0 +1,58 @@
+#pragma once
+
+#include "platform.h"
+#include "frustum.h"
+#include <cstddef>
+#include <vector>
+
+// Batched textured billboards (armies, cavalry, trees, stars, ...).
+//
+// Every background billboard is the same leaning quad: [-halfWidth, halfWidth]
+// in x, [0, height] in y, running from z = -halfDepth at the base to
+// +halfDepth at the top. A batch holds one shape and a list of instances
+// (position, scale, sway about z); draw() expands them into one vertex array
+// and submits the lot with a single glDrawArrays, so a pass costs one draw per
+// texture instead of a push/translate/scale/glBegin per quad. Fixed-function
+// state (lighting, fog, colour, current normal) applies exactly as it did to
+// the immediate-mode quads, and the call compiles into display lists.
+class BillboardBatch {
+public:
+    BillboardBatch(float halfWidth, float height, float halfDepth);
+
+    void clear() { instances.clear(); }
+    void reserve(size_t count) { instances.reserve(count); }
+    size_t size() const { return instances.size(); }
+
+    // Same order as glTranslatef(x, y, z); glRotatef(swayDegrees, 0, 0, 1);
+    // glScalef(scaleX, scaleY, scaleZ)
+    void add(float x, float y, float z, float scaleX, float scaleY, float scaleZ, float swayDegrees = 0.0f);
+
+    // Re-aims one instance, for batches that are placed once and only sway
+    void setSway(size_t index, float swayDegrees) { instances[index].sway = swayDegrees; }
+
+    // Draws every instance with the bound texture; a no-op when empty. With a
+    // frustum, instances whose quad lies wholly outside it are left out.
+    // Returns the number drawn.
+    size_t draw(const Frustum* frustum = nullptr) { prepare(frustum); return submit(); }
+
+    // draw() in two halves: prepare() expands the instances into the vertex
+    // array on the job threads (jobs.h) and touches no GL, so it may run as a
+    // job itself; submit() draws what the last prepare() left
+    void prepare(const Frustum* frustum = nullptr);
+    size_t submit();
+    size_t preparedCount() const { return prepared; }
+
+private:
+    struct Instance { float x, y, z, scaleX, scaleY, scaleZ, sway; };
+    static const size_t kSlice = 256;   // Instances per job in prepare()
+
+    // Writes instances [begin, end) from vertex begin on, dropping the culled
+    // ones (the whole slice when its box is out of view); returns how many it kept
+    size_t expand(size_t begin, size_t end, const Frustum* frustum);
+
+    float halfWidth, height, halfDepth;
+    std::vector<Instance> instances;
+    std::vector<float> vertices;    // Interleaved s, t, x, y, z; kept between frames
+    std::vector<size_t> sliceKept;  // prepare(): instances each slice kept
+    size_t prepared = 0;            // Instances in vertices since the last prepare()
+};
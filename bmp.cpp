@@ -0,0 +1,149 @@
+#include "bmp.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    uint16_t readU16(const unsigned char* p) { return uint16_t(p[0] | (p[1] << 8)); }
+    uint32_t readU32(const unsigned char* p) { return uint32_t(p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24)); }
+
+    // BI_BITFIELDS: red, green and blue masks at 54, 58 and 62, after a
+    // 40-byte header or inside a longer one, which also has alpha at 66.
+    // The rows are read as BGRA, so only that layout is taken.
+    bool hasDefaultMasks(const unsigned char* h, size_t size, uint32_t headerSize, uint32_t dataOffset) {
+        const size_t masksEnd = headerSize >= 56 ? 70 : 66;
+        if (headerSize < 40 || masksEnd > size || masksEnd > dataOffset) return false;
+        if (readU32(h + 54) != 0x00FF0000u || readU32(h + 58) != 0x0000FF00u || readU32(h + 62) != 0x000000FFu) return false;
+        return headerSize < 56 || readU32(h + 66) == 0xFF000000u;
+    }
+
+    // One read per page faults the whole range in
+    void touchPages(const unsigned char* begin, size_t size) {
+        volatile unsigned char sink = 0;
+        for (size_t offset = 0; offset < size; offset += 4096) sink = sink + begin[offset];
+        if (size > 0) sink = sink + begin[size - 1];
+        (void)sink;
+    }
+}
+
+namespace Bmp {
+    Bitmap::~Bitmap() { close(*this); }
+
+    bool open(const char* path, Bitmap& out) {
+        close(out);
+        if (!Platform::mapFile(path, out.file)) {
+            printf("ERROR: Could not load bitmap '%s'\n", path);
+            return false;
+        }
+
+        const unsigned char* h = out.file.data;
+        const size_t size = out.file.size;
+        if (size < 54 || h[0] != 'B' || h[1] != 'M') {
+            printf("ERROR: '%s' is not a BMP file\n", path);
+            close(out);
+            return false;
+        }
+        const uint32_t dataOffset = readU32(h + 10);
+        const uint32_t headerSize = readU32(h + 14);
+        const int32_t width = (int32_t)readU32(h + 18);
+        int32_t height = (int32_t)readU32(h + 22);
+        const int bpp = readU16(h + 28);
+        const uint32_t compression = readU32(h + 30);
+        const bool topDown = height < 0;
+        if (topDown) height = -height;
+
+        // BI_RGB, or BI_BITFIELDS with the default 32-bit BGRA masks
+        if (width <= 0 || height <= 0 || (compression != 0 && !(compression == 3 && bpp == 32)) ||
+            (bpp != 8 && bpp != 24 && bpp != 32)) {
+            printf("ERROR: Unsupported BMP format in '%s' (%d bpp, compression %u)\n", path, bpp, compression);
+            close(out);
+            return false;
+        }
+        if (compression == 3 && !hasDefaultMasks(h, size, headerSize, dataOffset)) {
+            printf("ERROR: Unsupported BMP channel masks in '%s'\n", path);
+            close(out);
+            return false;
+        }
+
+        const size_t srcStride = ((size_t)width * bpp / 8 + 3) & ~(size_t)3;
+        if (dataOffset > size || srcStride * height > size - dataOffset) {
+            printf("ERROR: Truncated BMP file '%s'\n", path);
+            close(out);
+            return false;
+        }
+        const unsigned char* src = h + dataOffset;
+
+        out.width = width;
+        out.height = height;
+        if (bpp != 8) {
+            out.bitsPerPixel = bpp;
+            out.topDown = topDown;
+            out.stride = srcStride;
+            out.rows = src;
+            touchPages(src, out.bytes());
+            return true;
+        }
+
+        // Palettised: expand to BGR, flipping to bottom-up on the way
+        uint32_t paletteSize = readU32(h + 46);
+        if (paletteSize == 0 || paletteSize > 256) paletteSize = 256;
+        if (14 + (size_t)headerSize + paletteSize * 4 > dataOffset) {
+            printf("ERROR: Corrupt BMP palette in '%s'\n", path);
+            close(out);
+            return false;
+        }
+        const unsigned char* palette = h + 14 + headerSize;
+        out.bitsPerPixel = 24;
+        out.topDown = false;
+        out.stride = ((size_t)width * 3 + 3) & ~(size_t)3;
+        out.expanded.assign(out.bytes(), 0);
+        for (int y = 0; y < height; ++y) {
+            const unsigned char* in = src + srcStride * (topDown ? height - 1 - y : y);
+            unsigned char* dst = out.expanded.data() + out.stride * y;
+            for (int x = 0; x < width; ++x) memcpy(dst + x * 3, palette + (in[x] < paletteSize ? in[x] : 0) * 4, 3);
+        }
+        out.rows = out.expanded.data();
+        Platform::unmapFile(out.file);                      // Nothing left to read from it
+        return true;
+    }
+
+    void close(Bitmap& bitmap) {
+        Platform::unmapFile(bitmap.file);
+        std::vector<unsigned char>().swap(bitmap.expanded);
+        bitmap.rows = nullptr;
+        bitmap.width = bitmap.height = bitmap.bitsPerPixel = 0;
+        bitmap.stride = 0;
+        bitmap.topDown = false;
+    }
+
+    void upload(const Bitmap& bitmap) {
+        const GLenum format = bitmap.bitsPerPixel == 32 ? GL_BGRA : GL_BGR;
+        const GLint internalFormat = bitmap.bitsPerPixel == 32 ? GL_RGBA : GL_RGB;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (!bitmap.topDown) {
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, bitmap.width, bitmap.height, 0, format, GL_UNSIGNED_BYTE, bitmap.rows);
+            return;
+        }
+        // GL wants the bottom row first; reversing the rows needs a row stride
+        // GL does not have, so send them one by one
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, bitmap.width, bitmap.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        for (int y = 0; y < bitmap.height; ++y) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, bitmap.width, 1, format, GL_UNSIGNED_BYTE,
+                            bitmap.rows + bitmap.stride * (bitmap.height - 1 - y));
+        }
+    }
+
+    void copy(const Bitmap& bitmap, Platform::Image& out) {
+        out.width = bitmap.width;
+        out.height = bitmap.height;
+        out.bitsPerPixel = bitmap.bitsPerPixel;
+        out.pixels.resize(bitmap.bytes());
+        if (!bitmap.topDown) {
+            memcpy(out.pixels.data(), bitmap.rows, bitmap.bytes());
+            return;
+        }
+        for (int y = 0; y < bitmap.height; ++y) {
+            memcpy(out.pixels.data() + bitmap.stride * y, bitmap.rows + bitmap.stride * (bitmap.height - 1 - y), bitmap.stride);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "platform.h"
+#include <cstddef>
+#include <vector>
+
+// BMP reading shared by every texture loader, on every platform.
+//
+// open() memory-maps the file and parses the header in place: the pixel rows
+// are then read straight out of the mapping, and upload() hands them to
+// glTexImage2D as they are (BMP rows are BGR/BGRA padded to 4 bytes, which
+// GL takes with GL_UNPACK_ALIGNMENT 4). Only palettised 8-bit files are
+// expanded into a private copy.
+namespace Bmp {
+    struct Bitmap {
+        int width = 0;
+        int height = 0;
+        int bitsPerPixel = 0;                   // 24 or 32, as uploaded
+        bool topDown = false;                   // First row in memory is the top one
+        size_t stride = 0;                      // Bytes per row, a multiple of 4
+        const unsigned char* rows = nullptr;    // First row in memory order; null when closed
+        Platform::MappedFile file;
+        std::vector<unsigned char> expanded;    // 8-bit files only: palette applied, bottom-up
+
+        Bitmap() = default;
+        Bitmap(const Bitmap&) = delete;         // Owns the mapping
+        Bitmap& operator=(const Bitmap&) = delete;
+        ~Bitmap();
+
+        size_t bytes() const { return stride * (size_t)height; }
+    };
+
+    // Uncompressed 24/32-bit (BI_RGB, or BI_BITFIELDS with the default masks)
+    // and palettised 8-bit, bottom-up or top-down. Every page of the rows is
+    // touched before returning, so the disk reads happen here rather than
+    // inside a later upload. Prints why on failure.
+    bool open(const char* path, Bitmap& out);
+    void close(Bitmap& bitmap);
+
+    // Level 0 of the bound GL_TEXTURE_2D, read directly from the rows (RGBA
+    // for 32-bit files, RGB otherwise); a top-down file goes up one row at a time
+    void upload(const Bitmap& bitmap);
+
+    // Bottom-up copy, for code that wants to own the pixels
+    void copy(const Bitmap& bitmap, Platform::Image& out);
+}
@@ -0,0 +1,274 @@
+#include "collision.h"
+#include <algorithm>
+#include <cmath>
+
+void CollisionGrid::build(const std::vector<CollisionBox>& boxes, float minX, float maxX, float minZ, float maxZ, float size) {
+    source = &boxes;
+    originX = minX;
+    originZ = minZ;
+    cellSize = size;
+    inverseCell = 1.0f / size;
+    columns = std::max(1, (int)ceilf((maxX - minX) * inverseCell));
+    rows = std::max(1, (int)ceilf((maxZ - minZ) * inverseCell));
+
+    // Counting pass, then fill: one flat array, cells contiguous
+    std::vector<uint32_t> counts(rows * columns + 1, 0);
+    for (const CollisionBox& box : boxes) {
+        int x0, x1, z0, z1;
+        cellRange(box.minX, box.maxX, box.minZ, box.maxZ, x0, x1, z0, z1);
+        for (int r = z0; r <= z1; ++r)
+            for (int c = x0; c <= x1; ++c) ++counts[r * columns + c];
+    }
+    cellStart.assign(rows * columns + 1, 0);
+    for (int cell = 0; cell < rows * columns; ++cell) cellStart[cell + 1] = cellStart[cell] + counts[cell];
+    cellBoxes.resize(cellStart.back());
+    std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (size_t b = 0; b < boxes.size(); ++b) {
+        int x0, x1, z0, z1;
+        cellRange(boxes[b].minX, boxes[b].maxX, boxes[b].minZ, boxes[b].maxZ, x0, x1, z0, z1);
+        for (int r = z0; r <= z1; ++r)
+            for (int c = x0; c <= x1; ++c) cellBoxes[cursor[r * columns + c]++] = (uint16_t)b;
+    }
+    stamp.assign(boxes.size(), 0u);
+    query = 0;
+}
+
+void CollisionGrid::cellRange(float minX, float maxX, float minZ, float maxZ, int& x0, int& x1, int& z0, int& z1) const {
+    auto column = [this](float x) {
+        const int c = (int)floorf((x - originX) * inverseCell);
+        return c < 0 ? 0 : (c >= columns ? columns - 1 : c);
+    };
+    auto row = [this](float z) {
+        const int r = (int)floorf((z - originZ) * inverseCell);
+        return r < 0 ? 0 : (r >= rows ? rows - 1 : r);
+    };
+    x0 = column(minX); x1 = column(maxX);
+    z0 = row(minZ);    z1 = row(maxZ);
+}
+
+int CollisionGrid::overlapCircle(float x, float z, float radius, unsigned categories) const {
+    int hit = -1;
+    if (!source) return hit;
+    const std::vector<CollisionBox>& all = *source;
+    forEachCandidate(x - radius, x + radius, z - radius, z + radius, [&](int b) {
+        if (!(all[b].category & categories) || !circleOverlapsBox(x, z, radius, all[b])) return false;
+        hit = b;
+        return true;
+    });
+    return hit;
+}
+
+void CollisionGrid::overlapCircles(const float* x, const float* z, const float* radius, size_t count,
+                                   int* hits, unsigned categories) const {
+    for (size_t i = 0; i < count; ++i) hits[i] = overlapCircle(x[i], z[i], radius[i], categories);
+}
+
+// Direction that separates a circle centre from a box it touches: away from
+// the closest point, or out through the nearest face if the centre is inside
+static void separatingNormal(float cx, float cz, const CollisionBox& box, float& nx, float& nz) {
+    const float closestX = box.minX > cx ? box.minX : (cx > box.maxX ? box.maxX : cx);
+    const float closestZ = box.minZ > cz ? box.minZ : (cz > box.maxZ ? box.maxZ : cz);
+    const float ox = cx - closestX, oz = cz - closestZ;
+    const float lengthSq = ox * ox + oz * oz;
+    if (lengthSq > 1e-12f) {
+        const float inverse = 1.0f / sqrtf(lengthSq);
+        nx = ox * inverse;
+        nz = oz * inverse;
+        return;
+    }
+    const float depths[4] = { cx - box.minX, box.maxX - cx, cz - box.minZ, box.maxZ - cz };
+    int face = 0;
+    for (int i = 1; i < 4; ++i) if (depths[i] < depths[face]) face = i;
+    nx = face == 0 ? -1.0f : (face == 1 ? 1.0f : 0.0f);
+    nz = face == 2 ? -1.0f : (face == 3 ? 1.0f : 0.0f);
+}
+
+bool sweepCircleBox(float cx, float cz, float dx, float dz, float radius, const CollisionBox& box, SweepHit& hit) {
+    // Slab test of the centre against the box grown by the radius
+    const float origin[2] = { cx, cz };
+    const float delta[2] = { dx, dz };
+    const float low[2] = { box.minX - radius, box.minZ - radius };
+    const float high[2] = { box.maxX + radius, box.maxZ + radius };
+    float enter = 0.0f, leave = 1.0f, faceNormal = 0.0f;
+    int faceAxis = -1;
+    for (int axis = 0; axis < 2; ++axis) {
+        if (fabsf(delta[axis]) < 1e-12f) {
+            if (origin[axis] < low[axis] || origin[axis] > high[axis]) return false;
+            continue;
+        }
+        const float inverse = 1.0f / delta[axis];
+        float t0 = (low[axis] - origin[axis]) * inverse;
+        float t1 = (high[axis] - origin[axis]) * inverse;
+        float normal = -1.0f;
+        if (t0 > t1) { std::swap(t0, t1); normal = 1.0f; }
+        if (t0 > enter) { enter = t0; faceAxis = axis; faceNormal = normal; }
+        if (t1 < leave) leave = t1;
+        if (enter > leave) return false;
+    }
+
+    // Where the centre enters the grown box; beyond both ranges it is in a
+    // corner square, where the real boundary is a quarter circle
+    const float px = cx + dx * enter, pz = cz + dz * enter;
+    const bool outsideX = px < box.minX || px > box.maxX;
+    const bool outsideZ = pz < box.minZ || pz > box.maxZ;
+    if (outsideX && outsideZ) {
+        // Solved from the entry point, next to the corner, to keep the
+        // quadratic well conditioned for long sweeps far from the origin
+        const float cornerX = px < box.minX ? box.minX : box.maxX;
+        const float cornerZ = pz < box.minZ ? box.minZ : box.maxZ;
+        const float mx = px - cornerX, mz = pz - cornerZ;
+        const float c = mx * mx + mz * mz - radius * radius;
+        if (c > 0.0f || enter > 0.0f) {
+            float step = 0.0f;
+            if (c > 0.0f) {
+                const float a = dx * dx + dz * dz;
+                const float b = mx * dx + mz * dz;
+                const float discriminant = b * b - a * c;
+                if (b >= 0.0f || discriminant < 0.0f) return false;
+                step = (-b - sqrtf(discriminant)) / a;
+                if (enter + step > 1.0f) return false;
+            }
+            const float nx = mx + dx * step, nz = mz + dz * step;
+            const float length = sqrtf(nx * nx + nz * nz);
+            if (length > 1e-12f) {
+                hit.normalX = nx / length;
+                hit.normalZ = nz / length;
+            } else {
+                separatingNormal(px, pz, box, hit.normalX, hit.normalZ);
+            }
+            hit.time = enter + step;
+            return true;
+        }
+    } else if (faceAxis >= 0) {
+        hit.time = enter;
+        hit.normalX = faceAxis == 0 ? faceNormal : 0.0f;
+        hit.normalZ = faceAxis == 1 ? faceNormal : 0.0f;
+        return true;
+    }
+
+    // Already touching: blocked only while moving further in. Motion along
+    // the surface, as left by a slide, is let through despite rounding.
+    separatingNormal(cx, cz, box, hit.normalX, hit.normalZ);
+    if (dx * hit.normalX + dz * hit.normalZ >= -1e-4f * sqrtf(dx * dx + dz * dz)) return false;
+    hit.time = 0.0f;
+    return true;
+}
+
+bool CollisionGrid::sweepCircle(float x, float z, float dx, float dz, float radius, SweepHit& hit,
+                                unsigned categories) const {
+    hit.time = 1.0f;
+    hit.normalX = hit.normalZ = 0.0f;
+    hit.box = -1;
+    if (!source) return false;
+    const std::vector<CollisionBox>& all = *source;
+    const float minX = std::min(x, x + dx) - radius, maxX = std::max(x, x + dx) + radius;
+    const float minZ = std::min(z, z + dz) - radius, maxZ = std::max(z, z + dz) + radius;
+    forEachCandidate(minX, maxX, minZ, maxZ, [&](int b) {
+        SweepHit candidate;
+        if (!(all[b].category & categories) || !sweepCircleBox(x, z, dx, dz, radius, all[b], candidate)) return false;
+        if (hit.box < 0 || candidate.time < hit.time) {
+            hit = candidate;
+            hit.box = b;
+        }
+        return hit.time <= 0.0f;
+    });
+    return hit.box >= 0;
+}
+
+void CollisionGrid::sweepCircles(const float* x, const float* z, const float* dx, const float* dz, const float* radius,
+                                 size_t count, SweepHit* hits, unsigned categories) const {
+    for (size_t i = 0; i < count; ++i) sweepCircle(x[i], z[i], dx[i], dz[i], radius[i], hits[i], categories);
+}
+
+bool segmentHitsBox(float x, float y, float z, float dx, float dy, float dz, const CollisionBox& box, SegmentHit& hit) {
+    const float origin[3] = { x, y, z };
+    const float delta[3] = { dx, dy, dz };
+    const float low[3] = { box.minX, -1e6f, box.minZ };
+    const float high[3] = { box.maxX, box.height, box.maxZ };
+    float enter = -1e30f, leave = 1e30f, faceNormal = 1.0f;
+    int faceAxis = 1;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (fabsf(delta[axis]) < 1e-12f) {
+            if (origin[axis] < low[axis] || origin[axis] > high[axis]) return false;
+            continue;
+        }
+        const float inverse = 1.0f / delta[axis];
+        float t0 = (low[axis] - origin[axis]) * inverse;
+        float t1 = (high[axis] - origin[axis]) * inverse;
+        float normal = -1.0f;
+        if (t0 > t1) { std::swap(t0, t1); normal = 1.0f; }
+        if (t0 > enter) { enter = t0; faceAxis = axis; faceNormal = normal; }
+        if (t1 < leave) leave = t1;
+        if (enter > leave) return false;
+    }
+    if (leave < 0.0f || enter > 1.0f) return false;
+    hit.time = enter > 0.0f ? enter : 0.0f;
+    for (int axis = 0; axis < 3; ++axis) hit.normal[axis] = axis == faceAxis ? faceNormal : 0.0f;
+    return true;
+}
+
+bool segmentHitsCapsule(float x, float y, float z, float dx, float dy, float dz,
+                        float cx, float cz, float bottomY, float topY, float radius, float& time) {
+    const float radiusSq = radius * radius;
+    const float axisY = y < bottomY ? bottomY : (y > topY ? topY : y);
+    const float mx = x - cx, mz = z - cz;
+    if (mx * mx + (y - axisY) * (y - axisY) + mz * mz <= radiusSq) {
+        time = 0.0f;
+        return true;
+    }
+
+    // Starting outside, the entry is the earliest crossing of the side or
+    // either end sphere (entries into those that lie inside the capsule can
+    // only come after it)
+    float best = 2.0f;
+    const float a = dx * dx + dz * dz;
+    const float b = mx * dx + mz * dz;
+    const float c = mx * mx + mz * mz - radiusSq;
+    if (a > 1e-12f && c > 0.0f && b < 0.0f) {
+        const float discriminant = b * b - a * c;
+        if (discriminant >= 0.0f) {
+            const float t = (-b - sqrtf(discriminant)) / a;
+            const float hitY = y + dy * t;
+            if (t <= 1.0f && hitY >= bottomY && hitY <= topY) best = t;
+        }
+    }
+    const float ends[2] = { bottomY, topY };
+    for (float endY : ends) {
+        const float my = y - endY;
+        const float a3 = a + dy * dy;
+        const float b3 = b + my * dy;
+        const float c3 = c + my * my;
+        if (a3 < 1e-12f || c3 <= 0.0f || b3 >= 0.0f) continue;
+        const float discriminant = b3 * b3 - a3 * c3;
+        if (discriminant < 0.0f) continue;
+        const float t = (-b3 - sqrtf(discriminant)) / a3;
+        if (t < best) best = t;
+    }
+    if (best > 1.0f) return false;
+    time = best;
+    return true;
+}
+
+bool CollisionGrid::segmentHit(float x, float y, float z, float dx, float dy, float dz, SegmentHit& hit,
+                               unsigned categories) const {
+    hit.time = 1.0f;
+    hit.normal[0] = hit.normal[1] = hit.normal[2] = 0.0f;
+    hit.box = -1;
+    if (!source) return false;
+    const std::vector<CollisionBox>& all = *source;
+    forEachCandidate(std::min(x, x + dx), std::max(x, x + dx), std::min(z, z + dz), std::max(z, z + dz), [&](int b) {
+        SegmentHit candidate;
+        if (!(all[b].category & categories) || !segmentHitsBox(x, y, z, dx, dy, dz, all[b], candidate)) return false;
+        if (hit.box < 0 || candidate.time < hit.time) {
+            hit = candidate;
+            hit.box = b;
+        }
+        return hit.time <= 0.0f;
+    });
+    return hit.box >= 0;
+}
+
+void CollisionGrid::segmentHits(const float* x, const float* y, const float* z, const float* dx, const float* dy, const float* dz,
+                                size_t count, SegmentHit* hits, unsigned categories) const {
+    for (size_t i = 0; i < count; ++i) segmentHit(x[i], y[i], z[i], dx[i], dy[i], dz[i], hits[i], categories);
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Static collision geometry of the battlefield and a uniform-grid index over it.
+//
+// Boxes are axis-aligned footprints on the XZ plane with a height, tagged
+// once with a category so queries can select e.g. only fortifications
+// without looking at names. The grid covers the playable area in square
+// cells; each cell lists the boxes overlapping it (boxes reaching past the
+// border are clamped into the edge cells), so a query only visits the cells
+// under its own bounds. Queries come singly or batched (structure-of-arrays),
+// for callers that test many agents at once.
+//
+// Sweeps move a circle along a straight line and report the first contact,
+// so a fast mover cannot step over a thin box between two frames. They are
+// exact: the circle's centre is traced against each box grown by the radius
+// (a rectangle with rounded corners).
+//
+// Segment queries are the 3D counterpart for projectiles: each box is solid
+// from below the ground up to its height, and an arrow's step is traced
+// through it. Batches of steps go through the grid together, so thousands of
+// arrows cost a few cell visits each rather than a pass over every box.
+enum CollisionCategory {
+    COLLIDE_FORTIFICATION = 1 << 0,  // Fortress and castle walls
+    COLLIDE_SIEGE_ENGINE  = 1 << 1,  // Siege towers, trebuchets, rams
+    COLLIDE_CAMP          = 1 << 2,  // Campfires, weapon racks, tents
+    COLLIDE_DEBRIS        = 1 << 3,  // Wagons, carts, boulders, wreckage
+    COLLIDE_ALL           = 0xF
+};
+
+struct CollisionBox {
+    float minX, maxX, minZ, maxZ;
+    float height;
+    const char* name;   // For debugging
+    int category;       // One CollisionCategory
+};
+
+// First contact of a sweep
+struct SweepHit {
+    float time;             // Fraction of the motion travelled before contact, 0..1
+    float normalX, normalZ; // Unit contact normal, pointing away from the obstacle
+    int box;                // Index of the box hit; -1 for other obstacles
+};
+
+// Circle at (cx, cz) moving by (dx, dz) against one box. Returns true and
+// fills time/normal (not box) on contact within the motion. A circle that
+// already touches the box reports time 0 while it moves inward and no hit
+// once it moves apart, so a blocked mover can always back away.
+bool sweepCircleBox(float cx, float cz, float dx, float dz, float radius, const CollisionBox& box, SweepHit& hit);
+
+// First contact of a segment in 3D
+struct SegmentHit {
+    float time;             // Fraction of the segment before contact, 0..1
+    float normal[3];        // Outward normal of the face entered
+    int box;                // Index of the box hit, -1 if clear
+};
+
+// Segment from (x, y, z) by (dx, dy, dz) against a box standing on the
+// ground. A start inside the box reports time 0.
+bool segmentHitsBox(float x, float y, float z, float dx, float dy, float dz, const CollisionBox& box, SegmentHit& hit);
+
+// Same segment against a vertical capsule whose axis runs from
+// (cx, bottomY, cz) up to (cx, topY, cz); time of entry in time
+bool segmentHitsCapsule(float x, float y, float z, float dx, float dy, float dz,
+                        float cx, float cz, float bottomY, float topY, float radius, float& time);
+
+class CollisionGrid {
+public:
+    // Indexes boxes (kept by reference; rebuild if they change) over
+    // [minX, maxX] x [minZ, maxZ]
+    void build(const std::vector<CollisionBox>& boxes, float minX, float maxX, float minZ, float maxZ, float cellSize);
+
+    // Index of the first box in categories that a circle overlaps, or -1
+    int overlapCircle(float x, float z, float radius, unsigned categories = COLLIDE_ALL) const;
+
+    // Batched form: hits[i] = overlapCircle(x[i], z[i], radius[i], categories)
+    void overlapCircles(const float* x, const float* z, const float* radius, size_t count,
+                        int* hits, unsigned categories = COLLIDE_ALL) const;
+
+    // Earliest contact of a circle moving by (dx, dz) with boxes in categories;
+    // false if the whole motion is clear. Radius 0 traces a segment.
+    bool sweepCircle(float x, float z, float dx, float dz, float radius, SweepHit& hit,
+                     unsigned categories = COLLIDE_ALL) const;
+
+    // Batched form: hit[i].box < 0 with time 1 where sweep i is clear
+    void sweepCircles(const float* x, const float* z, const float* dx, const float* dz, const float* radius,
+                      size_t count, SweepHit* hits, unsigned categories = COLLIDE_ALL) const;
+
+    // Earliest box in categories a 3D segment enters; false if it is clear
+    bool segmentHit(float x, float y, float z, float dx, float dy, float dz, SegmentHit& hit,
+                    unsigned categories = COLLIDE_ALL) const;
+
+    // Batched form over structure-of-arrays segments
+    void segmentHits(const float* x, const float* y, const float* z, const float* dx, const float* dy, const float* dz,
+                     size_t count, SegmentHit* hits, unsigned categories = COLLIDE_ALL) const;
+
+    // Calls visit(boxIndex) once for every box whose cells the rectangle
+    // touches (a superset of the boxes it overlaps); stops early when visit
+    // returns true, and returns whether it did
+    template <class Visit>
+    bool forEachCandidate(float minX, float maxX, float minZ, float maxZ, Visit visit) const;
+
+    const std::vector<CollisionBox>& boxes() const { return *source; }
+
+private:
+    void cellRange(float minX, float maxX, float minZ, float maxZ, int& x0, int& x1, int& z0, int& z1) const;
+
+    const std::vector<CollisionBox>* source = nullptr;
+    float originX = 0.0f, originZ = 0.0f, cellSize = 1.0f, inverseCell = 1.0f;
+    int columns = 0, rows = 0;
+    std::vector<uint32_t> cellStart;    // rows * columns + 1 offsets into cellBoxes
+    std::vector<uint16_t> cellBoxes;
+    mutable std::vector<uint32_t> stamp; // Per box: last query that visited it
+    mutable uint32_t query = 0;
+};
+
+inline bool circleOverlapsBox(float cx, float cz, float radius, const CollisionBox& box) {
+    // Closest point on the box to the circle centre
+    const float closestX = box.minX > cx ? box.minX : (cx > box.maxX ? box.maxX : cx);
+    const float closestZ = box.minZ > cz ? box.minZ : (cz > box.maxZ ? box.maxZ : cz);
+    const float dx = cx - closestX, dz = cz - closestZ;
+    return dx * dx + dz * dz < radius * radius;
+}
+
+template <class Visit>
+bool CollisionGrid::forEachCandidate(float minX, float maxX, float minZ, float maxZ, Visit visit) const {
+    if (!source || source->empty()) return false;
+    int x0, x1, z0, z1;
+    cellRange(minX, maxX, minZ, maxZ, x0, x1, z0, z1);
+    // A box spanning several cells is listed in each; the stamp skips repeats
+    if (++query == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0u);
+        query = 1;
+    }
+    for (int r = z0; r <= z1; ++r) {
+        for (int c = x0; c <= x1; ++c) {
+            const int cell = r * columns + c;
+            for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                const uint16_t b = cellBoxes[k];
+                if (stamp[b] == query) continue;
+                stamp[b] = query;
+                if (visit((int)b)) return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,68 @@
+#include "command_list.h"
+#include "log.h"
+
+// Not routed through gl_stats.h: the recorded commands are counted as they
+// are submitted, once, and a replay submits nothing new from the CPU
+
+CommandList* CommandList::active = nullptr;
+
+void CommandList::begin() {
+    if (active) {
+        LOG_ERROR("CommandList::begin while another list records");
+        return;
+    }
+    entries.clear();
+    namesUsed = 0;
+    active = this;
+    openSegment();
+}
+
+void CommandList::end() {
+    if (active != this) return;
+    closeSegment();
+    active = nullptr;
+}
+
+void CommandList::replay() const {
+    for (const Entry& entry : entries) {
+        if (entry.list) glCallList(entry.list);
+        else entry.draw();
+    }
+}
+
+void CommandList::release() {
+    if (active == this) end();
+    for (GLuint name : names) glDeleteLists(name, 1);
+    names.clear();
+    entries.clear();
+    namesUsed = 0;
+}
+
+void CommandList::perView(void (*draw)()) {
+    CommandList* list = active;
+    if (!list) {
+        draw();
+        return;
+    }
+    list->closeSegment();
+    list->entries.push_back({ 0, draw });
+    list->openSegment();
+}
+
+void CommandList::openSegment() {
+    if (namesUsed == names.size()) {
+        const GLuint name = glGenLists(1);
+        if (name == 0) {
+            LOG_WARN("Could not allocate display list, recording nothing");
+            return;
+        }
+        names.push_back(name);
+    }
+    const GLuint name = names[namesUsed++];
+    entries.push_back({ name, nullptr });
+    glNewList(name, GL_COMPILE);
+}
+
+void CommandList::closeSegment() {
+    if (!entries.empty() && entries.back().list) glEndList();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "platform.h"
+#include <vector>
+
+// A frame's scene recorded once and replayed under several cameras (the
+// split viewport).
+//
+// Between begin() and end() GL commands are compiled into display lists
+// instead of executed, so animation, skinning and the immediate-mode
+// geometry run once; replay() then draws the lot under whatever projection
+// and modelview are current. Matrix operations and light positions are
+// recorded relative to the modelview at replay, as they would be when drawn
+// directly. Work that depends on the camera (culling, level of detail) goes
+// through perView(): while a list records it ends the current segment and
+// runs the function at each replay, otherwise it runs it straight away.
+//
+// Nothing may compile another list while recording, and glGet reads the
+// state as it was before begin(). Textures requested meanwhile stay empty
+// until the next upload (texture_manager.h). CPU-side state caches must not
+// assume a perView() function ran.
+class CommandList {
+public:
+    void begin();
+    void end();
+    void replay() const;
+    void release();                 // Needs the GL context; not done on destruction
+
+    static bool recording() { return active != nullptr; }
+    static void perView(void (*draw)());
+
+    unsigned segments() const { return (unsigned)entries.size(); }
+
+private:
+    struct Entry {
+        GLuint list;                // 0 for a perView() function
+        void (*draw)();
+    };
+    void openSegment();
+    void closeSegment();
+
+    std::vector<Entry> entries;
+    std::vector<GLuint> names;      // Reused frame to frame; entries use the first few
+    unsigned namesUsed = 0;
+    static CommandList* active;
+};
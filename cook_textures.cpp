@@ -0,0 +1,346 @@
+// Offline texture cooker.
+//
+// Converts BMPs into cooked textures (cooked_texture.h) next to them:
+// "texturess/sky.bmp" -> "texturess/sky.mtex". Each gets its full mip chain,
+// box-filtered in linear light, stored as BC1 (DXT1, 8:1 against RGBX) or as
+// plain BGR rows. The texture manager picks the cooked file up in place of
+// the BMP the next time the program starts; delete it to go back.
+//
+// Prints, per texture, what the driver holds before (uncompressed GL_RGB,
+// one level) and after cooking, and the PSNR of the BC1 top level.
+//
+// Build (Windows, console):
+//   cl /O2 /EHsc cook_textures.cpp cooked_texture.cpp bmp.cpp gl_ext.cpp platform_win32.cpp
+//      /link /SUBSYSTEM:CONSOLE user32.lib gdi32.lib
+//
+// Build (Linux):
+//   g++ -O2 cook_textures.cpp cooked_texture.cpp bmp.cpp gl_ext.cpp platform_linux.cpp
+//       -lGL -lGLU -lX11 -lEGL -o cook_textures
+//
+// Usage:
+//   cook_textures [--bgr] [FILE.bmp | DIR]...   (default: texturess and the working directory)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bmp.h"
+#include "cooked_texture.h"
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    // Tightly packed BGR, bottom-up
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<unsigned char> bgr;
+    };
+
+    float sLinear[256];
+
+    float toLinear(unsigned char v) { return sLinear[v]; }
+    unsigned char toSrgb(float v) {
+        const float s = powf(std::max(0.0f, std::min(1.0f, v)), 1.0f / 2.2f) * 255.0f + 0.5f;
+        return (unsigned char)std::min(255.0f, s);
+    }
+
+    bool isDirectory(const std::string& path) {
+#ifdef _WIN32
+        const DWORD attributes = GetFileAttributesA(path.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+    }
+
+    void listBitmaps(const std::string& dir, std::vector<std::string>& out) {
+        std::vector<std::string> found;
+#ifdef _WIN32
+        WIN32_FIND_DATAA data;
+        HANDLE find = FindFirstFileA((dir + "\\*.bmp").c_str(), &data);
+        if (find != INVALID_HANDLE_VALUE) {
+            do found.push_back(dir + "/" + data.cFileName); while (FindNextFileA(find, &data));
+            FindClose(find);
+        }
+#else
+        if (DIR* d = opendir(dir.c_str())) {
+            while (dirent* entry = readdir(d)) {
+                const size_t n = strlen(entry->d_name);
+                if (n > 4 && !strcmp(entry->d_name + n - 4, ".bmp")) found.push_back(dir + "/" + entry->d_name);
+            }
+            closedir(d);
+        }
+#endif
+        std::sort(found.begin(), found.end());
+        out.insert(out.end(), found.begin(), found.end());
+    }
+
+    bool loadTopLevel(const char* path, Level& out) {
+        Bmp::Bitmap bitmap;
+        if (!Bmp::open(path, bitmap)) return false;
+        Platform::Image image;
+        Bmp::copy(bitmap, image);
+        const size_t stride = ((size_t)image.width * image.bitsPerPixel / 8 + 3) & ~(size_t)3;
+        const int texel = image.bitsPerPixel / 8;
+        out.width = image.width;
+        out.height = image.height;
+        out.bgr.resize((size_t)out.width * out.height * 3);
+        for (int y = 0; y < out.height; ++y) {
+            for (int x = 0; x < out.width; ++x) {
+                memcpy(&out.bgr[((size_t)y * out.width + x) * 3], &image.pixels[stride * y + (size_t)x * texel], 3);
+            }
+        }
+        return true;
+    }
+
+    // Halves each side (rounding down, never below 1), averaging up to 2x2
+    // texels; an odd last row or column is folded into its neighbour
+    Level downsample(const Level& src) {
+        Level dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.bgr.resize((size_t)dst.width * dst.height * 3);
+        for (int y = 0; y < dst.height; ++y) {
+            const int y0 = std::min(src.height - 1, y * 2);
+            const int y1 = std::min(src.height - 1, y * 2 + 1);
+            for (int x = 0; x < dst.width; ++x) {
+                const int x0 = std::min(src.width - 1, x * 2);
+                const int x1 = std::min(src.width - 1, x * 2 + 1);
+                for (int c = 0; c < 3; ++c) {
+                    const float sum = toLinear(src.bgr[((size_t)y0 * src.width + x0) * 3 + c]) +
+                                      toLinear(src.bgr[((size_t)y0 * src.width + x1) * 3 + c]) +
+                                      toLinear(src.bgr[((size_t)y1 * src.width + x0) * 3 + c]) +
+                                      toLinear(src.bgr[((size_t)y1 * src.width + x1) * 3 + c]);
+                    dst.bgr[((size_t)y * dst.width + x) * 3 + c] = toSrgb(sum * 0.25f);
+                }
+            }
+        }
+        return dst;
+    }
+
+    uint16_t pack565(const float rgb[3]) {
+        const int r = (int)(std::max(0.0f, std::min(255.0f, rgb[0])) * 31.0f / 255.0f + 0.5f);
+        const int g = (int)(std::max(0.0f, std::min(255.0f, rgb[1])) * 63.0f / 255.0f + 0.5f);
+        const int b = (int)(std::max(0.0f, std::min(255.0f, rgb[2])) * 31.0f / 255.0f + 0.5f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void unpack565(uint16_t c, int rgb[3]) {
+        rgb[0] = ((c >> 11) & 31) * 255 / 31;
+        rgb[1] = ((c >> 5) & 63) * 255 / 63;
+        rgb[2] = (c & 31) * 255 / 31;
+    }
+
+    // Four-colour BC1 block: endpoints at the extremes of the texels along
+    // their principal axis, then each texel takes the nearest palette entry
+    void encodeBlock(const int rgb[16][3], unsigned char out[8]) {
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; ++i) for (int c = 0; c < 3; ++c) mean[c] += rgb[i][c] / 16.0f;
+        float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };    // rr rg rb gg gb bb
+        for (int i = 0; i < 16; ++i) {
+            const float d[3] = { rgb[i][0] - mean[0], rgb[i][1] - mean[1], rgb[i][2] - mean[2] };
+            cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+        }
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; ++iteration) {                 // Power iteration
+            const float next[3] = { cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                                    cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                                    cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2] };
+            const float length = sqrtf(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+            if (length < 1e-6f) break;                                         // Flat block: keep the grey axis
+            for (int c = 0; c < 3; ++c) axis[c] = next[c] / length;
+        }
+        float lo = 1e30f, hi = -1e30f;
+        for (int i = 0; i < 16; ++i) {
+            const float t = (rgb[i][0] - mean[0]) * axis[0] + (rgb[i][1] - mean[1]) * axis[1] + (rgb[i][2] - mean[2]) * axis[2];
+            lo = std::min(lo, t);
+            hi = std::max(hi, t);
+        }
+        float end0[3], end1[3];
+        for (int c = 0; c < 3; ++c) {
+            end0[c] = mean[c] + axis[c] * hi;
+            end1[c] = mean[c] + axis[c] * lo;
+        }
+        uint16_t c0 = pack565(end0), c1 = pack565(end1);
+        if (c0 < c1) std::swap(c0, c1);                                        // c0 > c1 selects four colours
+
+        int palette[4][3];
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        uint32_t indices = 0;
+        if (c0 != c1) {                                                        // Equal endpoints: all index 0
+            for (int i = 0; i < 16; ++i) {
+                int best = 0, bestError = 1 << 30;
+                for (int p = 0; p < 4; ++p) {
+                    const int dr = rgb[i][0] - palette[p][0], dg = rgb[i][1] - palette[p][1], db = rgb[i][2] - palette[p][2];
+                    const int error = dr * dr + dg * dg + db * db;
+                    if (error < bestError) { bestError = error; best = p; }
+                }
+                indices |= (uint32_t)best << (2 * i);
+            }
+        }
+        out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+        out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+        for (int i = 0; i < 4; ++i) out[4 + i] = (unsigned char)(indices >> (8 * i));
+    }
+
+    // Blocks in row order from the first (bottom) row; edge blocks repeat
+    // their last texel
+    std::vector<unsigned char> encodeBC1(const Level& level) {
+        const int blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+        std::vector<unsigned char> out((size_t)blocksX * blocksY * 8);
+        for (int by = 0; by < blocksY; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                int rgb[16][3];
+                for (int i = 0; i < 16; ++i) {
+                    const int x = std::min(level.width - 1, bx * 4 + (i & 3));
+                    const int y = std::min(level.height - 1, by * 4 + (i >> 2));
+                    const unsigned char* bgr = &level.bgr[((size_t)y * level.width + x) * 3];
+                    rgb[i][0] = bgr[2]; rgb[i][1] = bgr[1]; rgb[i][2] = bgr[0];
+                }
+                encodeBlock(rgb, &out[((size_t)by * blocksX + bx) * 8]);
+            }
+        }
+        return out;
+    }
+
+    double psnrBC1(const Level& level, const std::vector<unsigned char>& blocks) {
+        const int blocksX = (level.width + 3) / 4;
+        double squared = 0.0;
+        for (int y = 0; y < level.height; ++y) {
+            for (int x = 0; x < level.width; ++x) {
+                const unsigned char* block = &blocks[((size_t)(y / 4) * blocksX + x / 4) * 8];
+                const uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8)), c1 = (uint16_t)(block[2] | (block[3] << 8));
+                int palette[4][3];
+                unpack565(c0, palette[0]);
+                unpack565(c1, palette[1]);
+                for (int c = 0; c < 3; ++c) {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                const int i = (y & 3) * 4 + (x & 3);
+                const int index = (block[4 + i / 4] >> (2 * (i & 3))) & 3;
+                const unsigned char* bgr = &level.bgr[((size_t)y * level.width + x) * 3];
+                for (int c = 0; c < 3; ++c) {
+                    const double d = (double)bgr[2 - c] - palette[index][c];
+                    squared += d * d;
+                }
+            }
+        }
+        const double mse = squared / ((double)level.width * level.height * 3.0);
+        return mse <= 0.0 ? 99.0 : 10.0 * log10(255.0 * 255.0 / mse);
+    }
+
+    std::vector<unsigned char> paddedRows(const Level& level) {
+        const size_t stride = ((size_t)level.width * 3 + 3) & ~(size_t)3;
+        std::vector<unsigned char> out(stride * level.height, 0);
+        for (int y = 0; y < level.height; ++y) {
+            memcpy(&out[stride * y], &level.bgr[(size_t)y * level.width * 3], (size_t)level.width * 3);
+        }
+        return out;
+    }
+
+    bool writeCooked(const std::string& path, CookedTexture::Format format, const std::vector<Level>& levels,
+                     const std::vector<std::vector<unsigned char>>& payloads) {
+        CookedTexture::Header header = { CookedTexture::kMagic, CookedTexture::kVersion, (uint32_t)format,
+                                         (uint32_t)levels[0].width, (uint32_t)levels[0].height, (uint32_t)levels.size() };
+        std::vector<CookedTexture::Level> table(levels.size());
+        size_t offset = sizeof(header) + table.size() * sizeof(CookedTexture::Level);
+        for (size_t i = 0; i < levels.size(); ++i) {
+            offset = (offset + 15) & ~(size_t)15;
+            table[i] = { (uint32_t)offset, (uint32_t)payloads[i].size(), (uint32_t)levels[i].width, (uint32_t)levels[i].height };
+            offset += payloads[i].size();
+        }
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        fwrite(&header, sizeof(header), 1, f);
+        fwrite(table.data(), sizeof(CookedTexture::Level), table.size(), f);
+        for (size_t i = 0; i < levels.size(); ++i) {
+            static const unsigned char zeros[16] = { 0 };
+            fwrite(zeros, 1, table[i].offset - (size_t)ftell(f), f);
+            fwrite(payloads[i].data(), 1, payloads[i].size(), f);
+        }
+        const bool ok = ferror(f) == 0;
+        fclose(f);
+        return ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    CookedTexture::Format format = CookedTexture::FORMAT_BC1;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--bgr")) format = CookedTexture::FORMAT_BGR;
+        else if (argv[i][0] == '-') { fprintf(stderr, "usage: cook_textures [--bgr] [FILE.bmp | DIR]...\n"); return 1; }
+        else inputs.push_back(argv[i]);
+    }
+    if (inputs.empty()) { inputs.push_back("texturess"); inputs.push_back("."); }
+
+    std::vector<std::string> sources;
+    for (const std::string& input : inputs) {
+        if (isDirectory(input)) listBitmaps(input, sources);
+        else sources.push_back(input);
+    }
+    if (sources.empty()) {
+        fprintf(stderr, "No .bmp files to cook\n");
+        return 1;
+    }
+    for (int i = 0; i < 256; ++i) sLinear[i] = powf(i / 255.0f, 2.2f);
+
+    printf("%-38s %11s %6s %10s %10s %10s %7s %8s\n", "texture", "size", "levels", "before KB", "after KB", "file KB", "PSNR", "cook ms");
+    size_t before = 0, after = 0, fileBytes = 0;
+    int failures = 0;
+    for (const std::string& source : sources) {
+        const Clock::time_point start = Clock::now();
+        std::vector<Level> levels(1);
+        if (!loadTopLevel(source.c_str(), levels[0])) { ++failures; continue; }
+        while (levels.back().width > 1 || levels.back().height > 1) levels.push_back(downsample(levels.back()));
+
+        std::vector<std::vector<unsigned char>> payloads;
+        for (const Level& level : levels) payloads.push_back(format == CookedTexture::FORMAT_BC1 ? encodeBC1(level) : paddedRows(level));
+
+        const std::string target = CookedTexture::pathFor(source.c_str());
+        if (!writeCooked(target, format, levels, payloads)) {
+            printf("ERROR: Could not write '%s'\n", target.c_str());
+            ++failures;
+            continue;
+        }
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        CookedTexture::Texture cooked;
+        if (!CookedTexture::open(target.c_str(), cooked)) { ++failures; continue; }
+        const size_t was = CookedTexture::gpuBytesRGB(levels[0].width, levels[0].height);
+        const size_t now = CookedTexture::gpuBytes(cooked);
+        char size[32], psnr[16];
+        snprintf(size, sizeof(size), "%dx%d", levels[0].width, levels[0].height);
+        if (format == CookedTexture::FORMAT_BC1) snprintf(psnr, sizeof(psnr), "%.1f", psnrBC1(levels[0], payloads[0]));
+        else snprintf(psnr, sizeof(psnr), "-");
+        printf("%-38s %11s %6zu %10.0f %10.0f %10.0f %7s %8.1f\n", source.c_str(), size, levels.size(),
+               was / 1024.0, now / 1024.0, cooked.file.size / 1024.0, psnr, ms);
+        before += was;
+        after += now;
+        fileBytes += cooked.file.size;
+    }
+    printf("%zu textures cooked as %s: GPU memory %.2f MB -> %.2f MB, %.2f MB on disk\n",
+           sources.size() - failures, format == CookedTexture::FORMAT_BC1 ? "BC1 + mips" : "BGR + mips",
+           before / (1024.0 * 1024.0), after / (1024.0 * 1024.0), fileBytes / (1024.0 * 1024.0));
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include "cooked_texture.h"
+#include "gl_ext.h"
+#include <cstdio>
+#include <cstring>
+
+namespace CookedTexture {
+    Texture::~Texture() { close(*this); }
+
+    size_t Texture::bytes() const {
+        size_t total = 0;
+        for (int i = 0; i < levelCount; ++i) total += levels[i].size;
+        return total;
+    }
+
+    std::string pathFor(const char* sourcePath) {
+        std::string path = sourcePath;
+        const size_t dot = path.find_last_of("./\\");
+        if (dot != std::string::npos && path[dot] == '.') path.erase(dot);
+        return path + ".mtex";
+    }
+
+    bool open(const char* path, Texture& out) {
+        close(out);
+        if (!Platform::mapFile(path, out.file)) return false;
+
+        // The file is written by cook_textures on a little-endian machine, and
+        // the mapping is page-aligned, so the header can be read in place
+        const unsigned char* data = out.file.data;
+        const size_t size = out.file.size;
+        const Header* header = (const Header*)data;
+        const Level* levels = (const Level*)(data + sizeof(Header));
+        bool valid = size >= sizeof(Header) && header->magic == kMagic && header->version == kVersion &&
+            (header->format == FORMAT_BGR || header->format == FORMAT_BC1) &&
+            header->levelCount >= 1 && header->levelCount <= (uint32_t)kMaxLevels &&
+            sizeof(Header) + header->levelCount * sizeof(Level) <= size;
+        for (uint32_t i = 0; valid && i < header->levelCount; ++i) {
+            valid = levels[i].offset <= size && levels[i].size <= size - levels[i].offset;
+        }
+        if (!valid) {
+            printf("ERROR: '%s' is not a cooked texture this build can read\n", path);
+            close(out);
+            return false;
+        }
+
+        out.format = (Format)header->format;
+        out.width = (int)header->width;
+        out.height = (int)header->height;
+        out.levelCount = (int)header->levelCount;
+        out.levels = levels;
+
+        volatile unsigned char sink = 0;                    // Page the levels in here, not in the upload
+        for (size_t offset = 0; offset < size; offset += 4096) sink = sink + data[offset];
+        (void)sink;
+        return true;
+    }
+
+    void close(Texture& texture) {
+        Platform::unmapFile(texture.file);
+        texture.levels = nullptr;
+        texture.levelCount = 0;
+        texture.width = texture.height = 0;
+    }
+
+    bool canUpload(const Texture& texture) {
+        return texture.levels && (texture.format != FORMAT_BC1 || GLExt::hasS3tc);
+    }
+
+    void upload(const Texture& texture) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        for (int i = 0; i < texture.levelCount; ++i) {
+            const Level& level = texture.levels[i];
+            const unsigned char* pixels = texture.file.data + level.offset;
+            if (texture.format == FORMAT_BC1) {
+                GLExt::CompressedTexImage2D(GL_TEXTURE_2D, i, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width, level.height, 0,
+                                            (GLsizei)level.size, pixels);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, i, GL_RGB, level.width, level.height, 0, GL_BGR, GL_UNSIGNED_BYTE, pixels);
+            }
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    }
+
+    size_t gpuBytes(const Texture& texture) {
+        if (texture.format == FORMAT_BC1) return texture.bytes();
+        size_t total = 0;
+        for (int i = 0; i < texture.levelCount; ++i) total += gpuBytesRGB(texture.levels[i].width, texture.levels[i].height);
+        return total;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "platform.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Textures cooked offline by cook_textures: the whole mip chain, stored either
+// as BGR rows (padded to 4 bytes, like a BMP) or as BC1 (DXT1) blocks, behind a
+// small header, so the runtime maps the file and uploads every level straight
+// out of it.
+//
+// File layout, little-endian:
+//   Header                    magic "MTEX", version, format, width, height, levelCount
+//   Level[levelCount]         offset, size, width, height; largest level first
+//   level data                each level starts on a 16-byte boundary
+// Rows and block rows run bottom-up, the order glTexImage2D expects.
+namespace CookedTexture {
+    const uint32_t kMagic = 0x5845544Du;       // "MTEX"
+    const uint32_t kVersion = 1;
+    const int kMaxLevels = 16;
+
+    enum Format : uint32_t {
+        FORMAT_BGR = 0,
+        FORMAT_BC1 = 1,
+    };
+
+    struct Header {
+        uint32_t magic, version, format;
+        uint32_t width, height, levelCount;
+    };
+
+    struct Level {
+        uint32_t offset, size;                 // Bytes from the start of the file
+        uint32_t width, height;
+    };
+
+    struct Texture {
+        Format format = FORMAT_BGR;
+        int width = 0;
+        int height = 0;
+        int levelCount = 0;
+        const Level* levels = nullptr;         // Into the mapping; null when closed
+        Platform::MappedFile file;
+
+        Texture() = default;
+        Texture(const Texture&) = delete;      // Owns the mapping
+        Texture& operator=(const Texture&) = delete;
+        ~Texture();
+
+        size_t bytes() const;                  // All levels as stored
+    };
+
+    // Where cook_textures writes the cooked form of a source: "a/b.bmp" -> "a/b.mtex"
+    std::string pathFor(const char* sourcePath);
+
+    // Maps and validates a cooked file and touches its pages. A missing file
+    // returns false quietly (the caller falls back to the source); a broken
+    // one says why.
+    bool open(const char* path, Texture& out);
+    void close(Texture& texture);
+
+    // BC1 needs GLExt::hasS3tc, so GLExt::init() must have run
+    bool canUpload(const Texture& texture);
+
+    // Every level into the bound GL_TEXTURE_2D, with trilinear minification
+    void upload(const Texture& texture);
+
+    // What the driver holds once uploaded: BC1 as stored, 4 bytes a texel for
+    // uncompressed RGB (drivers pad it to RGBX)
+    size_t gpuBytes(const Texture& texture);
+    inline size_t gpuBytesRGB(int width, int height) { return (size_t)width * height * 4; }
+}
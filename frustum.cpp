@@ -0,0 +1,84 @@
+#include "frustum.h"
+#include "platform.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    void cross(const float a[3], const float b[3], float out[3]) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    // The point on all three planes (a, b, c, d with ax + by + cz + d = 0)
+    void intersect(const float* p1, const float* p2, const float* p3, float out[3]) {
+        float c23[3], c31[3], c12[3];
+        cross(p2, p3, c23);
+        cross(p3, p1, c31);
+        cross(p1, p2, c12);
+        const float det = p1[0] * c23[0] + p1[1] * c23[1] + p1[2] * c23[2];
+        for (int k = 0; k < 3; ++k) {
+            out[k] = det != 0.0f ? -(p1[3] * c23[k] + p2[3] * c31[k] + p3[3] * c12[k]) / det : 0.0f;
+        }
+    }
+}
+
+Frustum Frustum::fromCurrentMatrices() {
+    float projection[16], modelview[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    return fromMatrices(projection, modelview);
+}
+
+Frustum Frustum::fromMatrices(const float p[16], const float m[16]) {
+    // clip = projection * modelview, both column-major
+    float c[16];
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            c[col * 4 + row] = p[row] * m[col * 4] + p[4 + row] * m[col * 4 + 1] +
+                               p[8 + row] * m[col * 4 + 2] + p[12 + row] * m[col * 4 + 3];
+        }
+    }
+
+    // Gribb/Hartmann: each plane is row 3 plus or minus row 0, 1 or 2
+    Frustum f;
+    for (int i = 0; i < 6; ++i) {
+        const int axis = i / 2;
+        const float sign = (i & 1) ? -1.0f : 1.0f;
+        float length = 0.0f;
+        for (int k = 0; k < 4; ++k) {
+            f.planes[i][k] = c[k * 4 + 3] + sign * c[k * 4 + axis];
+            if (k < 3) length += f.planes[i][k] * f.planes[i][k];
+        }
+        length = sqrtf(length);
+        if (length > 0.0f) for (int k = 0; k < 4; ++k) f.planes[i][k] /= length;
+    }
+
+    // Modelview is a rigid transform (the background adds a translation at
+    // most), so the eye is -R^T t
+    for (int k = 0; k < 3; ++k) {
+        f.eye[k] = -(m[k * 4] * m[12] + m[k * 4 + 1] * m[13] + m[k * 4 + 2] * m[14]);
+    }
+
+    // The far corners are the furthest, for perspective and orthographic alike
+    f.reach = 0.0f;
+    for (int corner = 0; corner < 4; ++corner) {
+        float p[3];
+        intersect(f.planes[5], f.planes[corner & 1], f.planes[2 + (corner >> 1)], p);
+        const float dx = p[0] - f.eye[0], dy = p[1] - f.eye[1], dz = p[2] - f.eye[2];
+        f.reach = std::max(f.reach, sqrtf(dx * dx + dy * dy + dz * dz));
+    }
+    return f;
+}
+
+bool Frustum::boxVisible(const float min[3], const float max[3]) const {
+    for (int i = 0; i < 6; ++i) {
+        const float* pl = planes[i];
+        // The corner furthest along the plane normal
+        const float x = pl[0] >= 0.0f ? max[0] : min[0];
+        const float y = pl[1] >= 0.0f ? max[1] : min[1];
+        const float z = pl[2] >= 0.0f ? max[2] : min[2];
+        if (pl[0] * x + pl[1] * y + pl[2] * z + pl[3] < 0.0f) return false;
+    }
+    return true;
+}
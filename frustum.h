@@ -0,0 +1,19 @@
+#pragma once
+
+// View frustum of the current GL matrices, for culling world-space boxes.
+//
+// fromCurrentMatrices() reads GL_PROJECTION and GL_MODELVIEW, so boxes are
+// tested in whatever space the modelview maps from (world space for the
+// background, which draws in absolute coordinates). Planes point inwards;
+// a box is culled only when it is entirely behind one of them, so the test
+// is conservative near the frustum's corners.
+struct Frustum {
+    float planes[6][4];     // a, b, c, d with ax + by + cz + d >= 0 inside
+    float eye[3];           // Camera position in the same space
+    float reach;            // Distance from the eye to the farthest corner; nothing further is visible
+
+    static Frustum fromCurrentMatrices();
+    static Frustum fromMatrices(const float projection[16], const float modelview[16]);
+
+    bool boxVisible(const float min[3], const float max[3]) const;
+};
@@ -0,0 +1,118 @@
+#include "gl_ext.h"
+#include <cstdio>
+#include <cstring>
+
+namespace GLExt {
+    GenBuffersFn    GenBuffers = nullptr;
+    DeleteBuffersFn DeleteBuffers = nullptr;
+    BindBufferFn    BindBuffer = nullptr;
+    BufferDataFn    BufferData = nullptr;
+    BufferSubDataFn BufferSubData = nullptr;
+    bool hasVertexBuffers = false;
+
+    CreateShaderFn             CreateShader = nullptr;
+    ShaderSourceFn             ShaderSource = nullptr;
+    CompileShaderFn            CompileShader = nullptr;
+    GetShaderivFn              GetShaderiv = nullptr;
+    GetShaderInfoLogFn         GetShaderInfoLog = nullptr;
+    DeleteShaderFn             DeleteShader = nullptr;
+    CreateProgramFn            CreateProgram = nullptr;
+    AttachShaderFn             AttachShader = nullptr;
+    BindAttribLocationFn       BindAttribLocation = nullptr;
+    LinkProgramFn              LinkProgram = nullptr;
+    GetProgramivFn             GetProgramiv = nullptr;
+    GetProgramInfoLogFn        GetProgramInfoLog = nullptr;
+    DeleteProgramFn            DeleteProgram = nullptr;
+    UseProgramFn               UseProgram = nullptr;
+    GetUniformLocationFn       GetUniformLocation = nullptr;
+    Uniform1iFn                Uniform1i = nullptr;
+    Uniform1fFn                Uniform1f = nullptr;
+    UniformMatrix4fvFn         UniformMatrix4fv = nullptr;
+    VertexAttribPointerFn      VertexAttribPointer = nullptr;
+    EnableVertexAttribArrayFn  EnableVertexAttribArray = nullptr;
+    DisableVertexAttribArrayFn DisableVertexAttribArray = nullptr;
+    bool hasShaders = false;
+
+    CompressedTexImage2DFn CompressedTexImage2D = nullptr;
+    bool hasS3tc = false;
+
+    // Core name first, then the ARB alias older drivers expose
+    template <typename Fn>
+    static bool load(Fn& fn, const char* name, const char* arbName) {
+        fn = (Fn)Platform::getProcAddress(name);
+        if (!fn && arbName) fn = (Fn)Platform::getProcAddress(arbName);
+        return fn != nullptr;
+    }
+
+    void init() {
+        hasVertexBuffers =
+            load(GenBuffers, "glGenBuffers", "glGenBuffersARB") &
+            load(DeleteBuffers, "glDeleteBuffers", "glDeleteBuffersARB") &
+            load(BindBuffer, "glBindBuffer", "glBindBufferARB") &
+            load(BufferData, "glBufferData", "glBufferDataARB") &
+            load(BufferSubData, "glBufferSubData", "glBufferSubDataARB");
+
+        // The ARB_shader_objects names use handle types of their own, so only
+        // the 2.0 core entry points are accepted here
+        hasShaders =
+            load(CreateShader, "glCreateShader", nullptr) &
+            load(ShaderSource, "glShaderSource", nullptr) &
+            load(CompileShader, "glCompileShader", nullptr) &
+            load(GetShaderiv, "glGetShaderiv", nullptr) &
+            load(GetShaderInfoLog, "glGetShaderInfoLog", nullptr) &
+            load(DeleteShader, "glDeleteShader", nullptr) &
+            load(CreateProgram, "glCreateProgram", nullptr) &
+            load(AttachShader, "glAttachShader", nullptr) &
+            load(BindAttribLocation, "glBindAttribLocation", nullptr) &
+            load(LinkProgram, "glLinkProgram", nullptr) &
+            load(GetProgramiv, "glGetProgramiv", nullptr) &
+            load(GetProgramInfoLog, "glGetProgramInfoLog", nullptr) &
+            load(DeleteProgram, "glDeleteProgram", nullptr) &
+            load(UseProgram, "glUseProgram", nullptr) &
+            load(GetUniformLocation, "glGetUniformLocation", nullptr) &
+            load(Uniform1i, "glUniform1i", nullptr) &
+            load(Uniform1f, "glUniform1f", nullptr) &
+            load(UniformMatrix4fv, "glUniformMatrix4fv", nullptr) &
+            load(VertexAttribPointer, "glVertexAttribPointer", nullptr) &
+            load(EnableVertexAttribArray, "glEnableVertexAttribArray", nullptr) &
+            load(DisableVertexAttribArray, "glDisableVertexAttribArray", nullptr);
+
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+        hasS3tc = load(CompressedTexImage2D, "glCompressedTexImage2D", "glCompressedTexImage2DARB") &&
+            extensions && strstr(extensions, "GL_EXT_texture_compression_s3tc");
+
+        printf("GL extensions: vertex buffers %s, shaders %s, S3TC %s\n",
+            hasVertexBuffers ? "yes" : "no", hasShaders ? "yes" : "no", hasS3tc ? "yes" : "no");
+    }
+
+    GLuint buildVertexProgram(const char* name, const char* source, const char* const* attributes, int attributeCount) {
+        if (!hasShaders) return 0;
+        char log[1024];
+
+        GLuint shader = CreateShader(GL_VERTEX_SHADER);
+        ShaderSource(shader, 1, &source, nullptr);
+        CompileShader(shader);
+        GLint ok = GL_FALSE;
+        GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            GetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            printf("ERROR: %s vertex shader failed to compile:\n%s\n", name, log);
+            DeleteShader(shader);
+            return 0;
+        }
+
+        GLuint program = CreateProgram();
+        AttachShader(program, shader);
+        for (int i = 0; i < attributeCount; ++i) BindAttribLocation(program, (GLuint)(i + 1), attributes[i]); // 0 aliases gl_Vertex
+        LinkProgram(program);
+        DeleteShader(shader); // Stays alive while attached
+        GetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            GetProgramInfoLog(program, sizeof(log), nullptr, log);
+            printf("ERROR: %s program failed to link:\n%s\n", name, log);
+            DeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "platform.h"
+#include <cstddef>
+
+// GL entry points beyond 1.1 (opengl32.dll stops there), resolved at runtime
+// through Platform::getProcAddress. Call GLExt::init() once a context is
+// current; each has* flag says whether the matching group of pointers is usable
+// and callers keep their immediate-mode path for when it is not.
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER             0x8892
+#define GL_ELEMENT_ARRAY_BUFFER     0x8893
+#define GL_STREAM_DRAW              0x88E0
+#define GL_STATIC_DRAW              0x88E4
+#define GL_DYNAMIC_DRAW             0x88E8
+#endif
+
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER            0x8B31
+#define GL_COMPILE_STATUS           0x8B81
+#define GL_LINK_STATUS              0x8B82
+#define GL_INFO_LOG_LENGTH          0x8B84
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+namespace GLExt {
+    typedef ptrdiff_t SizeiPtr;
+    typedef ptrdiff_t IntPtr;
+
+    // --- Buffer objects (GL 1.5 / ARB_vertex_buffer_object) ---
+    typedef void (APIENTRY* GenBuffersFn)(GLsizei n, GLuint* buffers);
+    typedef void (APIENTRY* DeleteBuffersFn)(GLsizei n, const GLuint* buffers);
+    typedef void (APIENTRY* BindBufferFn)(GLenum target, GLuint buffer);
+    typedef void (APIENTRY* BufferDataFn)(GLenum target, SizeiPtr size, const void* data, GLenum usage);
+    typedef void (APIENTRY* BufferSubDataFn)(GLenum target, IntPtr offset, SizeiPtr size, const void* data);
+
+    extern GenBuffersFn    GenBuffers;
+    extern DeleteBuffersFn DeleteBuffers;
+    extern BindBufferFn    BindBuffer;
+    extern BufferDataFn    BufferData;
+    extern BufferSubDataFn BufferSubData;
+    extern bool hasVertexBuffers;
+
+    // --- GLSL programs (GL 2.0) ---
+    typedef char Char;
+    typedef GLuint(APIENTRY* CreateShaderFn)(GLenum type);
+    typedef void (APIENTRY* ShaderSourceFn)(GLuint shader, GLsizei count, const Char* const* strings, const GLint* lengths);
+    typedef void (APIENTRY* CompileShaderFn)(GLuint shader);
+    typedef void (APIENTRY* GetShaderivFn)(GLuint shader, GLenum pname, GLint* params);
+    typedef void (APIENTRY* GetShaderInfoLogFn)(GLuint shader, GLsizei maxLength, GLsizei* length, Char* infoLog);
+    typedef void (APIENTRY* DeleteShaderFn)(GLuint shader);
+    typedef GLuint(APIENTRY* CreateProgramFn)();
+    typedef void (APIENTRY* AttachShaderFn)(GLuint program, GLuint shader);
+    typedef void (APIENTRY* BindAttribLocationFn)(GLuint program, GLuint index, const Char* name);
+    typedef void (APIENTRY* LinkProgramFn)(GLuint program);
+    typedef void (APIENTRY* GetProgramivFn)(GLuint program, GLenum pname, GLint* params);
+    typedef void (APIENTRY* GetProgramInfoLogFn)(GLuint program, GLsizei maxLength, GLsizei* length, Char* infoLog);
+    typedef void (APIENTRY* DeleteProgramFn)(GLuint program);
+    typedef void (APIENTRY* UseProgramFn)(GLuint program);
+    typedef GLint(APIENTRY* GetUniformLocationFn)(GLuint program, const Char* name);
+    typedef void (APIENTRY* Uniform1iFn)(GLint location, GLint v0);
+    typedef void (APIENTRY* Uniform1fFn)(GLint location, GLfloat v0);
+    typedef void (APIENTRY* UniformMatrix4fvFn)(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    typedef void (APIENTRY* VertexAttribPointerFn)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+    typedef void (APIENTRY* EnableVertexAttribArrayFn)(GLuint index);
+    typedef void (APIENTRY* DisableVertexAttribArrayFn)(GLuint index);
+
+    extern CreateShaderFn             CreateShader;
+    extern ShaderSourceFn             ShaderSource;
+    extern CompileShaderFn            CompileShader;
+    extern GetShaderivFn              GetShaderiv;
+    extern GetShaderInfoLogFn         GetShaderInfoLog;
+    extern DeleteShaderFn             DeleteShader;
+    extern CreateProgramFn            CreateProgram;
+    extern AttachShaderFn             AttachShader;
+    extern BindAttribLocationFn       BindAttribLocation;
+    extern LinkProgramFn              LinkProgram;
+    extern GetProgramivFn             GetProgramiv;
+    extern GetProgramInfoLogFn        GetProgramInfoLog;
+    extern DeleteProgramFn            DeleteProgram;
+    extern UseProgramFn               UseProgram;
+    extern GetUniformLocationFn       GetUniformLocation;
+    extern Uniform1iFn                Uniform1i;
+    extern Uniform1fFn                Uniform1f;
+    extern UniformMatrix4fvFn         UniformMatrix4fv;
+    extern VertexAttribPointerFn      VertexAttribPointer;
+    extern EnableVertexAttribArrayFn  EnableVertexAttribArray;
+    extern DisableVertexAttribArrayFn DisableVertexAttribArray;
+    extern bool hasShaders;
+
+    // --- Compressed textures (GL 1.3 + EXT_texture_compression_s3tc) ---
+    typedef void (APIENTRY* CompressedTexImage2DFn)(GLenum target, GLint level, GLenum internalFormat, GLsizei width,
+                                                    GLsizei height, GLint border, GLsizei imageSize, const void* data);
+
+    extern CompressedTexImage2DFn CompressedTexImage2D;
+    extern bool hasS3tc;            // BC1 (DXT1) uploads
+
+    // Resolves everything the current context offers; safe to call again
+    void init();
+
+    // Compiles and links a vertex shader (fixed-function fragment stage);
+    // attributes[i] is bound to location i + 1, since 0 aliases gl_Vertex.
+    // Returns 0 and prints the log on failure
+    GLuint buildVertexProgram(const char* name, const char* source, const char* const* attributes, int attributeCount);
+}
@@ -0,0 +1,59 @@
+#include "gl_stats.h"
+
+#include <unordered_map>
+
+namespace GLStats {
+    Counters counters[SUB_COUNT] = {};
+    Counters* sink = &counters[SUB_OTHER];
+    int current = SUB_OTHER;
+
+    // Vertex cost of every compiled list, and the tally for the one being compiled
+    static std::unordered_map<GLuint, unsigned> listCosts;
+    static Counters recording = {};
+    static GLuint recordingList = 0;
+
+    const char* subsystemName(int subsystem) {
+        static const char* names[SUB_COUNT] = {
+            "background", "legs", "arms", "torso/head", "armor", "weapons", "other"
+        };
+        return (subsystem >= 0 && subsystem < SUB_COUNT) ? names[subsystem] : "?";
+    }
+
+    void reset() {
+        for (int i = 0; i < SUB_COUNT; ++i) counters[i] = Counters();
+    }
+
+    void setSubsystem(int subsystem) {
+        current = subsystem;
+        if (recordingList == 0) sink = &counters[subsystem];
+    }
+
+    unsigned totalDrawCalls() {
+        unsigned total = 0;
+        for (int i = 0; i < SUB_COUNT; ++i) total += counters[i].drawCalls;
+        return total;
+    }
+
+    unsigned totalVertices() {
+        unsigned total = 0;
+        for (int i = 0; i < SUB_COUNT; ++i) total += counters[i].vertices;
+        return total;
+    }
+
+    void beginList(GLuint list) {
+        recording = Counters();
+        recordingList = list;
+        sink = &recording;
+    }
+
+    void endList() {
+        if (recordingList != 0) listCosts[recordingList] = recording.vertices;
+        recordingList = 0;
+        sink = &counters[current];
+    }
+
+    unsigned listVertices(GLuint list) {
+        std::unordered_map<GLuint, unsigned>::const_iterator it = listCosts.find(list);
+        return it != listCosts.end() ? it->second : 0;
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "platform.h"
+
+// Per-frame GL submission counters.
+// Include this AFTER the GL headers in a translation unit to route glBegin,
+// glVertex*, the display-list calls and the GLU quadrics through counting
+// wrappers. Build with MULAN_GL_STATS=0 to compile the counting out entirely.
+#ifndef MULAN_GL_STATS
+#define MULAN_GL_STATS 1
+#endif
+
+namespace GLStats {
+    // Which part of the scene submissions are attributed to
+    enum Subsystem {
+        SUB_BACKGROUND = 0,
+        SUB_LEGS,
+        SUB_ARMS,
+        SUB_HEAD,           // Torso, neck and head
+        SUB_ARMOR,
+        SUB_WEAPONS,
+        SUB_OTHER,
+        SUB_COUNT
+    };
+
+    struct Counters {
+        unsigned drawCalls;   // Primitive batches (glBegin, glCallList, GLU stacks)
+        unsigned vertices;    // Vertices submitted, including those replayed from lists
+    };
+
+    extern Counters counters[SUB_COUNT];
+    extern Counters* sink;      // Where submissions are counted right now
+    extern int current;         // Active subsystem
+
+    const char* subsystemName(int subsystem);
+
+    void reset();
+    void setSubsystem(int subsystem);
+    unsigned totalDrawCalls();
+    unsigned totalVertices();
+
+    // Display lists remember what they cost when compiled so a glCallList
+    // is charged for the vertices it replays
+    void beginList(GLuint list);
+    void endList();
+    unsigned listVertices(GLuint list);
+
+    // Attributes everything submitted inside a C++ scope to one subsystem
+    struct Scope {
+        int previous;
+        explicit Scope(int subsystem) : previous(current) { setSubsystem(subsystem); }
+        ~Scope() { setSubsystem(previous); }
+    };
+
+    inline void countedBegin(GLenum mode) { ++sink->drawCalls; glBegin(mode); }
+    inline void countedVertex2f(GLfloat x, GLfloat y) { ++sink->vertices; glVertex2f(x, y); }
+    inline void countedVertex3f(GLfloat x, GLfloat y, GLfloat z) { ++sink->vertices; glVertex3f(x, y, z); }
+    inline void countedVertex3fv(const GLfloat* v) { ++sink->vertices; glVertex3fv(v); }
+
+    inline void countedNewList(GLuint list, GLenum mode) { beginList(list); glNewList(list, mode); }
+    inline void countedEndList() { glEndList(); endList(); }
+    inline void countedCallList(GLuint list) {
+        ++sink->drawCalls;
+        sink->vertices += listVertices(list);
+        glCallList(list);
+    }
+
+    inline void countedDrawArrays(GLenum mode, GLint first, GLsizei count) {
+        ++sink->drawCalls;
+        sink->vertices += count;
+        glDrawArrays(mode, first, count);
+    }
+    inline void countedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+        ++sink->drawCalls;
+        sink->vertices += count;
+        glDrawElements(mode, count, type, indices);
+    }
+
+    // GLU quadrics emit one strip per stack (or loop) of (slices + 1) * 2 vertices
+    inline void countedSphere(GLUquadric* q, GLdouble radius, GLint slices, GLint stacks) {
+        sink->drawCalls += stacks;
+        sink->vertices += stacks * (slices + 1) * 2;
+        gluSphere(q, radius, slices, stacks);
+    }
+    inline void countedCylinder(GLUquadric* q, GLdouble base, GLdouble top, GLdouble height, GLint slices, GLint stacks) {
+        sink->drawCalls += stacks;
+        sink->vertices += stacks * (slices + 1) * 2;
+        gluCylinder(q, base, top, height, slices, stacks);
+    }
+    inline void countedDisk(GLUquadric* q, GLdouble inner, GLdouble outer, GLint slices, GLint loops) {
+        sink->drawCalls += loops;
+        sink->vertices += loops * (slices + 1) * 2;
+        gluDisk(q, inner, outer, slices, loops);
+    }
+}
+
+#if MULAN_GL_STATS
+#define GLSTATS_CONCAT_(a, b)   a##b
+#define GLSTATS_CONCAT(a, b)    GLSTATS_CONCAT_(a, b)
+#define GL_STATS_SCOPE(sub)     GLStats::Scope GLSTATS_CONCAT(glStatsScope_, __LINE__)(GLStats::sub)
+
+#define glBegin(mode)           GLStats::countedBegin(mode)
+#define glVertex2f(x, y)        GLStats::countedVertex2f(x, y)
+#define glVertex3f(x, y, z)     GLStats::countedVertex3f(x, y, z)
+#define glVertex3fv(v)          GLStats::countedVertex3fv(v)
+#define glNewList(list, mode)   GLStats::countedNewList(list, mode)
+#define glEndList()             GLStats::countedEndList()
+#define glCallList(list)        GLStats::countedCallList(list)
+#define glDrawArrays(...)       GLStats::countedDrawArrays(__VA_ARGS__)
+#define glDrawElements(...)     GLStats::countedDrawElements(__VA_ARGS__)
+#define gluSphere(...)          GLStats::countedSphere(__VA_ARGS__)
+#define gluCylinder(...)        GLStats::countedCylinder(__VA_ARGS__)
+#define gluDisk(...)            GLStats::countedDisk(__VA_ARGS__)
+#else
+#define GL_STATS_SCOPE(sub)     ((void)0)
+#endif
@@ -0,0 +1,239 @@
+#include "jobs.h"
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Jobs {
+    struct Job {
+        std::function<void()> work;
+        Counter* counter;
+    };
+
+    // Counter's internals, for the pool
+    struct Pool {
+        static void add(Counter& counter) { counter.pending.fetch_add(1, std::memory_order_relaxed); }
+
+        // Notified under the lock, so a waiter that wakes cannot let the
+        // counter go before this is done with it
+        static void finish(Counter& counter) {
+            std::lock_guard<std::mutex> lock(counter.finishing);
+            if (counter.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) counter.finished.notify_all();
+        }
+
+        // The last finish() has let go of the counter, so it may be destroyed
+        static void settle(Counter& counter) { std::lock_guard<std::mutex> lock(counter.finishing); }
+
+        static void sleepUntilDone(Counter& counter) {
+            std::unique_lock<std::mutex> lock(counter.finishing);
+            counter.finished.wait(lock, [&counter] { return counter.done(); });
+        }
+    };
+
+    namespace {
+        // Jobs by value in a ring that doubles when full and never shrinks,
+        // so a frame's jobs reuse the storage of the frames before
+        struct Deque {
+            std::mutex mutex;
+            std::vector<Job> ring;      // Size a power of two
+            size_t head = 0;            // Oldest job
+            size_t count = 0;
+
+            void pushBack(Job&& job) {
+                if (count == ring.size()) grow();
+                ring[(head + count) & (ring.size() - 1)] = std::move(job);
+                ++count;
+            }
+            bool popBack(Job& out) {
+                if (count == 0) return false;
+                --count;
+                out = std::move(ring[(head + count) & (ring.size() - 1)]);
+                return true;
+            }
+            bool popFront(Job& out) {
+                if (count == 0) return false;
+                out = std::move(ring[head]);
+                head = (head + 1) & (ring.size() - 1);
+                --count;
+                return true;
+            }
+            void grow() {
+                std::vector<Job> larger(std::max<size_t>(16, ring.size() * 2));
+                for (size_t k = 0; k < count; ++k) larger[k] = std::move(ring[(head + k) & (ring.size() - 1)]);
+                ring.swap(larger);
+                head = 0;
+            }
+        };
+
+        // [0, kMaxCallers) belong to threads outside the pool, one each in
+        // the order they first queue a job (past kMaxCallers they share);
+        // pool thread k (1 <= k < threadCount()) owns kMaxCallers + k - 1
+        const int kMaxCallers = 4;
+        Deque deques[kMaxCallers + kMaxThreads - 1];
+        std::atomic<int> callers{ 0 };
+        thread_local int ownDeque = -1;
+
+        std::atomic<int> activeThreads{ 1 };   // Pool threads, counting the caller's
+        std::atomic<int> queued{ 0 };          // Jobs sitting in any deque
+        std::atomic<unsigned> jobsRun{ 0 }, jobsStolen{ 0 };
+
+        std::mutex sleepMutex;
+        std::condition_variable wake;          // Workers: a job was queued, or stop
+        bool stopping = false;
+
+        // A wait() with nothing to take tries this many times before it sleeps
+        const int kSpinsBeforeSleep = 64;
+
+        int own() {
+            if (ownDeque < 0) ownDeque = callers.fetch_add(1, std::memory_order_relaxed) % kMaxCallers;
+            return ownDeque;
+        }
+
+        void push(Job&& job) {
+            {
+                Deque& deque = deques[own()];
+                std::lock_guard<std::mutex> lock(deque.mutex);
+                deque.pushBack(std::move(job));
+            }
+            queued.fetch_add(1, std::memory_order_release);
+            { std::lock_guard<std::mutex> lock(sleepMutex); }
+            wake.notify_one();
+        }
+
+        // Newest from the own deque; on a pool thread, else the oldest from
+        // the next deque with any
+        bool take(Job& out) {
+            const int index = own();
+            {
+                Deque& deque = deques[index];
+                std::lock_guard<std::mutex> lock(deque.mutex);
+                if (deque.popBack(out)) {
+                    queued.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            if (index < kMaxCallers) return false;
+
+            const int dequeCount = kMaxCallers + activeThreads.load(std::memory_order_relaxed) - 1;
+            for (int k = 1; k < dequeCount; ++k) {
+                Deque& deque = deques[(index + k) % dequeCount];
+                std::lock_guard<std::mutex> lock(deque.mutex);
+                if (!deque.popFront(out)) continue;
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                jobsStolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        void execute(Job& job) {
+            job.work();
+            job.work = nullptr;         // Let the captures go before the counter does
+            Pool::finish(*job.counter);
+            jobsRun.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void workerLoop(int index) {
+            ownDeque = kMaxCallers + index - 1;
+            Job job;
+            for (;;) {
+                if (take(job)) {
+                    execute(job);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wake.wait(lock, [] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+                if (stopping) return;
+            }
+        }
+
+        // Joined on exit; started on first use
+        struct Workers {
+            std::vector<std::thread> threads;
+            bool started = false;
+
+            void start(int count) {
+                stopping = false;
+                activeThreads.store(count, std::memory_order_relaxed);
+                for (int k = 1; k < count; ++k) threads.emplace_back(workerLoop, k);
+                started = true;
+            }
+
+            void stop() {
+                {
+                    std::lock_guard<std::mutex> lock(sleepMutex);
+                    stopping = true;
+                }
+                wake.notify_all();
+                for (std::thread& t : threads) t.join();
+                threads.clear();
+            }
+
+            ~Workers() { stop(); }
+        } workers;
+        std::once_flag startOnce;
+
+        void ensureStarted() {
+            std::call_once(startOnce, [] {
+                workers.start(std::max(1, std::min(kMaxThreads, (int)std::thread::hardware_concurrency())));
+            });
+        }
+    }
+
+    void run(Counter& counter, std::function<void()> work) {
+        ensureStarted();
+        Pool::add(counter);
+        push(Job{ std::move(work), &counter });
+    }
+
+    void wait(Counter& counter) {
+        Job job;
+        int idle = 0;
+        while (!counter.done()) {
+            if (take(job)) {
+                execute(job);
+                idle = 0;
+            }
+            // What is left is running on other threads
+            else if (++idle == kSpinsBeforeSleep) Pool::sleepUntilDone(counter);
+        }
+        Pool::settle(counter);
+    }
+
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+        if (count <= grain || threadCount() == 1) {
+            body(0, count);
+            return;
+        }
+        Counter slices;
+        for (size_t begin = grain; begin < count; begin += grain) {
+            const size_t end = std::min(count, begin + grain);
+            run(slices, [&body, begin, end] { body(begin, end); });
+        }
+        body(0, grain);
+        wait(slices);
+    }
+
+    void setThreadCount(int threads) {
+        ensureStarted();
+        workers.stop();
+        workers.start(std::max(1, std::min(kMaxThreads, threads)));
+    }
+
+    int threadCount() {
+        ensureStarted();
+        return activeThreads.load(std::memory_order_relaxed);
+    }
+
+    Stats stats() {
+        return { jobsRun.load(std::memory_order_relaxed), jobsStolen.load(std::memory_order_relaxed) };
+    }
+
+    void resetStats() {
+        jobsRun.store(0, std::memory_order_relaxed);
+        jobsStolen.store(0, std::memory_order_relaxed);
+    }
+}
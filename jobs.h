@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+// Work-stealing jobs for the frame's independent CPU work: both legs'
+// skinning, the animated billboard batches and the siege particle pools.
+//
+// Every pool thread owns a deque of jobs. It pushes and pops its own at the
+// back and, when that runs dry, steals the oldest job from the front of
+// another thread's. Each thread outside the pool (the render and simulation
+// threads) gets a deque of its own on first use; the pool steals from it,
+// but the thread itself only runs its own jobs, so those threads neither
+// share a lock nor pick up each other's work. A Counter counts a group of
+// jobs not yet finished; wait() runs queued jobs while there are any to take
+// and only then sleeps until the counter reaches zero, so a job may start
+// jobs of its own and wait for them (a parallelFor inside a job). Jobs are
+// kept by value in the deques, whose storage is reused, so queueing one
+// allocates nothing beyond what its std::function needs. Jobs run on
+// whichever thread takes them: the caller reads what a job needs and
+// captures it.
+namespace Jobs {
+    // Jobs of a group still to finish. wait() on it before it goes out of scope.
+    class Counter {
+    public:
+        Counter() = default;
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+        bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend struct Pool;
+        std::atomic<int> pending{ 0 };
+        std::mutex finishing;          // Held by the job taking pending to zero
+        std::condition_variable finished;  // wait(): pending reached zero
+    };
+
+    // Queues work on the calling thread's deque, counted by counter until it has run
+    void run(Counter& counter, std::function<void()> work);
+    // Runs queued jobs (this thread's first, then, on a pool thread, stolen
+    // ones) and, once there are none to take, sleeps until counter is done
+    void wait(Counter& counter);
+    // body(begin, end) over [0, count) in slices of grain items; the calling
+    // thread takes the first slice and helps with the rest. Returns once all
+    // have run. One slice, or one thread, runs body on the caller alone.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    const int kMaxThreads = 8;
+
+    // Threads running jobs, counting the one that waits (1 = everything on the
+    // caller). Defaults to the hardware threads, at most kMaxThreads. Only
+    // while no job is queued or running.
+    void setThreadCount(int threads);
+    int threadCount();
+
+    // Jobs run since resetStats(), and how many of them were stolen from
+    // another thread's deque
+    struct Stats {
+        unsigned jobs;
+        unsigned steals;
+    };
+    Stats stats();
+    void resetStats();
+}
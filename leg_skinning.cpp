@@ -0,0 +1,67 @@
+#include "leg_skinning.h"
+#include "jobs.h"
+
+namespace LegSkinning {
+    static void poseRotations(const Pose& pose, Skinning::Quat rotations[2]) {
+        rotations[kHipJoint] = Skinning::axisAngle(1.0f, 0.0f, 0.0f, pose.hipDegrees);
+        rotations[kKneeJoint] = Skinning::axisAngle(1.0f, 0.0f, 0.0f, pose.kneeDegrees);
+    }
+
+    float kneeWeight(float y, const Joints& joints) {
+        if (joints.kneeBlend <= 0.0f) return y <= joints.kneeY ? 1.0f : 0.0f;
+        float t = (joints.kneeY + joints.kneeBlend - y) / (2.0f * joints.kneeBlend);
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    void buildRestPose(const Vec3f* positions, const Vec3f* normals, size_t count, const Joints& joints,
+                       RestPose& out, std::vector<int>& order) {
+        out.skeleton = Skinning::Skeleton();
+        out.skeleton.addJoint(-1, { 0.0f, joints.hipY, joints.hipZ });
+        out.skeleton.addJoint(kHipJoint, { 0.0f, joints.kneeY, joints.kneeZ });
+
+        std::vector<Skinning::VertexWeights> weights(count);
+        for (size_t i = 0; i < count; ++i) {
+            const float w = kneeWeight(positions[i].y, joints);
+            weights[i] = { { kKneeJoint, kHipJoint, 0, 0 }, { w, 1.0f - w, 0.0f, 0.0f } };
+        }
+        Skinning::buildMesh(positions, normals, weights.data(), count, out.mesh, order);
+        out.count = count;
+    }
+
+    void skin(RestPose& rest, const Pose poses[2], Skinning::Method method,
+              Vec3f* const outPositions[2], Vec3f* const outNormals[2]) {
+        // The legs are independent: one job each (a big mesh splits further)
+        Jobs::parallelFor(2, 1, [&](size_t begin, size_t end) {
+            for (size_t leg = begin; leg < end; ++leg) {
+                Skinning::Palette& palette = rest.palettes[leg];
+                Skinning::Quat rotations[2];
+                poseRotations(poses[leg], rotations);
+                Skinning::computePalette(rest.skeleton, rotations, palette);
+                Skinning::skin(rest.mesh, palette, method, poses[leg].mirror, outPositions[leg], outNormals[leg]);
+            }
+        });
+    }
+
+    void boneMatrices(const Joints& joints, const Pose& pose, float thigh[16], float shin[16]) {
+        Skinning::Skeleton skeleton;
+        skeleton.addJoint(-1, { 0.0f, joints.hipY, joints.hipZ });
+        skeleton.addJoint(kHipJoint, { 0.0f, joints.kneeY, joints.kneeZ });
+        Skinning::Quat rotations[2];
+        poseRotations(pose, rotations);
+        Skinning::Palette palette;
+        Skinning::computePalette(skeleton, rotations, palette);
+
+        // Rows of [R | t] -> column-major 4x4, with the mirror folded into row 0
+        float* out[2] = { thigh, shin };
+        for (int j = 0; j < 2; ++j) {
+            const float* m = &palette.matrices[j * 12];
+            for (int col = 0; col < 4; ++col) {
+                out[j][col * 4 + 0] = m[col] * (pose.mirror ? -1.0f : 1.0f);
+                out[j][col * 4 + 1] = m[4 + col];
+                out[j][col * 4 + 2] = m[8 + col];
+                out[j][col * 4 + 3] = col == 3 ? 1.0f : 0.0f;
+            }
+        }
+    }
+}
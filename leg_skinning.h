@@ -0,0 +1,74 @@
+#pragma once
+
+#include "utils.h"
+#include "skinning.h"
+#include <cstddef>
+#include <vector>
+
+// The legs as a two-joint skeleton (hip, then knee) on the shared skinning
+// engine in skinning.h.
+//
+// Vertices near the knee are weighted between thigh and shin over a band of
+// +/- kneeBlend instead of the old hard y <= kneeY cut, so a deep knee bend
+// stretches the skin instead of tearing it. buildRestPose() hands back the
+// vertex order the engine wants; the caller permutes its own arrays to match.
+//
+// The GPU path (leg_skinning_gpu.cpp) does the same linear blend in a vertex
+// shader: the rest pose stays in a static buffer with a knee weight per
+// vertex, and only the two bone matrices change per draw.
+namespace LegSkinning {
+    // Pivot points of the two rotations (about the x axis), in mesh space
+    struct Joints {
+        float kneeY, kneeZ;
+        float hipY, hipZ;
+        float kneeBlend;        // Half-height of the thigh/shin blend band; 0 = hard cut
+    };
+
+    // One leg's pose; a mirrored leg is reflected in x after skinning
+    struct Pose {
+        float hipDegrees;
+        float kneeDegrees;
+        bool mirror;
+    };
+
+    enum { kHipJoint, kKneeJoint };
+
+    struct RestPose {
+        Skinning::Skeleton skeleton;
+        Skinning::Mesh mesh;
+        size_t count = 0;
+        Skinning::Palette palettes[2];  // skin()'s, one per leg; kept so a frame allocates nothing
+    };
+
+    // Shin weight of a rest-pose vertex at height y (1 below the band, 0 above)
+    float kneeWeight(float y, const Joints& joints);
+
+    // Builds the skeleton and the batched mesh; order[k] is the source index of
+    // vertex k in the skinned output
+    void buildRestPose(const Vec3f* positions, const Vec3f* normals, size_t count, const Joints& joints,
+                       RestPose& out, std::vector<int>& order);
+
+    // Writes both legs' skinned positions/normals (count entries each),
+    // posing them in rest.palettes
+    void skin(RestPose& rest, const Pose poses[2], Skinning::Method method,
+              Vec3f* const outPositions[2], Vec3f* const outNormals[2]);
+
+    // Column-major bone matrices for one leg: thigh (hip rotation, then the
+    // mirror) and shin (knee rotation, then the thigh's)
+    void boneMatrices(const Joints& joints, const Pose& pose, float thigh[16], float shin[16]);
+
+    // --- GPU path ---
+    // Vertex attribute location of the per-vertex knee weight (1 = shin, 0 = thigh)
+    const GLuint kKneeWeightAttribute = 1;
+
+    // Compiles the skinning shader; false if GLSL is unavailable or it fails
+    bool initShader();
+    void releaseShader();
+    bool shaderReady();
+
+    // Makes the skinning program current for one leg. The shader reproduces the
+    // fixed-function lighting, texturing and fog inputs of the current GL state,
+    // so the leg matches the CPU path under any render mode.
+    void bindShader(const Joints& joints, const Pose& pose);
+    void unbindShader();
+}
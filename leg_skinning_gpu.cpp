@@ -0,0 +1,102 @@
+#include "leg_skinning.h"
+#include "gl_ext.h"
+
+namespace LegSkinning {
+    namespace {
+        // GLSL 1.10 so any GL 2.0 driver takes it. Lighting follows the
+        // fixed-function equations for the first two lights (positional or
+        // directional, attenuation, spot cone, non-local viewer specular), with
+        // GL_COLOR_MATERIAL tracking ambient and diffuse.
+        const char* kVertexSource =
+            "#version 110\n"
+            "uniform mat4 thighMatrix;\n"
+            "uniform mat4 shinMatrix;\n"
+            "uniform float lighting;\n"
+            "uniform float colorMaterial;\n"
+            "uniform float lightEnabled[2];\n"
+            "attribute float kneeWeight;\n"
+            "\n"
+            "vec4 shade(vec3 eyePos, vec3 N) {\n"
+            "    vec4 ambient = colorMaterial > 0.5 ? gl_Color : gl_FrontMaterial.ambient;\n"
+            "    vec4 diffuse = colorMaterial > 0.5 ? gl_Color : gl_FrontMaterial.diffuse;\n"
+            "    vec4 color = gl_FrontMaterial.emission + ambient * gl_LightModel.ambient;\n"
+            "    for (int i = 0; i < 2; ++i) {\n"
+            "        if (lightEnabled[i] < 0.5) continue;\n"
+            "        vec4 lp = gl_LightSource[i].position;\n"
+            "        vec3 L = lp.w == 0.0 ? normalize(lp.xyz) : normalize(lp.xyz - eyePos);\n"
+            "        float attenuation = 1.0;\n"
+            "        if (lp.w != 0.0) {\n"
+            "            float d = length(lp.xyz - eyePos);\n"
+            "            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +\n"
+            "                gl_LightSource[i].linearAttenuation * d + gl_LightSource[i].quadraticAttenuation * d * d);\n"
+            "            if (gl_LightSource[i].spotCutoff <= 90.0) {\n"
+            "                float spot = dot(-L, normalize(gl_LightSource[i].spotDirection));\n"
+            "                attenuation *= spot < gl_LightSource[i].spotCosCutoff ? 0.0 : pow(spot, gl_LightSource[i].spotExponent);\n"
+            "            }\n"
+            "        }\n"
+            "        float NdotL = max(dot(N, L), 0.0);\n"
+            "        vec4 term = ambient * gl_LightSource[i].ambient + NdotL * diffuse * gl_LightSource[i].diffuse;\n"
+            "        if (NdotL > 0.0) {\n"
+            "            float NdotH = max(dot(N, normalize(L + vec3(0.0, 0.0, 1.0))), 0.0);\n"
+            "            term += pow(NdotH, gl_FrontMaterial.shininess) * gl_FrontMaterial.specular * gl_LightSource[i].specular;\n"
+            "        }\n"
+            "        color += attenuation * term;\n"
+            "    }\n"
+            "    return vec4(clamp(color.rgb, 0.0, 1.0), diffuse.a);\n"
+            "}\n"
+            "\n"
+            "void main() {\n"
+            "    mat4 bone = thighMatrix + kneeWeight * (shinMatrix - thighMatrix);\n"
+            "    vec4 eyePos = gl_ModelViewMatrix * (bone * gl_Vertex);\n"
+            "    vec3 N = normalize(gl_NormalMatrix * (mat3(bone[0].xyz, bone[1].xyz, bone[2].xyz) * gl_Normal));\n"
+            "    gl_FrontColor = lighting > 0.5 ? shade(eyePos.xyz, N) : gl_Color;\n"
+            "    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+            "    gl_FogFragCoord = abs(eyePos.z);\n"
+            "    gl_Position = gl_ProjectionMatrix * eyePos;\n"
+            "}\n";
+
+        GLuint sProgram = 0;
+        GLint sThigh = -1, sShin = -1, sLighting = -1, sColorMaterial = -1, sLightEnabled[2] = { -1, -1 };
+    }
+
+    bool initShader() {
+        if (sProgram) return true;
+        const char* attributes[] = { "kneeWeight" }; // -> kKneeWeightAttribute
+        sProgram = GLExt::buildVertexProgram("leg skinning", kVertexSource, attributes, 1);
+        if (!sProgram) return false;
+        sThigh = GLExt::GetUniformLocation(sProgram, "thighMatrix");
+        sShin = GLExt::GetUniformLocation(sProgram, "shinMatrix");
+        sLighting = GLExt::GetUniformLocation(sProgram, "lighting");
+        sColorMaterial = GLExt::GetUniformLocation(sProgram, "colorMaterial");
+        sLightEnabled[0] = GLExt::GetUniformLocation(sProgram, "lightEnabled[0]");
+        sLightEnabled[1] = GLExt::GetUniformLocation(sProgram, "lightEnabled[1]");
+        return true;
+    }
+
+    void releaseShader() {
+        if (!sProgram) return;
+        GLExt::DeleteProgram(sProgram);
+        sProgram = 0;
+    }
+
+    bool shaderReady() {
+        return sProgram != 0;
+    }
+
+    void bindShader(const Joints& joints, const Pose& pose) {
+        float thigh[16], shin[16];
+        boneMatrices(joints, pose, thigh, shin);
+
+        GLExt::UseProgram(sProgram);
+        GLExt::UniformMatrix4fv(sThigh, 1, GL_FALSE, thigh);
+        GLExt::UniformMatrix4fv(sShin, 1, GL_FALSE, shin);
+        GLExt::Uniform1f(sLighting, glIsEnabled(GL_LIGHTING) ? 1.0f : 0.0f);
+        GLExt::Uniform1f(sColorMaterial, glIsEnabled(GL_COLOR_MATERIAL) ? 1.0f : 0.0f);
+        GLExt::Uniform1f(sLightEnabled[0], glIsEnabled(GL_LIGHT0) ? 1.0f : 0.0f);
+        GLExt::Uniform1f(sLightEnabled[1], glIsEnabled(GL_LIGHT1) ? 1.0f : 0.0f);
+    }
+
+    void unbindShader() {
+        GLExt::UseProgram(0);
+    }
+}
@@ -0,0 +1,121 @@
+#include "log.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+
+namespace {
+    struct Record {
+        std::atomic<unsigned> sequence;    // == position once written, position + 1 once published
+        Log::Level level;
+        char text[Log::kMessageSize];
+    };
+
+    // Bounded multi-producer ring (Vyukov), drained by a single flush()
+    struct Ring {
+        Record records[Log::kRingSize];
+        std::atomic<unsigned> head{ 0 };   // Next position to claim
+        unsigned tail = 0;                 // Next position to flush; flush() only
+        std::atomic<unsigned> dropped{ 0 };
+
+        Ring() {
+            for (unsigned i = 0; i < (unsigned)Log::kRingSize; ++i) records[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    };
+
+    Ring& ring() {
+        static Ring instance;
+        return instance;
+    }
+
+    std::atomic<int> minimumLevel{ LOG_LEVEL_INFO };
+
+    void push(Log::Level level, const char* format, va_list args, const char* suffix) {
+        Ring& r = ring();
+        unsigned position = r.head.load(std::memory_order_relaxed);
+        Record* record;
+        for (;;) {
+            record = &r.records[position & (Log::kRingSize - 1)];
+            const unsigned sequence = record->sequence.load(std::memory_order_acquire);
+            const int lag = (int)(sequence - position);
+            if (lag == 0) {
+                if (r.head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                r.dropped.fetch_add(1, std::memory_order_relaxed);    // Full: the flush is a lap behind
+                return;
+            } else {
+                position = r.head.load(std::memory_order_relaxed);
+            }
+        }
+
+        record->level = level;
+        int length = vsnprintf(record->text, sizeof(record->text), format, args);
+        if (length < 0) length = 0;
+        if (length >= (int)sizeof(record->text)) length = (int)sizeof(record->text) - 1;
+        if (length > 0 && record->text[length - 1] == '\n') record->text[--length] = '\0';
+        if (suffix) snprintf(record->text + length, sizeof(record->text) - length, "%s", suffix);
+        record->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    long long nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+namespace Log {
+    void setLevel(Level level) {
+        minimumLevel.store(level, std::memory_order_relaxed);
+    }
+
+    bool enabled(Level level) {
+        return level >= MULAN_LOG_LEVEL && level >= minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    void write(Level level, const char* format, ...) {
+        if (!enabled(level)) return;
+        va_list args;
+        va_start(args, format);
+        push(level, format, args, nullptr);
+        va_end(args);
+    }
+
+    bool RateLimit::allow(unsigned& suppressed) {
+        const long long now = nowMicros();
+        long long next = nextMicros.load(std::memory_order_relaxed);
+        if (now < next || !nextMicros.compare_exchange_strong(next, now + (long long)(interval * 1e6))) {
+            held.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = held.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    void writeLimited(RateLimit& limit, Level level, const char* format, ...) {
+        unsigned suppressed = 0;
+        if (!enabled(level) || !limit.allow(suppressed)) return;
+        char suffix[48] = "";
+        if (suppressed > 0) snprintf(suffix, sizeof(suffix), " (%u more since the last)", suppressed);
+        va_list args;
+        va_start(args, format);
+        push(level, format, args, suffix);
+        va_end(args);
+    }
+
+    int flush(FILE* out) {
+        Ring& r = ring();
+        int written = 0;
+        for (;;) {
+            Record& record = r.records[r.tail & (kRingSize - 1)];
+            if (record.sequence.load(std::memory_order_acquire) != r.tail + 1) break;
+            const char* prefix = record.level == Error ? "ERROR: " : record.level == Warn ? "Warning: " : "";
+            fprintf(out, "%s%s\n", prefix, record.text);
+            record.sequence.store(r.tail + kRingSize, std::memory_order_release);
+            ++r.tail;
+            ++written;
+        }
+        const unsigned dropped = r.dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) fprintf(out, "Warning: %u log messages dropped (ring full)\n", dropped);
+        if (written > 0 || dropped > 0) fflush(out);
+        return written;
+    }
+}
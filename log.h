@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+
+// Leveled logging for code that runs every frame.
+//
+// LOG_INFO(...) and friends take printf arguments. The message is formatted
+// into a fixed-size record on a ring buffer shared by all threads: a writer
+// claims a slot with one atomic compare-and-swap and publishes it with a
+// sequence number, so it never takes a lock or touches the console. The frame
+// loop calls flush() after the swap, which writes everything queued since
+// the last frame in one go. When the ring is full new messages are dropped
+// and counted, and flush() says how many.
+//
+// Levels below MULAN_LOG_LEVEL (a -D flag, default LOG_LEVEL_INFO) are
+// compiled out: their macros expand to nothing, arguments included.
+// setLevel() raises the bar further at run time. LOG_WARN_EVERY(seconds, ...)
+// lets one message a call site through per interval and counts the rest.
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF   5
+
+#ifndef MULAN_LOG_LEVEL
+#define MULAN_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#if defined(__GNUC__)
+#define LOG_PRINTF_FORMAT(formatIndex, firstArg) __attribute__((format(printf, formatIndex, firstArg)))
+#else
+#define LOG_PRINTF_FORMAT(formatIndex, firstArg)
+#endif
+
+namespace Log {
+    enum Level {
+        Trace = LOG_LEVEL_TRACE,
+        Debug = LOG_LEVEL_DEBUG,
+        Info = LOG_LEVEL_INFO,
+        Warn = LOG_LEVEL_WARN,
+        Error = LOG_LEVEL_ERROR,
+    };
+
+    const int kRingSize = 1024;        // Records; a power of two
+    const int kMessageSize = 240;      // Longer messages are cut
+
+    void setLevel(Level level);
+    bool enabled(Level level);
+
+    // Any thread. Warnings and errors come out prefixed "Warning: " and "ERROR: "
+    void write(Level level, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+
+    // One message per interval from a call site; see LOG_WARN_EVERY
+    class RateLimit {
+    public:
+        explicit RateLimit(double intervalSeconds) : interval(intervalSeconds) {}
+        // True when a message may go out now; suppressed is how many were
+        // held back since the last one
+        bool allow(unsigned& suppressed);
+    private:
+        double interval;
+        std::atomic<long long> nextMicros{ 0 };
+        std::atomic<unsigned> held{ 0 };
+    };
+    void writeLimited(RateLimit& limit, Level level, const char* format, ...) LOG_PRINTF_FORMAT(3, 4);
+
+    // Writes out and releases everything queued. One thread at a time (the
+    // frame loop); returns the number of records written.
+    int flush(FILE* out = stdout);
+}
+
+#if MULAN_LOG_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) Log::write(Log::Trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+#if MULAN_LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Log::write(Log::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#if MULAN_LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) Log::write(Log::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if MULAN_LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) Log::write(Log::Warn, __VA_ARGS__)
+#define LOG_WARN_EVERY(seconds, ...) \
+    do { static Log::RateLimit logLimit(seconds); Log::writeLimited(logLimit, Log::Warn, __VA_ARGS__); } while (0)
+#else
+#define LOG_WARN(...) ((void)0)
+#define LOG_WARN_EVERY(seconds, ...) ((void)0)
+#endif
+#if MULAN_LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Log::write(Log::Error, __VA_ARGS__)
+#define LOG_ERROR_EVERY(seconds, ...) \
+    do { static Log::RateLimit logLimit(seconds); Log::writeLimited(logLimit, Log::Error, __VA_ARGS__); } while (0)
+#else
+#define LOG_ERROR(...) ((void)0)
+#define LOG_ERROR_EVERY(seconds, ...) ((void)0)
+#endif
@@ -1,33 +1,33 @@
-#define NOMINMAX
-#include <Windows.h>
-#include <windowsx.h>
-#include <gl/GL.h>
-#include <gl/GLU.h>
+#include "platform.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <vector>
 #include <cstdio>
 #include<algorithm>
 #include <string>
+#include <atomic>
+#include <cstdlib>
 
+#include "gl_stats.h"
+#include "gl_ext.h"
 #include "utils.h"
+#include "skinning.h"
+#include "leg_skinning.h"
 #include "spear.h"
 #include "shield.h"
 #include "armor.h"
 #include "background.h"
+#include "terrain.h"
 #include "sword.h"
 #include "texture.h"
+#include "texture_manager.h"
+#include "command_list.h"
+#include "jobs.h"
+#include "log.h"
+#include "sim_thread.h"
+#include "triple_buffer.h"
 
 
-#pragma comment(lib, "OpenGL32.lib")
-#pragma comment(lib, "Glu32.lib")
-
-
-// Define GL_BGR if not available
-#ifndef GL_BGR
-#define GL_BGR 0x80E0
-#endif
-
 #define WINDOW_TITLE "Full Body Model Viewer"
 
 // ===================================================================
@@ -49,7 +49,7 @@ RenderMode gRenderMode = RM_TEXTURED;   // default
 
 
 bool  gLMBDown = false;
-POINT gLastMouse = { 0, 0 };
+struct { int x, y; } gLastMouse = { 0, 0 };
 
 // --- Camera State ---
 Vec3  gTarget = { 0.0f, 3.5f, 0.0f };
@@ -61,6 +61,8 @@ float gPitch = 0.1f;
 enum ProjectionMode { PROJ_PERSPECTIVE = 0, PROJ_ORTHOGRAPHIC = 1 };
 ProjectionMode gProjMode = PROJ_PERSPECTIVE;
 bool gViewportMode = false; // false = full viewport, true = split viewport
+CommandList gSplitScene;     // Split viewport: the scene recorded once per frame, replayed in each half
+bool gSplitSceneRecorded = true; // F7 - record once and replay vs render each half
 
 // --- Input State ---
 bool keyW = false, keyS = false, keyA = false, keyD = false; // For Camera
@@ -89,15 +91,15 @@ float g_helmetDomeRotationZ = 0.0f;
 // == Background controls
 bool gBackgroundVisible = true; // Background starts visible
 bool keyK = false; // For Background Toggle
+bool gShowPerfStats = false; // F3 - print background draw calls / CPU time once per second
 
-LARGE_INTEGER gFreq = { 0 }, gPrev = { 0 };
+double gPrevTime = 0.0;
 
 // --- Leg Animation State ---
-float gAnimTime = 0.0f;
 float gWalkSpeed = 0.5f;
 float gRunSpeed = 1.0f;
-bool  gRunningAnim = false;
-bool  gIsMoving = false;
+// Hip and knee angles for the frame (updateLegAngles)
+struct LegAngles { float hipL, kneeL, hipR, kneeR; };
 
 // --- Proportions Control ---
 #define BODY_SCALE 3.5f
@@ -119,18 +121,12 @@ float EYE_SCALE = 1.2f;          // Controls eye size (0.5 = small, 1.0 = normal
 float NOSE_SCALE = 1.0f;         // Controls nose size (0.5 = small, 1.0 = normal, 1.5 = large)
 
 // --- Arm Bend Configuration ---
-float gLeftLowerArmBend = 0.0f;  // Bend angle for left lower arm (positive = bend up)
-float gRightLowerArmBend = 0.0f; // Bend angle for right lower arm (positive = bend up)
 const float MAX_ARM_BEND = 120.0f; // Maximum bend angle in degrees
 
 // --- Slow Arm Bend Controls ---
 float gSlowArmBendSpeed = 30.0f; // Degrees per second for slow arm bending
-bool gSlowArmBendActive = false; // Whether slow arm bending is active
 
 // --- Boxing Stance Animation ---
-bool gInBoxingStance = false;    // Current stance state
-bool gBoxingAnimActive = false;  // Animation in progress
-float gBoxingAnimTime = 0.0f;    // Animation timer
 const float BOXING_ANIM_DURATION = 1.0f; // Animation duration in seconds
 
 // Relaxed pose (arms hanging down)
@@ -146,14 +142,6 @@ const float BOXING_SHOULDER_ROLL = 180.0f;   // 180-degree arm rotation
 const float BOXING_ELBOW_BEND = 90.0f;       // Elbow bent 80-100°
 
 // Current pose values (interpolated)
-float gCurrentLeftShoulderPitch = 0.0f;
-float gCurrentLeftShoulderYaw = 0.0f;
-float gCurrentLeftShoulderRoll = 0.0f;
-float gCurrentLeftElbowBend = 0.0f;
-float gCurrentRightShoulderPitch = 0.0f;
-float gCurrentRightShoulderYaw = 0.0f;
-float gCurrentRightShoulderRoll = 0.0f;
-float gCurrentRightElbowBend = 0.0f;
 
 // Joint visualization
 bool gShowJointVisuals = true;   // Show joint spheres/boxes
@@ -162,86 +150,52 @@ float EYEBROW_SCALE = 1.0f;      // Controls eyebrow thickness (0.5 = thin, 1.0
 float HAIR_SCALE = 1.0f;         // Controls hair volume (0.5 = flat, 1.0 = normal, 1.5 = voluminous)
 
 // --- Animation & Character State ---
-Vec3  gCharacterPos = { 0.0f, 0.0f, 0.0f };
-float gCharacterYaw = 0.0f;
-float gWalkPhase = 0.0f;
-float gMoveSpeed = 0.0f;
 const float WALK_SPEED = 1.8f;    // Enhanced: Slightly slower for more graceful walking
 const float RUN_SPEED = 3.8f;     // Enhanced: Adjusted to maintain good speed ratio
 const float TURN_SPEED = 120.0f;
 
 // --- Fist Animation State ---
-float gFistAnimationTime = 0.0f;
-bool gFistAnimationActive = false;
-bool gIsFist = false; // Current state: false = open hand, true = fist
+// Where this step left the hands, for applyFistHands(): the hand joints are
+// the renderer's (the poses set grips on them as they draw)
+struct FistHands { bool moving, toFist; float blend; };
 const float FIST_ANIMATION_DURATION = 1.0f;
 
 // --- K-pop Dance Animation State ---
-bool gIsDancing = false;
-bool gIsJumping = false; // Keep for compatibility with existing jump logic
-float gJumpPhase = 0.0f;            // Jump phase for original jump function compatibility  
-float gDancePhase = 0.0f;           // Current phase of dance (0.0 to 8.0 for 8-second dance)
-float gDanceTime = 0.0f;            // Total dance time elapsed
-float gJumpVerticalOffset = 0.0f;   // Current vertical position offset (used for dance jumps too)
 const float DANCE_SPEED = 4.0f;     // Dance animation speed multiplier
 const float DANCE_DURATION = 8.0f;  // Total dance sequence duration in seconds
 const float JUMP_HEIGHT = 2.0f;     // Maximum jump height for dance moves
 const float JUMP_DURATION = 0.8f;   // Keep original jump duration for compatibility
 
 // --- Kung Fu Pattern State ---
-int gKungFuPattern = 0; // 0 = normal, 1 = crane, 2 = dragon, 3 = tiger
 bool gConcreteHands = false;
 
 // --- Kung Fu Animation State ---
-bool gKungFuAnimating = false;
-float gKungFuAnimationTime = 0.0f;
-int gKungFuAnimationPhase = 0;
 const float KUNGFU_ANIMATION_SPEED = 2.0f;
 const float PHASE_DURATION = 1.5f; // Duration of each animation phase
 
 // --- Sword Attack Animation State ---
-bool gSwordAttackAnimating = false;
-float gSwordAttackAnimationTime = 0.0f;
-int gSwordAttackPhase = 0; // 0 = ready, 1 = wind up, 2 = strike, 3 = follow through
 const float SWORD_ATTACK_DURATION = 2.5f; // Total attack animation duration - much slower
 const float SWORD_WINDUP_DURATION = 0.8f; // Wind up phase duration - slower dramatic overhead raise
 const float SWORD_STRIKE_DURATION = 0.3f; // Strike phase duration - slower but still powerful
 const float SWORD_FOLLOWTHROUGH_DURATION = 1.4f; // Follow through phase duration - longer recovery
 
 // Sword attack pose offsets
-float gSwordAttackTorsoRotation = 0.0f;
-float gSwordAttackShoulderOffset = 0.0f;
-float gSwordAttackArmExtension = 0.0f;
-float gSwordAttackLegStance = 0.0f;
 
 // --- Spear Attack Animation State ---
-bool gSpearAttackAnimating = false;
-float gSpearAttackAnimationTime = 0.0f;
-int gSpearAttackPhase = 0; // 0 = ready, 1 = wind up, 2 = thrust, 3 = follow through
 const float SPEAR_ATTACK_DURATION = 2.0f; // Total attack animation duration
 const float SPEAR_WINDUP_DURATION = 0.6f; // Wind up phase duration
 const float SPEAR_THRUST_DURATION = 0.4f; // Thrust phase duration
 const float SPEAR_FOLLOWTHROUGH_DURATION = 1.0f; // Follow through phase duration
 
 // Spear attack pose offsets
-float gSpearAttackTorsoRotation = 0.0f;
-float gSpearAttackShoulderOffset = 0.0f;
-float gSpearAttackArmExtension = 0.0f;
-float gSpearAttackLegStance = 0.0f;
 
 // --- Shield Block Animation State ---
-bool gShieldBlockAnimating = false;
-float gShieldBlockAnimationTime = 0.0f;
-int gShieldBlockPhase = 0; // 0 = ready, 1 = raise, 2 = hold, 3 = lower
 const float SHIELD_BLOCK_DURATION = 1.5f; // Total block animation duration
 const float SHIELD_RAISE_DURATION = 0.3f; // Raise phase duration
 const float SHIELD_HOLD_DURATION = 0.6f; // Hold phase duration
 const float SHIELD_LOWER_DURATION = 0.6f; // Lower phase duration
 
 // Shield block pose offsets
-float gShieldBlockArmRaise = 0.0f;
-float gShieldBlockTorsoLean = 0.0f;
-float gShieldBlockStance = 0.0f;
 
 // --- Realistic Hand Form States ---
 enum HandForm {
@@ -272,7 +226,7 @@ struct KungFuPose {
 KungFuPose gCraneSequence[4];
 KungFuPose gDragonSequence[4];
 KungFuPose gTigerSequence[4];
-KungFuPose gCurrentPose, gTargetPose;
+KungFuPose gTargetPose;
 
 // =========================================================
 // == 📍 ENHANCED: NATURAL WALKING ANIMATION CONTROLS ==
@@ -294,17 +248,120 @@ std::vector<Tri>   gTris;
 std::vector<Vec3f> gVertexNormals;
 struct Vec2f { float u, v; };
 std::vector<Vec2f> gTexCoords;
-// These will be modified each frame to create the animation
-std::vector<Vec3f> gAnimatedVertices;
-std::vector<Vec3f> gAnimatedNormals;
-struct JointPose { float torsoYaw, torsoPitch, torsoRoll; float headYaw, headPitch, headRoll; } g_pose = { 0,0,0, 0,0,0 };
+// These will be modified each frame to create the animation, [0] left leg, [1] right leg
+std::vector<Vec3f> gAnimatedVertices[2];
+std::vector<Vec3f> gAnimatedNormals[2];
+// Hip/knee pivots shared by the skinning and the leg armour transforms
+LegSkinning::Joints gLegJoints = { 4.5f, 0.2f, 8.5f, -0.2f, 0.5f };
+// Rest pose in the skinning engine's batched layout (built by partitionLegMesh)
+LegSkinning::RestPose gLegRestPose;
+Skinning::Method gLegSkinningMethod = Skinning::LINEAR_BLEND; // F6 - linear blend vs dual quaternion
+struct JointPose { float torsoYaw, torsoPitch, torsoRoll; float headYaw, headPitch, headRoll; };
 struct HandJoint { Vec3 position; int parentIndex; };
 struct ArmJoint { Vec3 position; int parentIndex; };
 
+// --- Character State ---
+// Everything updateCharacter() advances from step to step. The simulation
+// owns one copy and the renderer draws another, made from the frames the
+// simulation publishes (SECTION 4): the functions that step the character
+// take the first, the ones that draw it take the second as const, and
+// neither reaches for a global.
+struct CharacterState {
+    // Position and movement
+    Vec3  position = { 0.0f, 0.0f, 0.0f };
+    float yaw = 0.0f;
+    float walkPhase = 0.0f;
+    float moveSpeed = 0.0f;
+
+    // Leg animation
+    float animTime = 0.0f;
+    bool  runningAnim = false;
+    bool  isMoving = false;
+    LegAngles legAngles = { 0.0f, 0.0f, 0.0f, 0.0f }; // Hip and knee angles for the step (updateLegAngles)
+
+    // Arm bend
+    float leftLowerArmBend = 0.0f;  // Bend angle for left lower arm (positive = bend up)
+    float rightLowerArmBend = 0.0f; // Bend angle for right lower arm (positive = bend up)
+    bool slowArmBendActive = false; // Whether slow arm bending is active
+
+    // Boxing stance
+    bool inBoxingStance = false;    // Current stance state
+    bool boxingAnimActive = false;  // Animation in progress
+    float boxingAnimTime = 0.0f;    // Animation timer
+
+    // Current arm pose values (interpolated)
+    float currentLeftShoulderPitch = 0.0f;
+    float currentLeftShoulderYaw = 0.0f;
+    float currentLeftShoulderRoll = 0.0f;
+    float currentLeftElbowBend = 0.0f;
+    float currentRightShoulderPitch = 0.0f;
+    float currentRightShoulderYaw = 0.0f;
+    float currentRightShoulderRoll = 0.0f;
+    float currentRightElbowBend = 0.0f;
+
+    // Fist animation
+    float fistAnimationTime = 0.0f;
+    bool fistAnimationActive = false;
+    bool isFist = false; // Current state: false = open hand, true = fist
+    FistHands fistHands = { false, false, 0.0f };
+
+    // K-pop dance and jump
+    bool isDancing = false;
+    bool isJumping = false;         // Keep for compatibility with existing jump logic
+    float jumpPhase = 0.0f;         // Jump phase for original jump function compatibility
+    float dancePhase = 0.0f;        // Current phase of dance (0.0 to 8.0 for 8-second dance); wraps, so never blended
+    float danceTime = 0.0f;         // Total dance time elapsed
+    float jumpVerticalOffset = 0.0f; // Current vertical position offset (used for dance jumps too)
+
+    // Kung fu
+    int kungFuPattern = 0;          // 0 = normal, 1 = crane, 2 = dragon, 3 = tiger
+    bool kungFuAnimating = false;
+    float kungFuAnimationTime = 0.0f;
+    int kungFuAnimationPhase = 0;
+    KungFuPose currentPose = {};
+
+    // Sword attack
+    bool swordAttackAnimating = false;
+    float swordAttackAnimationTime = 0.0f;
+    int swordAttackPhase = 0;       // 0 = ready, 1 = wind up, 2 = strike, 3 = follow through
+    float swordAttackTorsoRotation = 0.0f;
+    float swordAttackShoulderOffset = 0.0f;
+    float swordAttackArmExtension = 0.0f;
+    float swordAttackLegStance = 0.0f;
+
+    // Spear attack
+    bool spearAttackAnimating = false;
+    float spearAttackAnimationTime = 0.0f;
+    int spearAttackPhase = 0;       // 0 = ready, 1 = wind up, 2 = thrust, 3 = follow through
+    float spearAttackTorsoRotation = 0.0f;
+    float spearAttackShoulderOffset = 0.0f;
+    float spearAttackArmExtension = 0.0f;
+    float spearAttackLegStance = 0.0f;
+
+    // Shield block
+    bool shieldBlockAnimating = false;
+    float shieldBlockAnimationTime = 0.0f;
+    int shieldBlockPhase = 0;       // 0 = ready, 1 = raise, 2 = hold, 3 = lower
+    float shieldBlockArmRaise = 0.0f;
+    float shieldBlockTorsoLean = 0.0f;
+    float shieldBlockStance = 0.0f;
+
+    JointPose pose = { 0,0,0, 0,0,0 };
+
+    // The last step jumped the pose rather than moving it (a reset, a dance
+    // or jump starting or ending): it is drawn as the step left it, not
+    // blended in from the one before
+    bool snapped = false;
+};
+
+// The character keys as a step reads them, taken when it is queued (stepSimulation)
+struct CharacterInput { bool keyUp, keydown, keyLeft, keyRight, keyShift, keySlash; };
+
+// The copy display() draws; the simulation steps its own (SECTION 4)
+CharacterState gDrawnCharacter;
+
 // --- Texture Support ---
 GLuint g_HandTexture = 0; // texture name
-BITMAP BMP; // bitmap structure
-HBITMAP hBMP = NULL; // bitmap handle
 bool g_TextureEnabled = true;
 
 // --- Body/Head Data ---
@@ -331,23 +388,6 @@ static void setRenderMode(RenderMode m) {
         glEnable(GL_LIGHTING);
         break;
     }
-
-    // Enhanced texture loading from main2.cpp
-    if (hBMP != NULL) {
-        GetObject(hBMP, sizeof(BMP), &BMP);
-
-        // Assign texture to polygon
-        glEnable(GL_TEXTURE_2D);
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, BMP.bmWidth, BMP.bmHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, BMP.bmBits);
-
-        DeleteObject(hBMP);
-        hBMP = NULL;
-    }
 }
 
 inline void bindConcreteTex() {
@@ -428,6 +468,10 @@ std::vector<HandJoint> g_HandJoints;
 std::vector<HandJoint> g_HandJoints2;
 std::vector<ArmJoint> g_ArmJoints;
 std::vector<ArmJoint> g_ArmJoints2;
+// The arm chains as skinning skeletons (pivots = joint positions), [0] left, [1] right
+Skinning::Skeleton gArmSkeleton[2];
+const int kArmJointCount = 8;
+const int kArmElbowJoint = 3;
 
 // ===================================================================
 //
@@ -683,6 +727,7 @@ void drawSwordTassel() {
 
 // Main sword drawing function
 void drawSword() {
+    GL_STATS_SCOPE(SUB_WEAPONS);
     if (!gSwordVisible) return;
 
     glPushMatrix();
@@ -732,11 +777,20 @@ void drawSword() {
 // ===================================================================
 
 // --- Forward Declarations ---
-LRESULT WINAPI WindowProcedure(HWND, UINT, WPARAM, LPARAM);
+void onKeyDown(int key);
+void onKeyUp(int key);
+void onMouseButton(int x, int y, bool down);
+void onMouseMove(int x, int y);
+void onMouseWheel(int delta);
+void onResize(int width, int height);
+void buildLegMesh(int legSegments = 40);
+void partitionLegMesh();
+void buildLegBuffers();
+void releaseLegBuffers();
 void display();
-void updateCharacter(float dt);
-void drawBodyAndHead(float leftLegAngle, float rightLegAngle, float leftArmAngle, float rightArmAngle); // Updated signature
-void drawArmsAndHands(float leftArmAngle, float rightArmAngle);
+void updateCharacter(CharacterState& character, const CharacterInput& input, float dt);
+void drawBodyAndHead(const CharacterState& character, float leftLegAngle, float rightLegAngle, float leftArmAngle, float rightArmAngle); // Updated signature
+void drawArmsAndHands(const CharacterState& character, float leftArmAngle, float rightArmAngle);
 void drawInternalShoulderJoints();
 void drawCustomFaceShape();
 void drawMulanHead();
@@ -747,34 +801,34 @@ void drawMulanNose();
 void drawMulanMouth();
 void drawMulanHair();
 void initializeFistPositions(); // Add fist animation initialization
-void toggleFistAnimation(); // Add fist animation toggle
-void updateFistAnimation(float deltaTime); // Add fist animation update
-void updateBoxingStance(float deltaTime); // Add boxing stance animation update
-void toggleBoxingStance(); // Add boxing stance toggle
-void startJump(); // Start jump animation
-void startDance(); // Start K-pop dance animation
-void updateDance(); // Update dance animation
-void updateJumpAnimation(float deltaTime); // Update jump animation
-void startSwordAttack(); // Start sword attack animation
-void updateSwordAttackAnimation(float deltaTime); // Update sword attack animation
-void startSpearAttack(); // Start spear attack animation
-void updateSpearAttackAnimation(float deltaTime); // Update spear attack animation
-void startShieldBlock(); // Start shield block animation
-void updateShieldBlockAnimation(float deltaTime); // Update shield block animation
+void toggleFistAnimation(CharacterState& character); // Add fist animation toggle
+void updateFistAnimation(CharacterState& character, float deltaTime); // Add fist animation update
+void updateBoxingStance(CharacterState& character, float deltaTime); // Add boxing stance animation update
+void toggleBoxingStance(CharacterState& character); // Add boxing stance toggle
+void startJump(CharacterState& character); // Start jump animation
+void startDance(CharacterState& character); // Start K-pop dance animation
+void updateDance(CharacterState& character, float deltaTime); // Update dance animation
+void updateJumpAnimation(CharacterState& character, float deltaTime); // Update jump animation
+void startSwordAttack(CharacterState& character); // Start sword attack animation
+void updateSwordAttackAnimation(CharacterState& character, float deltaTime); // Update sword attack animation
+void startSpearAttack(CharacterState& character); // Start spear attack animation
+void updateSpearAttackAnimation(CharacterState& character, float deltaTime); // Update spear attack animation
+void startShieldBlock(CharacterState& character); // Start shield block animation
+void updateShieldBlockAnimation(CharacterState& character, float deltaTime); // Update shield block animation
 Vec3 lerp(const Vec3& a, const Vec3& b, float t); // Linear interpolation
 float smoothStep(float t); // Smooth easing function
 void initializeKungFuSequences(); // Add kung fu animation initialization
-void updateKungFuAnimation(float deltaTime);
-void startKungFuAnimation(int style);
+void updateKungFuAnimation(CharacterState& character, float deltaTime);
+void startKungFuAnimation(CharacterState& character, int style);
 
 // --- Hand Drawing Function Forward Declarations ---
-void drawConcretePalm(const std::vector<HandJoint>& joints);
-void drawConcreteThumb(const std::vector<HandJoint>& joints);
-void drawConcreteFinger(const std::vector<HandJoint>& joints, int mcpIdx, int pipIdx, int dipIdx, int tipIdx);
-void drawSkinnedPalm(const std::vector<HandJoint>& joints);
-void drawSkinnedPalm2(const std::vector<HandJoint>& joints);
-void drawLowPolyThumb(const std::vector<HandJoint>& joints);
-void drawLowPolyFinger(const std::vector<HandJoint>& joints, int mcpIdx, int pipIdx, int dipIdx, int tipIdx);
+static void drawConcretePalm(const std::vector<HandJoint>& joints);
+static void drawConcreteThumb(const std::vector<HandJoint>& joints);
+static void drawConcreteFinger(const std::vector<HandJoint>& joints, int mcpIdx, int pipIdx, int dipIdx, int tipIdx);
+static void drawSkinnedPalm(const std::vector<HandJoint>& joints);
+static void drawSkinnedPalm2(const std::vector<HandJoint>& joints);
+static void drawLowPolyThumb(const std::vector<HandJoint>& joints);
+static void drawLowPolyFinger(const std::vector<HandJoint>& joints, int mcpIdx, int pipIdx, int dipIdx, int tipIdx);
 
 // ======== SKIN TEXTURE HELPERS ========
 inline void useSkinTexture() {
@@ -880,9 +934,9 @@ inline Vec3f rotateY(const Vec3f& v, float ang) {
 }
 
 // --------------------- Build Mesh (Leg + Foot) from leg.cpp ---------------------
-void buildLegMesh() {
+void buildLegMesh(int legSegments) {
     gAllVertices.clear(); gAllQuads.clear();
-    const int legSegments = 40; const float legScale = 0.7f; int currentVertexIndex = 0;
+    const float legScale = 0.7f; int currentVertexIndex = 0;
     int ankleRingIdx = currentVertexIndex; auto ankleRing = generateRing(0.0f, 0.9f, -0.3f, 0.5f * legScale, 0.4f * legScale, legSegments); gAllVertices.insert(gAllVertices.end(), ankleRing.begin(), ankleRing.end()); currentVertexIndex += legSegments;
     int lowerShinRingIdx = currentVertexIndex; auto lowerShinRing = generateRing(0.0f, 1.45f, -0.2f, 0.55f * legScale, 0.45f * legScale, legSegments); gAllVertices.insert(gAllVertices.end(), lowerShinRing.begin(), lowerShinRing.end()); currentVertexIndex += legSegments; addRingQuads(ankleRingIdx, lowerShinRingIdx, legSegments);
     int lowerCalfRingIdx = currentVertexIndex; auto lowerCalfRing = generateRing(0.0f, 2.0f, -0.2f, 0.6f * legScale, 0.5f * legScale, legSegments); gAllVertices.insert(gAllVertices.end(), lowerCalfRing.begin(), lowerCalfRing.end()); currentVertexIndex += legSegments; addRingQuads(lowerShinRingIdx, lowerCalfRingIdx, legSegments);
@@ -929,6 +983,7 @@ void computeLegFootUVs() {
     }
 }
 void drawLegAndFootMesh() {
+    GL_STATS_SCOPE(SUB_LEGS);
     // Make sure we use the explicit UVs we computed (no texgen!)
     if (gRenderMode == RM_TEXTURED) Tex::disableObjectLinearST();
 
@@ -1051,6 +1106,13 @@ static void InitializeHand2() {
     g_HandJoints2[20] = { {-0.5f * flipSign, 0.0f, 1.8f}, 19 };
 }
 
+static void buildArmSkeleton(const std::vector<ArmJoint>& armJoints, Skinning::Skeleton& skeleton) {
+    skeleton = Skinning::Skeleton();
+    for (const auto& joint : armJoints) {
+        skeleton.addJoint(joint.parentIndex, { joint.position.x, joint.position.y, joint.position.z });
+    }
+}
+
 static void InitializeArm() {
     g_ArmJoints.clear();
     g_ArmJoints.resize(8); // Increased to 8 joints for better arm structure
@@ -1063,6 +1125,7 @@ static void InitializeArm() {
     g_ArmJoints[5] = { {0.28f, 0.22f, 8.2f}, 4 };       // Lower arm mid - shortened
     g_ArmJoints[6] = { {0.25f, 0.28f, 9.2f}, 5 };       // Lower arm end - shortened  
     g_ArmJoints[7] = { {0.20f, 0.35f, 9.8f}, 6 };       // Wrist joint - much shorter forearm
+    buildArmSkeleton(g_ArmJoints, gArmSkeleton[0]);
 }
 
 static void InitializeArm2() {
@@ -1078,6 +1141,7 @@ static void InitializeArm2() {
     g_ArmJoints2[5] = { {0.28f * flipSign, 0.22f, 8.2f}, 4 };       // Lower arm mid - shortened
     g_ArmJoints2[6] = { {0.25f * flipSign, 0.28f, 9.2f}, 5 };       // Lower arm end - shortened
     g_ArmJoints2[7] = { {0.20f * flipSign, 0.35f, 9.8f}, 6 };       // Wrist joint - much shorter forearm
+    buildArmSkeleton(g_ArmJoints2, gArmSkeleton[1]);
 }
 
 void initializeCharacterParts() {
@@ -1086,6 +1150,9 @@ void initializeCharacterParts() {
     buildTriangles();
     computeVertexNormals();
     computeLegFootUVs(); // <<< Call the new UV generation function
+    partitionLegMesh();
+    GLExt::init();
+    buildLegBuffers();
 
     InitializeHand();
     InitializeHand2();
@@ -1094,7 +1161,7 @@ void initializeCharacterParts() {
     initializeFistPositions();
     initializeKungFuSequences();
 
-    Tex::loadAll(); // Load all textures from your texture manager
+    Tex::loadAll(); // Queue all textures on the texture manager (they stream in over the first frames)
 
     if (!g_headQuadric) {
         g_headQuadric = gluNewQuadric();
@@ -1198,26 +1265,32 @@ float smoothStep(float t) {
     return t * t * (3.0f - 2.0f * t);
 }
 
-void updateFistAnimation(float deltaTime) {
-    if (!gFistAnimationActive) return;
+void updateFistAnimation(CharacterState& character, float deltaTime) {
+    character.fistHands.moving = false;
+    if (!character.fistAnimationActive) return;
 
-    gFistAnimationTime += deltaTime;
+    character.fistAnimationTime += deltaTime;
 
     // Calculate animation progress (0 to 1)
-    float progress = gFistAnimationTime / FIST_ANIMATION_DURATION;
+    float progress = character.fistAnimationTime / FIST_ANIMATION_DURATION;
 
     if (progress >= 1.0f) {
         // Animation finished
         progress = 1.0f;
-        gFistAnimationActive = false;
-        gIsFist = !gIsFist; // Toggle to the target state
+        character.fistAnimationActive = false;
+        character.isFist = !character.isFist; // Toggle to the target state
     }
 
-    // Apply smooth easing
-    float easedProgress = smoothStep(progress);
+    // Apply smooth easing; the direction is the inverse of the current state
+    character.fistHands = { true, !character.isFist, smoothStep(progress) };
+}
 
-    // Choose interpolation direction based on target state (inverse of current)
-    if (!gIsFist) {
+// Moves the hand joints to where updateFistAnimation() left the animation
+static void applyFistHands(const CharacterState& character) {
+    if (!character.fistHands.moving) return;
+    const float easedProgress = character.fistHands.blend;
+
+    if (character.fistHands.toFist) {
         // Currently open, going to fist
         for (int i = 0; i < 21; ++i) {
             g_HandJoints[i].position = lerp(g_OriginalHandJoints[i].position, g_FistHandJoints[i].position, easedProgress);
@@ -1233,57 +1306,57 @@ void updateFistAnimation(float deltaTime) {
     }
 }
 
-void toggleFistAnimation() {
-    if (gFistAnimationActive) return; // Don't interrupt ongoing animation
+void toggleFistAnimation(CharacterState& character) {
+    if (character.fistAnimationActive) return; // Don't interrupt ongoing animation
 
-    gFistAnimationActive = true;
-    gFistAnimationTime = 0.0f;
-    // The animation direction is determined by the current gIsFist state in updateFistAnimation
+    character.fistAnimationActive = true;
+    character.fistAnimationTime = 0.0f;
+    // The animation direction is determined by the current isFist state in updateFistAnimation
 }
 
 // SWORD ATTACK ANIMATION FUNCTIONS
-void startSwordAttack() {
-    if (gSwordAttackAnimating) return; // Don't interrupt ongoing animation
+void startSwordAttack(CharacterState& character) {
+    if (character.swordAttackAnimating) return; // Don't interrupt ongoing animation
     
-    gSwordAttackAnimating = true;
-    gSwordAttackAnimationTime = 0.0f;
-    gSwordAttackPhase = 0;
+    character.swordAttackAnimating = true;
+    character.swordAttackAnimationTime = 0.0f;
+    character.swordAttackPhase = 0;
     
     // Reset attack pose offsets
-    gSwordAttackTorsoRotation = 0.0f;
-    gSwordAttackShoulderOffset = 0.0f;
-    gSwordAttackArmExtension = 0.0f;
-    gSwordAttackLegStance = 0.0f;
+    character.swordAttackTorsoRotation = 0.0f;
+    character.swordAttackShoulderOffset = 0.0f;
+    character.swordAttackArmExtension = 0.0f;
+    character.swordAttackLegStance = 0.0f;
 }
 
-void updateSwordAttackAnimation(float deltaTime) {
-    if (!gSwordAttackAnimating) return;
+void updateSwordAttackAnimation(CharacterState& character, float deltaTime) {
+    if (!character.swordAttackAnimating) return;
     
-    gSwordAttackAnimationTime += deltaTime;
+    character.swordAttackAnimationTime += deltaTime;
     
     // Calculate progress through current phase
     float phaseTime = 0.0f;
     float phaseDuration = 0.0f;
     
-    if (gSwordAttackAnimationTime <= SWORD_WINDUP_DURATION) {
+    if (character.swordAttackAnimationTime <= SWORD_WINDUP_DURATION) {
         // Wind up phase
-        gSwordAttackPhase = 1;
-        phaseTime = gSwordAttackAnimationTime;
+        character.swordAttackPhase = 1;
+        phaseTime = character.swordAttackAnimationTime;
         phaseDuration = SWORD_WINDUP_DURATION;
         
         float progress = phaseTime / phaseDuration;
         progress = smoothStep(progress); // Smooth easing
         
         // Wind up: dramatic preparation - raise sword high above head like a real warrior
-        gSwordAttackTorsoRotation = -30.0f * progress; // More pronounced torso twist
-        gSwordAttackShoulderOffset = -25.0f * progress; // Greater shoulder movement for overhead position
-        gSwordAttackArmExtension = -35.0f * progress; // Pull arm way back and up
-        gSwordAttackLegStance = 15.0f * progress; // Wider stance for power
+        character.swordAttackTorsoRotation = -30.0f * progress; // More pronounced torso twist
+        character.swordAttackShoulderOffset = -25.0f * progress; // Greater shoulder movement for overhead position
+        character.swordAttackArmExtension = -35.0f * progress; // Pull arm way back and up
+        character.swordAttackLegStance = 15.0f * progress; // Wider stance for power
         
-    } else if (gSwordAttackAnimationTime <= SWORD_WINDUP_DURATION + SWORD_STRIKE_DURATION) {
+    } else if (character.swordAttackAnimationTime <= SWORD_WINDUP_DURATION + SWORD_STRIKE_DURATION) {
         // Strike phase
-        gSwordAttackPhase = 2;
-        phaseTime = gSwordAttackAnimationTime - SWORD_WINDUP_DURATION;
+        character.swordAttackPhase = 2;
+        phaseTime = character.swordAttackAnimationTime - SWORD_WINDUP_DURATION;
         phaseDuration = SWORD_STRIKE_DURATION;
         
         float progress = phaseTime / phaseDuration;
@@ -1295,15 +1368,15 @@ void updateSwordAttackAnimation(float deltaTime) {
         float windupArm = -35.0f;
         float windupLeg = 15.0f;
         
-        gSwordAttackTorsoRotation = windupTorso + (50.0f * progress); // Powerful torso rotation
-        gSwordAttackShoulderOffset = windupShoulder + (40.0f * progress); // Shoulder drives forward
-        gSwordAttackArmExtension = windupArm + (60.0f * progress); // Full arm extension like real sword strike
-        gSwordAttackLegStance = windupLeg + (-20.0f * progress); // Weight shifts forward aggressively
+        character.swordAttackTorsoRotation = windupTorso + (50.0f * progress); // Powerful torso rotation
+        character.swordAttackShoulderOffset = windupShoulder + (40.0f * progress); // Shoulder drives forward
+        character.swordAttackArmExtension = windupArm + (60.0f * progress); // Full arm extension like real sword strike
+        character.swordAttackLegStance = windupLeg + (-20.0f * progress); // Weight shifts forward aggressively
         
-    } else if (gSwordAttackAnimationTime <= SWORD_ATTACK_DURATION) {
+    } else if (character.swordAttackAnimationTime <= SWORD_ATTACK_DURATION) {
         // Follow through phase
-        gSwordAttackPhase = 3;
-        phaseTime = gSwordAttackAnimationTime - SWORD_WINDUP_DURATION - SWORD_STRIKE_DURATION;
+        character.swordAttackPhase = 3;
+        phaseTime = character.swordAttackAnimationTime - SWORD_WINDUP_DURATION - SWORD_STRIKE_DURATION;
         phaseDuration = SWORD_FOLLOWTHROUGH_DURATION;
         
         float progress = phaseTime / phaseDuration;
@@ -1315,65 +1388,65 @@ void updateSwordAttackAnimation(float deltaTime) {
         float strikeArm = 25.0f;
         float strikeLeg = -5.0f;
         
-        gSwordAttackTorsoRotation = strikeTorso * (1.0f - progress);
-        gSwordAttackShoulderOffset = strikeShoulder * (1.0f - progress);
-        gSwordAttackArmExtension = strikeArm * (1.0f - progress);
-        gSwordAttackLegStance = strikeLeg * (1.0f - progress);
+        character.swordAttackTorsoRotation = strikeTorso * (1.0f - progress);
+        character.swordAttackShoulderOffset = strikeShoulder * (1.0f - progress);
+        character.swordAttackArmExtension = strikeArm * (1.0f - progress);
+        character.swordAttackLegStance = strikeLeg * (1.0f - progress);
         
     } else {
         // Animation complete
-        gSwordAttackAnimating = false;
-        gSwordAttackPhase = 0;
-        gSwordAttackTorsoRotation = 0.0f;
-        gSwordAttackShoulderOffset = 0.0f;
-        gSwordAttackArmExtension = 0.0f;
-        gSwordAttackLegStance = 0.0f;
+        character.swordAttackAnimating = false;
+        character.swordAttackPhase = 0;
+        character.swordAttackTorsoRotation = 0.0f;
+        character.swordAttackShoulderOffset = 0.0f;
+        character.swordAttackArmExtension = 0.0f;
+        character.swordAttackLegStance = 0.0f;
     }
 }
 
 // SPEAR ATTACK ANIMATION FUNCTIONS
-void startSpearAttack() {
-    if (gSpearAttackAnimating) return; // Don't interrupt ongoing animation
+void startSpearAttack(CharacterState& character) {
+    if (character.spearAttackAnimating) return; // Don't interrupt ongoing animation
     
-    gSpearAttackAnimating = true;
-    gSpearAttackAnimationTime = 0.0f;
-    gSpearAttackPhase = 0;
+    character.spearAttackAnimating = true;
+    character.spearAttackAnimationTime = 0.0f;
+    character.spearAttackPhase = 0;
     
     // Reset attack pose offsets
-    gSpearAttackTorsoRotation = 0.0f;
-    gSpearAttackShoulderOffset = 0.0f;
-    gSpearAttackArmExtension = 0.0f;
-    gSpearAttackLegStance = 0.0f;
+    character.spearAttackTorsoRotation = 0.0f;
+    character.spearAttackShoulderOffset = 0.0f;
+    character.spearAttackArmExtension = 0.0f;
+    character.spearAttackLegStance = 0.0f;
 }
 
-void updateSpearAttackAnimation(float deltaTime) {
-    if (!gSpearAttackAnimating) return;
+void updateSpearAttackAnimation(CharacterState& character, float deltaTime) {
+    if (!character.spearAttackAnimating) return;
     
-    gSpearAttackAnimationTime += deltaTime;
+    character.spearAttackAnimationTime += deltaTime;
     
     // Calculate progress through current phase
     float phaseTime = 0.0f;
     float phaseDuration = 0.0f;
     
-    if (gSpearAttackAnimationTime <= SPEAR_WINDUP_DURATION) {
+    if (character.spearAttackAnimationTime <= SPEAR_WINDUP_DURATION) {
         // Wind up phase - prepare for powerful thrust
-        gSpearAttackPhase = 1;
-        phaseTime = gSpearAttackAnimationTime;
+        character.spearAttackPhase = 1;
+        phaseTime = character.spearAttackAnimationTime;
         phaseDuration = SPEAR_WINDUP_DURATION;
         
         float progress = phaseTime / phaseDuration;
         progress = smoothStep(progress); // Smooth easing
         
         // Wind up: pull spear back and prepare for thrust like a warrior
-        gSpearAttackTorsoRotation = -20.0f * progress; // Torso twist back
-        gSpearAttackShoulderOffset = -30.0f * progress; // Pull shoulder back
-        gSpearAttackArmExtension = -40.0f * progress; // Pull arm way back
-        gSpearAttackLegStance = 20.0f * progress; // Wider stance for power
+        character.spearAttackTorsoRotation = -20.0f * progress; // Torso twist back
+        character.spearAttackShoulderOffset = -30.0f * progress; // Pull shoulder back
+        character.spearAttackArmExtension = -40.0f * progress; // Pull arm way back
+        character.spearAttackLegStance = 20.0f * progress; // Wider stance for power
         
-    } else if (gSpearAttackAnimationTime <= SPEAR_WINDUP_DURATION + SPEAR_THRUST_DURATION) {
+    } else if (character.spearAttackAnimationTime <= SPEAR_WINDUP_DURATION + SPEAR_THRUST_DURATION) {
         // Thrust phase - explosive forward lunge
-        gSpearAttackPhase = 2;
-        phaseTime = gSpearAttackAnimationTime - SPEAR_WINDUP_DURATION;
+        character.spearAttackPhase = 2;
+        phaseTime = character.spearAttackAnimationTime - SPEAR_WINDUP_DURATION;
         phaseDuration = SPEAR_THRUST_DURATION;
         
         float progress = phaseTime / phaseDuration;
@@ -1385,15 +1458,15 @@ void updateSpearAttackAnimation(float deltaTime) {
         float windupArm = -40.0f;
         float windupLeg = 20.0f;
         
-        gSpearAttackTorsoRotation = windupTorso + (35.0f * progress); // Powerful torso rotation
-        gSpearAttackShoulderOffset = windupShoulder + (50.0f * progress); // Shoulder drives forward
-        gSpearAttackArmExtension = windupArm + (70.0f * progress); // Full arm extension for thrust
-        gSpearAttackLegStance = windupLeg + (-25.0f * progress); // Weight shifts forward
+        character.spearAttackTorsoRotation = windupTorso + (35.0f * progress); // Powerful torso rotation
+        character.spearAttackShoulderOffset = windupShoulder + (50.0f * progress); // Shoulder drives forward
+        character.spearAttackArmExtension = windupArm + (70.0f * progress); // Full arm extension for thrust
+        character.spearAttackLegStance = windupLeg + (-25.0f * progress); // Weight shifts forward
         
-    } else if (gSpearAttackAnimationTime <= SPEAR_ATTACK_DURATION) {
+    } else if (character.spearAttackAnimationTime <= SPEAR_ATTACK_DURATION) {
         // Follow through phase - controlled recovery
-        gSpearAttackPhase = 3;
-        phaseTime = gSpearAttackAnimationTime - SPEAR_WINDUP_DURATION - SPEAR_THRUST_DURATION;
+        character.spearAttackPhase = 3;
+        phaseTime = character.spearAttackAnimationTime - SPEAR_WINDUP_DURATION - SPEAR_THRUST_DURATION;
         phaseDuration = SPEAR_FOLLOWTHROUGH_DURATION;
         
         float progress = phaseTime / phaseDuration;
@@ -1405,94 +1478,94 @@ void updateSpearAttackAnimation(float deltaTime) {
         float thrustArm = 30.0f;
         float thrustLeg = -5.0f;
         
-        gSpearAttackTorsoRotation = thrustTorso * (1.0f - progress);
-        gSpearAttackShoulderOffset = thrustShoulder * (1.0f - progress);
-        gSpearAttackArmExtension = thrustArm * (1.0f - progress);
-        gSpearAttackLegStance = thrustLeg * (1.0f - progress);
+        character.spearAttackTorsoRotation = thrustTorso * (1.0f - progress);
+        character.spearAttackShoulderOffset = thrustShoulder * (1.0f - progress);
+        character.spearAttackArmExtension = thrustArm * (1.0f - progress);
+        character.spearAttackLegStance = thrustLeg * (1.0f - progress);
         
     } else {
         // Animation complete
-        gSpearAttackAnimating = false;
-        gSpearAttackPhase = 0;
-        gSpearAttackTorsoRotation = 0.0f;
-        gSpearAttackShoulderOffset = 0.0f;
-        gSpearAttackArmExtension = 0.0f;
-        gSpearAttackLegStance = 0.0f;
+        character.spearAttackAnimating = false;
+        character.spearAttackPhase = 0;
+        character.spearAttackTorsoRotation = 0.0f;
+        character.spearAttackShoulderOffset = 0.0f;
+        character.spearAttackArmExtension = 0.0f;
+        character.spearAttackLegStance = 0.0f;
     }
 }
 
 // SHIELD BLOCK ANIMATION FUNCTIONS
-void startShieldBlock() {
-    if (gShieldBlockAnimating) return; // Don't interrupt ongoing animation
+void startShieldBlock(CharacterState& character) {
+    if (character.shieldBlockAnimating) return; // Don't interrupt ongoing animation
     
-    gShieldBlockAnimating = true;
-    gShieldBlockAnimationTime = 0.0f;
-    gShieldBlockPhase = 0;
+    character.shieldBlockAnimating = true;
+    character.shieldBlockAnimationTime = 0.0f;
+    character.shieldBlockPhase = 0;
     
     // Reset block pose offsets
-    gShieldBlockArmRaise = 0.0f;
-    gShieldBlockTorsoLean = 0.0f;
-    gShieldBlockStance = 0.0f;
+    character.shieldBlockArmRaise = 0.0f;
+    character.shieldBlockTorsoLean = 0.0f;
+    character.shieldBlockStance = 0.0f;
 }
 
-void updateShieldBlockAnimation(float deltaTime) {
-    if (!gShieldBlockAnimating) return;
+void updateShieldBlockAnimation(CharacterState& character, float deltaTime) {
+    if (!character.shieldBlockAnimating) return;
     
-    gShieldBlockAnimationTime += deltaTime;
+    character.shieldBlockAnimationTime += deltaTime;
     
     // Calculate progress through current phase
     float phaseTime = 0.0f;
     float phaseDuration = 0.0f;
     
-    if (gShieldBlockAnimationTime <= SHIELD_RAISE_DURATION) {
+    if (character.shieldBlockAnimationTime <= SHIELD_RAISE_DURATION) {
         // Raise phase - quickly raise shield to block
-        gShieldBlockPhase = 1;
-        phaseTime = gShieldBlockAnimationTime;
+        character.shieldBlockPhase = 1;
+        phaseTime = character.shieldBlockAnimationTime;
         phaseDuration = SHIELD_RAISE_DURATION;
         
         float progress = phaseTime / phaseDuration;
         progress = progress * progress; // Fast start
         
         // Raise: quickly raise shield and brace for impact with bent arm
-        gShieldBlockArmRaise = 80.0f * progress; // Higher raise for better protection
-        gShieldBlockTorsoLean = -8.0f * progress; // Less lean, more upright defensive stance
-        gShieldBlockStance = 35.0f * progress; // Wider stance for stability
+        character.shieldBlockArmRaise = 80.0f * progress; // Higher raise for better protection
+        character.shieldBlockTorsoLean = -8.0f * progress; // Less lean, more upright defensive stance
+        character.shieldBlockStance = 35.0f * progress; // Wider stance for stability
         
-    } else if (gShieldBlockAnimationTime <= SHIELD_RAISE_DURATION + SHIELD_HOLD_DURATION) {
+    } else if (character.shieldBlockAnimationTime <= SHIELD_RAISE_DURATION + SHIELD_HOLD_DURATION) {
         // Hold phase - maintain defensive position
-        gShieldBlockPhase = 2;
-        phaseTime = gShieldBlockAnimationTime - SHIELD_RAISE_DURATION;
+        character.shieldBlockPhase = 2;
+        phaseTime = character.shieldBlockAnimationTime - SHIELD_RAISE_DURATION;
         phaseDuration = SHIELD_HOLD_DURATION;
         
         // Hold: maintain defensive position with slight tension
         float tension = sinf(phaseTime * 8.0f) * 1.0f; // Reduced tension for more stable hold
-        gShieldBlockArmRaise = 80.0f + tension; // Maintain high shield position
-        gShieldBlockTorsoLean = -8.0f;
-        gShieldBlockStance = 35.0f;
+        character.shieldBlockArmRaise = 80.0f + tension; // Maintain high shield position
+        character.shieldBlockTorsoLean = -8.0f;
+        character.shieldBlockStance = 35.0f;
         
-    } else if (gShieldBlockAnimationTime <= SHIELD_BLOCK_DURATION) {
+    } else if (character.shieldBlockAnimationTime <= SHIELD_BLOCK_DURATION) {
         // Lower phase - return to ready position
-        gShieldBlockPhase = 3;
-        phaseTime = gShieldBlockAnimationTime - SHIELD_RAISE_DURATION - SHIELD_HOLD_DURATION;
+        character.shieldBlockPhase = 3;
+        phaseTime = character.shieldBlockAnimationTime - SHIELD_RAISE_DURATION - SHIELD_HOLD_DURATION;
         phaseDuration = SHIELD_LOWER_DURATION;
         
         float progress = phaseTime / phaseDuration;
         progress = smoothStep(progress); // Smooth recovery
         
         // Lower: controlled return to ready position
-        gShieldBlockArmRaise = 80.0f * (1.0f - progress);
-        gShieldBlockTorsoLean = -8.0f * (1.0f - progress);
-        gShieldBlockStance = 35.0f * (1.0f - progress);
+        character.shieldBlockArmRaise = 80.0f * (1.0f - progress);
+        character.shieldBlockTorsoLean = -8.0f * (1.0f - progress);
+        character.shieldBlockStance = 35.0f * (1.0f - progress);
         
     } else {
         // Animation complete
-        gShieldBlockAnimating = false;
-        gShieldBlockPhase = 0;
-        gShieldBlockArmRaise = 0.0f;
-        gShieldBlockTorsoLean = 0.0f;
-        gShieldBlockStance = 0.0f;
+        character.shieldBlockAnimating = false;
+        character.shieldBlockPhase = 0;
+        character.shieldBlockArmRaise = 0.0f;
+        character.shieldBlockTorsoLean = 0.0f;
+        character.shieldBlockStance = 0.0f;
         // Reset lower arm bend when shield animation ends
-        gLeftLowerArmBend = 0.0f;
+        character.leftLowerArmBend = 0.0f;
     }
 }
 
@@ -1930,15 +2003,15 @@ float lerpf(float a, float b, float t) {
 }
 
 // Update boxing stance animation
-void updateBoxingStance(float deltaTime) {
-    if (!gBoxingAnimActive) return;
+void updateBoxingStance(CharacterState& character, float deltaTime) {
+    if (!character.boxingAnimActive) return;
 
-    gBoxingAnimTime += deltaTime;
-    float progress = gBoxingAnimTime / BOXING_ANIM_DURATION;
+    character.boxingAnimTime += deltaTime;
+    float progress = character.boxingAnimTime / BOXING_ANIM_DURATION;
 
     if (progress >= 1.0f) {
         progress = 1.0f;
-        gBoxingAnimActive = false;
+        character.boxingAnimActive = false;
     }
 
     // Apply smooth easing
@@ -1948,7 +2021,7 @@ void updateBoxingStance(float deltaTime) {
     float targetLeftShoulderPitch, targetLeftShoulderYaw, targetLeftShoulderRoll, targetLeftElbowBend;
     float targetRightShoulderPitch, targetRightShoulderYaw, targetRightShoulderRoll, targetRightElbowBend;
 
-    if (gInBoxingStance) {
+    if (character.inBoxingStance) {
         // Transitioning to boxing stance
         targetLeftShoulderPitch = BOXING_SHOULDER_PITCH;
         targetLeftShoulderYaw = BOXING_SHOULDER_YAW;
@@ -1972,101 +2045,104 @@ void updateBoxingStance(float deltaTime) {
     }
 
     // Interpolate current values
-    gCurrentLeftShoulderPitch = lerpf(RELAXED_SHOULDER_PITCH, targetLeftShoulderPitch, easedProgress);
-    gCurrentLeftShoulderYaw = lerpf(RELAXED_SHOULDER_YAW, targetLeftShoulderYaw, easedProgress);
-    gCurrentLeftShoulderRoll = lerpf(RELAXED_SHOULDER_ROLL, targetLeftShoulderRoll, easedProgress);
-    gCurrentLeftElbowBend = lerpf(RELAXED_ELBOW_BEND, targetLeftElbowBend, easedProgress);
-    gCurrentRightShoulderPitch = lerpf(RELAXED_SHOULDER_PITCH, targetRightShoulderPitch, easedProgress);
-    gCurrentRightShoulderYaw = lerpf(RELAXED_SHOULDER_YAW, targetRightShoulderYaw, easedProgress);
-    gCurrentRightShoulderRoll = lerpf(RELAXED_SHOULDER_ROLL, targetRightShoulderRoll, easedProgress);
-    gCurrentRightElbowBend = lerpf(RELAXED_ELBOW_BEND, targetRightElbowBend, easedProgress);
+    character.currentLeftShoulderPitch = lerpf(RELAXED_SHOULDER_PITCH, targetLeftShoulderPitch, easedProgress);
+    character.currentLeftShoulderYaw = lerpf(RELAXED_SHOULDER_YAW, targetLeftShoulderYaw, easedProgress);
+    character.currentLeftShoulderRoll = lerpf(RELAXED_SHOULDER_ROLL, targetLeftShoulderRoll, easedProgress);
+    character.currentLeftElbowBend = lerpf(RELAXED_ELBOW_BEND, targetLeftElbowBend, easedProgress);
+    character.currentRightShoulderPitch = lerpf(RELAXED_SHOULDER_PITCH, targetRightShoulderPitch, easedProgress);
+    character.currentRightShoulderYaw = lerpf(RELAXED_SHOULDER_YAW, targetRightShoulderYaw, easedProgress);
+    character.currentRightShoulderRoll = lerpf(RELAXED_SHOULDER_ROLL, targetRightShoulderRoll, easedProgress);
+    character.currentRightElbowBend = lerpf(RELAXED_ELBOW_BEND, targetRightElbowBend, easedProgress);
 }
 
 // Toggle boxing stance
-void toggleBoxingStance() {
-    if (gBoxingAnimActive) return; // Don't interrupt ongoing animation
+void toggleBoxingStance(CharacterState& character) {
+    if (character.boxingAnimActive) return; // Don't interrupt ongoing animation
 
-    gInBoxingStance = !gInBoxingStance;
-    gBoxingAnimActive = true;
-    gBoxingAnimTime = 0.0f;
+    character.inBoxingStance = !character.inBoxingStance;
+    character.boxingAnimActive = true;
+    character.boxingAnimTime = 0.0f;
 }
 
 // Start jump animation
-void startJump() {
-    if (!gIsJumping) {  // Only start if not already jumping
-        gIsJumping = true;
-        gJumpPhase = 0.0f;
-        gJumpVerticalOffset = 0.0f;
+void startJump(CharacterState& character) {
+    if (!character.isJumping) {  // Only start if not already jumping
+        character.isJumping = true;
+        character.jumpPhase = 0.0f;
+        character.jumpVerticalOffset = 0.0f;
+        character.snapped = true;
     }
 }
 
 // Update jump animation
-void updateJumpAnimation(float deltaTime) {
-    if (!gIsJumping) return;
+void updateJumpAnimation(CharacterState& character, float deltaTime) {
+    if (!character.isJumping) return;
 
     // Advance jump phase
-    gJumpPhase += deltaTime / JUMP_DURATION;
+    character.jumpPhase += deltaTime / JUMP_DURATION;
 
-    if (gJumpPhase >= 2.0f) {
+    if (character.jumpPhase >= 2.0f) {
         // Jump complete
-        gIsJumping = false;
-        gJumpPhase = 0.0f;
-        gJumpVerticalOffset = 0.0f;
+        character.isJumping = false;
+        character.jumpPhase = 0.0f;
+        character.jumpVerticalOffset = 0.0f;
+        character.snapped = true;
     }
     else {
         // Calculate vertical offset using a parabolic curve
         // Phase 0.0 to 1.0 = going up, 1.0 to 2.0 = coming down
-        float normalizedPhase = gJumpPhase;
+        float normalizedPhase = character.jumpPhase;
         if (normalizedPhase > 1.0f) normalizedPhase = 2.0f - normalizedPhase; // Mirror for descent
 
         // Use parabolic curve for natural jump motion
-        gJumpVerticalOffset = JUMP_HEIGHT * (4.0f * normalizedPhase * (1.0f - normalizedPhase));
+        character.jumpVerticalOffset = JUMP_HEIGHT * (4.0f * normalizedPhase * (1.0f - normalizedPhase));
     }
 }
 
 // Start K-pop dance animation
-void startDance() {
-    if (!gIsDancing) {  // Only start if not already dancing
-        gIsDancing = true;
-        gDanceTime = 0.0f;
-        gDancePhase = 0.0f;
-        gJumpVerticalOffset = 0.0f;
+void startDance(CharacterState& character) {
+    if (!character.isDancing) {  // Only start if not already dancing
+        character.isDancing = true;
+        character.danceTime = 0.0f;
+        character.dancePhase = 0.0f;
+        character.jumpVerticalOffset = 0.0f;
+        character.snapped = true;
 
         // Reset all pose values to neutral before starting dance
-        g_pose.torsoYaw = g_pose.torsoPitch = g_pose.torsoRoll = 0.0f;
-        g_pose.headYaw = g_pose.headPitch = g_pose.headRoll = 0.0f;
-        gCurrentPose.leftArmAngle = gCurrentPose.rightArmAngle = 0.0f;
-        gCurrentPose.torsoYaw = gCurrentPose.torsoPitch = gCurrentPose.torsoRoll = 0.0f;
+        character.pose.torsoYaw = character.pose.torsoPitch = character.pose.torsoRoll = 0.0f;
+        character.pose.headYaw = character.pose.headPitch = character.pose.headRoll = 0.0f;
+        character.currentPose.leftArmAngle = character.currentPose.rightArmAngle = 0.0f;
+        character.currentPose.torsoYaw = character.currentPose.torsoPitch = character.currentPose.torsoRoll = 0.0f;
     }
 }
 
 // Update K-pop dance animation with full-body choreography
-void updateDance() {
-    if (!gIsDancing) return;
+void updateDance(CharacterState& character, float deltaTime) {
+    if (!character.isDancing) return;
 
-    const float deltaTime = 0.016f; // Assuming 60 FPS
-    gDanceTime += deltaTime;
-    gDancePhase = gDanceTime * DANCE_SPEED;
+    character.danceTime += deltaTime;
+    character.dancePhase = character.danceTime * DANCE_SPEED;
 
-    if (gDanceTime >= DANCE_DURATION) {
+    if (character.danceTime >= DANCE_DURATION) {
         // Dance complete - return to neutral pose
-        gIsDancing = false;
-        gDanceTime = 0.0f;
-        gDancePhase = 0.0f;
-        gJumpVerticalOffset = 0.0f;
+        character.isDancing = false;
+        character.danceTime = 0.0f;
+        character.dancePhase = 0.0f;
+        character.jumpVerticalOffset = 0.0f;
+        character.snapped = true;
 
         // Reset pose to neutral
-        g_pose.torsoYaw = g_pose.torsoPitch = g_pose.torsoRoll = 0.0f;
-        g_pose.headYaw = g_pose.headPitch = g_pose.headRoll = 0.0f;
-        gCurrentPose.leftArmAngle = gCurrentPose.rightArmAngle = 0.0f;
-        gCurrentPose.torsoYaw = gCurrentPose.torsoPitch = gCurrentPose.torsoRoll = 0.0f;
+        character.pose.torsoYaw = character.pose.torsoPitch = character.pose.torsoRoll = 0.0f;
+        character.pose.headYaw = character.pose.headPitch = character.pose.headRoll = 0.0f;
+        character.currentPose.leftArmAngle = character.currentPose.rightArmAngle = 0.0f;
+        character.currentPose.torsoYaw = character.currentPose.torsoPitch = character.currentPose.torsoRoll = 0.0f;
         return;
     }
 
     // K-pop dance choreography with 8-second sequence
-    float t = gDancePhase;
+    float t = character.dancePhase;
     float beat = fmod(t, 1.0f); // Individual beat within each second
-    int measure = (int)(gDanceTime * 2.0f) % 16; // 16 different measures for variety
+    int measure = (int)(character.danceTime * 2.0f) % 16; // 16 different measures for variety
 
     // === ARM MOVEMENTS (K-pop style) ===
     float leftArmBase = 0.0f, rightArmBase = 0.0f;
@@ -2114,20 +2190,20 @@ void updateDance() {
     }
 
     // Apply arm movements
-    gCurrentPose.leftArmAngle = leftArmBase;
-    gCurrentPose.rightArmAngle = rightArmBase;
+    character.currentPose.leftArmAngle = leftArmBase;
+    character.currentPose.rightArmAngle = rightArmBase;
 
     // === TORSO MOVEMENTS ===
     // Torso sway and rotation
-    g_pose.torsoYaw = sinf(t * 2.5f) * 15.0f;
-    g_pose.torsoPitch = sinf(t * 1.8f) * 8.0f;
-    g_pose.torsoRoll = cosf(t * 3.2f) * 12.0f;
+    character.pose.torsoYaw = sinf(t * 2.5f) * 15.0f;
+    character.pose.torsoPitch = sinf(t * 1.8f) * 8.0f;
+    character.pose.torsoRoll = cosf(t * 3.2f) * 12.0f;
 
     // === HEAD MOVEMENTS ===
     // Head bobs and turns with the beat
-    g_pose.headYaw = sinf(t * 3.0f) * 20.0f;
-    g_pose.headPitch = cosf(t * 4.0f) * 10.0f;
-    g_pose.headRoll = sinf(t * 2.8f) * 8.0f;
+    character.pose.headYaw = sinf(t * 3.0f) * 20.0f;
+    character.pose.headPitch = cosf(t * 4.0f) * 10.0f;
+    character.pose.headRoll = sinf(t * 2.8f) * 8.0f;
 
     // === JUMPING AND BODY MOVEMENTS ===
     // Add periodic jumps during energetic sections
@@ -2136,109 +2212,66 @@ void updateDance() {
         float jumpCycle = fmod(t * 2.0f, 2.0f);
         if (jumpCycle < 0.3f) {
             float jumpPhase = jumpCycle / 0.3f;
-            gJumpVerticalOffset = JUMP_HEIGHT * sinf(jumpPhase * PI) * 0.7f; // Smaller jumps for dance
+            character.jumpVerticalOffset = JUMP_HEIGHT * sinf(jumpPhase * PI) * 0.7f; // Smaller jumps for dance
         }
         else {
-            gJumpVerticalOffset = 0.0f;
+            character.jumpVerticalOffset = 0.0f;
         }
     }
     else if (measure >= 4 && measure < 6) {
         // Sharp movements section with small hops
-        gJumpVerticalOffset = (sinf(t * 8.0f) > 0.8f) ? JUMP_HEIGHT * 0.3f : 0.0f;
+        character.jumpVerticalOffset = (sinf(t * 8.0f) > 0.8f) ? JUMP_HEIGHT * 0.3f : 0.0f;
     }
     else {
         // Ground-based movements
-        gJumpVerticalOffset = sinf(t * 1.5f) * 0.2f; // Subtle body bobbing
+        character.jumpVerticalOffset = sinf(t * 1.5f) * 0.2f; // Subtle body bobbing
     }
 
     // Add extra body dynamics to make it more lively
-    gCurrentPose.torsoYaw += g_pose.torsoYaw;
-    gCurrentPose.torsoPitch += g_pose.torsoPitch;
-    gCurrentPose.torsoRoll += g_pose.torsoRoll;
+    character.currentPose.torsoYaw += character.pose.torsoYaw;
+    character.currentPose.torsoPitch += character.pose.torsoPitch;
+    character.currentPose.torsoRoll += character.pose.torsoRoll;
 }
 
-// Helper function to get transformed wrist position accounting for lower arm bending
-Vec3 getTransformedWristPosition(const std::vector<ArmJoint>& armJoints, float lowerArmBend) {
-    if (armJoints.size() < 8) return { 0.0f, 0.0f, 0.0f };
-
-    Vec3 elbowPos = armJoints[3].position;
-    Vec3 originalWristPos = armJoints[7].position; // Last joint is wrist
-
-    // Transform wrist position based on elbow bend
-    Vec3 relativePos = {
-        originalWristPos.x - elbowPos.x,
-        originalWristPos.y - elbowPos.y,
-        originalWristPos.z - elbowPos.z
-    };
-
-    // Apply rotation around X-axis (pitch rotation for bending up/down)
-    float bendRad = lowerArmBend * PI / 180.0f;
-    float cosB = cosf(bendRad);
-    float sinB = sinf(bendRad);
+// Poses an arm chain (one of gArmSkeleton) on the shared skinning engine: the
+// elbow rotates about the x axis (pitch, bending up/down) and every joint
+// below it follows. Writes kArmJointCount joints. Render thread only: the
+// palette is kept between calls so posing allocates nothing.
+static void poseArmJoints(const Skinning::Skeleton& skeleton, float lowerArmBend, Vec3* out) {
+    static Skinning::Palette palette;
+    Skinning::Quat rotations[kArmJointCount];
+    for (Skinning::Quat& rotation : rotations) rotation = Skinning::kIdentity;
+    rotations[kArmElbowJoint] = Skinning::axisAngle(1.0f, 0.0f, 0.0f, lowerArmBend);
+    Skinning::computePalette(skeleton, rotations, palette);
+
+    Vec3f posed[kArmJointCount];
+    Skinning::transformJoints(skeleton, palette, posed);
+    for (int i = 0; i < kArmJointCount; ++i) out[i] = { posed[i].x, posed[i].y, posed[i].z };
+}
 
-    Vec3 rotatedPos = {
-        relativePos.x,
-        relativePos.y * cosB - relativePos.z * sinB,
-        relativePos.y * sinB + relativePos.z * cosB
-    };
+Vec3 getTransformedWristPosition(const Skinning::Skeleton& skeleton, float lowerArmBend) {
+    if (skeleton.size() != kArmJointCount) return { 0.0f, 0.0f, 0.0f };
 
-    // Translate back from elbow origin
-    return {
-        rotatedPos.x + elbowPos.x,
-        rotatedPos.y + elbowPos.y,
-        rotatedPos.z + elbowPos.z
-    };
+    Vec3 posed[kArmJointCount];
+    poseArmJoints(skeleton, lowerArmBend, posed);
+    return posed[7]; // Last joint is wrist
 }
 
 // Draw complete anatomically complex arm with texture for hand 1
-static void drawLowPolyArm(const std::vector<ArmJoint>& armJoints) {
+// lowerArmBend combines the boxing stance and the slow bend (drawArmsAndHands)
+static void drawLowPolyArm(const CharacterState& character, const std::vector<ArmJoint>& armJoints, float lowerArmBend) {
     if (armJoints.empty()) return;
 
-    // Determine which arm this is and get the appropriate bend angle from boxing stance + slow arm bend
-    float lowerArmBend = 0.0f;
-    if (&armJoints == &g_ArmJoints) {
-        // Combine boxing stance + slow bend (negate only the slow bend for forward direction)
-        lowerArmBend = gCurrentLeftElbowBend + (-gLeftLowerArmBend);
-    }
-    else if (&armJoints == &g_ArmJoints2) {
-        // Combine boxing stance + slow bend (negate only the slow bend for forward direction)
-        lowerArmBend = gCurrentRightElbowBend + (-gRightLowerArmBend);
-    }
-
-    // Calculate transformed lower arm joint positions when bending
-    std::vector<Vec3> transformedJoints;
-    transformedJoints.resize(armJoints.size());
-
-    // Copy upper arm joints (0-3) without transformation
-    for (size_t i = 0; i <= 3; ++i) {
-        transformedJoints[i] = armJoints[i].position;
+    // Determine which arm this is
+    const Skinning::Skeleton* skeleton = &gArmSkeleton[0];
+    if (&armJoints == &g_ArmJoints2) {
+        skeleton = &gArmSkeleton[1];
     }
+    if (skeleton->size() != kArmJointCount) return;
 
-    // Transform lower arm joints (4-7) based on elbow bend
-    Vec3 elbowPos = armJoints[3].position;
-    for (size_t i = 4; i < armJoints.size(); ++i) {
-        Vec3 originalPos = armJoints[i].position;
-        // Translate to elbow origin
-        Vec3 relativePos = { originalPos.x - elbowPos.x, originalPos.y - elbowPos.y, originalPos.z - elbowPos.z };
-
-        // Apply rotation around X-axis (pitch rotation for bending up/down)
-        float bendRad = lowerArmBend * PI / 180.0f;
-        float cosB = cosf(bendRad);
-        float sinB = sinf(bendRad);
-
-        Vec3 rotatedPos = {
-            relativePos.x,
-            relativePos.y * cosB - relativePos.z * sinB,
-            relativePos.y * sinB + relativePos.z * cosB
-        };
-
-        // Translate back from elbow origin
-        transformedJoints[i] = {
-            rotatedPos.x + elbowPos.x,
-            rotatedPos.y + elbowPos.y,
-            rotatedPos.z + elbowPos.z
-        };
-    }
+    // Upper arm joints (0-3) stay put, lower arm joints (4-7) follow the elbow bend
+    Vec3 transformedJoints[kArmJointCount];
+    poseArmJoints(*skeleton, lowerArmBend, transformedJoints);
 
     // Draw arm segments - upper arm (shoulder to elbow)
     Vec3 shoulderSocket = { 0.0f, 0.0f, 0.0f };  // Start from shoulder socket
@@ -2288,7 +2321,7 @@ static void drawLowPolyArm(const std::vector<ArmJoint>& armJoints) {
     // Determine which hand this is and apply appropriate rotations
     if (&armJoints == &g_ArmJoints) {
         // Left hand - rotate based on boxing stance
-        if (gInBoxingStance) {
+        if (character.inBoxingStance) {
             // Boxing stance: palm facing down
             glRotatef(90.0f, 1.0f, 0.0f, 0.0f);  // Rotate around X-axis to make palm face down
             glRotatef(180.0f, 0.0f, 0.0f, 1.0f); // Additional Z rotation for proper orientation
@@ -2300,7 +2333,7 @@ static void drawLowPolyArm(const std::vector<ArmJoint>& armJoints) {
     }
     else if (&armJoints == &g_ArmJoints2) {
         // Right hand - rotate based on boxing stance
-        if (gInBoxingStance) {
+        if (character.inBoxingStance) {
             // Boxing stance: palm facing down
             glRotatef(90.0f, 1.0f, 0.0f, 0.0f);  // Rotate around X-axis to make palm face down
             glRotatef(180.0f, 0.0f, 0.0f, 1.0f); // Additional Z rotation for proper orientation
@@ -2381,7 +2414,7 @@ static void drawLowPolyArm(const std::vector<ArmJoint>& armJoints) {
     drawJointBox(transformedJoints[7], 0.1f, 0.0f, 1.0f, 0.0f);
 
     // Draw additional joint markers for better visualization
-    for (size_t i = 1; i < transformedJoints.size(); ++i) {
+    for (int i = 1; i < kArmJointCount; ++i) {
         Vec3 pos = transformedJoints[i];
         if (i == 3) {
             // Elbow - larger red sphere
@@ -3355,24 +3388,24 @@ KungFuPose lerpPose(const KungFuPose& from, const KungFuPose& to, float t) {
     return result;
 }
 
-void updateKungFuAnimation(float deltaTime) {
-    if (!gKungFuAnimating) return;
+void updateKungFuAnimation(CharacterState& character, float deltaTime) {
+    if (!character.kungFuAnimating) return;
 
-    gKungFuAnimationTime += deltaTime * KUNGFU_ANIMATION_SPEED;
+    character.kungFuAnimationTime += deltaTime * KUNGFU_ANIMATION_SPEED;
 
     // Calculate which phase we're in and progress within that phase
-    float totalPhaseTime = gKungFuAnimationTime;
+    float totalPhaseTime = character.kungFuAnimationTime;
     int currentPhase = (int)(totalPhaseTime / PHASE_DURATION) % 4;
     float phaseProgress = fmodf(totalPhaseTime, PHASE_DURATION) / PHASE_DURATION;
 
     // Get the current sequence based on style
     KungFuPose* sequence;
-    switch (gKungFuPattern) {
+    switch (character.kungFuPattern) {
     case 1: sequence = gCraneSequence; break;
     case 2: sequence = gDragonSequence; break;
     case 3: sequence = gTigerSequence; break;
     default:
-        gKungFuAnimating = false;
+        character.kungFuAnimating = false;
         return;
     }
 
@@ -3380,89 +3413,234 @@ void updateKungFuAnimation(float deltaTime) {
     KungFuPose fromPose = sequence[currentPhase];
     KungFuPose toPose = sequence[(currentPhase + 1) % 4];
 
-    gCurrentPose = lerpPose(fromPose, toPose, phaseProgress);
+    character.currentPose = lerpPose(fromPose, toPose, phaseProgress);
 
     // Update global pose for torso
-    g_pose.torsoYaw = gCurrentPose.torsoYaw;
-    g_pose.torsoPitch = gCurrentPose.torsoPitch;
-    g_pose.torsoRoll = gCurrentPose.torsoRoll;
+    character.pose.torsoYaw = character.currentPose.torsoYaw;
+    character.pose.torsoPitch = character.currentPose.torsoPitch;
+    character.pose.torsoRoll = character.currentPose.torsoRoll;
 }
 
-void startKungFuAnimation(int style) {
+void startKungFuAnimation(CharacterState& character, int style) {
     if (style == 0) {
-        gKungFuAnimating = false;
-        gKungFuPattern = 0;
+        character.kungFuAnimating = false;
+        character.kungFuPattern = 0;
         // Reset to neutral pose
-        g_pose.torsoYaw = 0.0f;
-        g_pose.torsoPitch = 0.0f;
-        g_pose.torsoRoll = 0.0f;
+        character.pose.torsoYaw = 0.0f;
+        character.pose.torsoPitch = 0.0f;
+        character.pose.torsoRoll = 0.0f;
         return;
     }
 
-    gKungFuPattern = style;
-    gKungFuAnimating = true;
-    gKungFuAnimationTime = 0.0f;
-    gKungFuAnimationPhase = 0;
+    character.kungFuPattern = style;
+    character.kungFuAnimating = true;
+    character.kungFuAnimationTime = 0.0f;
+    character.kungFuAnimationPhase = 0;
 }
 
-// --------------------- Animation and Drawing from leg.cpp ---------------------
-void animateLegVertices(float hipAngle, float kneeAngle, bool mirror) {
-    if (gAnimatedVertices.size() != gAllVertices.size()) {
-        gAnimatedVertices.resize(gAllVertices.size());
-        gAnimatedNormals.resize(gAllVertices.size());
+// --------------------- Leg skinning layout ---------------------
+// Pose last written to gAnimatedVertices/Normals; an unchanged pose (split
+// viewport, idle) is neither re-skinned nor re-uploaded
+struct LegSkinnedPose { bool valid; float hip, knee; Skinning::Method method; };
+LegSkinnedPose gLegSkinnedPose[2] = { { false, 0.0f, 0.0f, Skinning::LINEAR_BLEND }, { false, 0.0f, 0.0f, Skinning::LINEAR_BLEND } };
+double gLegSkinMs = 0.0;   // Time animateLegs() spent skinning on the CPU, added up until reset (bench_headless)
+
+// Builds the skinning rest pose, which groups vertices by the joints that move
+// them (shin, knee blend band, thigh), and remaps every per-vertex array and
+// index list to that order so the engine streams through each group linearly.
+void partitionLegMesh() {
+    const size_t n = gAllVertices.size();
+    std::vector<int> order;
+    LegSkinning::buildRestPose(gAllVertices.data(), gVertexNormals.data(), n, gLegJoints, gLegRestPose, order);
+
+    std::vector<int> remap(n);
+    std::vector<Vec3f> vertices(n), normals(n);
+    std::vector<Vec2f> uvs(n);
+    for (size_t k = 0; k < n; ++k) {
+        remap[order[k]] = (int)k;
+        vertices[k] = gAllVertices[order[k]];
+        normals[k] = gVertexNormals[order[k]];
+        uvs[k] = gTexCoords[order[k]];
+    }
+    gAllVertices.swap(vertices);
+    gVertexNormals.swap(normals);
+    gTexCoords.swap(uvs);
+    for (auto& t : gTris) { t.a = remap[t.a]; t.b = remap[t.b]; t.c = remap[t.c]; }
+    for (auto& q : gAllQuads) for (auto& idx : q) if (idx >= 0) idx = remap[idx];
+
+    for (int leg = 0; leg < 2; ++leg) {
+        gAnimatedVertices[leg].resize(n);
+        gAnimatedNormals[leg].resize(n);
+        gLegSkinnedPose[leg].valid = false;
     }
+}
 
-    float hipRad = hipAngle * (float)M_PI / 180.0f;
-    float kneeRad = kneeAngle * (float)M_PI / 180.0f;
+// --------------------- Leg GPU buffers ---------------------
+// Topology and UVs never change, so they are uploaded once; only the skinned
+// positions/normals are streamed. Each leg has its own stream buffer so the
+// right leg's upload never waits on the left leg's draw.
+struct LegGpuBuffers {
+    GLuint uvBuffer = 0;
+    GLuint indexBuffer = 0;
+    GLuint streamBuffer[2] = { 0, 0 };      // [0] left, [1] right: positions then normals
+    GLuint restBuffer = 0;                  // Rest positions, normals, knee weights (shader skinning)
+    GLsizei indexCount = 0;
+    bool streamCurrent[2] = { false, false }; // Buffer holds gAnimatedVertices/Normals[leg]
+};
+LegGpuBuffers gLegGpu;
+bool gLegBuffersEnabled = true; // F4 - indexed vertex buffers vs immediate mode
+bool gLegShaderEnabled = true;  // F5 - skin in the vertex shader vs on the CPU
 
-    float cosHip = cosf(hipRad), sinHip = sinf(hipRad); // Use sinf/cosf
-    float cosKnee = cosf(kneeRad), sinKnee = sinf(kneeRad); // Use sinf/cosf
+// Pose requested for each leg this frame; the shader path skins from it directly
+LegSkinning::Pose gLegPose[2] = { { 0.0f, 0.0f, false }, { 0.0f, 0.0f, true } };
 
-    const float kneeY = 4.5f, kneeZ = 0.2f;
-    const float hipY = 8.5f, hipZ = -0.2f;
+static bool legBuffersActive() {
+    return gLegBuffersEnabled && gLegGpu.indexCount > 0;
+}
 
-    for (size_t i = 0; i < gAllVertices.size(); ++i) {
-        Vec3f v = gAllVertices[i];
-        Vec3f n = gVertexNormals[i];
-
-        // 1. Knee bend (only affects lower leg vertices)
-        if (v.y <= kneeY) {
-            float translatedY = v.y - kneeY;
-            float translatedZ = v.z - kneeZ;
-            v.y = translatedY * cosKnee - translatedZ * sinKnee + kneeY;
-            v.z = translatedY * sinKnee + translatedZ * cosKnee + kneeZ;
-
-            // Also rotate the normal
-            float normalY = n.y;
-            float normalZ = n.z;
-            n.y = normalY * cosKnee - normalZ * sinKnee;
-            n.z = normalY * sinKnee + normalZ * cosKnee;
-        }
+static bool legShaderActive() {
+    return gLegShaderEnabled && gLegSkinningMethod == Skinning::LINEAR_BLEND && legBuffersActive() &&
+        gLegGpu.restBuffer != 0 && LegSkinning::shaderReady();
+}
 
-        // 2. Hip bend (affects all vertices)
-        float translatedY = v.y - hipY;
-        float translatedZ = v.z - hipZ;
-        v.y = translatedY * cosHip - translatedZ * sinHip + hipY;
-        v.z = translatedY * sinHip + translatedZ * cosHip + hipZ;
-
-        // Also rotate the normal
-        float normalY = n.y;
-        float normalZ = n.z;
-        n.y = normalY * cosHip - normalZ * sinHip;
-        n.z = normalY * sinHip + normalZ * cosHip;
-
-        // 3. Mirror if necessary
-        if (mirror) {
-            v.x *= -1.0f;
-            n.x *= -1.0f;
-        }
+void buildLegBuffers() {
+    if (!GLExt::hasVertexBuffers || gAllVertices.empty() || gAllVertices.size() > 65535) return;
+
+    // V is flipped here once instead of per vertex per frame (BMPs are stored bottom-up)
+    std::vector<Vec2f> uvs(gTexCoords.size());
+    for (size_t i = 0; i < gTexCoords.size(); ++i) uvs[i] = { gTexCoords[i].u, 1.0f - gTexCoords[i].v };
+
+    std::vector<GLushort> indices;
+    indices.reserve(gTris.size() * 3);
+    for (const auto& t : gTris) {
+        indices.push_back((GLushort)t.a); indices.push_back((GLushort)t.b); indices.push_back((GLushort)t.c);
+    }
+
+    GLExt::GenBuffers(1, &gLegGpu.uvBuffer);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, gLegGpu.uvBuffer);
+    GLExt::BufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(Vec2f), uvs.data(), GL_STATIC_DRAW);
+
+    GLExt::GenBuffers(2, gLegGpu.streamBuffer);
+    for (int i = 0; i < 2; ++i) {
+        GLExt::BindBuffer(GL_ARRAY_BUFFER, gLegGpu.streamBuffer[i]);
+        GLExt::BufferData(GL_ARRAY_BUFFER, gAllVertices.size() * 2 * sizeof(Vec3f), nullptr, GL_STREAM_DRAW);
+    }
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Same knee weights as the CPU rest pose, baked per vertex
+    if (LegSkinning::initShader()) {
+        const size_t n = gAllVertices.size();
+        std::vector<float> weights(n);
+        for (size_t i = 0; i < n; ++i) weights[i] = LegSkinning::kneeWeight(gAllVertices[i].y, gLegJoints);
+        const GLExt::SizeiPtr bytes = n * sizeof(Vec3f);
+        GLExt::GenBuffers(1, &gLegGpu.restBuffer);
+        GLExt::BindBuffer(GL_ARRAY_BUFFER, gLegGpu.restBuffer);
+        GLExt::BufferData(GL_ARRAY_BUFFER, bytes * 2 + n * sizeof(float), nullptr, GL_STATIC_DRAW);
+        GLExt::BufferSubData(GL_ARRAY_BUFFER, 0, bytes, gAllVertices.data());
+        GLExt::BufferSubData(GL_ARRAY_BUFFER, bytes, bytes, gVertexNormals.data());
+        GLExt::BufferSubData(GL_ARRAY_BUFFER, bytes * 2, n * sizeof(float), weights.data());
+        GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GLExt::GenBuffers(1, &gLegGpu.indexBuffer);
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, gLegGpu.indexBuffer);
+    GLExt::BufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    gLegGpu.indexCount = (GLsizei)indices.size();
+    LOG_INFO("Leg mesh: %zu vertices, %zu triangles in vertex buffers, skinned on the %s",
+        gAllVertices.size(), gTris.size(), gLegGpu.restBuffer ? "GPU" : "CPU");
+}
+
+void releaseLegBuffers() {
+    if (gLegGpu.indexCount == 0) return;
+    GLExt::DeleteBuffers(1, &gLegGpu.uvBuffer);
+    GLExt::DeleteBuffers(2, gLegGpu.streamBuffer);
+    if (gLegGpu.restBuffer) GLExt::DeleteBuffers(1, &gLegGpu.restBuffer);
+    GLExt::DeleteBuffers(1, &gLegGpu.indexBuffer);
+    LegSkinning::releaseShader();
+    gLegGpu = LegGpuBuffers();
+}
+
+// Streams one leg's skinned positions/normals into its buffer. Orphaning the
+// store first lets the driver hand back fresh memory instead of synchronising
+// with a draw that still reads the previous pose.
+static void uploadLegPose(int leg) {
+    const GLExt::SizeiPtr bytes = gAnimatedVertices[leg].size() * sizeof(Vec3f);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, gLegGpu.streamBuffer[leg]);
+    GLExt::BufferData(GL_ARRAY_BUFFER, bytes * 2, nullptr, GL_STREAM_DRAW);
+    GLExt::BufferSubData(GL_ARRAY_BUFFER, 0, bytes, gAnimatedVertices[leg].data());
+    GLExt::BufferSubData(GL_ARRAY_BUFFER, bytes, bytes, gAnimatedNormals[leg].data());
+    gLegGpu.streamCurrent[leg] = true;
+}
+
+// Draws one leg from the CPU-skinned stream buffer, or from the rest pose
+// through the skinning shader when it is active
+static void drawLegBuffers(int leg) {
+    const bool shader = legShaderActive();
+    if (!shader && !gLegGpu.streamCurrent[leg]) uploadLegPose(leg);
+    const GLExt::SizeiPtr bytes = gAllVertices.size() * sizeof(Vec3f);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, shader ? gLegGpu.restBuffer : gLegGpu.streamBuffer[leg]);
+    glVertexPointer(3, GL_FLOAT, 0, (const void*)0);
+    glNormalPointer(GL_FLOAT, 0, (const void*)bytes);
+    if (shader) {
+        GLExt::EnableVertexAttribArray(LegSkinning::kKneeWeightAttribute);
+        GLExt::VertexAttribPointer(LegSkinning::kKneeWeightAttribute, 1, GL_FLOAT, GL_FALSE, 0, (const void*)(bytes * 2));
+        LegSkinning::bindShader(gLegJoints, gLegPose[leg]);
+    }
+    if (gRenderMode == RM_TEXTURED) {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        GLExt::BindBuffer(GL_ARRAY_BUFFER, gLegGpu.uvBuffer);
+        glTexCoordPointer(2, GL_FLOAT, 0, (const void*)0);
+    }
+
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, gLegGpu.indexBuffer);
+    glDrawElements(GL_TRIANGLES, gLegGpu.indexCount, GL_UNSIGNED_SHORT, (const void*)0);
 
-        gAnimatedVertices[i] = v;
-        gAnimatedNormals[i] = n;
+    if (shader) {
+        LegSkinning::unbindShader();
+        GLExt::DisableVertexAttribArray(LegSkinning::kKneeWeightAttribute);
     }
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
 }
 
-void drawLeg() {
+// --------------------- Animation and Drawing from leg.cpp ---------------------
+// Skins both legs on the shared skinning engine (skinning.cpp); with the
+// skinning shader active only the pose is recorded
+void animateLegs(float hipAngleL, float kneeAngleL, float hipAngleR, float kneeAngleR) {
+    gLegPose[0] = { hipAngleL, kneeAngleL, false };
+    gLegPose[1] = { hipAngleR, kneeAngleR, true };
+    if (legShaderActive()) return;
+
+    const float hip[2] = { hipAngleL, hipAngleR }, knee[2] = { kneeAngleL, kneeAngleR };
+    bool unchanged = true;
+    for (int leg = 0; leg < 2; ++leg) {
+        const LegSkinnedPose& p = gLegSkinnedPose[leg];
+        unchanged = unchanged && p.valid && p.hip == hip[leg] && p.knee == knee[leg] && p.method == gLegSkinningMethod;
+    }
+    if (unchanged || gLegRestPose.count != gAllVertices.size()) return;
+
+    Vec3f* const positions[2] = { gAnimatedVertices[0].data(), gAnimatedVertices[1].data() };
+    Vec3f* const normals[2] = { gAnimatedNormals[0].data(), gAnimatedNormals[1].data() };
+    const double start = Platform::timeSeconds();
+    LegSkinning::skin(gLegRestPose, gLegPose, gLegSkinningMethod, positions, normals);
+    gLegSkinMs += (Platform::timeSeconds() - start) * 1000.0;
+
+    for (int leg = 0; leg < 2; ++leg) {
+        gLegSkinnedPose[leg] = { true, hip[leg], knee[leg], gLegSkinningMethod };
+        gLegGpu.streamCurrent[leg] = false;
+    }
+}
+
+void drawLeg(int leg) {
+    GL_STATS_SCOPE(SUB_LEGS);
     // Set material/texture based on the current render mode
     if (gRenderMode == RM_TEXTURED) {
         glEnable(GL_TEXTURE_2D);
@@ -3474,12 +3652,20 @@ void drawLeg() {
         glColor3f(0.9f, 0.7f, 0.6f); // Solid/wireframe skin color
     }
 
+    if (legBuffersActive()) {
+        drawLegBuffers(leg); // One indexed draw, no per-vertex calls
+        if (gRenderMode == RM_TEXTURED) {
+            Tex::unbind();
+        }
+        return;
+    }
+
     glBegin(GL_TRIANGLES);
     for (const auto& t : gTris) {
         auto emit = [&](int vertexIndex) {
             const Vec2f& uv = gTexCoords[vertexIndex];
-            const Vec3f& n = gAnimatedNormals[vertexIndex];
-            const Vec3f& v = gAnimatedVertices[vertexIndex];
+            const Vec3f& n = gAnimatedNormals[leg][vertexIndex];
+            const Vec3f& v = gAnimatedVertices[leg][vertexIndex];
 
             glNormal3f(n.x, n.y, n.z);
             if (gRenderMode == RM_TEXTURED) {
@@ -4293,7 +4479,10 @@ void drawShoulderSocketsOLD() {
 //     so sword/spear/shield mapping isn’t affected.
 // [KEEP] Your pose logic and hierarchy.
 
-void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
+void drawArmsAndHands(const CharacterState& character, float leftArmAngle, float rightArmAngle) {
+    // The shield block bends the left forearm further, for this draw only
+    float leftLowerArmBend = character.leftLowerArmBend;
+    GL_STATS_SCOPE(SUB_ARMS);
     // Use animated kung fu poses if animation is active
     float leftShoulderPitch, rightShoulderPitch;
     float leftShoulderYaw, rightShoulderYaw;
@@ -4303,33 +4492,33 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
     float leftWristYaw = 0.0f, rightWristYaw = 0.0f;
     float leftWristRoll = 0.0f, rightWristRoll = 0.0f;
 
-    if (gKungFuAnimating) {
+    if (character.kungFuAnimating) {
         // Use animated pose values
-        leftShoulderPitch = gCurrentPose.leftShoulderPitch;
-        rightShoulderPitch = gCurrentPose.rightShoulderPitch;
-        leftShoulderYaw = gCurrentPose.leftShoulderYaw;
-        rightShoulderYaw = gCurrentPose.rightShoulderYaw;
-        leftShoulderRoll = gCurrentPose.leftShoulderRoll;
-        rightShoulderRoll = gCurrentPose.rightShoulderRoll;
-        leftArmAngle += gCurrentPose.leftArmAngle;
-        rightArmAngle += gCurrentPose.rightArmAngle;
-        leftElbowBend = gCurrentPose.leftElbowBend;
-        rightElbowBend = gCurrentPose.rightElbowBend;
-        leftWristPitch = gCurrentPose.leftWristPitch;
-        rightWristPitch = gCurrentPose.rightWristPitch;
+        leftShoulderPitch = character.currentPose.leftShoulderPitch;
+        rightShoulderPitch = character.currentPose.rightShoulderPitch;
+        leftShoulderYaw = character.currentPose.leftShoulderYaw;
+        rightShoulderYaw = character.currentPose.rightShoulderYaw;
+        leftShoulderRoll = character.currentPose.leftShoulderRoll;
+        rightShoulderRoll = character.currentPose.rightShoulderRoll;
+        leftArmAngle += character.currentPose.leftArmAngle;
+        rightArmAngle += character.currentPose.rightArmAngle;
+        leftElbowBend = character.currentPose.leftElbowBend;
+        rightElbowBend = character.currentPose.rightElbowBend;
+        leftWristPitch = character.currentPose.leftWristPitch;
+        rightWristPitch = character.currentPose.rightWristPitch;
 
         // Apply realistic hand forms during animation while preserving wrist connection
         Vec3 leftWristBackup = g_HandJoints[0].position;
         Vec3 rightWristBackup = g_HandJoints2[0].position;
 
-        setHandForm(g_HandJoints, gCurrentPose.leftHandForm);
-        setHandForm(g_HandJoints2, gCurrentPose.rightHandForm);
+        setHandForm(g_HandJoints, character.currentPose.leftHandForm);
+        setHandForm(g_HandJoints2, character.currentPose.rightHandForm);
 
         // Restore wrist positions to maintain arm connection
         g_HandJoints[0].position = leftWristBackup;
         g_HandJoints2[0].position = rightWristBackup;
     }
-    else if (gSwordAttackAnimating) {
+    else if (character.swordAttackAnimating) {
         // Use sword attack pose values - warrior-like sword attack stance
         // Create realistic warrior sword attack with proper arm bending patterns
         
@@ -4341,20 +4530,20 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
         // Determine which arm holds the sword and calculate realistic warrior movements
         if (gWeaponInRightHand) {
             // Right arm sword attack - realistic overhead to forward swing
-            switch (gSwordAttackPhase) {
+            switch (character.swordAttackPhase) {
                 case 1: // Wind up phase - raise arm high above head
-                    swordArmPitch = 120.0f + gSwordAttackShoulderOffset; // High overhead position
-                    swordElbowBend = 70.0f + abs(gSwordAttackShoulderOffset) * 0.8f; // Bent elbow for power
+                    swordArmPitch = 120.0f + character.swordAttackShoulderOffset; // High overhead position
+                    swordElbowBend = 70.0f + abs(character.swordAttackShoulderOffset) * 0.8f; // Bent elbow for power
                     balanceArmPitch = 60.0f; // Left arm raised for balance
                     break;
                 case 2: // Strike phase - powerful downward swing
-                    swordArmPitch = 45.0f + gSwordAttackArmExtension; // Swinging down and forward
-                    swordElbowBend = 25.0f + gSwordAttackArmExtension * 0.4f; // Extending for reach
+                    swordArmPitch = 45.0f + character.swordAttackArmExtension; // Swinging down and forward
+                    swordElbowBend = 25.0f + character.swordAttackArmExtension * 0.4f; // Extending for reach
                     balanceArmPitch = 90.0f; // Left arm extended for balance
                     break;
                 case 3: // Follow through - arm extends fully forward
-                    swordArmPitch = 30.0f + gSwordAttackArmExtension * 0.7f; // Forward completion
-                    swordElbowBend = 10.0f + gSwordAttackArmExtension * 0.2f; // Nearly straight
+                    swordArmPitch = 30.0f + character.swordAttackArmExtension * 0.7f; // Forward completion
+                    swordElbowBend = 10.0f + character.swordAttackArmExtension * 0.2f; // Nearly straight
                     balanceArmPitch = 45.0f; // Left arm settling
                     break;
                 default: // Default/ready position
@@ -4366,31 +4555,31 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             
             // Apply to right arm (sword arm) and left arm (balance arm)
             rightShoulderPitch = swordArmPitch + rightArmAngle;
-            rightShoulderYaw = 20.0f + gSwordAttackTorsoRotation * 0.8f;
-            rightShoulderRoll = 40.0f + gSwordAttackArmExtension;
+            rightShoulderYaw = 20.0f + character.swordAttackTorsoRotation * 0.8f;
+            rightShoulderRoll = 40.0f + character.swordAttackArmExtension;
             rightElbowBend = swordElbowBend;
             
             leftShoulderPitch = balanceArmPitch + leftArmAngle;
-            leftShoulderYaw = -20.0f - gSwordAttackTorsoRotation * 0.3f;
+            leftShoulderYaw = -20.0f - character.swordAttackTorsoRotation * 0.3f;
             leftShoulderRoll = -40.0f;
-            leftElbowBend = 20.0f + gSwordAttackShoulderOffset * 0.3f;
+            leftElbowBend = 20.0f + character.swordAttackShoulderOffset * 0.3f;
             
         } else {
             // Left arm sword attack - mirror the movements
-            switch (gSwordAttackPhase) {
+            switch (character.swordAttackPhase) {
                 case 1: // Wind up phase - raise arm high above head
-                    swordArmPitch = 120.0f + gSwordAttackShoulderOffset;
-                    swordElbowBend = 70.0f + abs(gSwordAttackShoulderOffset) * 0.8f;
+                    swordArmPitch = 120.0f + character.swordAttackShoulderOffset;
+                    swordElbowBend = 70.0f + abs(character.swordAttackShoulderOffset) * 0.8f;
                     balanceArmPitch = 60.0f;
                     break;
                 case 2: // Strike phase - powerful downward swing
-                    swordArmPitch = 45.0f + gSwordAttackArmExtension;
-                    swordElbowBend = 25.0f + gSwordAttackArmExtension * 0.4f;
+                    swordArmPitch = 45.0f + character.swordAttackArmExtension;
+                    swordElbowBend = 25.0f + character.swordAttackArmExtension * 0.4f;
                     balanceArmPitch = 90.0f;
                     break;
                 case 3: // Follow through - arm extends fully forward
-                    swordArmPitch = 30.0f + gSwordAttackArmExtension * 0.7f;
-                    swordElbowBend = 10.0f + gSwordAttackArmExtension * 0.2f;
+                    swordArmPitch = 30.0f + character.swordAttackArmExtension * 0.7f;
+                    swordElbowBend = 10.0f + character.swordAttackArmExtension * 0.2f;
                     balanceArmPitch = 45.0f;
                     break;
                 default:
@@ -4402,14 +4591,14 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             
             // Apply to left arm (sword arm) and right arm (balance arm)
             leftShoulderPitch = swordArmPitch + leftArmAngle;
-            leftShoulderYaw = -20.0f - gSwordAttackTorsoRotation * 0.8f;
-            leftShoulderRoll = -40.0f - gSwordAttackArmExtension;
+            leftShoulderYaw = -20.0f - character.swordAttackTorsoRotation * 0.8f;
+            leftShoulderRoll = -40.0f - character.swordAttackArmExtension;
             leftElbowBend = swordElbowBend;
             
             rightShoulderPitch = balanceArmPitch + rightArmAngle;
-            rightShoulderYaw = 20.0f + gSwordAttackTorsoRotation * 0.3f;
+            rightShoulderYaw = 20.0f + character.swordAttackTorsoRotation * 0.3f;
             rightShoulderRoll = 40.0f;
-            rightElbowBend = 20.0f + gSwordAttackShoulderOffset * 0.3f;
+            rightElbowBend = 20.0f + character.swordAttackShoulderOffset * 0.3f;
         }
         
         // Make sure sword-holding hand forms a proper grip
@@ -4423,7 +4612,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             }
         }
     }
-    else if (gSpearAttackAnimating) {
+    else if (character.spearAttackAnimating) {
         // Use spear attack pose values - spear thrust stance
         // Create realistic spear thrust with proper arm extension patterns
         
@@ -4435,20 +4624,20 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
         // Determine which arm holds the spear and calculate realistic thrust movements
         if (gWeaponInRightHand) {
             // Right arm spear attack - powerful forward thrust
-            switch (gSpearAttackPhase) {
+            switch (character.spearAttackPhase) {
                 case 1: // Wind up phase - pull spear back for thrust
-                    spearArmPitch = 70.0f + gSpearAttackShoulderOffset * 0.5f;
-                    spearElbowBend = 40.0f + abs(gSpearAttackShoulderOffset) * 0.6f;
+                    spearArmPitch = 70.0f + character.spearAttackShoulderOffset * 0.5f;
+                    spearElbowBend = 40.0f + abs(character.spearAttackShoulderOffset) * 0.6f;
                     balanceArmPitch = 45.0f;
                     break;
                 case 2: // Thrust phase - explosive forward extension
-                    spearArmPitch = 30.0f + gSpearAttackArmExtension * 0.4f;
-                    spearElbowBend = 10.0f + gSpearAttackArmExtension * 0.2f;
+                    spearArmPitch = 30.0f + character.spearAttackArmExtension * 0.4f;
+                    spearElbowBend = 10.0f + character.spearAttackArmExtension * 0.2f;
                     balanceArmPitch = 80.0f;
                     break;
                 case 3: // Follow through - controlled recovery
-                    spearArmPitch = 50.0f + gSpearAttackArmExtension * 0.3f;
-                    spearElbowBend = 25.0f + gSpearAttackArmExtension * 0.3f;
+                    spearArmPitch = 50.0f + character.spearAttackArmExtension * 0.3f;
+                    spearElbowBend = 25.0f + character.spearAttackArmExtension * 0.3f;
                     balanceArmPitch = 60.0f;
                     break;
             }
@@ -4456,36 +4645,36 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             leftShoulderPitch = 90.0f + balanceArmPitch + leftArmAngle;
             rightShoulderPitch = spearArmPitch + rightArmAngle;
             leftShoulderYaw = -20.0f;
-            rightShoulderYaw = 20.0f + gSpearAttackShoulderOffset * 0.3f;
+            rightShoulderYaw = 20.0f + character.spearAttackShoulderOffset * 0.3f;
             leftShoulderRoll = -40.0f;
-            rightShoulderRoll = 40.0f + gSpearAttackShoulderOffset * 0.5f;
+            rightShoulderRoll = 40.0f + character.spearAttackShoulderOffset * 0.5f;
             leftElbowBend = 20.0f;
             rightElbowBend = spearElbowBend;
         } else {
             // Left arm spear attack - mirror the movements
-            switch (gSpearAttackPhase) {
+            switch (character.spearAttackPhase) {
                 case 1: // Wind up phase - pull spear back for thrust
-                    spearArmPitch = 70.0f + gSpearAttackShoulderOffset * 0.5f;
-                    spearElbowBend = 40.0f + abs(gSpearAttackShoulderOffset) * 0.6f;
+                    spearArmPitch = 70.0f + character.spearAttackShoulderOffset * 0.5f;
+                    spearElbowBend = 40.0f + abs(character.spearAttackShoulderOffset) * 0.6f;
                     balanceArmPitch = 45.0f;
                     break;
                 case 2: // Thrust phase - explosive forward extension
-                    spearArmPitch = 30.0f + gSpearAttackArmExtension * 0.4f;
-                    spearElbowBend = 10.0f + gSpearAttackArmExtension * 0.2f;
+                    spearArmPitch = 30.0f + character.spearAttackArmExtension * 0.4f;
+                    spearElbowBend = 10.0f + character.spearAttackArmExtension * 0.2f;
                     balanceArmPitch = 80.0f;
                     break;
                 case 3: // Follow through - controlled recovery
-                    spearArmPitch = 50.0f + gSpearAttackArmExtension * 0.3f;
-                    spearElbowBend = 25.0f + gSpearAttackArmExtension * 0.3f;
+                    spearArmPitch = 50.0f + character.spearAttackArmExtension * 0.3f;
+                    spearElbowBend = 25.0f + character.spearAttackArmExtension * 0.3f;
                     balanceArmPitch = 60.0f;
                     break;
             }
             
             leftShoulderPitch = spearArmPitch + leftArmAngle;
             rightShoulderPitch = 90.0f + balanceArmPitch + rightArmAngle;
-            leftShoulderYaw = -20.0f + gSpearAttackShoulderOffset * 0.3f;
+            leftShoulderYaw = -20.0f + character.spearAttackShoulderOffset * 0.3f;
             rightShoulderYaw = 20.0f;
-            leftShoulderRoll = -40.0f + gSpearAttackShoulderOffset * 0.5f;
+            leftShoulderRoll = -40.0f + character.spearAttackShoulderOffset * 0.5f;
             rightShoulderRoll = 40.0f;
             leftElbowBend = spearElbowBend;
             rightElbowBend = 20.0f;
@@ -4502,7 +4691,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             }
         }
     }
-    else if (gShieldBlockAnimating) {
+    else if (character.shieldBlockAnimating) {
         // Use shield block pose values - tactical defensive stance
         // Create realistic shield blocking with arm bent up to protect body
         
@@ -4511,21 +4700,21 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
         float balanceArmPitch = 0.0f;
         
         // Shield is held in left arm with bent elbow for body protection
-        switch (gShieldBlockPhase) {
+        switch (character.shieldBlockPhase) {
             case 1: // Raise phase - quickly raise shield with bent arm
-                shieldArmPitch = 45.0f + gShieldBlockArmRaise * 0.5f; // Less shoulder raise, more elbow bend
-                shieldElbowBend = 120.0f + gShieldBlockArmRaise * 0.8f; // High elbow bend for protection
-                balanceArmPitch = 30.0f + gShieldBlockArmRaise * 0.2f;
+                shieldArmPitch = 45.0f + character.shieldBlockArmRaise * 0.5f; // Less shoulder raise, more elbow bend
+                shieldElbowBend = 120.0f + character.shieldBlockArmRaise * 0.8f; // High elbow bend for protection
+                balanceArmPitch = 30.0f + character.shieldBlockArmRaise * 0.2f;
                 break;
             case 2: // Hold phase - maintain defensive position with shield protecting torso
-                shieldArmPitch = 45.0f + gShieldBlockArmRaise * 0.5f;
-                shieldElbowBend = 120.0f + gShieldBlockArmRaise * 0.8f; // Keep high elbow bend
-                balanceArmPitch = 30.0f + gShieldBlockArmRaise * 0.2f;
+                shieldArmPitch = 45.0f + character.shieldBlockArmRaise * 0.5f;
+                shieldElbowBend = 120.0f + character.shieldBlockArmRaise * 0.8f; // Keep high elbow bend
+                balanceArmPitch = 30.0f + character.shieldBlockArmRaise * 0.2f;
                 break;
             case 3: // Lower phase - controlled return
-                shieldArmPitch = 45.0f + gShieldBlockArmRaise * 0.5f;
-                shieldElbowBend = 120.0f + gShieldBlockArmRaise * 0.8f;
-                balanceArmPitch = 30.0f + gShieldBlockArmRaise * 0.2f;
+                shieldArmPitch = 45.0f + character.shieldBlockArmRaise * 0.5f;
+                shieldElbowBend = 120.0f + character.shieldBlockArmRaise * 0.8f;
+                balanceArmPitch = 30.0f + character.shieldBlockArmRaise * 0.2f;
                 break;
         }
         
@@ -4541,8 +4730,8 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
         
         // Apply enhanced lower arm bending for better body defense positioning
         // Bend the left lower arm (forearm) up significantly more while keeping upper arm stable
-        if (gShieldBlockPhase >= 1) {
-            gLeftLowerArmBend = -80.0f * (gShieldBlockArmRaise / 80.0f); // Increased to -80° for more pronounced forearm bend
+        if (character.shieldBlockPhase >= 1) {
+            leftLowerArmBend = -80.0f * (character.shieldBlockArmRaise / 80.0f); // Increased to -80° for more pronounced forearm bend
         }
         
         // Shield blocking hand form
@@ -4551,19 +4740,19 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             setHandForm(g_HandJoints2, HAND_OPEN); // Right hand ready for action
         }
     }
-    else if (gBoxingAnimActive || gInBoxingStance) {
+    else if (character.boxingAnimActive || character.inBoxingStance) {
         // Use boxing stance pose values
-        leftShoulderPitch = gCurrentLeftShoulderPitch;
-        rightShoulderPitch = gCurrentRightShoulderPitch;
-        leftShoulderYaw = gCurrentLeftShoulderYaw;
-        rightShoulderYaw = gCurrentRightShoulderYaw;
-        leftShoulderRoll = gCurrentLeftShoulderRoll;   // Use the 180-degree rotation
-        rightShoulderRoll = gCurrentRightShoulderRoll; // Use the 180-degree rotation
+        leftShoulderPitch = character.currentLeftShoulderPitch;
+        rightShoulderPitch = character.currentRightShoulderPitch;
+        leftShoulderYaw = character.currentLeftShoulderYaw;
+        rightShoulderYaw = character.currentRightShoulderYaw;
+        leftShoulderRoll = character.currentLeftShoulderRoll;   // Use the 180-degree rotation
+        rightShoulderRoll = character.currentRightShoulderRoll; // Use the 180-degree rotation
 
         // Boxing stance doesn't affect leg animation angles
         // leftArmAngle and rightArmAngle remain as they are
 
-        // Note: elbow bending is now handled in drawLowPolyArm via gCurrentLeftElbowBend/gCurrentRightElbowBend
+        // Note: elbow bending is now handled in drawLowPolyArm via currentLeftElbowBend/currentRightElbowBend
         leftElbowBend = 0.0f; // Not used anymore, handled in arm drawing
         rightElbowBend = 0.0f; // Not used anymore, handled in arm drawing
 
@@ -4600,7 +4789,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
         bool needRightSpearGrip = gSpearVisible && gWeaponInRightHand;
         bool needLeftShieldGrip = gShieldVisible; // Left hand holds shield
 
-        if (!gFistAnimationActive && !gIsFist && !needLeftSwordGrip && !needRightSwordGrip && !needLeftSpearGrip && !needRightSpearGrip && !needLeftShieldGrip) {
+        if (!character.fistAnimationActive && !character.isFist && !needLeftSwordGrip && !needRightSwordGrip && !needLeftSpearGrip && !needRightSpearGrip && !needLeftShieldGrip) {
             if (g_OriginalHandJoints.size() == g_HandJoints.size()) g_HandJoints = g_OriginalHandJoints;
             if (g_OriginalHandJoints2.size() == g_HandJoints2.size()) g_HandJoints2 = g_OriginalHandJoints2;
         }
@@ -4668,7 +4857,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             
             //shield 位置
             // Adjust shield position based on animation state
-            if (gShieldBlockAnimating && gShieldBlockPhase >= 1) {
+            if (character.shieldBlockAnimating && character.shieldBlockPhase >= 1) {
                 // During shield defense animation - completely cover hand
                 glTranslatef(0.1f, -0.5f, 0.5f); // Position for defensive coverage with grip alignment
                 glRotatef(-60.0f, 0, 1, 0); // Enhanced Y rotation for frontal coverage
@@ -4696,7 +4885,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             }
             if (gRenderMode != RM_TEXTURED) glColor3f(0.75f, 0.75f, 0.8f); // Armor color
             glScalef(ARM_SCALE * 1.15f, ARM_SCALE * 1.15f, ARM_SCALE * 1.15f);
-            drawLowPolyArm(g_ArmJoints);
+            drawLowPolyArm(character, g_ArmJoints, character.currentLeftElbowBend + (-leftLowerArmBend));
         }
         else {
             if (gRenderMode == RM_TEXTURED) {
@@ -4705,7 +4894,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             }
             if (gRenderMode != RM_TEXTURED) glColor3f(0.9f, 0.7f, 0.6f);
             glScalef(ARM_SCALE, ARM_SCALE, ARM_SCALE);
-            drawLowPolyArm(g_ArmJoints);
+            drawLowPolyArm(character, g_ArmJoints, character.currentLeftElbowBend + (-leftLowerArmBend));
         }
         glPopMatrix();
 
@@ -4721,11 +4910,11 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
 
         Vec3 elbowPos = g_ArmJoints[3].position;
         glTranslatef(elbowPos.x * ARM_SCALE, elbowPos.y * ARM_SCALE, elbowPos.z * ARM_SCALE);
-        glRotatef(gLeftLowerArmBend, 1.0f, 0.0f, 0.0f);  // Use new lower arm bend system
+        glRotatef(leftLowerArmBend, 1.0f, 0.0f, 0.0f);  // Use new lower arm bend system
         glTranslatef(-elbowPos.x * ARM_SCALE, -elbowPos.y * ARM_SCALE, -elbowPos.z * ARM_SCALE);
 
         // Get transformed wrist position that accounts for lower arm bending
-        Vec3 leftWristPos = getTransformedWristPosition(g_ArmJoints, gCurrentLeftElbowBend + (-gLeftLowerArmBend));
+        Vec3 leftWristPos = getTransformedWristPosition(gArmSkeleton[0], character.currentLeftElbowBend + (-leftLowerArmBend));
         glTranslatef(leftWristPos.x * ARM_SCALE, leftWristPos.y * ARM_SCALE, leftWristPos.z * ARM_SCALE);
         glRotatef(leftWristPitch, 1.0f, 0.0f, 0.0f);  // Use animated wrist pitch
         glRotatef(leftWristYaw, 0.0f, 1.0f, 0.0f);    // Use animated wrist yaw
@@ -4791,7 +4980,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             }
             if (gRenderMode != RM_TEXTURED) glColor3f(0.75f, 0.75f, 0.8f); // Armor color
             glScalef(ARM_SCALE * 1.15f, ARM_SCALE * 1.15f, ARM_SCALE * 1.15f);
-            drawLowPolyArm(g_ArmJoints2);
+            drawLowPolyArm(character, g_ArmJoints2, character.currentRightElbowBend + (-character.rightLowerArmBend));
         }
         else {
             if (gRenderMode == RM_TEXTURED) {
@@ -4800,7 +4989,7 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
             }
             if (gRenderMode != RM_TEXTURED) glColor3f(0.9f, 0.7f, 0.6f);
             glScalef(ARM_SCALE, ARM_SCALE, ARM_SCALE);
-            drawLowPolyArm(g_ArmJoints2);
+            drawLowPolyArm(character, g_ArmJoints2, character.currentRightElbowBend + (-character.rightLowerArmBend));
         }
         glPopMatrix();
 
@@ -4820,11 +5009,11 @@ void drawArmsAndHands(float leftArmAngle, float rightArmAngle) {
 
         Vec3 rightElbowPos = g_ArmJoints2[3].position;
         glTranslatef(rightElbowPos.x * ARM_SCALE, rightElbowPos.y * ARM_SCALE, rightElbowPos.z * ARM_SCALE);
-        glRotatef(gRightLowerArmBend, 1.0f, 0.0f, 0.0f);  // Use new lower arm bend system
+        glRotatef(character.rightLowerArmBend, 1.0f, 0.0f, 0.0f);  // Use new lower arm bend system
         glTranslatef(-rightElbowPos.x * ARM_SCALE, -rightElbowPos.y * ARM_SCALE, -rightElbowPos.z * ARM_SCALE);
 
         // Get transformed wrist position that accounts for lower arm bending
-        Vec3 rightWristPos = getTransformedWristPosition(g_ArmJoints2, gCurrentRightElbowBend + (-gRightLowerArmBend));
+        Vec3 rightWristPos = getTransformedWristPosition(gArmSkeleton[1], character.currentRightElbowBend + (-character.rightLowerArmBend));
         glTranslatef(rightWristPos.x * ARM_SCALE, rightWristPos.y * ARM_SCALE, rightWristPos.z * ARM_SCALE);
         glRotatef(rightWristPitch, 1.0f, 0.0f, 0.0f);  // Use animated wrist pitch
         glRotatef(rightWristYaw, 0.0f, 1.0f, 0.0f);    // Use animated wrist yaw  
@@ -4919,8 +5108,9 @@ void drawTexturedNeck() {
 //          Torso uses its own texture inside drawTorso(); head/neck use skin here.
 //          Nothing else in your animation flow changes.
 
-void drawBodyAndHead(float leftLegAngle, float rightLegAngle, float leftArmAngle, float rightArmAngle)
+void drawBodyAndHead(const CharacterState& character, float leftLegAngle, float rightLegAngle, float leftArmAngle, float rightArmAngle)
 {
+    GL_STATS_SCOPE(SUB_HEAD);
     glPushMatrix();
 
     // [KEEP] Body placement to meet the leg tops (your comment about 6.0f is fine)
@@ -4929,32 +5119,32 @@ void drawBodyAndHead(float leftLegAngle, float rightLegAngle, float leftArmAngle
 
     // Enhanced: Apply shoulder sway for natural walking
     float shoulderSway = 0.0f;
-    if (fabsf(gMoveSpeed) > 0.1f) {
-        float phase = gWalkPhase;
+    if (fabsf(character.moveSpeed) > 0.1f) {
+        float phase = character.walkPhase;
         shoulderSway = -sinf(phase * 0.5f + STEP_TIMING_OFFSET) * SHOULDER_COUNTER_SWAY;
     }
     glRotatef(shoulderSway, 0, 0, 1); // Apply shoulder sway rotation
 
     // [KEEP] Torso orientation (animated)
-    glRotatef(g_pose.torsoYaw, 0, 1, 0);
-    glRotatef(g_pose.torsoPitch, 1, 0, 0);
-    glRotatef(g_pose.torsoRoll, 0, 0, 1);
+    glRotatef(character.pose.torsoYaw, 0, 1, 0);
+    glRotatef(character.pose.torsoPitch, 1, 0, 0);
+    glRotatef(character.pose.torsoRoll, 0, 0, 1);
     
     // Apply sword attack animation torso rotation
-    if (gSwordAttackAnimating) {
-        glRotatef(gSwordAttackTorsoRotation, 0, 1, 0); // Rotate around Y-axis for sword swing
+    if (character.swordAttackAnimating) {
+        glRotatef(character.swordAttackTorsoRotation, 0, 1, 0); // Rotate around Y-axis for sword swing
     }
     // Apply spear attack animation torso rotation  
-    if (gSpearAttackAnimating) {
-        glRotatef(gSpearAttackTorsoRotation, 0, 1, 0); // Rotate around Y-axis for spear thrust
+    if (character.spearAttackAnimating) {
+        glRotatef(character.spearAttackTorsoRotation, 0, 1, 0); // Rotate around Y-axis for spear thrust
     }
     // Apply shield block animation torso lean
-    if (gShieldBlockAnimating) {
-        glRotatef(gShieldBlockTorsoLean, 1, 0, 0); // Lean back slightly for shield defense
+    if (character.shieldBlockAnimating) {
+        glRotatef(character.shieldBlockTorsoLean, 1, 0, 0); // Lean back slightly for shield defense
     }
 
     // [KEEP] Arms
-    drawArmsAndHands(leftArmAngle, rightArmAngle);
+    drawArmsAndHands(character, leftArmAngle, rightArmAngle);
 
     // [KEEP] Torso (note: your drawTorso() should bind Tex::Skirt internally)
     drawTorso();
@@ -4966,8 +5156,8 @@ void drawBodyAndHead(float leftLegAngle, float rightLegAngle, float leftArmAngle
     {
         // Enhanced: Apply head bobbing for natural walking
         float headBob = 0.0f;
-        if (fabsf(gMoveSpeed) > 0.1f) {
-            float bobPhase = gWalkPhase * 2.0f;
+        if (fabsf(character.moveSpeed) > 0.1f) {
+            float bobPhase = character.walkPhase * 2.0f;
             headBob = sinf(bobPhase) * HEAD_BOB_AMOUNT;
         }
         
@@ -4975,9 +5165,9 @@ void drawBodyAndHead(float leftLegAngle, float rightLegAngle, float leftArmAngle
         glTranslatef(0.0f, HEAD_CENTER_Y + headBob, 0.0f);
 
         // Apply head orientation (relative to torso)
-        glRotatef(g_pose.headYaw, 0, 1, 0);
-        glRotatef(g_pose.headPitch, 1, 0, 0);
-        glRotatef(g_pose.headRoll, 0, 0, 1);
+        glRotatef(character.pose.headYaw, 0, 1, 0);
+        glRotatef(character.pose.headPitch, 1, 0, 0);
+        glRotatef(character.pose.headRoll, 0, 0, 1);
 
         // Draw neck first so head sits on top seamlessly.
         // IMPORTANT: drawTexturedNeck() should use SKIN texture inside itself.
@@ -5040,11 +5230,121 @@ void setupSplitViewportPerspective() {
     gluPerspective(45.0, (double)halfWidth / gHeight, 0.1, 100.0);
 }
 
-void renderScene() {
+// --------------------- Ground following ---------------------
+// The background is drawn kBackgroundDrop lower than the character's world,
+// and the soles sit kSoleDepth below the character origin (legs are drawn at
+// y = -2 with the sole at mesh y = 0).
+const float kBackgroundDrop = 2.5f;
+const float kSoleDepth = 2.0f;
+const float kHalfFootLength = 0.75f;
+// Collision radius of the body, and its head centre above the origin (the
+// torso is drawn at y = 6, the head HEAD_CENTER_Y above it in body scale)
+const float kCharacterRadius = 1.2f;
+const float kHeadCentreHeight = 6.0f + HEAD_CENTER_Y * BODY_SCALE;
+
+// Ground height/normal in world space, from the cached terrain grid (O(1))
+float terrainHeightAt(float x, float z) {
+    return Terrain::heightAt(x, z) - kBackgroundDrop;
+}
+
+Vec3f terrainNormalAt(float x, float z) {
+    float n[3];
+    Terrain::normalAt(x, z, n);
+    return { n[0], n[1], n[2] };
+}
+
+// Where one sole touches the ground, world y. The foot is found from the
+// character's position and yaw plus the hip swing; on a slope the foot
+// rests on its higher end, half a foot length up the gradient.
+static float footGroundHeight(const CharacterState& character, int leg, float hipDegrees) {
+    const float yaw = character.yaw * PI / 180.0f;
+    const float legLength = gLegJoints.hipY;
+    const float lx = leg == 0 ? -0.75f : 0.75f;
+    const float lz = 0.55f - legLength * sinf(hipDegrees * PI / 180.0f);
+    const float x = character.position.x + lx * cosf(yaw) + lz * sinf(yaw);
+    const float z = character.position.z - lx * sinf(yaw) + lz * cosf(yaw);
+
+    const Vec3f n = terrainNormalAt(x, z);
+    const float slope = -(n.x * -sinf(yaw) + n.z * -cosf(yaw)) / n.y; // Rise per unit along the facing
+    return terrainHeightAt(x, z) + kHalfFootLength * fabsf(slope);
+}
+
+// The body stands on the lower foot (updateCharacter); a foot over higher
+// ground crouches its leg, thigh forward and shin back by the same angle, so
+// the sole rises by the difference and stays under the hip
+static void placeFeetOnTerrain(const CharacterState& character, float& hipL, float& kneeL, float& hipR, float& kneeR) {
+    float* hips[2] = { &hipL, &hipR };
+    float* knees[2] = { &kneeL, &kneeR };
+    const float legLength = gLegJoints.hipY;
+    for (int leg = 0; leg < 2; ++leg) {
+        float rise = footGroundHeight(character, leg, *hips[leg]) - (character.position.y - kSoleDepth);
+        if (rise <= 0.0f) continue;
+        rise = std::min(rise, legLength * 0.5f);
+        const float crouch = acosf(1.0f - rise / legLength) * 180.0f / PI;
+        *hips[leg] -= crouch;
+        *knees[leg] += 2.0f * crouch;
+    }
+}
+
+// The frame's hip and knee angles: the walk cycle, the attack stances, then
+// the ground under each foot (updateCharacter)
+static void updateLegAngles(CharacterState& character) {
+    float current_speed = character.runningAnim ? gRunSpeed : gWalkSpeed;
+    float max_hip_angle = character.runningAnim ? 28.0f : 18.0f;    // Enhanced: More natural range
+    float max_knee_angle = character.runningAnim ? 65.0f : 42.0f;   // Enhanced: Better knee bend
+
+    // Enhanced leg animation with more natural timing and easing
+    float left_leg_phase = character.animTime * current_speed;
+    float right_leg_phase = character.animTime * current_speed + PI;
+    
+    // Natural hip movement with easing
+    float leftHipSin = sinf(left_leg_phase);
+    float rightHipSin = sinf(right_leg_phase);
+    float hip_angle_L = character.isMoving ? (max_hip_angle * leftHipSin * 0.9f) : 0.0f;
+    float hip_angle_R = character.isMoving ? (max_hip_angle * rightHipSin * 0.9f) : 0.0f;
+    
+    // Natural knee movement with better follow-through
+    float leftKneePhase = left_leg_phase + 0.3f; // Slight delay for natural movement
+    float rightKneePhase = right_leg_phase + 0.3f;
+    float knee_angle_L = character.isMoving ? (max_knee_angle * std::max(0.0f, sinf(leftKneePhase) * 0.8f)) : 0.0f;
+    float knee_angle_R = character.isMoving ? (max_knee_angle * std::max(0.0f, sinf(rightKneePhase) * 0.8f)) : 0.0f;
+    
+    // Apply sword attack stance modifications
+    if (character.swordAttackAnimating) {
+        // Warrior stance: wider leg position, weight shifting
+        hip_angle_L += character.swordAttackLegStance * 0.5f; // Slight back leg position
+        hip_angle_R -= character.swordAttackLegStance * 0.3f; // Front leg forward
+        knee_angle_L += abs(character.swordAttackLegStance) * 0.2f; // Slight knee bend for stability
+        knee_angle_R += abs(character.swordAttackLegStance) * 0.3f; // More bend in front leg
+    }
+    
+    // Apply spear attack stance modifications
+    if (character.spearAttackAnimating) {
+        // Spear thrust stance: forward lunge position
+        hip_angle_L += character.spearAttackLegStance * 0.4f; // Back leg for stability
+        hip_angle_R -= character.spearAttackLegStance * 0.6f; // Front leg extends for thrust
+        knee_angle_L += abs(character.spearAttackLegStance) * 0.3f; // Bend for power
+        knee_angle_R += abs(character.spearAttackLegStance) * 0.4f; // Forward leg bent for lunge
+    }
+    
+    // Apply shield block stance modifications
+    if (character.shieldBlockAnimating) {
+        // Shield tactical defensive stance: stable, braced position
+        hip_angle_L += character.shieldBlockStance * 0.2f; // Slightly back for balance
+        hip_angle_R += character.shieldBlockStance * 0.3f; // Forward for aggressive defense
+        knee_angle_L += abs(character.shieldBlockStance) * 0.3f; // Bent for stability
+        knee_angle_R += abs(character.shieldBlockStance) * 0.5f; // More bend in forward leg
+    }
+
+    placeFeetOnTerrain(character, hip_angle_L, knee_angle_L, hip_angle_R, knee_angle_R);
+    character.legAngles = { hip_angle_L, knee_angle_L, hip_angle_R, knee_angle_R };
+}
+
+void renderScene(const CharacterState& character) {
     // Render background first (if enabled)
     if (gBackgroundVisible) {
         glPushMatrix();
-        glTranslatef(0.0f, -2.5f, 0.0f); // Lower the entire background by 2.5 units
+        glTranslatef(0.0f, -kBackgroundDrop, 0.0f); // Lower the entire background
         BackgroundRenderer::render();
         glPopMatrix();
     }
@@ -5068,9 +5368,9 @@ void renderScene() {
     float headBob = 0.0f;
     float torsoRotation = 0.0f;
 
-    if (fabsf(gMoveSpeed) > 0.1f) {
-        float animSpeed = keyShift ? 1.8f : 1.0f;
-        float phase = gWalkPhase * animSpeed;
+    if (fabsf(character.moveSpeed) > 0.1f) {
+        float animSpeed = character.runningAnim ? 1.8f : 1.0f;
+        float phase = character.walkPhase * animSpeed;
         float sinPhase = sinf(phase);
         float cosPhase = cosf(phase);
         
@@ -5080,7 +5380,7 @@ void renderScene() {
         
         // Natural arm swing with slight delay and easing
         float armPhase = phase + STEP_TIMING_OFFSET;
-        float armSwingAmplitude = keyShift ? RUN_ARM_SWING : WALK_ARM_SWING;
+        float armSwingAmplitude = character.runningAnim ? RUN_ARM_SWING : WALK_ARM_SWING;
         rightArmSwing = sinf(armPhase) * armSwingAmplitude * 0.8f;
         leftArmSwing = -sinf(armPhase) * armSwingAmplitude * 0.8f;
         
@@ -5099,71 +5399,27 @@ void renderScene() {
 
     glPushMatrix();
     // Enhanced: Apply hip sway and body rotation for natural walking
-    glTranslatef(gCharacterPos.x + hipSway, gCharacterPos.y + bodyBob + gJumpVerticalOffset, gCharacterPos.z);
-    glRotatef(gCharacterYaw + torsoRotation, 0.0f, 1.0f, 0.0f);
-
-    float current_speed = gRunningAnim ? gRunSpeed : gWalkSpeed;
-    float max_hip_angle = gRunningAnim ? 28.0f : 18.0f;    // Enhanced: More natural range
-    float max_knee_angle = gRunningAnim ? 65.0f : 42.0f;   // Enhanced: Better knee bend
+    glTranslatef(character.position.x + hipSway, character.position.y + bodyBob + character.jumpVerticalOffset, character.position.z);
+    glRotatef(character.yaw + torsoRotation, 0.0f, 1.0f, 0.0f);
 
-    // Enhanced leg animation with more natural timing and easing
-    float left_leg_phase = gAnimTime * current_speed;
-    float right_leg_phase = gAnimTime * current_speed + PI;
-    
-    // Natural hip movement with easing
-    float leftHipSin = sinf(left_leg_phase);
-    float rightHipSin = sinf(right_leg_phase);
-    float hip_angle_L = gIsMoving ? (max_hip_angle * leftHipSin * 0.9f) : 0.0f;
-    float hip_angle_R = gIsMoving ? (max_hip_angle * rightHipSin * 0.9f) : 0.0f;
-    
-    // Natural knee movement with better follow-through
-    float leftKneePhase = left_leg_phase + 0.3f; // Slight delay for natural movement
-    float rightKneePhase = right_leg_phase + 0.3f;
-    float knee_angle_L = gIsMoving ? (max_knee_angle * std::max(0.0f, sinf(leftKneePhase) * 0.8f)) : 0.0f;
-    float knee_angle_R = gIsMoving ? (max_knee_angle * std::max(0.0f, sinf(rightKneePhase) * 0.8f)) : 0.0f;
-    
-    // Apply sword attack stance modifications
-    if (gSwordAttackAnimating) {
-        // Warrior stance: wider leg position, weight shifting
-        hip_angle_L += gSwordAttackLegStance * 0.5f; // Slight back leg position
-        hip_angle_R -= gSwordAttackLegStance * 0.3f; // Front leg forward
-        knee_angle_L += abs(gSwordAttackLegStance) * 0.2f; // Slight knee bend for stability
-        knee_angle_R += abs(gSwordAttackLegStance) * 0.3f; // More bend in front leg
-    }
-    
-    // Apply spear attack stance modifications
-    if (gSpearAttackAnimating) {
-        // Spear thrust stance: forward lunge position
-        hip_angle_L += gSpearAttackLegStance * 0.4f; // Back leg for stability
-        hip_angle_R -= gSpearAttackLegStance * 0.6f; // Front leg extends for thrust
-        knee_angle_L += abs(gSpearAttackLegStance) * 0.3f; // Bend for power
-        knee_angle_R += abs(gSpearAttackLegStance) * 0.4f; // Forward leg bent for lunge
-    }
-    
-    // Apply shield block stance modifications
-    if (gShieldBlockAnimating) {
-        // Shield tactical defensive stance: stable, braced position
-        hip_angle_L += gShieldBlockStance * 0.2f; // Slightly back for balance
-        hip_angle_R += gShieldBlockStance * 0.3f; // Forward for aggressive defense
-        knee_angle_L += abs(gShieldBlockStance) * 0.3f; // Bent for stability
-        knee_angle_R += abs(gShieldBlockStance) * 0.5f; // More bend in forward leg
-        
-        // Apply torso lean for shield defense to show hand better
-        if (gShieldBlockPhase >= 1) {
-            // Lean torso slightly away from shield to reveal hand
-            glRotatef(gShieldBlockTorsoLean * 0.5f, 0, 0, 1); // Slight side lean
-        }
+    // Apply torso lean for shield defense to show hand better
+    if (character.shieldBlockAnimating && character.shieldBlockPhase >= 1) {
+        // Lean torso slightly away from shield to reveal hand
+        glRotatef(character.shieldBlockTorsoLean * 0.5f, 0, 0, 1); // Slight side lean
     }
 
-    const float kneeY = 4.5f, kneeZ = 0.2f;
-    const float hipY = 8.5f, hipZ = -0.2f;
+    const float hip_angle_L = character.legAngles.hipL, knee_angle_L = character.legAngles.kneeL;
+    const float hip_angle_R = character.legAngles.hipR, knee_angle_R = character.legAngles.kneeR;
+    const float kneeY = gLegJoints.kneeY, kneeZ = gLegJoints.kneeZ;
+    const float hipY = gLegJoints.hipY, hipZ = gLegJoints.hipZ;
+
+    animateLegs(hip_angle_L, knee_angle_L, hip_angle_R, knee_angle_R);
 
     // --- Draw Left Leg & Armor ---
     glPushMatrix();
     glTranslatef(-0.75f, -2.0f, 0.55f);
-    animateLegVertices(hip_angle_L, knee_angle_L, false);
     //glColor3f(0.9f, 0.7f, 0.6f); // Set skin color
-    drawLeg();
+    drawLeg(0);
     if (gArmorVisible) {
         glPushMatrix();
         glTranslatef(0, hipY, hipZ);
@@ -5182,9 +5438,8 @@ void renderScene() {
     // --- Draw Right Leg & Armor ---
     glPushMatrix();
     glTranslatef(0.75f, -2.0f, 0.55f);
-    animateLegVertices(hip_angle_R, knee_angle_R, true);
     //glColor3f(0.9f, 0.7f, 0.6f); // Set skin color
-    drawLeg();
+    drawLeg(1);
     if (gArmorVisible) {
         glPushMatrix();
         // CORRECTED: Isolate the mirroring so it only affects the armor
@@ -5212,28 +5467,34 @@ void renderScene() {
         glPushMatrix();
         glTranslatef(0.0f, 6.0f - 0.05f, 0.0f);
         glScalef(BODY_SCALE, BODY_SCALE, BODY_SCALE);
-        glRotatef(g_pose.torsoYaw, 0, 1, 0);
-        glRotatef(g_pose.torsoPitch, 1, 0, 0);
-        glRotatef(g_pose.torsoRoll, 0, 0, 1);
+        glRotatef(character.pose.torsoYaw, 0, 1, 0);
+        glRotatef(character.pose.torsoPitch, 1, 0, 0);
+        glRotatef(character.pose.torsoRoll, 0, 0, 1);
         drawArmor();
         drawShoulderArmor();
         glPushMatrix();
         glTranslatef(0, HEAD_CENTER_Y, 0);
-        glRotatef(g_pose.headYaw, 0, 1, 0);
-        glRotatef(g_pose.headPitch, 1, 0, 0);
-        glRotatef(g_pose.headRoll, 0, 0, 1);
+        glRotatef(character.pose.headYaw, 0, 1, 0);
+        glRotatef(character.pose.headPitch, 1, 0, 0);
+        glRotatef(character.pose.headRoll, 0, 0, 1);
         glTranslatef(0, -0.2f, 0);
         drawHelmet();
         glPopMatrix();
         glPopMatrix();
     }
 
-    drawBodyAndHead(0.0f, 0.0f, leftArmSwing, rightArmSwing);
+    drawBodyAndHead(character, 0.0f, 0.0f, leftArmSwing, rightArmSwing);
 
     glPopMatrix();
 }
 
 void display() {
+    const CharacterState& character = gDrawnCharacter;
+    // Textures decoded since the last frame, a bounded amount per frame
+    TextureManager::uploadPending(TextureManager::kFrameUploadBudget);
+    Tex::refresh();
+    applyFistHands(character);
+
     glClearColor(0.5f, 0.7f, 0.9f, 1.0f); // Natural sky blue background
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -5241,11 +5502,18 @@ void display() {
     setRenderMode(gRenderMode);
     // Handle viewport and projection setup
     if (gViewportMode) {
-        // Split viewport mode - render model twice with different projections
+        // Split viewport mode - record the scene once and replay it with each
+        // half's projection and camera, so animation and geometry are built once
 
         // Clear the entire screen first
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        if (gSplitSceneRecorded) {
+            gSplitScene.begin();
+            renderScene(character);
+            gSplitScene.end();
+        }
+
         // Left viewport - Orthographic
         int halfWidth = gWidth / 2;
         glViewport(0, 0, halfWidth, gHeight);
@@ -5261,8 +5529,8 @@ void display() {
         Vec3 orthoEye; { orthoEye.x = gTarget.x + gDist * cosf(orthoPitch) * sinf(gYaw); orthoEye.y = gTarget.y - gDist * sinf(orthoPitch); orthoEye.z = gTarget.z + gDist * cosf(orthoPitch) * cosf(gYaw); }
         gluLookAt(orthoEye.x, orthoEye.y, orthoEye.z, gTarget.x, gTarget.y, gTarget.z, 0.0, 1.0, 0.0);
 
-        // Render the scene for orthographic view
-        renderScene();
+        // Replay the scene for orthographic view
+        if (gSplitSceneRecorded) gSplitScene.replay(); else renderScene(character);
 
         // Right viewport - Perspective
         glViewport(halfWidth, 0, halfWidth, gHeight);
@@ -5275,8 +5543,8 @@ void display() {
         Vec3 eye; { eye.x = gTarget.x + gDist * cosf(gPitch) * sinf(gYaw); eye.y = gTarget.y + gDist * sinf(gPitch); eye.z = gTarget.z + gDist * cosf(gPitch) * cosf(gYaw); }
         gluLookAt(eye.x, eye.y, eye.z, gTarget.x, gTarget.y, gTarget.z, 0.0, 1.0, 0.0);
 
-        // Render the scene for perspective view
-        renderScene();
+        // Replay the scene for perspective view
+        if (gSplitSceneRecorded) gSplitScene.replay(); else renderScene(character);
 
         return; // Skip the single viewport rendering below
 
@@ -5310,23 +5578,291 @@ void display() {
         gluLookAt(eye.x, eye.y, eye.z, gTarget.x, gTarget.y, gTarget.z, 0.0, 1.0, 0.0);
     }
 
-    // Update animation and movement state
-    gIsMoving = keyUp || keydown;
-    gRunningAnim = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
-    if (gIsMoving) {
-        gAnimTime += 0.016f;
-    }
-
     // Render the scene
-    renderScene();
+    renderScene(character);
 }
+// Prints the averaged BackgroundRenderer cost once per second (toggled with F3)
+void reportBackgroundStats(float dt) {
+    static float elapsed = 0.0f;
+    static int frames = 0;
+    static double cpuMs = 0.0, prepareMs = 0.0;
+    static unsigned drawCalls = 0, staticBatches = 0, terrainChunks = 0, terrainCulled = 0;
+    static unsigned textureBinds = 0, queueStateChanges = 0;
+    static unsigned passesDrawn = 0, passesCulled = 0, instancesDrawn = 0, instancesCulled = 0;
+
+    const BackgroundRenderer::FrameStats& stats = BackgroundRenderer::getFrameStats();
+    elapsed += dt;
+    frames++;
+    cpuMs += stats.cpuMs;
+    prepareMs += stats.prepareMs;
+    drawCalls += stats.drawCalls;
+    staticBatches += stats.staticBatches;
+    terrainChunks += stats.terrainChunks;
+    terrainCulled += stats.terrainChunksCulled;
+    textureBinds += stats.textureBinds;
+    queueStateChanges += stats.queueStateChanges;
+    passesDrawn += stats.passesDrawn;
+    passesCulled += stats.passesCulled;
+    instancesDrawn += stats.instancesDrawn;
+    instancesCulled += stats.instancesCulled;
+
+    if (elapsed >= 1.0f) {
+        LOG_INFO("Background: %u draw calls (%u cached batches, %u/%u terrain chunks), %u texture binds, "
+                 "%u queued state changes, %u/%u passes and %u/%u billboards in view, %.3f ms CPU/frame "
+                 "(%.3f preparing billboards on %d job threads), static cache %s, culling %s",
+                 drawCalls / frames, staticBatches / frames, terrainChunks / frames, (terrainChunks + terrainCulled) / frames,
+                 textureBinds / frames, queueStateChanges / frames, passesDrawn / frames, (passesDrawn + passesCulled) / frames,
+                 instancesDrawn / frames, (instancesDrawn + instancesCulled) / frames, cpuMs / frames,
+                 prepareMs / frames, Jobs::threadCount(),
+                 BackgroundRenderer::isStaticCacheEnabled() ? "ON" : "OFF",
+                 BackgroundRenderer::isCullingEnabled() ? "ON" : "OFF");
+        elapsed = 0.0f; frames = 0; cpuMs = 0.0; prepareMs = 0.0; drawCalls = 0; staticBatches = 0; terrainChunks = 0; terrainCulled = 0;
+        textureBinds = 0; queueStateChanges = 0;
+        passesDrawn = 0; passesCulled = 0; instancesDrawn = 0; instancesCulled = 0;
+    }
+}
+
 // ===================================================================
 //
-// SECTION 4: WIN32 APPLICATION FRAMEWORK
+// SECTION 4: APPLICATION FRAMEWORK
 //
 // ===================================================================
 
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+// --- Simulation thread ---
+// updateCharacter() (and through it the background's update()) runs on
+// SimThread one frame ahead of the frame being drawn. It steps the
+// simulation's CharacterState below (and the background's simulated copy);
+// the state each frame's steps leave goes into a FrameSnapshot, published
+// through a triple buffer, and before drawing the render thread makes
+// gDrawnCharacter (and the background's drawn copy) from the newest one.
+// The keys a step reads go with it as a CharacterInput, and key presses that
+// start animations go through runOnSimulation().
+//
+// The steps are kSimStep long whatever the frame rate: a frame's time runs
+// as many whole steps as fit, and what is left over waits for the next
+// frame. The frame then draws the state that far between the one before the
+// last step and the last step's own (blendCharacter(), and the background's
+// clocks and particles), so a frame rate that does not divide the step rate
+// still moves smoothly, and the steps a run takes depend only on its time.
+
+struct FrameSnapshot {
+    CharacterState character;
+    CharacterState previous;    // Before the last step
+    BackgroundRenderer::Snapshot background;
+    float blend;                // How far past the last step the frame's time reached, in steps
+    int steps;                  // Run for this frame
+    double stepMs;              // Their updateCharacter() time, on the simulation thread
+};
+
+const float kSimStep = 1.0f / 60.0f;
+const int kMaxSimSteps = 8;     // In one frame; a longer one's time is dropped
+
+bool gSimThreadEnabled = true;  // F9 - simulation on its own thread vs before each frame on this one
+double gSimStepMs = 0.0;        // updateCharacter() time for the state the next frame draws
+int gSimSteps = 0;              // Steps run for it
+static TripleBuffer<FrameSnapshot> gFrames;
+static float gUnsteppedTime = 0.0f; // Frame time not yet handed to a step, while one was still running
+static std::atomic<bool> gStepQueued{ false }; // A step is posted and has not published yet
+
+// Simulation side, on whichever thread runs it
+static CharacterState gSimulatedCharacter;
+static float gStepRemainder = 0.0f;    // Time short of a whole step, for the next frame
+static CharacterState gPreviousCharacter;
+static bool gPreviousCaptured = false;
+
+// The simulated state, to the thread that runs the simulation: SimThread
+// while it is running, the frame loop otherwise. Any other caller would race
+// with it, so this is checked in release builds as well.
+static CharacterState& simulatedCharacter() {
+    if (SimThread::onThread() != SimThread::running()) {
+        fprintf(stderr, "ERROR: character state used off the simulation's thread\n");
+        std::abort();
+    }
+    return gSimulatedCharacter;
+}
+
+static void blendState(float& out, float from, float to, float t) { out = lerpf(from, to, t); }
+static void blendState(Vec3& out, const Vec3& from, const Vec3& to, float t) { out = lerp(from, to, t); }
+static void blendState(LegAngles& out, const LegAngles& from, const LegAngles& to, float t) {
+    out.hipL = lerpf(from.hipL, to.hipL, t);   out.kneeL = lerpf(from.kneeL, to.kneeL, t);
+    out.hipR = lerpf(from.hipR, to.hipR, t);   out.kneeR = lerpf(from.kneeR, to.kneeR, t);
+}
+static void blendState(JointPose& out, const JointPose& from, const JointPose& to, float t) {
+    out.torsoYaw = lerpf(from.torsoYaw, to.torsoYaw, t);
+    out.torsoPitch = lerpf(from.torsoPitch, to.torsoPitch, t);
+    out.torsoRoll = lerpf(from.torsoRoll, to.torsoRoll, t);
+    out.headYaw = lerpf(from.headYaw, to.headYaw, t);
+    out.headPitch = lerpf(from.headPitch, to.headPitch, t);
+    out.headRoll = lerpf(from.headRoll, to.headRoll, t);
+}
+// The hand forms are the last step's
+static void blendState(KungFuPose& out, const KungFuPose& from, const KungFuPose& to, float t) {
+    out = to;
+    out.leftShoulderPitch = lerpf(from.leftShoulderPitch, to.leftShoulderPitch, t);
+    out.rightShoulderPitch = lerpf(from.rightShoulderPitch, to.rightShoulderPitch, t);
+    out.leftShoulderYaw = lerpf(from.leftShoulderYaw, to.leftShoulderYaw, t);
+    out.rightShoulderYaw = lerpf(from.rightShoulderYaw, to.rightShoulderYaw, t);
+    out.leftShoulderRoll = lerpf(from.leftShoulderRoll, to.leftShoulderRoll, t);
+    out.rightShoulderRoll = lerpf(from.rightShoulderRoll, to.rightShoulderRoll, t);
+    out.leftArmAngle = lerpf(from.leftArmAngle, to.leftArmAngle, t);
+    out.rightArmAngle = lerpf(from.rightArmAngle, to.rightArmAngle, t);
+    out.torsoYaw = lerpf(from.torsoYaw, to.torsoYaw, t);
+    out.torsoPitch = lerpf(from.torsoPitch, to.torsoPitch, t);
+    out.torsoRoll = lerpf(from.torsoRoll, to.torsoRoll, t);
+    out.leftElbowBend = lerpf(from.leftElbowBend, to.leftElbowBend, t);
+    out.rightElbowBend = lerpf(from.rightElbowBend, to.rightElbowBend, t);
+    out.leftWristPitch = lerpf(from.leftWristPitch, to.leftWristPitch, t);
+    out.rightWristPitch = lerpf(from.rightWristPitch, to.rightWristPitch, t);
+}
+
+// out (already a copy of to) t of the way from from to to. Only what moves
+// smoothly from step to step; the rest (and a phase that wraps, like
+// dancePhase) is drawn as the last step left it.
+static void blendCharacter(CharacterState& out, const CharacterState& from, const CharacterState& to, float t) {
+    blendState(out.position, from.position, to.position, t);
+    blendState(out.yaw, from.yaw, to.yaw, t);
+    blendState(out.walkPhase, from.walkPhase, to.walkPhase, t);
+    blendState(out.animTime, from.animTime, to.animTime, t);
+    blendState(out.legAngles, from.legAngles, to.legAngles, t);
+    blendState(out.leftLowerArmBend, from.leftLowerArmBend, to.leftLowerArmBend, t);
+    blendState(out.rightLowerArmBend, from.rightLowerArmBend, to.rightLowerArmBend, t);
+    blendState(out.currentLeftShoulderPitch, from.currentLeftShoulderPitch, to.currentLeftShoulderPitch, t);
+    blendState(out.currentLeftShoulderYaw, from.currentLeftShoulderYaw, to.currentLeftShoulderYaw, t);
+    blendState(out.currentLeftShoulderRoll, from.currentLeftShoulderRoll, to.currentLeftShoulderRoll, t);
+    blendState(out.currentLeftElbowBend, from.currentLeftElbowBend, to.currentLeftElbowBend, t);
+    blendState(out.currentRightShoulderPitch, from.currentRightShoulderPitch, to.currentRightShoulderPitch, t);
+    blendState(out.currentRightShoulderYaw, from.currentRightShoulderYaw, to.currentRightShoulderYaw, t);
+    blendState(out.currentRightShoulderRoll, from.currentRightShoulderRoll, to.currentRightShoulderRoll, t);
+    blendState(out.currentRightElbowBend, from.currentRightElbowBend, to.currentRightElbowBend, t);
+    blendState(out.jumpVerticalOffset, from.jumpVerticalOffset, to.jumpVerticalOffset, t);
+    blendState(out.currentPose, from.currentPose, to.currentPose, t);
+    blendState(out.pose, from.pose, to.pose, t);
+    blendState(out.swordAttackTorsoRotation, from.swordAttackTorsoRotation, to.swordAttackTorsoRotation, t);
+    blendState(out.swordAttackShoulderOffset, from.swordAttackShoulderOffset, to.swordAttackShoulderOffset, t);
+    blendState(out.swordAttackArmExtension, from.swordAttackArmExtension, to.swordAttackArmExtension, t);
+    blendState(out.swordAttackLegStance, from.swordAttackLegStance, to.swordAttackLegStance, t);
+    blendState(out.spearAttackTorsoRotation, from.spearAttackTorsoRotation, to.spearAttackTorsoRotation, t);
+    blendState(out.spearAttackShoulderOffset, from.spearAttackShoulderOffset, to.spearAttackShoulderOffset, t);
+    blendState(out.spearAttackArmExtension, from.spearAttackArmExtension, to.spearAttackArmExtension, t);
+    blendState(out.spearAttackLegStance, from.spearAttackLegStance, to.spearAttackLegStance, t);
+    blendState(out.shieldBlockArmRaise, from.shieldBlockArmRaise, to.shieldBlockArmRaise, t);
+    blendState(out.shieldBlockTorsoLean, from.shieldBlockTorsoLean, to.shieldBlockTorsoLean, t);
+    blendState(out.shieldBlockStance, from.shieldBlockStance, to.shieldBlockStance, t);
+}
+
+// Runs the whole steps in frameTime and what earlier frames left over
+static int runSteps(const CharacterInput& input, float frameTime) {
+    CharacterState& character = simulatedCharacter();
+    gStepRemainder += frameTime;
+    int steps = 0;
+    while (gStepRemainder >= kSimStep) {
+        if (steps == kMaxSimSteps) {
+            gStepRemainder = 0.0f;      // Too far behind to catch up
+            break;
+        }
+        gPreviousCharacter = character;
+        gPreviousCaptured = true;
+        character.snapped = false;
+        updateCharacter(character, input, kSimStep);
+        gStepRemainder -= kSimStep;
+        ++steps;
+    }
+    return steps;
+}
+
+// Simulation side: the state as it stands, for the render thread
+static void publishFrame(int steps, double stepMs) {
+    FrameSnapshot& frame = gFrames.back();
+    frame.character = simulatedCharacter();
+    // Nothing to draw from before the first step, or from before a snap
+    frame.previous = gPreviousCaptured && !frame.character.snapped ? gPreviousCharacter : frame.character;
+    BackgroundRenderer::capture(frame.background);
+    frame.blend = gStepRemainder / kSimStep;
+    frame.steps = steps;
+    frame.stepMs = stepMs;
+    gFrames.publish();
+}
+
+static void simulateFrame(const CharacterInput& input, float frameTime) {
+    const double start = Platform::timeSeconds();
+    const int steps = runSteps(input, frameTime);
+    publishFrame(steps, (Platform::timeSeconds() - start) * 1000.0);
+    gStepQueued.store(false, std::memory_order_release);
+}
+
+// Render thread: the newest published frame, blended, as the state to draw
+static void applyNewestFrame() {
+    if (!gFrames.acquire()) return;
+    const FrameSnapshot& frame = gFrames.front();
+    gDrawnCharacter = frame.character;
+    blendCharacter(gDrawnCharacter, frame.previous, frame.character, frame.blend);
+    BackgroundRenderer::apply(frame.background, (1.0f - frame.blend) * kSimStep);
+    gSimStepMs = frame.stepMs;
+    gSimSteps = frame.steps;
+}
+
+// Hands the simulation back to this thread, with whatever the thread ran
+// after its last step
+void stopSimulationThread() {
+    if (!SimThread::running()) return;
+    SimThread::post([] { publishFrame(0, 0.0); });
+    SimThread::stop();
+    applyNewestFrame();
+    gUnsteppedTime = 0.0f;
+}
+
+// command on the simulated state, between steps. What it changes is not
+// blended in: a frame that runs no step after it draws from the state it left.
+static void runCommand(void (*command)(CharacterState& character)) {
+    command(simulatedCharacter());
+    gPreviousCaptured = false;
+}
+
+// Runs command where the simulation runs: queued for the simulation thread,
+// or at once
+void runOnSimulation(void (*command)(CharacterState& character)) {
+    if (SimThread::running()) {
+        SimThread::post([command] { runCommand(command); });
+        return;
+    }
+    runCommand(command);
+}
+
+// Brings the state the next display() draws up to date. With the simulation
+// thread that is the newest snapshot it published, and the steps for the
+// following frame start here to run while this one draws; while a step is
+// still queued or running the frame's time is kept for the next one instead of
+// queued behind it. Other work on the thread (a key's command) does not hold
+// the step back: it runs first, in order. Without the thread, the steps run
+// here and their frame is drawn at once.
+// A caller that needs every frame to draw the step before it (bench_headless)
+// calls SimThread::wait() first.
+void stepSimulation(float dt) {
+    if (gSimThreadEnabled != SimThread::running()) {
+        if (gSimThreadEnabled) SimThread::start();  // Takes the simulated state over as it stands
+        else stopSimulationThread();
+    }
+
+    const CharacterInput input = { keyUp, keydown, keyLeft, keyRight, keyShift, keySlash };
+    if (!SimThread::running()) {
+        simulateFrame(input, dt);
+        applyNewestFrame();
+        return;
+    }
+
+    applyNewestFrame();
+    gUnsteppedTime += dt;
+    if (!gStepQueued.load(std::memory_order_acquire)) {
+        const float stepTime = gUnsteppedTime;
+        gUnsteppedTime = 0.0f;
+        gStepQueued.store(true, std::memory_order_relaxed);
+        SimThread::post([input, stepTime] { simulateFrame(input, stepTime); });
+    }
+}
+
+// The headless benchmark links this file with its own main()
+#ifndef MULAN_NO_ENTRY_POINT
+static int runViewer() {
     // Debug console disabled - remove console window
     // AllocConsole();
     // freopen_s((FILE**)stdout, "CONOUT$", "w", stdout);
@@ -5334,17 +5870,12 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     
     // printf("Starting Full Body Model Viewer...\n");
     // printf("Skirt texture cycling: Use H key to cycle through textures\n");
-    WNDCLASSEXA wc{}; wc.cbSize = sizeof(WNDCLASSEXA); wc.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC; wc.lpfnWndProc = WindowProcedure; wc.hInstance = GetModuleHandle(NULL); wc.lpszClassName = WINDOW_TITLE;
-    if (!RegisterClassExA(&wc))return 0;
-    HWND hWnd = CreateWindowA(WINDOW_TITLE, WINDOW_TITLE, WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, gWidth, gHeight, NULL, NULL, wc.hInstance, NULL);
-    if (!hWnd)return 0;
-    HDC hdc = GetDC(hWnd);
-    { PIXELFORMATDESCRIPTOR pfd{}; pfd.nSize = sizeof(pfd); pfd.nVersion = 1; pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER; pfd.iPixelType = PFD_TYPE_RGBA; pfd.cColorBits = 32; pfd.cDepthBits = 24; pfd.iLayerType = PFD_MAIN_PLANE; int pf = ChoosePixelFormat(hdc, &pfd); SetPixelFormat(hdc, pf, &pfd); }
-    HGLRC rc = wglCreateContext(hdc); wglMakeCurrent(hdc, rc);
-    ShowWindow(hWnd, nCmdShow); UpdateWindow(hWnd);
+    Platform::Callbacks callbacks = { onKeyDown, onKeyUp, onMouseButton, onMouseMove, onMouseWheel, onResize };
+    if (!Platform::createWindow(WINDOW_TITLE, gWidth, gHeight, callbacks)) return 0;
 
     glEnable(GL_DEPTH_TEST); glEnable(GL_NORMALIZE);
     initializeCharacterParts();
+    Log::flush();
 
     // Display configuration controls
     printf("=== CONFIGURATION CONTROLS ===\n");
@@ -5365,287 +5896,337 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     printf("T - Toggle war sound on/off\n");
     printf("+/- - Increase/decrease war sound volume\n");
     printf("K - Toggle background visibility\n");
+    printf("F2 - Toggle static background cache (display lists)\n");
+    printf("F3 - Print background draw calls / CPU time per frame (and texture load times)\n");
+    printf("F4 - Toggle leg vertex buffers (indexed draw vs immediate mode)\n");
+    printf("F5 - Toggle leg skinning in the vertex shader (GPU vs CPU, needs F4 on)\n");
+    printf("F6 - Toggle leg skinning method (linear blend vs dual quaternion, CPU)\n");
+    printf("F7 - Toggle split viewport recording (record once and replay vs render each half)\n");
+    printf("F8 - Toggle background frustum culling\n");
+    printf("F9 - Toggle simulation thread (overlapped with drawing vs before each frame)\n");
     printf("\nCOLLISION SYSTEM:\n");
     printf("R - Toggle collision debug visualization\n");
     printf("Character now has realistic collision with castles and objects\n");
     printf("===============================\n");
 
-    QueryPerformanceFrequency(&gFreq); QueryPerformanceCounter(&gPrev);
+    gPrevTime = Platform::timeSeconds();
 
-    MSG msg{};
     while (gRunning) {
-        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) { if (msg.message == WM_QUIT)gRunning = false; TranslateMessage(&msg); DispatchMessage(&msg); }
-        LARGE_INTEGER now; QueryPerformanceCounter(&now); float dt = float(now.QuadPart - gPrev.QuadPart) / float(gFreq.QuadPart); gPrev = now;
+        if (!Platform::pumpEvents()) gRunning = false;
+        double now = Platform::timeSeconds(); float dt = float(now - gPrevTime); gPrevTime = now;
         if (dt > 0.1f) dt = 0.1f;
 
-        updateCharacter(dt);
+        stepSimulation(dt);
 
         { Vec3 eye; { eye.x = gTarget.x + gDist * cos(gPitch) * sin(gYaw); eye.y = gTarget.y + gDist * sin(gPitch); eye.z = gTarget.z + gDist * cos(gPitch) * cos(gYaw); } Vec3 f = { gTarget.x - eye.x,gTarget.y - eye.y,gTarget.z - eye.z }; float fl = sqrt(f.x * f.x + f.y * f.y + f.z * f.z); if (fl > 1e-6) { f.x /= fl; f.y /= fl; f.z /= fl; } Vec3 r = { f.z,0,-f.x }; float moveStep = gDist * 0.8f * dt; if (keyW)gTarget.y += moveStep; if (keyS)gTarget.y -= moveStep; if (keyA) { gTarget.x -= r.x * moveStep; gTarget.z -= r.z * moveStep; }if (keyD) { gTarget.x += r.x * moveStep; gTarget.z += r.z * moveStep; } }
-        display(); SwapBuffers(hdc);
+        display(); Platform::swapBuffers();
+        if (gShowPerfStats && gBackgroundVisible) reportBackgroundStats(dt);
+        Log::flush();              // The frame's messages, once it is on screen
     }
 
+    stopSimulationThread();
+
     // Cleanup background system
     BackgroundRenderer::cleanup();
+    releaseLegBuffers();
+    gSplitScene.release();
+    TextureManager::shutdown();
+    Log::flush();
 
-    wglMakeCurrent(NULL, NULL); wglDeleteContext(rc); ReleaseDC(hWnd, hdc); UnregisterClassA(WINDOW_TITLE, wc.hInstance);
+    Platform::destroyWindow();
     return 0;
 }
 
-void updateCharacter(float dt) {
+#ifdef _WIN32
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    return runViewer();
+}
+#else
+int main() {
+    return runViewer();
+}
+#endif
+#endif
+
+void updateCharacter(CharacterState& character, const CharacterInput& input, float dt) {
     float targetSpeed = 0.0f;
-    if (keyUp) { targetSpeed = keyShift ? RUN_SPEED : WALK_SPEED; }
-    if (keydown) { targetSpeed = -(keyShift ? RUN_SPEED : WALK_SPEED); }
-    gMoveSpeed = targetSpeed;
-    if (keyLeft) { gCharacterYaw += TURN_SPEED * dt; }
-    if (keyRight) { gCharacterYaw -= TURN_SPEED * dt; }
-    if (fabsf(gMoveSpeed) > 0.01f) {
-        float angleRad = gCharacterYaw * PI / 180.0f;
-        
-        // Calculate potential new position
-        float newX = gCharacterPos.x - sin(angleRad) * gMoveSpeed * dt;
-        float newZ = gCharacterPos.z - cos(angleRad) * gMoveSpeed * dt;
+    if (input.keyUp) { targetSpeed = input.keyShift ? RUN_SPEED : WALK_SPEED; }
+    if (input.keydown) { targetSpeed = -(input.keyShift ? RUN_SPEED : WALK_SPEED); }
+    character.moveSpeed = targetSpeed;
+    if (input.keyLeft) { character.yaw += TURN_SPEED * dt; }
+    if (input.keyRight) { character.yaw -= TURN_SPEED * dt; }
+    if (fabsf(character.moveSpeed) > 0.01f) {
+        float angleRad = character.yaw * PI / 180.0f;
         
-        // Character collision radius (adjust based on character size)
-        float characterRadius = 1.2f;
+        float moveX = -sin(angleRad) * character.moveSpeed * dt;
+        float moveZ = -cos(angleRad) * character.moveSpeed * dt;
         
-        // Check collision before moving
-        if (!BackgroundRenderer::checkCollision(newX, newZ, characterRadius)) {
-            // Safe to move - update position
-            gCharacterPos.x = newX;
-            gCharacterPos.z = newZ;
-        } else {
-            // Collision detected - try sliding along walls
-            // Try moving only in X direction
-            if (!BackgroundRenderer::checkCollision(newX, gCharacterPos.z, characterRadius)) {
-                gCharacterPos.x = newX;
-            }
-            // Try moving only in Z direction
-            else if (!BackgroundRenderer::checkCollision(gCharacterPos.x, newZ, characterRadius)) {
-                gCharacterPos.z = newZ;
+        // Sweep the whole step so a fast step cannot pass through a thin box
+        SweepHit hit;
+        if (BackgroundRenderer::sweepCollision(character.position.x, character.position.z, moveX, moveZ, kCharacterRadius, hit)) {
+            // Advance to the contact, then slide the rest of the step along the surface
+            character.position.x += moveX * hit.time;
+            character.position.z += moveZ * hit.time;
+            float restX = moveX * (1.0f - hit.time);
+            float restZ = moveZ * (1.0f - hit.time);
+            float into = restX * hit.normalX + restZ * hit.normalZ;
+            restX -= into * hit.normalX;
+            restZ -= into * hit.normalZ;
+            if (BackgroundRenderer::sweepCollision(character.position.x, character.position.z, restX, restZ, kCharacterRadius, hit)) {
+                restX *= hit.time;
+                restZ *= hit.time;
             }
-            // If both fail, character is blocked completely
+            moveX = restX;
+            moveZ = restZ;
         }
+        character.position.x += moveX;
+        character.position.z += moveZ;
         
-        float phaseSpeed = keyShift ? 7.0f : 4.5f;     // Enhanced: More natural walking rhythm
-        gWalkPhase += gMoveSpeed * dt * phaseSpeed / 2.0f;  // Enhanced: Smoother phase progression
+        float phaseSpeed = input.keyShift ? 7.0f : 4.5f;     // Enhanced: More natural walking rhythm
+        character.walkPhase += character.moveSpeed * dt * phaseSpeed / 2.0f;  // Enhanced: Smoother phase progression
     }
 
+    // Stand on the terrain: the lower of the two feet touches the ground
+    character.position.y = std::min(footGroundHeight(character, 0, 0.0f), footGroundHeight(character, 1, 0.0f)) + kSoleDepth;
+
     // Update animations
-    updateFistAnimation(dt);
-    updateKungFuAnimation(dt);  // Add kung fu animation updates
-    updateBoxingStance(dt);     // Add boxing stance animation updates
-    updateJumpAnimation(dt);    // Add jump animation updates
-    updateDance();              // Add K-pop dance animation updates
-    updateSwordAttackAnimation(dt); // Add sword attack animation updates
-    updateSpearAttackAnimation(dt); // Add spear attack animation updates
-    updateShieldBlockAnimation(dt); // Add shield block animation updates
+    updateFistAnimation(character, dt);
+    updateKungFuAnimation(character, dt);  // Add kung fu animation updates
+    updateBoxingStance(character, dt);     // Add boxing stance animation updates
+    updateJumpAnimation(character, dt);    // Add jump animation updates
+    updateDance(character, dt);            // Add K-pop dance animation updates
+    updateSwordAttackAnimation(character, dt); // Add sword attack animation updates
+    updateSpearAttackAnimation(character, dt); // Add spear attack animation updates
+    updateShieldBlockAnimation(character, dt); // Add shield block animation updates
 
     // Update slow arm bending
-    if (keySlash) {
-        gSlowArmBendActive = true;
+    if (input.keySlash) {
+        character.slowArmBendActive = true;
         // Slowly bend both arms up bit by bit
-        gLeftLowerArmBend += gSlowArmBendSpeed * dt;
-        gRightLowerArmBend += gSlowArmBendSpeed * dt;
+        character.leftLowerArmBend += gSlowArmBendSpeed * dt;
+        character.rightLowerArmBend += gSlowArmBendSpeed * dt;
         
         // Clamp to maximum arm bend angle
-        if (gLeftLowerArmBend > MAX_ARM_BEND) {
-            gLeftLowerArmBend = MAX_ARM_BEND;
+        if (character.leftLowerArmBend > MAX_ARM_BEND) {
+            character.leftLowerArmBend = MAX_ARM_BEND;
         }
-        if (gRightLowerArmBend > MAX_ARM_BEND) {
-            gRightLowerArmBend = MAX_ARM_BEND;
+        if (character.rightLowerArmBend > MAX_ARM_BEND) {
+            character.rightLowerArmBend = MAX_ARM_BEND;
         }
     } else {
-        gSlowArmBendActive = false;
+        character.slowArmBendActive = false;
         // Slowly return arms to normal position when key is released
-        if (gLeftLowerArmBend > 0.0f) {
-            gLeftLowerArmBend -= gSlowArmBendSpeed * dt * 1.5f; // Return slightly faster
-            if (gLeftLowerArmBend < 0.0f) {
-                gLeftLowerArmBend = 0.0f;
+        if (character.leftLowerArmBend > 0.0f) {
+            character.leftLowerArmBend -= gSlowArmBendSpeed * dt * 1.5f; // Return slightly faster
+            if (character.leftLowerArmBend < 0.0f) {
+                character.leftLowerArmBend = 0.0f;
             }
         }
-        if (gRightLowerArmBend > 0.0f) {
-            gRightLowerArmBend -= gSlowArmBendSpeed * dt * 1.5f; // Return slightly faster
-            if (gRightLowerArmBend < 0.0f) {
-                gRightLowerArmBend = 0.0f;
+        if (character.rightLowerArmBend > 0.0f) {
+            character.rightLowerArmBend -= gSlowArmBendSpeed * dt * 1.5f; // Return slightly faster
+            if (character.rightLowerArmBend < 0.0f) {
+                character.rightLowerArmBend = 0.0f;
             }
         }
     }
 
-    // Update background animation
+    // Leg animation: the walk cycle runs while a move key is held
+    character.isMoving = input.keyUp || input.keydown;
+    character.runningAnim = input.keyShift;
+    if (character.isMoving) {
+        character.animTime += dt;
+    }
+    updateLegAngles(character);
+
+    // Update background animation; the siege arrows see the character as a
+    // capsule from the soles to the head, in the lowered background's space
+    const float characterBase = character.position.y + character.jumpVerticalOffset + kBackgroundDrop;
+    BackgroundRenderer::setCharacterCapsule(character.position.x, character.position.z, characterBase - kSoleDepth + kCharacterRadius,
+                                            characterBase + kHeadCentreHeight, kCharacterRadius);
     BackgroundRenderer::update(dt);
 }
 
-LRESULT WINAPI WindowProcedure(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-    switch (msg) {
-    case WM_DESTROY: PostQuitMessage(0); return 0;
-    case WM_SIZE: gWidth = LOWORD(lParam); gHeight = HIWORD(lParam); if (gWidth <= 0)gWidth = 1; if (gHeight <= 0)gHeight = 1; glViewport(0, 0, gWidth, gHeight); return 0;
-    case WM_LBUTTONDOWN: gLMBDown = true; SetCapture(hWnd); gLastMouse.x = LOWORD(lParam); gLastMouse.y = HIWORD(lParam); return 0;
-    case WM_LBUTTONUP: gLMBDown = false; ReleaseCapture(); return 0;
-    case WM_MOUSEMOVE: if (gLMBDown) { int mx = LOWORD(lParam), my = HIWORD(lParam); int dx = mx - gLastMouse.x, dy = my - gLastMouse.y; gLastMouse.x = mx; gLastMouse.y = my; gYaw += dx * 0.005f; gPitch -= dy * 0.005f; if (gPitch > 1.55f)gPitch = 1.55f; if (gPitch < -1.55f)gPitch = -1.55f; } return 0;
-    case WM_MOUSEWHEEL: { short delta = GET_WHEEL_DELTA_WPARAM(wParam); gDist *= (1.0f - (delta / 120.0f) * 0.1f); if (gDist < 2.0f)gDist = 2.0f; if (gDist > 100.0f)gDist = 100.0f; } return 0;
-    case WM_KEYDOWN:
-        if (wParam == VK_ESCAPE)PostQuitMessage(0);
-        else if (wParam == '1' || wParam == VK_NUMPAD1) {   // Wireframe
-            setRenderMode(RM_WIREFRAME);
-            InvalidateRect(hWnd, NULL, FALSE);
-        }
-        else if (wParam == '2' || wParam == VK_NUMPAD2) {   // Solid (glColor)
-            setRenderMode(RM_SOLID);
-            InvalidateRect(hWnd, NULL, FALSE);
-        }
-        else if (wParam == '3' || wParam == VK_NUMPAD3) {   // Textured
-            setRenderMode(RM_TEXTURED);
-            InvalidateRect(hWnd, NULL, FALSE);
-        }
+// --- Window event handlers (registered with Platform::createWindow) ---
+void onResize(int width, int height) { gWidth = width; gHeight = height; if (gWidth <= 0)gWidth = 1; if (gHeight <= 0)gHeight = 1; glViewport(0, 0, gWidth, gHeight); }
+void onMouseButton(int x, int y, bool down) { gLMBDown = down; if (down) { gLastMouse.x = x; gLastMouse.y = y; } }
+void onMouseMove(int mx, int my) { if (gLMBDown) { int dx = mx - gLastMouse.x, dy = my - gLastMouse.y; gLastMouse.x = mx; gLastMouse.y = my; gYaw += dx * 0.005f; gPitch -= dy * 0.005f; if (gPitch > 1.55f)gPitch = 1.55f; if (gPitch < -1.55f)gPitch = -1.55f; } }
+void onMouseWheel(int delta) { gDist *= (1.0f - (delta / 120.0f) * 0.1f); if (gDist < 2.0f)gDist = 2.0f; if (gDist > 100.0f)gDist = 100.0f; }
+
+// R key: the character's part of the reset, run where the simulation runs
+static void resetCharacter(CharacterState& character) {
+    // Reset character position and orientation
+    character.position = { 0, 0, 0 }; 
+    character.yaw = 0;
+    character.snapped = true;
+    character.moveSpeed = 0.0f;
+    character.walkPhase = 0.0f;
+
+    // Reset animations
+    character.animTime = 0.0f;
+    character.isMoving = false;
+    character.runningAnim = false;
+    character.jumpVerticalOffset = 0.0f;
+
+    // Reset all special animations
+    character.kungFuAnimating = false;
+    character.swordAttackAnimating = false;
+    character.spearAttackAnimating = false;
+    character.shieldBlockAnimating = false;
+    character.boxingAnimActive = false;
+    character.inBoxingStance = false;
+    character.isDancing = false;
+    character.isJumping = false;
+    character.fistAnimationActive = false;
+
+    // Reset arm bending (including shield defense arm bend)
+    character.leftLowerArmBend = 0.0f;
+    character.rightLowerArmBend = 0.0f;
+    character.slowArmBendActive = false;
+}
 
-        else if (wParam == 'F') { toggleFistAnimation(); } // Toggle fist animation
-        else if (wParam == 'G') { startDance(); } // K-pop dance animation
-        else if (wParam == 'B') { toggleBoxingStance(); } // Toggle boxing stance (guard position)
-        else if (wParam == 'H') { // H key - Cycle skirt texture
-            printf("H key pressed - cycling skirt texture\n");
-            Tex::cycleSkirtTexture();
-            InvalidateRect(hWnd, NULL, FALSE); // Force screen redraw
-        }
-        else if (wParam == VK_OEM_3) { // Backtick (`) key - Cycle skirt texture
-            Tex::cycleSkirtTexture();
-            InvalidateRect(hWnd, NULL, FALSE); // Force screen redraw
-        }
-        else if (wParam == 'U') { // Test key for debugging keyboard input
-            printf("U key test - Keyboard input system working correctly\n");
-        }
-        else if (wParam == 'X') { 
-            if (gSwordVisible) {
-                gSwordVisible = false; // Hide sword
-            } else {
-                gSwordVisible = true; // Show sword
-                if (gSpearVisible) gSpearVisible = false; // Hide spear if it's visible
-            }
-        } // Toggle sword visibility (mutual exclusive with spear)
-        else if (wParam == 'Z') { startSwordAttack(); } // Warrior sword attack animation
-        else if (wParam == 'V') { 
-            if (gSpearVisible) {
-                gSpearVisible = false; // Hide spear
-            } else {
-                gSpearVisible = true; // Show spear
-                if (gSwordVisible) gSwordVisible = false; // Hide sword if it's visible
-            }
-        } // Toggle spear visibility (mutual exclusive with sword)
-        else if (wParam == 'J') { 
-            if (gSpearVisible) startSpearAttack(); // Spear thrust attack animation
-        } // Spear thrust attack (only when spear is visible)
-        else if (wParam == 'C') { 
-            if (gShieldVisible) {
-                gShieldVisible = false; // Hide shield
-            } else {
-                gShieldVisible = true; // Show shield
-            }
-        } // Toggle shield visibility
-        else if (wParam == 'I') { 
-            if (gShieldVisible) startShieldBlock(); // Shield block animation
-        } // Shield block animation (only when shield is visible)
-        else if (wParam == 'M') { gArmorVisible = !gArmorVisible; gConcreteHands = gArmorVisible;}
-        // Helmet dome rotation controls
-        //else if (wParam == '1') { g_helmetDomeRotationX += 5.0f; }
-        //else if (wParam == '2') { g_helmetDomeRotationX -= 5.0f; }
-        else if (wParam == '3') { g_helmetDomeRotationY += 5.0f; }
-        else if (wParam == '4') { g_helmetDomeRotationY -= 5.0f; }
-        //else if (wParam == '5') { g_helmetDomeRotationZ += 5.0f; }
-        //else if (wParam == '6') { g_helmetDomeRotationZ -= 5.0f; }
-        else if (wParam == 'K') { gBackgroundVisible = !gBackgroundVisible; } // Toggle background visibility
-        else if (wParam == 'T') { // Toggle war sound
-            if (BackgroundRenderer::warSoundPlaying) {
-                BackgroundRenderer::stopWarSound();
-            } else {
-                BackgroundRenderer::playWarSound();
-            }
+void onKeyDown(int key) {
+    if (key == Platform::KEY_ESCAPE)Platform::requestQuit();
+    else if (key == '1' || key == Platform::KEY_NUMPAD1) {   // Wireframe
+        setRenderMode(RM_WIREFRAME);
+    }
+    else if (key == '2' || key == Platform::KEY_NUMPAD2) {   // Solid (glColor)
+        setRenderMode(RM_SOLID);
+    }
+    else if (key == '3' || key == Platform::KEY_NUMPAD3) {   // Textured
+        setRenderMode(RM_TEXTURED);
+    }
+
+    else if (key == 'F') { runOnSimulation(toggleFistAnimation); } // Toggle fist animation
+    else if (key == 'G') { runOnSimulation(startDance); } // K-pop dance animation
+    else if (key == 'B') { runOnSimulation(toggleBoxingStance); } // Toggle boxing stance (guard position)
+    else if (key == 'H') { // H key - Cycle skirt texture
+        LOG_INFO("H key pressed - cycling skirt texture");
+        Tex::cycleSkirtTexture();
+    }
+    else if (key == Platform::KEY_BACKTICK) { // Backtick (`) key - Cycle skirt texture
+        Tex::cycleSkirtTexture();
+    }
+    else if (key == 'U') { // Test key for debugging keyboard input
+        LOG_INFO("U key test - Keyboard input system working correctly");
+    }
+    else if (key == 'X') { 
+        if (gSwordVisible) {
+            gSwordVisible = false; // Hide sword
+        } else {
+            gSwordVisible = true; // Show sword
+            if (gSpearVisible) gSpearVisible = false; // Hide spear if it's visible
         }
-        else if (wParam == VK_OEM_PLUS) { // + key to increase volume
-            BackgroundRenderer::setWarSoundVolume(BackgroundRenderer::warSoundVolume + 0.1f);
+    } // Toggle sword visibility (mutual exclusive with spear)
+    else if (key == 'Z') { runOnSimulation(startSwordAttack); } // Warrior sword attack animation
+    else if (key == 'V') { 
+        if (gSpearVisible) {
+            gSpearVisible = false; // Hide spear
+        } else {
+            gSpearVisible = true; // Show spear
+            if (gSwordVisible) gSwordVisible = false; // Hide sword if it's visible
         }
-        else if (wParam == VK_OEM_MINUS) { // - key to decrease volume
-            BackgroundRenderer::setWarSoundVolume(BackgroundRenderer::warSoundVolume - 0.1f);
+    } // Toggle spear visibility (mutual exclusive with sword)
+    else if (key == 'J') { 
+        if (gSpearVisible) runOnSimulation(startSpearAttack); // Spear thrust attack animation
+    } // Spear thrust attack (only when spear is visible)
+    else if (key == 'C') { 
+        if (gShieldVisible) {
+            gShieldVisible = false; // Hide shield
+        } else {
+            gShieldVisible = true; // Show shield
         }
-        else if (wParam == 'R') { // R key to reset everything
-            // Reset camera
-            gYaw = 0.2f; gPitch = 0.1f; gDist = 15.0f; 
-            gTarget = { 0.0f, 3.5f, 0.0f }; 
-            
-            // Reset character position and orientation
-            gCharacterPos = { 0, 0, 0 }; 
-            gCharacterYaw = 0;
-            gMoveSpeed = 0.0f;
-            gWalkPhase = 0.0f;
-            
-            // Reset animations
-            gAnimTime = 0.0f;
-            gIsMoving = false;
-            gRunningAnim = false;
-            gJumpVerticalOffset = 0.0f;
-            
-            // Reset all special animations
-            gKungFuAnimating = false;
-            gSwordAttackAnimating = false;
-            gSpearAttackAnimating = false;
-            gShieldBlockAnimating = false;
-            gBoxingAnimActive = false;
-            gInBoxingStance = false;
-            gIsDancing = false;
-            gIsJumping = false;
-            gFistAnimationActive = false;
-            
-            // Reset weapon/armor visibility
-            gSwordVisible = false;
-            gSpearVisible = false;
-            gShieldVisible = false;
-            gArmorVisible = false;
-            
-            // Reset arm bending (including shield defense arm bend)
-            gLeftLowerArmBend = 0.0f;
-            gRightLowerArmBend = 0.0f;
-            gSlowArmBendActive = false;
-            
-            // Stop war sound if playing
-            if (BackgroundRenderer::warSoundPlaying) {
-                BackgroundRenderer::stopWarSound();
-            }
-            
-            // Reset background settings
-            gBackgroundVisible = true;
-            BackgroundRenderer::collisionDebugMode = false;
-            
-            // Reset skirt texture to default
-            Tex::currentSkirtIndex = 0;
-            printf("Skirt texture reset to: Default Skirt (Index: 0)\n");
-            
-            printf("=== EVERYTHING RESET ===");
+    } // Toggle shield visibility
+    else if (key == 'I') { 
+        if (gShieldVisible) runOnSimulation(startShieldBlock); // Shield block animation
+    } // Shield block animation (only when shield is visible)
+    else if (key == 'M') { gArmorVisible = !gArmorVisible; gConcreteHands = gArmorVisible;}
+    // Helmet dome rotation controls
+    //else if (key == '1') { g_helmetDomeRotationX += 5.0f; }
+    //else if (key == '2') { g_helmetDomeRotationX -= 5.0f; }
+    else if (key == '3') { g_helmetDomeRotationY += 5.0f; }
+    else if (key == '4') { g_helmetDomeRotationY -= 5.0f; }
+    //else if (key == '5') { g_helmetDomeRotationZ += 5.0f; }
+    //else if (key == '6') { g_helmetDomeRotationZ -= 5.0f; }
+    else if (key == 'K') { gBackgroundVisible = !gBackgroundVisible; } // Toggle background visibility
+    else if (key == Platform::KEY_F2) { BackgroundRenderer::setStaticCacheEnabled(!BackgroundRenderer::isStaticCacheEnabled()); } // Retained vs immediate background
+    else if (key == Platform::KEY_F3) { // Background cost report, plus the texture load timings when switched on
+        gShowPerfStats = !gShowPerfStats;
+        if (gShowPerfStats) TextureManager::printReport(stdout);
+    }
+    else if (key == Platform::KEY_F4) { gLegBuffersEnabled = !gLegBuffersEnabled; } // Leg vertex buffers vs immediate mode
+    else if (key == Platform::KEY_F5) { gLegShaderEnabled = !gLegShaderEnabled; } // Leg skinning in the vertex shader vs on the CPU
+    else if (key == Platform::KEY_F6) { // Leg skinning: linear blend vs dual quaternion (CPU only)
+        gLegSkinningMethod = gLegSkinningMethod == Skinning::LINEAR_BLEND ? Skinning::DUAL_QUATERNION : Skinning::LINEAR_BLEND;
+    }
+    else if (key == Platform::KEY_F7) { gSplitSceneRecorded = !gSplitSceneRecorded; } // Split viewport: record once and replay vs render twice
+    else if (key == Platform::KEY_F8) { BackgroundRenderer::setCullingEnabled(!BackgroundRenderer::isCullingEnabled()); } // Skip background passes outside the view
+    else if (key == Platform::KEY_F9) { gSimThreadEnabled = !gSimThreadEnabled; } // Simulation overlapped with drawing vs before each frame
+    else if (key == 'T') { // Toggle war sound
+        if (BackgroundRenderer::warSoundPlaying) {
+            BackgroundRenderer::stopWarSound();
+        } else {
+            BackgroundRenderer::playWarSound();
         }
-        // Projection and Viewport Controls
-        else if (wParam == 'O') { gProjMode = PROJ_ORTHOGRAPHIC; } // Orthographic projection
-        else if (wParam == 'P') { gProjMode = PROJ_PERSPECTIVE; } // Perspective projection
-        else if (wParam == 'L') { gViewportMode = !gViewportMode; } // Toggle split viewport
-        // Kung Fu Animation Styles - Now with flowing anime-like animations!
-        else if (wParam == 'Q') { startKungFuAnimation(1); } // Crane style animation
-        else if (wParam == 'N') { startKungFuAnimation(0); } // Stop animation / Normal pose
-        // Higher jaw transition
-         // Facial Features Scale Controls
-        else if (wParam == 'W') keyW = true; else if (wParam == 'S') keyS = true;
-        else if (wParam == 'A') keyA = true; else if (wParam == 'D') keyD = true;
-        else if (wParam == 'G') keyG = true;
-        else if (wParam == VK_OEM_2) keySlash = true; // '/' key for slow arm bend
-        else if (wParam == VK_UP) keyUp = true; else if (wParam == VK_DOWN) keydown = true;
-        else if (wParam == VK_LEFT) keyLeft = true; else if (wParam == VK_RIGHT) keyRight = true;
-        else if (wParam == VK_SHIFT) keyShift = true;
-        return 0;
-    case WM_KEYUP:
-        if (wParam == 'W') keyW = false; else if (wParam == 'S') keyS = false;
-        else if (wParam == 'A') keyA = false; else if (wParam == 'D') keyD = false;
-        else if (wParam == 'G') keyG = false;
-        else if (wParam == VK_OEM_2) keySlash = false; // '/' key
-        else if (wParam == VK_UP) keyUp = false; else if (wParam == VK_DOWN) keydown = false;
-        else if (wParam == VK_LEFT) keyLeft = false; else if (wParam == VK_RIGHT) keyRight = false;
-        else if (wParam == VK_SHIFT) keyShift = false;
-        return 0;
-
-    default: return DefWindowProc(hWnd, msg, wParam, lParam);
     }
+    else if (key == Platform::KEY_PLUS) { // + key to increase volume
+        BackgroundRenderer::setWarSoundVolume(BackgroundRenderer::warSoundVolume + 0.1f);
+    }
+    else if (key == Platform::KEY_MINUS) { // - key to decrease volume
+        BackgroundRenderer::setWarSoundVolume(BackgroundRenderer::warSoundVolume - 0.1f);
+    }
+    else if (key == 'R') { // R key to reset everything
+        // Reset camera
+        gYaw = 0.2f; gPitch = 0.1f; gDist = 15.0f; 
+        gTarget = { 0.0f, 3.5f, 0.0f }; 
+        
+        // Reset character position, orientation and animations
+        runOnSimulation(resetCharacter);
+        
+        // Reset weapon/armor visibility
+        gSwordVisible = false;
+        gSpearVisible = false;
+        gShieldVisible = false;
+        gArmorVisible = false;
+        
+        // Stop war sound if playing
+        if (BackgroundRenderer::warSoundPlaying) {
+            BackgroundRenderer::stopWarSound();
+        }
+        
+        // Reset background settings
+        gBackgroundVisible = true;
+        BackgroundRenderer::collisionDebugMode = false;
+        
+        // Reset skirt texture to default
+        Tex::currentSkirtIndex = 0;
+        LOG_INFO("Skirt texture reset to: Default Skirt (Index: 0)");
+        
+        LOG_INFO("=== EVERYTHING RESET ===");
+    }
+    // Projection and Viewport Controls
+    else if (key == 'O') { gProjMode = PROJ_ORTHOGRAPHIC; } // Orthographic projection
+    else if (key == 'P') { gProjMode = PROJ_PERSPECTIVE; } // Perspective projection
+    else if (key == 'L') { gViewportMode = !gViewportMode; } // Toggle split viewport
+    // Kung Fu Animation Styles - Now with flowing anime-like animations!
+    else if (key == 'Q') { runOnSimulation([](CharacterState& character) { startKungFuAnimation(character, 1); }); } // Crane style animation
+    else if (key == 'N') { runOnSimulation([](CharacterState& character) { startKungFuAnimation(character, 0); }); } // Stop animation / Normal pose
+    // Higher jaw transition
+     // Facial Features Scale Controls
+    else if (key == 'W') keyW = true; else if (key == 'S') keyS = true;
+    else if (key == 'A') keyA = true; else if (key == 'D') keyD = true;
+    else if (key == 'G') keyG = true;
+    else if (key == Platform::KEY_SLASH) keySlash = true; // '/' key for slow arm bend
+    else if (key == Platform::KEY_UP) keyUp = true; else if (key == Platform::KEY_DOWN) keydown = true;
+    else if (key == Platform::KEY_LEFT) keyLeft = true; else if (key == Platform::KEY_RIGHT) keyRight = true;
+    else if (key == Platform::KEY_SHIFT) keyShift = true;
+}
+
+void onKeyUp(int key) {
+    if (key == 'W') keyW = false; else if (key == 'S') keyS = false;
+    else if (key == 'A') keyA = false; else if (key == 'D') keyD = false;
+    else if (key == 'G') keyG = false;
+    else if (key == Platform::KEY_SLASH) keySlash = false; // '/' key
+    else if (key == Platform::KEY_UP) keyUp = false; else if (key == Platform::KEY_DOWN) keydown = false;
+    else if (key == Platform::KEY_LEFT) keyLeft = false; else if (key == Platform::KEY_RIGHT) keyRight = false;
+    else if (key == Platform::KEY_SHIFT) keyShift = false;
 }
@@ -0,0 +1,78 @@
+#include "particles.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_SSE2 1
+#include <emmintrin.h>
+#else
+#define PARTICLES_SSE2 0
+#endif
+
+ParticlePool::ParticlePool(size_t capacity) : cap(capacity) {
+    const size_t padded = (capacity + 3) & ~(size_t)3;
+    for (std::vector<float>* v : { &px, &py, &pz, &vx, &vy, &vz, &life }) v->assign(padded, 0.0f);
+}
+
+void ParticlePool::assign(const ParticlePool& other) {
+    const std::vector<float>* from[] = { &other.px, &other.py, &other.pz, &other.vx, &other.vy, &other.vz, &other.life };
+    std::vector<float>* to[] = { &px, &py, &pz, &vx, &vy, &vz, &life };
+    for (int a = 0; a < 7; ++a) {
+        to[a]->resize(from[a]->size());     // Only when the capacities differ
+        std::copy(from[a]->begin(), from[a]->begin() + other.count, to[a]->begin());
+    }
+    cap = other.cap;
+    count = other.count;
+}
+
+bool ParticlePool::spawn(float x, float y, float z, float velX, float velY, float velZ, float lifetime) {
+    if (count == cap) return false;
+    const size_t i = count++;
+    px[i] = x;     py[i] = y;     pz[i] = z;
+    vx[i] = velX;  vy[i] = velY;  vz[i] = velZ;
+    life[i] = lifetime;
+    return true;
+}
+
+void ParticlePool::drift(float dt) {
+    for (size_t i = 0; i < count; ++i) {
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        pz[i] += vz[i] * dt;
+    }
+}
+
+void ParticlePool::update(float dt, float accelY, float floorY) {
+    // Integrate; lanes past count are padding and harmless to touch
+    size_t i = 0;
+#if PARTICLES_SSE2
+    const __m128 step = _mm_set1_ps(dt), gain = _mm_set1_ps(accelY * dt);
+    for (; i < count; i += 4) {
+        const __m128 vyOld = _mm_loadu_ps(&vy[i]);
+        _mm_storeu_ps(&px[i], _mm_add_ps(_mm_loadu_ps(&px[i]), _mm_mul_ps(_mm_loadu_ps(&vx[i]), step)));
+        _mm_storeu_ps(&py[i], _mm_add_ps(_mm_loadu_ps(&py[i]), _mm_mul_ps(vyOld, step)));
+        _mm_storeu_ps(&pz[i], _mm_add_ps(_mm_loadu_ps(&pz[i]), _mm_mul_ps(_mm_loadu_ps(&vz[i]), step)));
+        _mm_storeu_ps(&vy[i], _mm_add_ps(vyOld, gain));
+        _mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]), step));
+    }
+#else
+    const float gain = accelY * dt;
+    for (; i < count; ++i) {
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        pz[i] += vz[i] * dt;
+        vy[i] += gain;
+        life[i] -= dt;
+    }
+#endif
+
+    // Swap-and-pop: the last live particle takes the dead one's slot and is
+    // checked again on the next pass of the loop
+    i = 0;
+    while (i < count) {
+        if (life[i] > 0.0f && py[i] >= floorY) { ++i; continue; }
+        const size_t last = --count;
+        px[i] = px[last]; py[i] = py[last]; pz[i] = pz[last];
+        vx[i] = vx[last]; vy[i] = vy[last]; vz[i] = vz[last];
+        life[i] = life[last];
+    }
+}
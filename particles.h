@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity particle pool (arrows, sparks, embers, ...).
+//
+// Storage is structure-of-arrays, sized once in the constructor and never
+// grown; live particles are always the dense prefix [0, size()). spawn() is a
+// bounds check and seven stores, and dead particles are removed by moving the
+// last live one into their slot, so a frame never shuffles memory or
+// allocates. update() integrates every particle four at a time with SSE2
+// (scalar elsewhere) before the removal sweep.
+class ParticlePool {
+public:
+    explicit ParticlePool(size_t capacity);
+
+    // False (and nothing spawned) when the pool is full
+    bool spawn(float x, float y, float z, float vx, float vy, float vz, float lifetime);
+
+    // Explicit Euler, same order as the old per-effect loops: position with the
+    // current velocity, then velocity.y += accelY * dt, then lifetime -= dt.
+    // Particles whose lifetime ran out or that fell below floorY are removed
+    // (the order of the survivors is not kept).
+    void update(float dt, float accelY, float floorY = -1e30f);
+
+    // Moves every particle along its velocity for dt seconds (back, for a
+    // negative dt) and changes nothing else: frame snapshots drawn between two
+    // steps
+    void drift(float dt);
+
+    // Marks particle i dead; the next update() removes it
+    void expire(size_t i) { life[i] = 0.0f; }
+
+    void clear() { count = 0; }
+    // Becomes a copy of other's live particles, taking its capacity; the dead
+    // tail is not copied (frame snapshots)
+    void assign(const ParticlePool& other);
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool full() const { return count == cap; }
+
+    // Read access for drawing; valid for [0, size())
+    const float* x() const { return px.data(); }
+    const float* y() const { return py.data(); }
+    const float* z() const { return pz.data(); }
+    const float* velocityX() const { return vx.data(); }
+    const float* velocityY() const { return vy.data(); }
+    const float* velocityZ() const { return vz.data(); }
+    const float* lifetime() const { return life.data(); }
+
+private:
+    size_t cap;
+    size_t count = 0;
+    // Padded to a multiple of four so the SIMD loop never needs a scalar tail
+    std::vector<float> px, py, pz, vx, vy, vz, life;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+// Thin platform layer: window + GL context, input, timer, audio and
+// memory-mapped files. Everything else (animation, background, renderScene) talks to the
+// OS only through this header, so it builds and runs unchanged on Windows
+// (platform_win32.cpp) and Linux (platform_linux.cpp: X11/GLX window, or an
+// EGL pbuffer for headless runs).
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <gl/GL.h>
+#include <gl/GLU.h>
+#else
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+#include <cstddef>
+#include <vector>
+
+#ifndef GL_BGR
+#define GL_BGR  0x80E0
+#endif
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+
+namespace Platform {
+    // Key codes. Letters and digits are their upper-case ASCII values; the rest
+    // share the Win32 virtual-key numbering so the Win32 backend passes them through.
+    enum Key {
+        KEY_SHIFT     = 0x10,
+        KEY_ESCAPE    = 0x1B,
+        KEY_LEFT      = 0x25,
+        KEY_UP        = 0x26,
+        KEY_RIGHT     = 0x27,
+        KEY_DOWN      = 0x28,
+        KEY_NUMPAD1   = 0x61,
+        KEY_NUMPAD2   = 0x62,
+        KEY_NUMPAD3   = 0x63,
+        KEY_F2        = 0x71,
+        KEY_F3        = 0x72,
+        KEY_F4        = 0x73,
+        KEY_F5        = 0x74,
+        KEY_F6        = 0x75,
+        KEY_F7        = 0x76,
+        KEY_F8        = 0x77,
+        KEY_F9        = 0x78,
+        KEY_PLUS      = 0xBB,   // '=' / '+'
+        KEY_MINUS     = 0xBD,
+        KEY_SLASH     = 0xBF,
+        KEY_BACKTICK  = 0xC0,
+        KEY_COUNT     = 0x100
+    };
+
+    // Window events; any callback may be null
+    struct Callbacks {
+        void (*keyDown)(int key);
+        void (*keyUp)(int key);
+        void (*mouseButton)(int x, int y, bool down);   // Left button
+        void (*mouseMove)(int x, int y);
+        void (*mouseWheel)(int delta);                  // 120 per notch, positive away from the user
+        void (*resize)(int width, int height);
+    };
+
+    // --- Window / context ---
+    // Opens a visible window with a current legacy GL context
+    bool createWindow(const char* title, int width, int height, const Callbacks& callbacks);
+    // Current GL context with no visible window, for benchmarks and CI
+    bool createHeadless(int width, int height);
+    // Dispatches pending events; returns false once the window was closed or quit was requested
+    bool pumpEvents();
+    void swapBuffers();
+    void requestQuit();
+    void destroyWindow();
+    // Entry point of a GL function beyond 1.1 for the current context, or null
+    void* getProcAddress(const char* name);
+
+    // --- Input ---
+    bool isKeyDown(int key);
+
+    // --- Timer ---
+    // Monotonic seconds since an arbitrary origin
+    double timeSeconds();
+
+    // --- Audio ---
+    // Streams a file in a loop under an alias; returns false if it cannot be played
+    bool playLooping(const char* alias, const char* path, float volume);
+    void setVolume(const char* alias, float volume);   // 0..1
+    void stopSound(const char* alias);
+
+    // --- Files ---
+    // Read-only view of a whole file. Pages are read in on first touch and
+    // shared with the OS file cache, so nothing is copied up front.
+    struct MappedFile {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        void* handle = nullptr;     // OS mapping object, where there is one
+    };
+    bool mapFile(const char* path, MappedFile& out);   // False if missing or empty; callers report it
+    void unmapFile(MappedFile& file);
+
+    // --- Images ---
+    // CPU-side pixels laid out like an uncompressed BMP: bottom-up rows, BGR or
+    // BGRA, each row padded to 4 bytes (upload with GL_UNPACK_ALIGNMENT 4).
+    // Files are read with bmp.h.
+    struct Image {
+        int width = 0;
+        int height = 0;
+        int bitsPerPixel = 0;
+        std::vector<unsigned char> pixels;
+    };
+}
@@ -0,0 +1,234 @@
+#ifndef _WIN32
+
+#include "platform.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#include <GL/glx.h>
+#include <EGL/egl.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// X11 + GLX when a display is available, EGL pbuffer for headless runs.
+// With Mesa, EGL_PLATFORM=surfaceless gives a pbuffer without any X server.
+// Link: -lGL -lGLU -lX11 -lEGL
+
+namespace {
+    Display*   sDisplay = nullptr;
+    Window     sWindow = 0;
+    GLXContext sGlx = nullptr;
+    Atom       sDeleteAtom = 0;
+
+    EGLDisplay sEglDisplay = EGL_NO_DISPLAY;
+    EGLSurface sEglSurface = EGL_NO_SURFACE;
+    EGLContext sEglContext = EGL_NO_CONTEXT;
+
+    bool sQuit = false;
+    bool sKeys[Platform::KEY_COUNT] = {};
+    Platform::Callbacks sCallbacks = {};
+
+    int translateKey(KeySym sym) {
+        if (sym >= XK_a && sym <= XK_z) return 'A' + int(sym - XK_a);
+        if (sym >= XK_A && sym <= XK_Z) return 'A' + int(sym - XK_A);
+        if (sym >= XK_0 && sym <= XK_9) return '0' + int(sym - XK_0);
+        switch (sym) {
+        case XK_Shift_L: case XK_Shift_R: return Platform::KEY_SHIFT;
+        case XK_Escape:   return Platform::KEY_ESCAPE;
+        case XK_Left:     return Platform::KEY_LEFT;
+        case XK_Up:       return Platform::KEY_UP;
+        case XK_Right:    return Platform::KEY_RIGHT;
+        case XK_Down:     return Platform::KEY_DOWN;
+        case XK_KP_1: case XK_KP_End:       return Platform::KEY_NUMPAD1;
+        case XK_KP_2: case XK_KP_Down:      return Platform::KEY_NUMPAD2;
+        case XK_KP_3: case XK_KP_Page_Down: return Platform::KEY_NUMPAD3;
+        case XK_F2:       return Platform::KEY_F2;
+        case XK_F3:       return Platform::KEY_F3;
+        case XK_F4:       return Platform::KEY_F4;
+        case XK_F5:       return Platform::KEY_F5;
+        case XK_F6:       return Platform::KEY_F6;
+        case XK_F7:       return Platform::KEY_F7;
+        case XK_F8:       return Platform::KEY_F8;
+        case XK_F9:       return Platform::KEY_F9;
+        case XK_equal: case XK_plus: case XK_KP_Add:        return Platform::KEY_PLUS;
+        case XK_minus: case XK_KP_Subtract:                 return Platform::KEY_MINUS;
+        case XK_slash:    return Platform::KEY_SLASH;
+        case XK_grave:    return Platform::KEY_BACKTICK;
+        default:          return 0;
+        }
+    }
+
+    void setKey(int key, bool down) {
+        if (key <= 0 || key >= Platform::KEY_COUNT) return;
+        sKeys[key] = down;
+        if (down && sCallbacks.keyDown) sCallbacks.keyDown(key);
+        if (!down && sCallbacks.keyUp) sCallbacks.keyUp(key);
+    }
+
+}
+
+namespace Platform {
+    bool createWindow(const char* title, int width, int height, const Callbacks& callbacks) {
+        sCallbacks = callbacks;
+        sDisplay = XOpenDisplay(nullptr);
+        if (!sDisplay) {
+            printf("ERROR: No X display available\n");
+            return false;
+        }
+
+        int attribs[] = { GLX_RGBA, GLX_DOUBLEBUFFER, GLX_RED_SIZE, 8, GLX_GREEN_SIZE, 8, GLX_BLUE_SIZE, 8, GLX_DEPTH_SIZE, 24, None };
+        XVisualInfo* visual = glXChooseVisual(sDisplay, DefaultScreen(sDisplay), attribs);
+        if (!visual) return false;
+
+        Window root = RootWindow(sDisplay, visual->screen);
+        XSetWindowAttributes swa{};
+        swa.colormap = XCreateColormap(sDisplay, root, visual->visual, AllocNone);
+        swa.event_mask = ExposureMask | StructureNotifyMask | KeyPressMask | KeyReleaseMask |
+                         ButtonPressMask | ButtonReleaseMask | PointerMotionMask;
+        sWindow = XCreateWindow(sDisplay, root, 0, 0, width, height, 0, visual->depth, InputOutput,
+                                visual->visual, CWColormap | CWEventMask, &swa);
+        XStoreName(sDisplay, sWindow, title);
+        sDeleteAtom = XInternAtom(sDisplay, "WM_DELETE_WINDOW", False);
+        XSetWMProtocols(sDisplay, sWindow, &sDeleteAtom, 1);
+        XMapWindow(sDisplay, sWindow);
+
+        sGlx = glXCreateContext(sDisplay, visual, nullptr, True);
+        XFree(visual);
+        if (!sGlx) return false;
+        glXMakeCurrent(sDisplay, sWindow, sGlx);
+
+        // Held keys repeat as KeyPress only, like WM_KEYDOWN, instead of press/release pairs
+        XkbSetDetectableAutoRepeat(sDisplay, True, nullptr);
+        sQuit = false;
+        return true;
+    }
+
+    bool createHeadless(int width, int height) {
+        sCallbacks = Callbacks();
+        sEglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (sEglDisplay == EGL_NO_DISPLAY || !eglInitialize(sEglDisplay, nullptr, nullptr)) return false;
+
+        const EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+        EGLConfig config; EGLint count = 0;
+        if (!eglChooseConfig(sEglDisplay, configAttribs, &config, 1, &count) || count == 0) return false;
+
+        const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+        sEglSurface = eglCreatePbufferSurface(sEglDisplay, config, surfaceAttribs);
+        if (sEglSurface == EGL_NO_SURFACE) return false;
+
+        eglBindAPI(EGL_OPENGL_API);
+        sEglContext = eglCreateContext(sEglDisplay, config, EGL_NO_CONTEXT, nullptr);
+        if (sEglContext == EGL_NO_CONTEXT) return false;
+        sQuit = false;
+        return eglMakeCurrent(sEglDisplay, sEglSurface, sEglSurface, sEglContext) == EGL_TRUE;
+    }
+
+    bool pumpEvents() {
+        while (sDisplay && XPending(sDisplay)) {
+            XEvent ev;
+            XNextEvent(sDisplay, &ev);
+            switch (ev.type) {
+            case ConfigureNotify:
+                if (sCallbacks.resize) sCallbacks.resize(ev.xconfigure.width, ev.xconfigure.height);
+                break;
+            case KeyPress:
+            case KeyRelease:
+                setKey(translateKey(XLookupKeysym(&ev.xkey, 0)), ev.type == KeyPress);
+                break;
+            case ButtonPress:
+            case ButtonRelease:
+                if (ev.xbutton.button == Button1 && sCallbacks.mouseButton)
+                    sCallbacks.mouseButton(ev.xbutton.x, ev.xbutton.y, ev.type == ButtonPress);
+                else if (ev.type == ButtonPress && sCallbacks.mouseWheel && (ev.xbutton.button == Button4 || ev.xbutton.button == Button5))
+                    sCallbacks.mouseWheel(ev.xbutton.button == Button4 ? 120 : -120);
+                break;
+            case MotionNotify:
+                if (sCallbacks.mouseMove) sCallbacks.mouseMove(ev.xmotion.x, ev.xmotion.y);
+                break;
+            case ClientMessage:
+                if ((Atom)ev.xclient.data.l[0] == sDeleteAtom) sQuit = true;
+                break;
+            }
+        }
+        return !sQuit;
+    }
+
+    void swapBuffers() {
+        if (sDisplay) glXSwapBuffers(sDisplay, sWindow);
+        else if (sEglDisplay != EGL_NO_DISPLAY) eglSwapBuffers(sEglDisplay, sEglSurface);
+    }
+
+    void requestQuit() { sQuit = true; }
+
+    void destroyWindow() {
+        if (sDisplay) {
+            glXMakeCurrent(sDisplay, None, nullptr);
+            if (sGlx) glXDestroyContext(sDisplay, sGlx);
+            if (sWindow) XDestroyWindow(sDisplay, sWindow);
+            XCloseDisplay(sDisplay);
+            sDisplay = nullptr; sWindow = 0; sGlx = nullptr;
+        }
+        if (sEglDisplay != EGL_NO_DISPLAY) {
+            eglMakeCurrent(sEglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (sEglContext != EGL_NO_CONTEXT) eglDestroyContext(sEglDisplay, sEglContext);
+            if (sEglSurface != EGL_NO_SURFACE) eglDestroySurface(sEglDisplay, sEglSurface);
+            eglTerminate(sEglDisplay);
+            sEglDisplay = EGL_NO_DISPLAY; sEglSurface = EGL_NO_SURFACE; sEglContext = EGL_NO_CONTEXT;
+        }
+    }
+
+    void* getProcAddress(const char* name) {
+        if (sEglDisplay != EGL_NO_DISPLAY) return (void*)eglGetProcAddress(name);
+        return (void*)glXGetProcAddressARB((const GLubyte*)name);
+    }
+
+    bool isKeyDown(int key) { return key > 0 && key < KEY_COUNT && sKeys[key]; }
+
+    double timeSeconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // No audio backend on Linux yet; callers treat this like a missing device
+    bool playLooping(const char* alias, const char* path, float volume) {
+        (void)alias; (void)volume;
+        printf("Audio not available on this platform (%s)\n", path);
+        return false;
+    }
+    void setVolume(const char* alias, float volume) { (void)alias; (void)volume; }
+    void stopSound(const char* alias) { (void)alias; }
+
+    bool mapFile(const char* path, MappedFile& out) {
+        out = MappedFile();
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        void* data = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);                                          // The mapping keeps the file alive
+        if (data == MAP_FAILED) return false;
+        out.data = (const unsigned char*)data;
+        out.size = (size_t)info.st_size;
+        return true;
+    }
+
+    void unmapFile(MappedFile& file) {
+        if (file.data) munmap((void*)file.data, file.size);
+        file = MappedFile();
+    }
+}
+
+#endif // !_WIN32
@@ -0,0 +1,171 @@
+#ifdef _WIN32
+
+#include "platform.h"
+#include <windowsx.h>
+#include <mmsystem.h>
+#include <cstdio>
+#include <cstring>
+
+#pragma comment(lib, "OpenGL32.lib")
+#pragma comment(lib, "Glu32.lib")
+#pragma comment(lib, "winmm.lib")
+
+namespace {
+    const char* kWindowClass = "MulanPlatformWindow";
+
+    HWND  sWnd = NULL;
+    HDC   sDC = NULL;
+    HGLRC sRC = NULL;
+    bool  sQuit = false;
+    Platform::Callbacks sCallbacks = {};
+    LARGE_INTEGER sFreq = { 0 };
+
+    LRESULT WINAPI windowProcedure(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        switch (msg) {
+        case WM_DESTROY: PostQuitMessage(0); return 0;
+        case WM_SIZE: if (sCallbacks.resize) sCallbacks.resize(LOWORD(lParam), HIWORD(lParam)); return 0;
+        case WM_LBUTTONDOWN: SetCapture(hWnd); if (sCallbacks.mouseButton) sCallbacks.mouseButton(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), true); return 0;
+        case WM_LBUTTONUP: ReleaseCapture(); if (sCallbacks.mouseButton) sCallbacks.mouseButton(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), false); return 0;
+        case WM_MOUSEMOVE: if (sCallbacks.mouseMove) sCallbacks.mouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)); return 0;
+        case WM_MOUSEWHEEL: if (sCallbacks.mouseWheel) sCallbacks.mouseWheel(GET_WHEEL_DELTA_WPARAM(wParam)); return 0;
+        case WM_KEYDOWN: if (sCallbacks.keyDown) sCallbacks.keyDown((int)wParam); return 0;
+        case WM_KEYUP: if (sCallbacks.keyUp) sCallbacks.keyUp((int)wParam); return 0;
+        default: return DefWindowProc(hWnd, msg, wParam, lParam);
+        }
+    }
+
+    bool createContext(HWND hWnd) {
+        sDC = GetDC(hWnd);
+        PIXELFORMATDESCRIPTOR pfd{}; pfd.nSize = sizeof(pfd); pfd.nVersion = 1; pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER; pfd.iPixelType = PFD_TYPE_RGBA; pfd.cColorBits = 32; pfd.cDepthBits = 24; pfd.iLayerType = PFD_MAIN_PLANE;
+        int pf = ChoosePixelFormat(sDC, &pfd);
+        if (!pf || !SetPixelFormat(sDC, pf, &pfd)) return false;
+        sRC = wglCreateContext(sDC);
+        return sRC && wglMakeCurrent(sDC, sRC);
+    }
+
+    bool openWindow(const char* title, int width, int height, bool visible) {
+        WNDCLASSEXA wc{}; wc.cbSize = sizeof(WNDCLASSEXA); wc.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC; wc.lpfnWndProc = windowProcedure; wc.hInstance = GetModuleHandle(NULL); wc.lpszClassName = kWindowClass;
+        if (!RegisterClassExA(&wc)) return false;
+        sWnd = CreateWindowA(kWindowClass, title, WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, width, height, NULL, NULL, wc.hInstance, NULL);
+        if (!sWnd) return false;
+        if (!createContext(sWnd)) return false;
+        if (visible) { ShowWindow(sWnd, SW_SHOW); UpdateWindow(sWnd); }
+        sQuit = false;
+        return true;
+    }
+}
+
+namespace Platform {
+    bool createWindow(const char* title, int width, int height, const Callbacks& callbacks) {
+        sCallbacks = callbacks;
+        return openWindow(title, width, height, true);
+    }
+
+    // A never-shown window is enough for a legacy context: fragments outside the
+    // visible area may be discarded, but every GL call is still issued
+    bool createHeadless(int width, int height) {
+        sCallbacks = Callbacks();
+        return openWindow("Headless", width, height, false);
+    }
+
+    bool pumpEvents() {
+        MSG msg{};
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) { if (msg.message == WM_QUIT)sQuit = true; TranslateMessage(&msg); DispatchMessage(&msg); }
+        return !sQuit;
+    }
+
+    void swapBuffers() { SwapBuffers(sDC); }
+    void requestQuit() { PostQuitMessage(0); }
+
+    void destroyWindow() {
+        wglMakeCurrent(NULL, NULL);
+        if (sRC) wglDeleteContext(sRC);
+        if (sDC) ReleaseDC(sWnd, sDC);
+        if (sWnd) DestroyWindow(sWnd);
+        UnregisterClassA(kWindowClass, GetModuleHandle(NULL));
+        sWnd = NULL; sDC = NULL; sRC = NULL;
+    }
+
+    void* getProcAddress(const char* name) {
+        // wglGetProcAddress only knows extension/1.2+ entry points and may return small sentinel values
+        PROC proc = wglGetProcAddress(name);
+        if (proc == NULL || proc == (PROC)1 || proc == (PROC)2 || proc == (PROC)3 || proc == (PROC)-1) {
+            proc = GetProcAddress(GetModuleHandleA("opengl32.dll"), name);
+        }
+        return (void*)proc;
+    }
+
+    bool isKeyDown(int key) { return (GetKeyState(key) & 0x8000) != 0; }
+
+    double timeSeconds() {
+        if (sFreq.QuadPart == 0) QueryPerformanceFrequency(&sFreq);
+        LARGE_INTEGER now; QueryPerformanceCounter(&now);
+        return double(now.QuadPart) / double(sFreq.QuadPart);
+    }
+
+    // MCI plays MP3 through the mpegvideo device
+    bool playLooping(const char* alias, const char* path, float volume) {
+        char command[512];
+        sprintf_s(command, sizeof(command), "open \"%s\" type mpegvideo alias %s", path, alias);
+        MCIERROR mciError = mciSendStringA(command, NULL, 0, NULL);
+        if (mciError != 0) {
+            printf("Error opening %s: %lu\n", path, mciError);
+            return false;
+        }
+
+        setVolume(alias, volume);
+
+        sprintf_s(command, sizeof(command), "play %s repeat", alias);
+        mciError = mciSendStringA(command, NULL, 0, NULL);
+        if (mciError != 0) {
+            printf("Error playing %s: %lu\n", path, mciError);
+            stopSound(alias);
+            return false;
+        }
+        return true;
+    }
+
+    void setVolume(const char* alias, float volume) {
+        // MCI volume is 0 to 1000, where 1000 is maximum
+        char command[256];
+        sprintf_s(command, sizeof(command), "setaudio %s volume to %d", alias, (int)(volume * 1000.0f));
+        mciSendStringA(command, NULL, 0, NULL);
+    }
+
+    void stopSound(const char* alias) {
+        char command[256];
+        sprintf_s(command, sizeof(command), "stop %s", alias);
+        mciSendStringA(command, NULL, 0, NULL);
+        sprintf_s(command, sizeof(command), "close %s", alias);
+        mciSendStringA(command, NULL, 0, NULL);
+    }
+
+    bool mapFile(const char* path, MappedFile& out) {
+        out = MappedFile();
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size = { 0 };
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        }
+        CloseHandle(file);                                  // The mapping keeps the file open
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (!view) {
+            if (mapping) CloseHandle(mapping);
+            return false;
+        }
+        out.data = (const unsigned char*)view;
+        out.size = (size_t)size.QuadPart;
+        out.handle = mapping;
+        return true;
+    }
+
+    void unmapFile(MappedFile& file) {
+        if (file.data) UnmapViewOfFile(file.data);
+        if (file.handle) CloseHandle((HANDLE)file.handle);
+        file = MappedFile();
+    }
+}
+
+#endif // _WIN32
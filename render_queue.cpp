@@ -0,0 +1,80 @@
+#include "render_queue.h"
+#include <algorithm>
+
+void RenderQueue::submit(const State& state, void (*draw)()) {
+    items.push_back({ state, draw });
+}
+
+void RenderQueue::flush() {
+    stats = { (unsigned)items.size(), 0, 0 };
+    if (items.empty()) return;
+
+    std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        if (a.state.blend != b.state.blend) return !a.state.blend;
+        if (a.state.blend) return false;                  // Blended: submission order
+        if (a.state.lighting != b.state.lighting) return a.state.lighting;
+        if (a.state.texture != b.state.texture) return a.state.texture < b.state.texture;
+        return a.state.region < b.state.region;
+    });
+
+    // Nothing is known about the state on entry, so the first item sets all of it
+    const Item& first = items.front();
+    State current = first.state;
+    if (first.state.lighting) glEnable(GL_LIGHTING); else glDisable(GL_LIGHTING);
+    if (first.state.blend) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    if (first.state.texture) {
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, first.state.texture);
+        stats.textureBinds++;
+    } else {
+        glDisable(GL_TEXTURE_2D);
+    }
+    if (first.state.region) TextureAtlas::loadTextureMatrix(*first.state.region);
+    else TextureAtlas::resetTextureMatrix();
+    stats.stateChanges += 4;
+
+    for (const Item& item : items) {
+        const State& next = item.state;
+        if (next.lighting != current.lighting) {
+            if (next.lighting) glEnable(GL_LIGHTING); else glDisable(GL_LIGHTING);
+            stats.stateChanges++;
+        }
+        if (next.blend != current.blend) {
+            if (next.blend) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            } else {
+                glDisable(GL_BLEND);
+            }
+            stats.stateChanges++;
+        }
+        if (next.texture != current.texture) {
+            if ((next.texture != 0) != (current.texture != 0)) {
+                if (next.texture) glEnable(GL_TEXTURE_2D); else glDisable(GL_TEXTURE_2D);
+                stats.stateChanges++;
+            }
+            if (next.texture) {
+                glBindTexture(GL_TEXTURE_2D, next.texture);
+                stats.textureBinds++;
+            }
+        }
+        if (next.region != current.region) {
+            if (next.region) TextureAtlas::loadTextureMatrix(*next.region);
+            else TextureAtlas::resetTextureMatrix();
+            stats.stateChanges++;
+        }
+        current = next;
+        item.draw();
+    }
+
+    if (!current.lighting) glEnable(GL_LIGHTING);
+    if (current.blend) glDisable(GL_BLEND);
+    if (current.texture) glDisable(GL_TEXTURE_2D);
+    if (current.region) TextureAtlas::resetTextureMatrix();
+    items.clear();
+}
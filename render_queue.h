@@ -0,0 +1,48 @@
+#pragma once
+
+#include "platform.h"
+#include "texture_atlas.h"
+#include <vector>
+
+// Background draws collected for a frame and submitted sorted by the GL state
+// they need, so binds and enables happen once per run instead of once per
+// pass.
+//
+// A pass submitted here declares its state (texture, atlas rectangle,
+// lighting, blending) instead of setting it, and sets only what belongs to the
+// draw itself: colour, normal, matrices. flush() draws the opaque passes
+// first, grouped by lighting, texture and rectangle (stable, so equal states
+// keep their order), then the blended ones in submission order, since
+// blending depends on it. Between neighbours it changes only what differs.
+class RenderQueue {
+public:
+    struct State {
+        GLuint texture;                         // 0 draws untextured
+        const TextureAtlas::Rect* region;       // Part of the texture that s, t in [0, 1] cover; null for all of it
+        bool lighting;
+        bool blend;                             // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+    };
+
+    struct Stats {
+        unsigned draws;
+        unsigned textureBinds;
+        unsigned stateChanges;                  // Enables, disables and texture matrix loads
+    };
+
+    void submit(const State& state, void (*draw)());
+
+    // Draws and empties the queue. Afterwards lighting is on, blending and
+    // texturing are off and the texture matrix is the identity, whatever the
+    // state before.
+    void flush();
+
+    const Stats& lastFlush() const { return stats; }
+
+private:
+    struct Item {
+        State state;
+        void (*draw)();
+    };
+    std::vector<Item> items;
+    Stats stats = { 0, 0, 0 };
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// Small seeded generator (xorshift32) for procedural placement and effects.
+// Each system owns its own, so one system drawing more numbers never shifts
+// another's sequence, and a seed gives the same numbers on every platform,
+// which rand() does not promise.
+struct Rng {
+    uint32_t state;
+
+    explicit Rng(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Drop-in for rand() % n
+    int below(int n) { return (int)(next() % (uint32_t)n); }
+};
@@ -1,7 +1,6 @@
 #include "shield.h"
-#include <Windows.h>
-#include <gl/GL.h>
-#include <gl/GLU.h>
+#include "platform.h"
+#include "gl_stats.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include "texture.h"
@@ -13,6 +12,7 @@ extern RenderMode gRenderMode;
 
 void drawShield()
 {
+    GL_STATS_SCOPE(SUB_WEAPONS);
     const int segments = 32;
     const int rings = 8;
     const float radius = 1.8f;
@@ -0,0 +1,87 @@
+#include "sim_thread.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace SimThread {
+    namespace {
+        std::mutex mutex;
+        std::condition_variable wake;      // Worker: work or stop
+        std::condition_variable drained;   // wait(): the queue ran dry
+        std::deque<std::function<void()>> queue;
+        bool busy = false;                 // The worker is running an item
+        bool stopping = false;
+        thread_local bool isWorker = false;
+
+        void workerLoop() {
+            isWorker = true;
+            for (;;) {
+                std::function<void()> work;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [] { return stopping || !queue.empty(); });
+                    if (queue.empty()) return;     // Stopping, and everything ran
+                    work = std::move(queue.front());
+                    queue.pop_front();
+                    busy = true;
+                }
+                work();
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    busy = false;
+                }
+                drained.notify_all();
+            }
+        }
+
+        // Joined on exit even if stop() was never called
+        struct Worker {
+            std::thread thread;
+            ~Worker() { stop(); }
+        } worker;
+    }
+
+    void start() {
+        if (worker.thread.joinable()) return;
+        stopping = false;
+        worker.thread = std::thread(workerLoop);
+    }
+
+    void stop() {
+        if (!worker.thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.thread.join();
+    }
+
+    bool running() {
+        return worker.thread.joinable();
+    }
+
+    bool onThread() {
+        return isWorker;
+    }
+
+    void post(std::function<void()> work) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(work));
+        }
+        wake.notify_one();
+    }
+
+    bool idle() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.empty() && !busy;
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [] { return queue.empty() && !busy; });
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+
+// The thread the simulation runs on, so a frame's update overlaps the
+// drawing of the one before it.
+//
+// Work posted from the frame loop runs on the thread in the order it was
+// posted, one item at a time: a frame's step, a key press that starts an
+// animation, a reset. What the steps produce goes back to the render thread
+// through the caller's own channel (main.cpp publishes frame snapshots in a
+// TripleBuffer); this only orders and runs the work.
+namespace SimThread {
+    void start();
+    // Runs what is queued, then joins the thread. Safe to call when stopped.
+    void stop();
+    bool running();
+    // Called from the thread itself, i.e. from posted work
+    bool onThread();
+
+    void post(std::function<void()> work);
+    // Nothing queued or running
+    bool idle();
+    // Blocks until everything posted so far has run
+    void wait();
+}
@@ -0,0 +1,310 @@
+#include "skinning.h"
+#include "jobs.h"
+#include <algorithm>
+#include <array>
+#include <map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SKINNING_SSE2 1
+#include <emmintrin.h>
+#else
+#define SKINNING_SSE2 0
+#endif
+
+static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3f must be tightly packed for the interleaved stores");
+
+namespace Skinning {
+    size_t parallelThreshold = 16384;
+
+    namespace {
+        // --- Quaternion helpers (scalar, per joint) ---
+        Quat multiply(const Quat& a, const Quat& b) {
+            return {
+                a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+            };
+        }
+
+        Vec3f rotate(const Quat& q, const Vec3f& v) {
+            Vec3f u = { q.x, q.y, q.z };
+            Vec3f t = cross(u, v);
+            t = { 2.0f * t.x, 2.0f * t.y, 2.0f * t.z };
+            Vec3f c = cross(u, t);
+            return { v.x + q.w * t.x + c.x, v.y + q.w * t.y + c.y, v.z + q.w * t.z + c.z };
+        }
+
+        // --- Lanes: the kernel is written once and run four-wide or one-wide ---
+        struct ScalarLane {
+            typedef float V;
+            enum { width = 1 };
+            static V load(const float* p) { return *p; }
+            static V set(float f) { return f; }
+            static V rsqrt(V a) { return 1.0f / sqrtf(a); }
+            static void store(Vec3f* dst, V x, V y, V z) { *dst = { x, y, z }; }
+        };
+
+#if SKINNING_SSE2
+        struct F4 { __m128 v; };
+        inline F4 operator+(F4 a, F4 b) { return { _mm_add_ps(a.v, b.v) }; }
+        inline F4 operator-(F4 a, F4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+        inline F4 operator*(F4 a, F4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+        inline F4& operator+=(F4& a, F4 b) { a.v = _mm_add_ps(a.v, b.v); return a; }
+
+        struct SseLane {
+            typedef F4 V;
+            enum { width = 4 };
+            static V load(const float* p) { return { _mm_loadu_ps(p) }; }
+            static V set(float f) { return { _mm_set1_ps(f) }; }
+            static V rsqrt(V a) { return { _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a.v)) }; }
+
+            // Four SoA lanes -> four interleaved xyz triples (12 floats, three stores)
+            static void store(Vec3f* dst, V x, V y, V z) {
+                float* out = &dst->x;
+                __m128 xy01 = _mm_unpacklo_ps(x.v, y.v);                                    // x0 y0 x1 y1
+                __m128 xy23 = _mm_unpackhi_ps(x.v, y.v);                                    // x2 y2 x3 y3
+                __m128 z0x1 = _mm_shuffle_ps(z.v, x.v, _MM_SHUFFLE(1, 1, 0, 0));            // z0 z0 x1 x1
+                __m128 y1z1 = _mm_shuffle_ps(y.v, z.v, _MM_SHUFFLE(1, 1, 1, 1));            // y1 y1 z1 z1
+                __m128 z2x3 = _mm_shuffle_ps(z.v, xy23, _MM_SHUFFLE(3, 2, 3, 2));           // z2 z3 x3 y3
+                _mm_storeu_ps(out + 0, _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));  // x0 y0 z0 x1
+                _mm_storeu_ps(out + 4, _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));  // y1 z1 x2 y2
+                _mm_storeu_ps(out + 8, _mm_shuffle_ps(z2x3, z2x3, _MM_SHUFFLE(1, 3, 2, 0)));  // z2 x3 y3 z3
+            }
+        };
+#endif
+
+        // Skins [i, end) of one batch, lane-width at a time; returns where it stopped
+        template <class L>
+        size_t skinSpan(const Mesh& mesh, const Batch& batch, const Palette& palette, Method method, float mirror,
+                        size_t i, size_t end, Vec3f* outP, Vec3f* outN) {
+            typedef typename L::V V;
+            const int n = batch.jointCount;
+            const V m = L::set(mirror);
+
+            if (n == 1 || method == LINEAR_BLEND) {
+                // Blended 3x4 matrix per vertex; a single joint needs no blend at all
+                V joint[kMaxInfluences][12];
+                for (int k = 0; k < n; ++k)
+                    for (int c = 0; c < 12; ++c) joint[k][c] = L::set(palette.matrices[batch.joints[k] * 12 + c]);
+
+                V blended[12];
+                for (; i + L::width <= end; i += L::width) {
+                    const V* r = joint[0];
+                    if (n > 1) {
+                        const V w0 = L::load(&mesh.weights[0][i]);
+                        for (int c = 0; c < 12; ++c) blended[c] = w0 * joint[0][c];
+                        for (int k = 1; k < n; ++k) {
+                            const V w = L::load(&mesh.weights[k][i]);
+                            for (int c = 0; c < 12; ++c) blended[c] += w * joint[k][c];
+                        }
+                        r = blended;
+                    }
+                    const V x = L::load(&mesh.px[i]), y = L::load(&mesh.py[i]), z = L::load(&mesh.pz[i]);
+                    const V nx = L::load(&mesh.nx[i]), ny = L::load(&mesh.ny[i]), nz = L::load(&mesh.nz[i]);
+                    L::store(&outP[i], (r[0] * x + r[1] * y + r[2] * z + r[3]) * m,
+                                       r[4] * x + r[5] * y + r[6] * z + r[7],
+                                       r[8] * x + r[9] * y + r[10] * z + r[11]);
+                    L::store(&outN[i], (r[0] * nx + r[1] * ny + r[2] * nz) * m,
+                                       r[4] * nx + r[5] * ny + r[6] * nz,
+                                       r[8] * nx + r[9] * ny + r[10] * nz);
+                }
+                return i;
+            }
+
+            // Dual quaternions: flip joints into the first one's hemisphere so the
+            // blend takes the short way round (the sign only depends on the pose)
+            V joint[kMaxInfluences][8];
+            const float* q0 = &palette.dualQuats[batch.joints[0] * 8];
+            for (int k = 0; k < n; ++k) {
+                const float* q = &palette.dualQuats[batch.joints[k] * 8];
+                const float sign = (q0[0] * q[0] + q0[1] * q[1] + q0[2] * q[2] + q0[3] * q[3]) < 0.0f ? -1.0f : 1.0f;
+                for (int c = 0; c < 8; ++c) joint[k][c] = L::set(sign * q[c]);
+            }
+
+            const V two = L::set(2.0f);
+            for (; i + L::width <= end; i += L::width) {
+                V b[8];
+                const V w0 = L::load(&mesh.weights[0][i]);
+                for (int c = 0; c < 8; ++c) b[c] = w0 * joint[0][c];
+                for (int k = 1; k < n; ++k) {
+                    const V w = L::load(&mesh.weights[k][i]);
+                    for (int c = 0; c < 8; ++c) b[c] += w * joint[k][c];
+                }
+                const V inv = L::rsqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2] + b[3] * b[3]);
+                const V rx = b[0] * inv, ry = b[1] * inv, rz = b[2] * inv, rw = b[3] * inv;
+                const V dx = b[4] * inv, dy = b[5] * inv, dz = b[6] * inv, dw = b[7] * inv;
+
+                // Translation 2 (rw d - dw r + r x d), then v + 2 r x (r x v + rw v)
+                const V tx = two * (rw * dx - dw * rx + (ry * dz - rz * dy));
+                const V ty = two * (rw * dy - dw * ry + (rz * dx - rx * dz));
+                const V tz = two * (rw * dz - dw * rz + (rx * dy - ry * dx));
+
+                const V x = L::load(&mesh.px[i]), y = L::load(&mesh.py[i]), z = L::load(&mesh.pz[i]);
+                V cx = ry * z - rz * y + rw * x, cy = rz * x - rx * z + rw * y, cz = rx * y - ry * x + rw * z;
+                L::store(&outP[i], (x + two * (ry * cz - rz * cy) + tx) * m,
+                                   y + two * (rz * cx - rx * cz) + ty,
+                                   z + two * (rx * cy - ry * cx) + tz);
+
+                const V nx = L::load(&mesh.nx[i]), ny = L::load(&mesh.ny[i]), nz = L::load(&mesh.nz[i]);
+                cx = ry * nz - rz * ny + rw * nx; cy = rz * nx - rx * nz + rw * ny; cz = rx * ny - ry * nx + rw * nz;
+                L::store(&outN[i], (nx + two * (ry * cz - rz * cy)) * m,
+                                   ny + two * (rz * cx - rx * cz),
+                                   nz + two * (rx * cy - ry * cx));
+            }
+            return i;
+        }
+
+        void skinRange(const Mesh& mesh, const Palette& palette, Method method, bool mirrorX,
+                       size_t begin, size_t end, Vec3f* outP, Vec3f* outN) {
+            const float mirror = mirrorX ? -1.0f : 1.0f;
+            for (const Batch& batch : mesh.batches) {
+                size_t from = std::max(begin, batch.begin), to = std::min(end, batch.end);
+                if (from >= to) continue;
+#if SKINNING_SSE2
+                from = skinSpan<SseLane>(mesh, batch, palette, method, mirror, from, to, outP, outN);
+#endif
+                skinSpan<ScalarLane>(mesh, batch, palette, method, mirror, from, to, outP, outN);
+            }
+        }
+    }
+
+    Quat axisAngle(float axisX, float axisY, float axisZ, float degrees) {
+        Vec3f axis = normalize({ axisX, axisY, axisZ });
+        const float half = degrees * PI / 360.0f, s = sinf(half);
+        return { axis.x * s, axis.y * s, axis.z * s, cosf(half) };
+    }
+
+    int Skeleton::addJoint(int parent, const Vec3f& pivot) {
+        parents.push_back(parent);
+        pivots.push_back(pivot);
+        return (int)parents.size() - 1;
+    }
+
+    void computePalette(const Skeleton& skeleton, const Quat* rotations, Palette& out) {
+        const size_t count = skeleton.size();
+        out.matrices.resize(count * 12);
+        out.dualQuats.resize(count * 8);
+        for (size_t j = 0; j < count; ++j) {
+            // Local: rotate about the pivot, t = p - R p
+            Quat q = rotations[j];
+            const Vec3f& p = skeleton.pivots[j];
+            Vec3f rp = rotate(q, p);
+            Vec3f t = { p.x - rp.x, p.y - rp.y, p.z - rp.z };
+
+            const int parent = skeleton.parents[j];
+            if (parent >= 0) {
+                const float* pq = &out.dualQuats[parent * 8];
+                const float* pm = &out.matrices[parent * 12];
+                const Quat parentQ = { pq[0], pq[1], pq[2], pq[3] };
+                Vec3f pt = rotate(parentQ, t);
+                t = { pt.x + pm[3], pt.y + pm[7], pt.z + pm[11] };
+                q = multiply(parentQ, q);
+            }
+
+            const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+            const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+            const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+            float* m = &out.matrices[j * 12];
+            m[0] = 1 - 2 * (yy + zz); m[1] = 2 * (xy - wz);     m[2] = 2 * (xz + wy);      m[3] = t.x;
+            m[4] = 2 * (xy + wz);     m[5] = 1 - 2 * (xx + zz); m[6] = 2 * (yz - wx);      m[7] = t.y;
+            m[8] = 2 * (xz - wy);     m[9] = 2 * (yz + wx);     m[10] = 1 - 2 * (xx + yy); m[11] = t.z;
+
+            // Dual part 0.5 * (t, 0) * q
+            const Quat d = multiply({ t.x, t.y, t.z, 0.0f }, q);
+            float* dq = &out.dualQuats[j * 8];
+            dq[0] = q.x; dq[1] = q.y; dq[2] = q.z; dq[3] = q.w;
+            dq[4] = 0.5f * d.x; dq[5] = 0.5f * d.y; dq[6] = 0.5f * d.z; dq[7] = 0.5f * d.w;
+        }
+    }
+
+    void transformJoints(const Skeleton& skeleton, const Palette& palette, Vec3f* out) {
+        for (size_t j = 0; j < skeleton.size(); ++j) {
+            const Vec3f& p = skeleton.pivots[j];
+            const int parent = skeleton.parents[j];
+            if (parent < 0) { out[j] = p; continue; }
+            const float* m = &palette.matrices[parent * 12];
+            out[j] = { m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3],
+                       m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7],
+                       m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11] };
+        }
+    }
+
+    void buildMesh(const Vec3f* positions, const Vec3f* normals, const VertexWeights* weights, size_t count,
+                   Mesh& out, std::vector<int>& order) {
+        // Keep the strongest influences, renormalise, then key on the sorted joint set
+        struct Influence { int joint; float weight; };
+        std::vector<std::array<Influence, kMaxInfluences>> influences(count);
+        std::map<std::array<int, kMaxInfluences>, std::vector<int>> groups;
+        for (size_t i = 0; i < count; ++i) {
+            Influence in[kMaxInfluences];
+            int n = 0;
+            float total = 0.0f;
+            for (int k = 0; k < kMaxInfluences; ++k) {
+                if (weights[i].weights[k] <= 0.0f) continue;
+                in[n++] = { weights[i].joints[k], weights[i].weights[k] };
+                total += weights[i].weights[k];
+            }
+            if (n == 0) { in[n++] = { 0, 1.0f }; total = 1.0f; } // Unweighted vertices follow the root
+            std::sort(in, in + n, [](const Influence& a, const Influence& b) { return a.joint < b.joint; });
+
+            std::array<int, kMaxInfluences> key;
+            key.fill(-1);
+            for (int k = 0; k < kMaxInfluences; ++k) {
+                influences[i][k] = k < n ? Influence{ in[k].joint, in[k].weight / total } : Influence{ -1, 0.0f };
+                if (k < n) key[k] = in[k].joint;
+            }
+            groups[key].push_back((int)i);
+        }
+
+        out.px.resize(count); out.py.resize(count); out.pz.resize(count);
+        out.nx.resize(count); out.ny.resize(count); out.nz.resize(count);
+        for (auto& w : out.weights) w.assign(count, 0.0f);
+        out.batches.clear();
+        out.count = count;
+        order.clear();
+        order.reserve(count);
+
+        for (const auto& group : groups) {
+            Batch batch;
+            batch.begin = order.size();
+            batch.jointCount = 0;
+            for (int k = 0; k < kMaxInfluences; ++k) {
+                batch.joints[k] = group.first[k];
+                if (group.first[k] >= 0) ++batch.jointCount;
+            }
+            for (int source : group.second) {
+                const size_t i = order.size();
+                order.push_back(source);
+                out.px[i] = positions[source].x; out.py[i] = positions[source].y; out.pz[i] = positions[source].z;
+                out.nx[i] = normals[source].x;   out.ny[i] = normals[source].y;   out.nz[i] = normals[source].z;
+                for (int k = 0; k < batch.jointCount; ++k) out.weights[k][i] = influences[source][k].weight;
+            }
+            batch.end = order.size();
+            out.batches.push_back(batch);
+        }
+    }
+
+    void skin(const Mesh& mesh, const Palette& palette, Method method, bool mirrorX,
+              Vec3f* outPositions, Vec3f* outNormals) {
+        if (mesh.count < parallelThreshold) {
+            skinRange(mesh, palette, method, mirrorX, 0, mesh.count, outPositions, outNormals);
+            return;
+        }
+
+        // A slice per job thread, multiples of four so every lane group stays whole
+        const size_t threads = Jobs::threadCount();
+        const size_t slice = ((mesh.count + threads - 1) / threads + 3) & ~(size_t)3;
+        Jobs::parallelFor(mesh.count, slice, [&](size_t begin, size_t end) {
+            skinRange(mesh, palette, method, mirrorX, begin, end, outPositions, outNormals);
+        });
+    }
+
+    int workerCount() {
+        return Jobs::threadCount() - 1;
+    }
+
+    const char* kernelName() {
+        return SKINNING_SSE2 ? "SSE2, 4 vertices per iteration, batched by joint set" : "scalar, batched by joint set";
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "utils.h"
+#include <cstddef>
+#include <vector>
+
+// Skeletal skinning shared by every deforming part of the character.
+//
+// A Skeleton is a list of joints, parents first, each rotating about a pivot
+// given in mesh space (so no inverse bind matrices are needed). A pose is one
+// local rotation per joint. computePalette() turns a pose into per-joint
+// world transforms, both as 3x4 matrices (linear blend) and as unit dual
+// quaternions (dual-quaternion blend, no candy-wrapper collapse at big bends).
+//
+// Meshes are prepared once by buildMesh(): vertices with up to four weights
+// are grouped into batches that share the same joint set, stored as SoA, and
+// the caller reorders its own per-vertex arrays to match. Each batch is then
+// skinned with its joints' transforms held in registers; with SSE2 four
+// vertices are blended per iteration. Meshes above parallelThreshold vertices
+// are split across the job threads (jobs.h).
+namespace Skinning {
+    const int kMaxInfluences = 4;
+
+    enum Method { LINEAR_BLEND, DUAL_QUATERNION };
+
+    struct Quat { float x, y, z, w; };
+    Quat axisAngle(float axisX, float axisY, float axisZ, float degrees);
+    const Quat kIdentity = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+    struct Skeleton {
+        std::vector<int> parents;      // -1 for a root; always lower than the joint's own index
+        std::vector<Vec3f> pivots;     // Rotation centre of each joint, mesh space
+
+        int addJoint(int parent, const Vec3f& pivot);
+        size_t size() const { return parents.size(); }
+    };
+
+    // World transforms of every joint for one pose
+    struct Palette {
+        std::vector<float> matrices;   // 12 floats per joint: rows of [R | t]
+        std::vector<float> dualQuats;  // 8 floats per joint: real xyzw, dual xyzw
+    };
+
+    // rotations[j] is joint j's rotation about its pivot, in its parent's frame
+    void computePalette(const Skeleton& skeleton, const Quat* rotations, Palette& out);
+
+    // Posed pivot of every joint (a joint moves with its parent, not itself)
+    void transformJoints(const Skeleton& skeleton, const Palette& palette, Vec3f* out);
+
+    struct VertexWeights {
+        int joints[kMaxInfluences];
+        float weights[kMaxInfluences]; // Zero weights are ignored; the rest are renormalised
+    };
+
+    struct Batch {
+        size_t begin, end;
+        int jointCount;
+        int joints[kMaxInfluences];
+    };
+
+    struct Mesh {
+        std::vector<float> px, py, pz;
+        std::vector<float> nx, ny, nz;
+        std::vector<float> weights[kMaxInfluences]; // weights[k][i]: i's weight for its batch's k-th joint
+        std::vector<Batch> batches;
+        size_t count = 0;
+    };
+
+    // Groups the vertices by joint set. order[k] receives the source index of
+    // mesh vertex k; outputs of skin() follow that order.
+    void buildMesh(const Vec3f* positions, const Vec3f* normals, const VertexWeights* weights, size_t count,
+                   Mesh& out, std::vector<int>& order);
+
+    // Writes count skinned positions/normals; mirrorX reflects the result in x
+    void skin(const Mesh& mesh, const Palette& palette, Method method, bool mirrorX,
+              Vec3f* outPositions, Vec3f* outNormals);
+
+    // Meshes with at least this many vertices are skinned on the job threads;
+    // workerCount() is how many help the caller
+    extern size_t parallelThreshold;
+    int workerCount();
+
+    // Name of the kernel compiled in, for reports
+    const char* kernelName();
+}
@@ -1,6 +1,6 @@
 #include "spear.h"
-#include <Windows.h>
-#include <gl/GL.h>
+#include "platform.h"
+#include "gl_stats.h"
 #include <cmath>
 #include "utils.h"
 #include "texture.h"
@@ -12,6 +12,7 @@ extern RenderMode gRenderMode;
 
 void drawSpear()
 {
+    GL_STATS_SCOPE(SUB_WEAPONS);
     const int segments = 12;
     const float shaftHeight = 10.0f;
     const float shaftRadius = 0.1f;
@@ -1,9 +1,6 @@
 #pragma once
 
-#define NOMINMAX
-#include <Windows.h>
-#include <gl/GL.h>
-#include <gl/GLU.h>
+#include "platform.h"
 #define _USE_MATH_DEFINES
 #include <cmath>
 
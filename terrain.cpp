@@ -0,0 +1,245 @@
+#include "terrain.h"
+#include "frustum.h"
+#include <cmath>
+#include <vector>
+#include "gl_stats.h"
+
+namespace Terrain {
+    static const int kSamples = kGridCells + 1;
+    static const int kChunkCells = 20;
+    static const int kChunks = kGridCells / kChunkCells;
+    static const int kLevels = 3;                       // Vertex steps 1, 2, 4
+    static const float kLevelDistance[kLevels - 1] = { 40.0f, 80.0f };
+    static const float kSkirtDepth = 2.0f;
+
+    struct Sample {
+        float px, py, pz;
+        float nx, ny, nz;
+        float r, g, b;
+        float u, v;
+    };
+
+    struct Chunk {
+        float min[3], max[3];
+        GLuint lists;                                   // kLevels consecutive lists
+    };
+
+    static std::vector<Sample> samples;                 // Row-major, z then x
+    static std::vector<float> heights;                  // Same layout, for queries
+    static Chunk chunks[kChunks * kChunks];
+    static bool uploaded = false;
+
+    float analyticHeight(float x, float z) {
+        float baseHeight = sin(x * 0.05f) * cos(z * 0.07f) * 2.0f;
+        float mudVariation = sin(x * 0.25f + z * 0.35f) * 0.8f;   // Mud ruts and puddles
+        float battleWear = cos(x * 0.15f + z * 0.1f) * 0.5f;      // Battle trampling
+        return baseHeight + mudVariation + battleWear;
+    }
+
+    void generate() {
+        if (!samples.empty()) return;
+        heights.resize(kSamples * kSamples);
+        for (int j = 0; j < kSamples; ++j) {
+            for (int i = 0; i < kSamples; ++i) {
+                heights[j * kSamples + i] = analyticHeight(i * kCellSize - kExtent, j * kCellSize - kExtent);
+            }
+        }
+
+        samples.resize(kSamples * kSamples);
+        for (int j = 0; j < kSamples; ++j) {
+            for (int i = 0; i < kSamples; ++i) {
+                Sample& s = samples[j * kSamples + i];
+                s.px = i * kCellSize - kExtent;
+                s.pz = j * kCellSize - kExtent;
+                s.py = heights[j * kSamples + i];
+
+                // Central differences (one-sided on the border)
+                const int i0 = i > 0 ? i - 1 : i, i1 = i < kGridCells ? i + 1 : i;
+                const int j0 = j > 0 ? j - 1 : j, j1 = j < kGridCells ? j + 1 : j;
+                const float dx = (heights[j * kSamples + i1] - heights[j * kSamples + i0]) / ((i1 - i0) * kCellSize);
+                const float dz = (heights[j1 * kSamples + i] - heights[j0 * kSamples + i]) / ((j1 - j0) * kCellSize);
+                const float len = sqrtf(dx * dx + 1.0f + dz * dz);
+                s.nx = -dx / len; s.ny = 1.0f / len; s.nz = -dz / len;
+
+                // Subtle colour variations, blood and ash stains
+                float colorVar = (s.py + 3.0f) * 0.02f;
+                float bloodStain = (sin(s.px * 0.35f) + cos(s.pz * 0.3f)) > 1.5f ? -0.1f : 0.0f;
+                float ashStain = (sin(s.px * 0.6f) + cos(s.pz * 0.45f)) > 1.7f ? -0.05f : 0.0f;
+                s.r = 1.0f - colorVar + bloodStain + ashStain;
+                s.g = 1.0f - colorVar * 0.5f + bloodStain * 0.5f + ashStain;
+                s.b = 1.0f - colorVar * 0.3f + ashStain;
+
+                // Texture repeats every 20 units
+                s.u = (s.px + 100.0f) / 20.0f;
+                s.v = (s.pz + 100.0f) / 20.0f;
+            }
+        }
+    }
+
+    // Cell containing (x, z), clamped to the grid, and the position inside it
+    static const float* locate(float x, float z, float& tx, float& tz, bool& inside) {
+        generate();
+        float fx = (x + kExtent) / kCellSize, fz = (z + kExtent) / kCellSize;
+        inside = fx >= 0.0f && fx <= kGridCells && fz >= 0.0f && fz <= kGridCells;
+        fx = fx < 0.0f ? 0.0f : (fx > kGridCells ? (float)kGridCells : fx);
+        fz = fz < 0.0f ? 0.0f : (fz > kGridCells ? (float)kGridCells : fz);
+        int i = (int)fx, j = (int)fz;
+        if (i == kGridCells) --i;
+        if (j == kGridCells) --j;
+        tx = fx - i;
+        tz = fz - j;
+        return &heights[j * kSamples + i];
+    }
+
+    float heightAt(float x, float z) {
+        float tx, tz;
+        bool inside;
+        const float* row0 = locate(x, z, tx, tz, inside);
+        const float* row1 = row0 + kSamples;
+        const float a = row0[0] + (row0[1] - row0[0]) * tx;
+        const float b = row1[0] + (row1[1] - row1[0]) * tx;
+        return a + (b - a) * tz;
+    }
+
+    void normalAt(float x, float z, float normal[3]) {
+        float tx, tz;
+        bool inside;
+        const float* row0 = locate(x, z, tx, tz, inside);
+        const float* row1 = row0 + kSamples;
+        float dx = 0.0f, dz = 0.0f;
+        if (inside) {
+            dx = ((row0[1] - row0[0]) * (1.0f - tz) + (row1[1] - row1[0]) * tz) / kCellSize;
+            dz = ((row1[0] - row0[0]) * (1.0f - tx) + (row1[1] - row0[1]) * tx) / kCellSize;
+        }
+        const float len = sqrtf(dx * dx + 1.0f + dz * dz);
+        normal[0] = -dx / len;
+        normal[1] = 1.0f / len;
+        normal[2] = -dz / len;
+    }
+
+    // One chunk at one level: its grid vertices, then a skirt copy of the
+    // border dropped by kSkirtDepth, as indexed triangles
+    static void buildChunkLevel(int ci, int cj, int step, std::vector<Sample>& verts, std::vector<GLuint>& indices) {
+        const int n = kChunkCells / step + 1;
+        verts.clear();
+        indices.clear();
+        for (int b = 0; b < n; ++b) {
+            for (int a = 0; a < n; ++a) {
+                verts.push_back(samples[(cj * kChunkCells + b * step) * kSamples + ci * kChunkCells + a * step]);
+            }
+        }
+        // Same diagonal as the old triangle strips: (a, b+1) to (a+1, b)
+        for (int b = 0; b + 1 < n; ++b) {
+            for (int a = 0; a + 1 < n; ++a) {
+                const GLuint v00 = b * n + a, v10 = v00 + 1, v01 = v00 + n, v11 = v01 + 1;
+                const GLuint quad[6] = { v00, v01, v10, v01, v10, v11 };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+
+        // Border walk, counter-clockwise, closing the loop
+        std::vector<GLuint> border;
+        for (int a = 0; a < n - 1; ++a) border.push_back(a);
+        for (int b = 0; b < n - 1; ++b) border.push_back(b * n + n - 1);
+        for (int a = n - 1; a > 0; --a) border.push_back((n - 1) * n + a);
+        for (int b = n - 1; b > 0; --b) border.push_back(b * n);
+        const GLuint skirtBase = (GLuint)verts.size();
+        for (GLuint v : border) {
+            Sample s = verts[v];
+            s.py -= kSkirtDepth;
+            verts.push_back(s);
+        }
+        for (size_t k = 0; k < border.size(); ++k) {
+            const size_t next = (k + 1) % border.size();
+            const GLuint top0 = border[k], top1 = border[next];
+            const GLuint low0 = skirtBase + (GLuint)k, low1 = skirtBase + (GLuint)next;
+            const GLuint quad[6] = { top0, low0, top1, top1, low0, low1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    void upload() {
+        generate();
+        release();
+        std::vector<Sample> verts;
+        std::vector<GLuint> indices;
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        for (int cj = 0; cj < kChunks; ++cj) {
+            for (int ci = 0; ci < kChunks; ++ci) {
+                Chunk& chunk = chunks[cj * kChunks + ci];
+                chunk.min[0] = ci * kChunkCells * kCellSize - kExtent;
+                chunk.min[2] = cj * kChunkCells * kCellSize - kExtent;
+                chunk.max[0] = chunk.min[0] + kChunkCells * kCellSize;
+                chunk.max[2] = chunk.min[2] + kChunkCells * kCellSize;
+                chunk.min[1] = 1e30f;
+                chunk.max[1] = -1e30f;
+                for (int b = 0; b <= kChunkCells; ++b) {
+                    for (int a = 0; a <= kChunkCells; ++a) {
+                        const float y = heights[(cj * kChunkCells + b) * kSamples + ci * kChunkCells + a];
+                        chunk.min[1] = y < chunk.min[1] ? y : chunk.min[1];
+                        chunk.max[1] = y > chunk.max[1] ? y : chunk.max[1];
+                    }
+                }
+                chunk.min[1] -= kSkirtDepth;
+
+                chunk.lists = glGenLists(kLevels);
+                for (int level = 0; level < kLevels && chunk.lists; ++level) {
+                    buildChunkLevel(ci, cj, 1 << level, verts, indices);
+                    const Sample* s = verts.data();
+                    glVertexPointer(3, GL_FLOAT, sizeof(Sample), &s->px);
+                    glNormalPointer(GL_FLOAT, sizeof(Sample), &s->nx);
+                    glColorPointer(3, GL_FLOAT, sizeof(Sample), &s->r);
+                    glTexCoordPointer(2, GL_FLOAT, sizeof(Sample), &s->u);
+                    glNewList(chunk.lists + level, GL_COMPILE);
+                    glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, indices.data());
+                    glEndList();
+                }
+            }
+        }
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        uploaded = true;
+    }
+
+    void release() {
+        if (!uploaded) return;
+        for (Chunk& chunk : chunks) {
+            if (chunk.lists) glDeleteLists(chunk.lists, kLevels);
+            chunk.lists = 0;
+        }
+        uploaded = false;
+    }
+
+    void draw(DrawStats* stats) {
+        DrawStats local = {};
+        if (!uploaded) upload();
+        const Frustum frustum = Frustum::fromCurrentMatrices();
+        for (const Chunk& chunk : chunks) {
+            if (!chunk.lists || !frustum.boxVisible(chunk.min, chunk.max)) {
+                ++local.chunksCulled;
+                continue;
+            }
+            // Distance from the eye to the chunk's box
+            float d2 = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                const float e = frustum.eye[k];
+                const float d = e < chunk.min[k] ? chunk.min[k] - e : (e > chunk.max[k] ? e - chunk.max[k] : 0.0f);
+                d2 += d * d;
+            }
+            int level = 0;
+            while (level < kLevels - 1 && d2 > kLevelDistance[level] * kLevelDistance[level]) ++level;
+            glCallList(chunk.lists + level);
+            ++local.chunksDrawn;
+            ++local.chunksPerLevel[level];
+        }
+        // Vertex colours leave the current colour undefined
+        glColor3f(1.0f, 1.0f, 1.0f);
+        if (stats) *stats = local;
+    }
+}
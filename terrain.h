@@ -0,0 +1,47 @@
+#pragma once
+
+#include "platform.h"
+
+// The battlefield ground as a precomputed heightfield.
+//
+// The surface is the same analytic formula drawBattlefield used to evaluate
+// per vertex (rolling hills, mud ruts, trampling), sampled once on a 101x101
+// grid at 2-unit spacing over [-100, 100]^2 with positions, gradient normals,
+// stain colours and texture coordinates. For drawing, the grid is split into
+// 5x5 chunks of 20x20 cells, each compiled into a display list at three
+// levels of detail (every 1st, 2nd and 4th vertex) with skirts hiding the
+// cracks between neighbouring levels. draw() culls chunks against the view
+// frustum and picks a level by distance from the eye.
+//
+// Everything is in background space (the background is drawn 2.5 units
+// lower than the character's world; see renderScene()).
+namespace Terrain {
+    const int kGridCells = 100;         // Cells per side
+    const float kCellSize = 2.0f;
+    const float kExtent = kGridCells * kCellSize * 0.5f; // Grid covers [-kExtent, kExtent]
+
+    // The closed-form surface the grid is sampled from
+    float analyticHeight(float x, float z);
+
+    // Builds the grid on first use; safe without a GL context
+    void generate();
+
+    // Height of the ground at (x, z), bilinear between grid samples and
+    // clamped to the border outside the grid. O(1): one cell lookup.
+    float heightAt(float x, float z);
+
+    // Unit normal of the same bilinear surface (straight up outside the grid)
+    void normalAt(float x, float z, float normal[3]);
+
+    // Display lists for every chunk and level; needs a current GL context
+    void upload();
+    void release();
+
+    // Draws the visible chunks with the currently bound texture
+    struct DrawStats {
+        unsigned chunksDrawn;
+        unsigned chunksCulled;
+        unsigned chunksPerLevel[3];
+    };
+    void draw(DrawStats* stats = nullptr);
+}
@@ -1,6 +1,5 @@
 #pragma once
-#include <Windows.h>
-#include <gl/GL.h>
+#include "platform.h"
 
 // Central registry of all model textures
 namespace Tex {
@@ -26,8 +25,12 @@ namespace Tex {
 
     extern GLuint id[COUNT];
 
-    // Loads every texture into Tex::id[]. Safe to call once at init.
+    // Queues every texture on the texture manager and fills Tex::id[] with
+    // their names. Safe to call once at init.
     void loadAll();
+    // Once per frame after the manager's uploads: a file that failed to load
+    // gets id 0 (drawn untextured), as it did when loading was synchronous
+    void refresh();
 
     // Simple 2D bind/unbind (inline to avoid link issues)
     inline void bind(GLuint texId) { glBindTexture(GL_TEXTURE_2D, texId); }
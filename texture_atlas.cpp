@@ -0,0 +1,118 @@
+#include "texture_atlas.h"
+#include "bmp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Bilinear BGR sample at texel coordinates (x, y), y up, clamped to the edge
+    void sample(const Bmp::Bitmap& bitmap, float x, float y, float out[3]) {
+        const int bytesPerPixel = bitmap.bitsPerPixel / 8;
+        x = std::min(std::max(x, 0.0f), (float)(bitmap.width - 1));
+        y = std::min(std::max(y, 0.0f), (float)(bitmap.height - 1));
+        const int x0 = (int)x, y0 = (int)y;
+        const int x1 = std::min(x0 + 1, bitmap.width - 1), y1 = std::min(y0 + 1, bitmap.height - 1);
+        const float fx = x - x0, fy = y - y0;
+        const unsigned char* row0 = bitmap.rows + bitmap.stride * (bitmap.topDown ? bitmap.height - 1 - y0 : y0);
+        const unsigned char* row1 = bitmap.rows + bitmap.stride * (bitmap.topDown ? bitmap.height - 1 - y1 : y1);
+        for (int c = 0; c < 3; ++c) {
+            const float bottom = row0[x0 * bytesPerPixel + c] * (1.0f - fx) + row0[x1 * bytesPerPixel + c] * fx;
+            const float top = row1[x0 * bytesPerPixel + c] * (1.0f - fx) + row1[x1 * bytesPerPixel + c] * fx;
+            out[c] = bottom * (1.0f - fy) + top * fy;
+        }
+    }
+
+    // Scales the bitmap into size x size texels at dst; steps of more than a
+    // source texel average a grid of bilinear taps so nothing is skipped
+    void scaleInto(const Bmp::Bitmap& bitmap, unsigned char* dst, size_t dstStride, int size) {
+        const float scaleX = (float)bitmap.width / size, scaleY = (float)bitmap.height / size;
+        const int tapsX = std::max(1, (int)std::ceil(scaleX)), tapsY = std::max(1, (int)std::ceil(scaleY));
+        const float weight = 1.0f / (tapsX * tapsY);
+        for (int y = 0; y < size; ++y) {
+            unsigned char* out = dst + dstStride * y;
+            for (int x = 0; x < size; ++x) {
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+                for (int ty = 0; ty < tapsY; ++ty) {
+                    for (int tx = 0; tx < tapsX; ++tx) {
+                        float texel[3];
+                        sample(bitmap, (x + (tx + 0.5f) / tapsX) * scaleX - 0.5f, (y + (ty + 0.5f) / tapsY) * scaleY - 0.5f, texel);
+                        for (int c = 0; c < 3; ++c) sum[c] += texel[c];
+                    }
+                }
+                for (int c = 0; c < 3; ++c) out[x * 3 + c] = (unsigned char)(sum[c] * weight + 0.5f);
+            }
+        }
+    }
+}
+
+namespace TextureAtlas {
+    Rect Layout::rect(int cell) const {
+        const float x = (float)((cell % columns) * cellSize), y = (float)((cell / columns) * cellSize);
+        const Rect r = {
+            (x + gutter) / width(), (y + gutter) / height(),
+            (x + cellSize - gutter) / width(), (y + cellSize - gutter) / height()
+        };
+        return r;
+    }
+
+    Layout layoutFor(int cellCount, int cellSize, int gutter) {
+        Layout layout;
+        layout.columns = std::max(1, (int)std::ceil(std::sqrt((double)cellCount)));
+        layout.rows = std::max(1, (cellCount + layout.columns - 1) / layout.columns);
+        layout.cellSize = cellSize;
+        layout.gutter = gutter;
+        return layout;
+    }
+
+    int pack(const std::vector<std::string>& paths, const Layout& layout, Platform::Image& out) {
+        const size_t stride = ((size_t)layout.width() * 3 + 3) & ~(size_t)3;
+        out.width = layout.width();
+        out.height = layout.height();
+        out.bitsPerPixel = 24;
+        out.pixels.assign(stride * out.height, 255);
+
+        int missing = 0;
+        const int inner = layout.cellSize - 2 * layout.gutter;
+        for (size_t cell = 0; cell < paths.size() && (int)cell < layout.columns * layout.rows; ++cell) {
+            const int left = ((int)cell % layout.columns) * layout.cellSize;
+            const int bottom = ((int)cell / layout.columns) * layout.cellSize;
+            unsigned char* origin = out.pixels.data() + stride * bottom + left * 3;
+
+            Bmp::Bitmap bitmap;
+            if (!Bmp::open(paths[cell].c_str(), bitmap)) {
+                ++missing;
+                continue;
+            }
+            scaleInto(bitmap, origin + stride * layout.gutter + layout.gutter * 3, stride, inner);
+
+            // Repeat the edge texels into the gutter: columns first, then whole rows
+            for (int y = layout.gutter; y < layout.gutter + inner; ++y) {
+                unsigned char* row = origin + stride * y;
+                for (int g = 0; g < layout.gutter; ++g) {
+                    memcpy(row + g * 3, row + layout.gutter * 3, 3);
+                    memcpy(row + (layout.gutter + inner + g) * 3, row + (layout.gutter + inner - 1) * 3, 3);
+                }
+            }
+            const size_t rowBytes = (size_t)layout.cellSize * 3;
+            for (int g = 0; g < layout.gutter; ++g) {
+                memcpy(origin + stride * g, origin + stride * layout.gutter, rowBytes);
+                memcpy(origin + stride * (layout.gutter + inner + g), origin + stride * (layout.gutter + inner - 1), rowBytes);
+            }
+        }
+        return missing;
+    }
+
+    void loadTextureMatrix(const Rect& rect) {
+        glMatrixMode(GL_TEXTURE);
+        glLoadIdentity();
+        glTranslatef(rect.s0, rect.t0, 0.0f);
+        glScalef(rect.s1 - rect.s0, rect.t1 - rect.t0, 1.0f);
+        glMatrixMode(GL_MODELVIEW);
+    }
+
+    void resetTextureMatrix() {
+        glMatrixMode(GL_TEXTURE);
+        glLoadIdentity();
+        glMatrixMode(GL_MODELVIEW);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "platform.h"
+#include <string>
+#include <vector>
+
+// Several small textures packed into one, so passes that draw them can share
+// a bind.
+//
+// The layout is a fixed grid of square cells, known before any file is read:
+// callers get each member's texture rectangle at request time and can bake it
+// into display lists while the atlas is still loading. Every source is scaled
+// to fill its cell (box-filtered down, bilinear up) inside a gutter of
+// repeated edge texels, and the rectangle covers the inside of the gutter, so
+// linear filtering at its edges never reaches the neighbouring cell.
+namespace TextureAtlas {
+    // Texture coordinates of a member; (s0, t0) is the bottom-left corner
+    struct Rect { float s0, t0, s1, t1; };
+
+    struct Layout {
+        int columns = 0, rows = 0;
+        int cellSize = 0;           // Texels, gutter included
+        int gutter = 0;
+
+        int width() const { return columns * cellSize; }
+        int height() const { return rows * cellSize; }
+        Rect rect(int cell) const;  // Cells run left to right, bottom row first
+    };
+
+    // The smallest grid close to square with room for cellCount cells
+    Layout layoutFor(int cellCount, int cellSize, int gutter = 2);
+
+    // Decodes paths[i] into cell i of a 24-bit bottom-up image. A file that
+    // cannot be opened leaves its cell white, like a missing texture; returns
+    // how many were missing. Safe on a worker thread (no GL).
+    int pack(const std::vector<std::string>& paths, const Layout& layout, Platform::Image& out);
+
+    // Maps s and t in [0, 1] into rect as a texture matrix, so draws written
+    // for a whole texture can use one member unchanged; both leave the
+    // modelview matrix current
+    void loadTextureMatrix(const Rect& rect);
+    void resetTextureMatrix();
+}
@@ -0,0 +1,317 @@
+#include "texture_manager.h"
+#include "bmp.h"
+#include "cooked_texture.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace TextureManager {
+    namespace {
+        struct Entry {
+            std::string path, fallbackPath;
+            Generator generator;
+            std::vector<std::string> atlasPaths;    // Members, for an atlas
+            TextureAtlas::Layout atlasLayout;
+            GLuint name;
+            // Owned by the worker until queued for upload; at most one is filled
+            CookedTexture::Texture cooked;  // Mapped .mtex next to the source, when there is one
+            Bmp::Bitmap bitmap;             // Mapped source file
+            Platform::Image image;          // Generated pixels when neither could be opened
+            bool failed = false;
+            bool ready = false;
+            int width = 0, height = 0;
+            size_t bytes = 0;               // Handed to GL
+            size_t gpuBytes = 0;            // Held by the driver, all levels
+            const char* format = "";
+            double requestedAt = 0.0;
+            double decodeMs = 0.0, uploadMs = 0.0, waitMs = 0.0;
+        };
+
+        std::vector<std::unique_ptr<Entry>> entries;   // Render thread only
+        std::vector<Entry*> placeholders;              // Requested while a list compiled; render thread only
+        std::mutex mutex;
+        std::condition_variable wake;                  // Worker: decode work or stop
+        std::condition_variable decoded;               // finish(): an upload is waiting
+        std::deque<Entry*> decodeQueue, uploadQueue;
+        int decoding = 0;
+        bool stopping = false;
+
+        void stopWorker();
+
+        // Joined on exit even if shutdown() was never called
+        struct Worker {
+            std::thread thread;
+            ~Worker() { stopWorker(); }
+        } worker;
+
+        void fillWhite(Platform::Image& out) {
+            out.width = out.height = 2;
+            out.bitsPerPixel = 24;
+            out.pixels.assign(16, 255);                // Two rows of 6 bytes, padded to 8
+        }
+
+        // The cooked form wins when this context can take it
+        bool openSource(Entry& entry, const std::string& path) {
+            if (CookedTexture::open(CookedTexture::pathFor(path.c_str()).c_str(), entry.cooked)) {
+                if (CookedTexture::canUpload(entry.cooked)) return true;
+                CookedTexture::close(entry.cooked);
+            }
+            return Bmp::open(path.c_str(), entry.bitmap);
+        }
+
+        void workerLoop() {
+            for (;;) {
+                Entry* entry;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [] { return stopping || !decodeQueue.empty(); });
+                    if (stopping) return;
+                    entry = decodeQueue.front();
+                    decodeQueue.pop_front();
+                    ++decoding;
+                }
+
+                // The render thread leaves the entry alone until it is queued
+                const double start = Platform::timeSeconds();
+                bool ok;
+                if (!entry->atlasPaths.empty()) {
+                    ok = TextureAtlas::pack(entry->atlasPaths, entry->atlasLayout, entry->image) < (int)entry->atlasPaths.size();
+                } else {
+                    ok = openSource(*entry, entry->path);
+                    if (!ok && !entry->fallbackPath.empty()) ok = openSource(*entry, entry->fallbackPath);
+                }
+                if (!ok) {                          // An atlas of missing files is plain white too
+                    if (entry->generator) entry->generator(entry->image);
+                    else fillWhite(entry->image);
+                }
+                const double decodeMs = (Platform::timeSeconds() - start) * 1000.0;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    entry->failed = !ok;
+                    entry->bytes = entry->cooked.levels ? entry->cooked.bytes() :
+                                   entry->bitmap.rows ? entry->bitmap.bytes() : entry->image.pixels.size();
+                    entry->decodeMs = decodeMs;
+                    uploadQueue.push_back(entry);
+                    --decoding;
+                }
+                decoded.notify_all();
+            }
+        }
+
+        void stopWorker() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+                decodeQueue.clear();
+                uploadQueue.clear();
+            }
+            wake.notify_all();
+            if (worker.thread.joinable()) worker.thread.join();
+        }
+
+        void setParameters() {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // (no mipmaps)
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        }
+
+        void upload(Entry& entry) {
+            const double start = Platform::timeSeconds();
+            const Platform::Image& image = entry.image;
+            GLint previous = 0;                        // Callers' binding survives the upload
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+            glBindTexture(GL_TEXTURE_2D, entry.name);
+            if (entry.cooked.levels) {
+                CookedTexture::upload(entry.cooked);   // Every mip level, straight from the mapped file
+                entry.width = entry.cooked.width;
+                entry.height = entry.cooked.height;
+                entry.gpuBytes = CookedTexture::gpuBytes(entry.cooked);
+                entry.format = entry.cooked.format == CookedTexture::FORMAT_BC1 ? "bc1+mips" : "bgr+mips";
+            } else if (entry.bitmap.rows) {
+                Bmp::upload(entry.bitmap);             // Straight from the mapped file
+                entry.width = entry.bitmap.width;
+                entry.height = entry.bitmap.height;
+                entry.gpuBytes = CookedTexture::gpuBytesRGB(entry.width, entry.height);
+                entry.format = "bmp";
+            } else {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // BMP-style rows are 4-byte aligned
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0,
+                             image.bitsPerPixel == 32 ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE, image.pixels.data());
+                entry.width = image.width;
+                entry.height = image.height;
+                entry.gpuBytes = CookedTexture::gpuBytesRGB(entry.width, entry.height);
+                entry.format = !entry.atlasPaths.empty() && !entry.failed ? "atlas" : entry.generator ? "generated" : "white";
+            }
+            glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
+            const double end = Platform::timeSeconds();
+
+            entry.uploadMs = (end - start) * 1000.0;
+            entry.waitMs = (end - entry.requestedAt) * 1000.0;
+            entry.ready = true;
+            CookedTexture::close(entry.cooked);        // Release the mapping or the staging copy
+            Bmp::close(entry.bitmap);
+            entry.image = Platform::Image();
+        }
+
+        void createPlaceholder(const Entry& entry) {
+            const unsigned char grey[4] = { 128, 128, 128, 0 };
+            GLint previous = 0;
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+            glBindTexture(GL_TEXTURE_2D, entry.name);
+            setParameters();
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grey);
+            glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
+        }
+
+        Handle find(const std::string& path) {
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i]->path == path) return (Handle)i;
+            }
+            return -1;
+        }
+
+        // Gives the entry its placeholder texture and hands it to the worker
+        Handle queue(std::unique_ptr<Entry> entry) {
+            entry->requestedAt = Platform::timeSeconds();
+
+            // Placeholder until the upload; the name never changes after this.
+            // While a display list compiles (a recorded frame, command_list.h)
+            // the upload would land in the list, so it waits for uploadPending()
+            GLint compiling = 0;
+            glGetIntegerv(GL_LIST_INDEX, &compiling);
+            glGenTextures(1, &entry->name);
+            if (compiling) placeholders.push_back(entry.get());
+            else createPlaceholder(*entry);
+
+            Entry* queued = entry.get();
+            entries.push_back(std::move(entry));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!worker.thread.joinable()) {
+                    stopping = false;
+                    worker.thread = std::thread(workerLoop);
+                }
+                decodeQueue.push_back(queued);
+            }
+            wake.notify_one();
+            return (Handle)(entries.size() - 1);
+        }
+    }
+
+    Handle request(const char* path, const char* fallbackPath, Generator generator) {
+        const Handle existing = find(path);
+        if (existing >= 0) return existing;
+
+        std::unique_ptr<Entry> entry(new Entry());
+        entry->path = path;
+        entry->fallbackPath = fallbackPath ? fallbackPath : "";
+        entry->generator = generator;
+        return queue(std::move(entry));
+    }
+
+    Handle requestAtlas(const std::vector<std::string>& paths, const TextureAtlas::Layout& layout) {
+        // Named after its members, so asking again for the same set shares it
+        std::string key = "atlas:";
+        for (size_t i = 0; i < paths.size(); ++i) key += (i ? "|" : "") + paths[i];
+        const Handle existing = find(key);
+        if (existing >= 0) return existing;
+
+        std::unique_ptr<Entry> entry(new Entry());
+        entry->path = key;
+        entry->atlasPaths = paths;
+        entry->atlasLayout = layout;
+        return queue(std::move(entry));
+    }
+
+    GLuint name(Handle handle) {
+        return handle >= 0 && handle < (Handle)entries.size() ? entries[handle]->name : 0;
+    }
+
+    bool ready(Handle handle) {
+        return handle >= 0 && handle < (Handle)entries.size() && entries[handle]->ready;
+    }
+
+    bool failed(Handle handle) {
+        return handle >= 0 && handle < (Handle)entries.size() && entries[handle]->ready && entries[handle]->failed;
+    }
+
+    void uploadPending(size_t byteBudget) {
+        for (Entry* entry : placeholders) createPlaceholder(*entry);
+        placeholders.clear();
+
+        size_t spent = 0;
+        for (;;) {
+            Entry* entry;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (uploadQueue.empty()) return;
+                entry = uploadQueue.front();
+                if (spent > 0 && spent + entry->bytes > byteBudget) return;
+                uploadQueue.pop_front();
+            }
+            spent += entry->bytes;
+            upload(*entry);
+        }
+    }
+
+    void finish() {
+        for (;;) {
+            uploadPending((size_t)-1);
+            std::unique_lock<std::mutex> lock(mutex);
+            if (decodeQueue.empty() && uploadQueue.empty() && decoding == 0) return;
+            decoded.wait(lock, [] { return !uploadQueue.empty(); });
+        }
+    }
+
+    int pendingCount() {
+        int pending = 0;
+        for (const std::unique_ptr<Entry>& entry : entries) pending += entry->ready ? 0 : 1;
+        return pending;
+    }
+
+    void printReport(FILE* out) {
+        double decodeTotal = 0.0, uploadTotal = 0.0, uploadWorst = 0.0;
+        double waitWorst = 0.0;
+        size_t bytes = 0, gpuBytes = 0;
+        fprintf(out, "%-38s %11s %9s %8s %8s %10s %10s %10s\n", "texture", "size", "format", "KB", "GPU KB",
+                "decode ms", "upload ms", "wait ms");
+        for (const std::unique_ptr<Entry>& entry : entries) {
+            char label[64];
+            snprintf(label, sizeof(label), "(atlas of %zu)", entry->atlasPaths.size());
+            const char* path = entry->atlasPaths.empty() ? entry->path.c_str() : label;
+            if (!entry->ready) {
+                fprintf(out, "%-38s %11s\n", path, "(pending)");
+                continue;
+            }
+            char size[32];
+            snprintf(size, sizeof(size), "%dx%d", entry->width, entry->height);
+            fprintf(out, "%-38s %11s %9s %8.0f %8.0f %10.2f %10.2f %10.1f\n", path, size, entry->format,
+                    entry->bytes / 1024.0, entry->gpuBytes / 1024.0, entry->decodeMs, entry->uploadMs, entry->waitMs);
+            decodeTotal += entry->decodeMs;
+            uploadTotal += entry->uploadMs;
+            if (entry->uploadMs > uploadWorst) uploadWorst = entry->uploadMs;
+            if (entry->waitMs > waitWorst) waitWorst = entry->waitMs;
+            bytes += entry->bytes;
+            gpuBytes += entry->gpuBytes;
+        }
+        fprintf(out, "%zu textures, %.1f MB uploaded, %.1f MB on the GPU: decode %.1f ms on the worker, "
+                "upload %.1f ms on the render thread (worst %.2f ms), longest wait %.1f ms\n",
+                entries.size(), bytes / (1024.0 * 1024.0), gpuBytes / (1024.0 * 1024.0), decodeTotal, uploadTotal, uploadWorst,
+                waitWorst);
+    }
+
+    void shutdown() {
+        stopWorker();
+        for (const std::unique_ptr<Entry>& entry : entries) glDeleteTextures(1, &entry->name);
+        entries.clear();
+        placeholders.clear();
+    }
+}
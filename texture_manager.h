@@ -0,0 +1,63 @@
+#pragma once
+
+#include "platform.h"
+#include "texture_atlas.h"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Asynchronous texture loading shared by the character (Tex) and the
+// background.
+//
+// request() returns at once: it creates the GL texture holding a 1x1 grey
+// placeholder and queues the file for a worker thread, which maps it and
+// reads its pages in (bmp.h). Once per frame the render thread calls
+// uploadPending(), which uploads finished files straight from their mappings,
+// oldest first, until a byte budget is spent. A texture keeps its GL name
+// from placeholder to real image, so callers can bind it, store it or record
+// it into display lists straight away. Every file is requested once; repeated
+// paths share a texture. A cooked file next to the source (cooked_texture.h)
+// is used instead of it when present, bringing its mip chain and compression
+// with it.
+namespace TextureManager {
+    typedef int Handle;
+
+    // Fills in a replacement image when the file and its fallback both fail
+    // (runs on the worker thread)
+    typedef void (*Generator)(Platform::Image& out);
+
+    // Default per-frame upload budget, about four 1024x1024 RGB textures
+    const size_t kFrameUploadBudget = 12u << 20;
+
+    // Queues path (then fallbackPath) for decoding. Without a generator a file
+    // that cannot be loaded becomes plain white. Render thread only. Inside a
+    // display list being compiled the placeholder upload would be recorded
+    // into it, so the texture stays empty (untextured) until the next
+    // uploadPending().
+    Handle request(const char* path, const char* fallbackPath = nullptr, Generator generator = nullptr);
+    // Queues paths for packing into one texture laid out as layout says
+    // (texture_atlas.h); same rules as request(). Failed only when every
+    // member is missing.
+    Handle requestAtlas(const std::vector<std::string>& paths, const TextureAtlas::Layout& layout);
+
+    GLuint name(Handle handle);
+    bool ready(Handle handle);      // The real (or replacement) image is uploaded
+    bool failed(Handle handle);     // Ready, but from the generator or the white fallback
+
+    // Uploads decoded images until byteBudget is spent; at least one per call
+    // so a texture larger than the budget still goes through
+    void uploadPending(size_t byteBudget);
+    // Blocks until everything requested so far is decoded and uploaded
+    void finish();
+    // Requests not yet uploaded
+    int pendingCount();
+
+    // Per texture: size, source format (cooked or not), bytes uploaded and held
+    // by the driver, decode time on the worker, upload time on the render
+    // thread, and the wait from request to upload
+    void printReport(FILE* out);
+
+    // Stops the worker and deletes every texture
+    void shutdown();
+}
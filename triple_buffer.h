@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+
+// Hands whole values from one writer thread to one reader thread without a
+// lock, the reader always getting the newest complete one.
+//
+// Three slots: the writer fills back() and publish()es it, which swaps it
+// with the middle slot in one atomic exchange; the reader's acquire() swaps
+// the middle slot with the one it holds when something new was published
+// there. Neither side ever waits for the other or sees a slot the other is
+// using. A value published twice before the reader looks is replaced, never
+// queued. Slots are reused, so a T holding vectors keeps their storage.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer
+    T& back() { return slots[backIndex]; }
+    void publish() {
+        backIndex = middle.exchange(backIndex | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader. False (front() unchanged) when nothing was published since the last call.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static const unsigned kIndexMask = 3;
+    static const unsigned kFresh = 4;       // The middle slot was published and not yet acquired
+
+    T slots[3];
+    unsigned backIndex = 0;                 // Writer only
+    unsigned frontIndex = 1;                // Reader only
+    std::atomic<unsigned> middle{ 2 };
+};
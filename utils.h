@@ -1,8 +1,7 @@
 #pragma once
 
 #include <vector>
-#include <gl/GL.h>   // Added for OpenGL types
-#include <gl/GLU.h>  // Added for GLUquadric
+#include "platform.h"  // OpenGL types and GLUquadric
 #define _USE_MATH_DEFINES
 #include <cmath>
 